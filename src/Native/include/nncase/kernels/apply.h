@@ -19,9 +19,12 @@
 #include <alloca.h> // alloca
 #endif
 
+#include <algorithm>
+#include <array>
 #include <nncase/runtime/datatypes.h>
 #include <nncase/runtime/error.h>
 #include <nncase/runtime/result.h>
+#include <utility>
 
 #define BEGIN_NS_NNCASE_KERNELS_STACKVM                                        \
     namespace nncase {                                                         \
@@ -150,4 +153,176 @@ result<void> apply(gsl::span<const size_t> shape,
     return detail::apply_generic(shape, std::forward<Callable>(callable));
 }
 
+namespace detail {
+// Elements below this count are iterated on the calling thread.
+inline constexpr size_t apply_strided_parallel_threshold = 32768;
+// Smallest inner block handed to a thread when an inner run is split.
+inline constexpr size_t apply_strided_min_block = 4096;
+
+/**
+ * Shape and per-operand strides after dropping extent-1 dims and merging
+ * every dim into its outer neighbour when that is contiguous for all
+ * operands. Broadcast operands (stride 0) merge with each other as well.
+ * The innermost dim is always present.
+ */
+template <size_t N> struct strided_loop {
+    dims_t shape;
+    std::array<strides_t, N> strides;
+};
+
+template <size_t N>
+strided_loop<N>
+coalesce_strided_loop(gsl::span<const size_t> shape,
+                      const std::array<gsl::span<const size_t>, N> &strides) {
+    strided_loop<N> loop;
+    for (size_t i = 0; i < shape.size(); i++) {
+        if (shape[i] == 1)
+            continue;
+
+        bool mergeable = !loop.shape.empty();
+        for (size_t k = 0; k < N && mergeable; k++)
+            mergeable = loop.strides[k].back() == strides[k][i] * shape[i];
+        if (mergeable) {
+            loop.shape.back() *= shape[i];
+            for (size_t k = 0; k < N; k++)
+                loop.strides[k].back() = strides[k][i];
+        } else {
+            loop.shape.push_back(shape[i]);
+            for (size_t k = 0; k < N; k++)
+                loop.strides[k].push_back(strides[k][i]);
+        }
+    }
+
+    if (loop.shape.empty()) {
+        loop.shape.push_back(1);
+        for (size_t k = 0; k < N; k++)
+            loop.strides[k].push_back(1);
+    }
+    return loop;
+}
+
+template <size_t N, class Callable, size_t... I>
+void apply_strided_run(const std::array<size_t, N> &base,
+                       const std::array<size_t, N> &steps, size_t count,
+                       Callable &callable, std::index_sequence<I...>) {
+    if (((steps[I] == 1) && ...)) {
+        for (size_t i = 0; i < count; i++)
+            callable((base[I] + i)...);
+    } else {
+        for (size_t i = 0; i < count; i++)
+            callable((base[I] + i * steps[I])...);
+    }
+}
+
+// Runs tasks [begin, end), where task t is block (t % blocks) of the inner
+// run selected by outer index (t / blocks).
+template <size_t N, class Callable>
+void apply_strided_tasks(const strided_loop<N> &loop, size_t blocks,
+                         size_t block_size, size_t begin, size_t end,
+                         Callable &callable) {
+    const auto outer_rank = loop.shape.size() - 1;
+    const auto inner_size = loop.shape.back();
+    std::array<size_t, N> steps;
+    for (size_t k = 0; k < N; k++)
+        steps[k] = loop.strides[k].back();
+
+    dims_t index(outer_rank);
+    std::array<size_t, N> base{};
+    auto outer = begin / blocks;
+    auto block = begin % blocks;
+    for (size_t d = outer_rank; d-- > 0;) {
+        index[d] = outer % loop.shape[d];
+        outer /= loop.shape[d];
+        for (size_t k = 0; k < N; k++)
+            base[k] += index[d] * loop.strides[k][d];
+    }
+
+    for (auto task = begin; task < end; task++) {
+        const auto first = block * block_size;
+        const auto count = std::min(block_size, inner_size - first);
+        std::array<size_t, N> run_base;
+        for (size_t k = 0; k < N; k++)
+            run_base[k] = base[k] + first * steps[k];
+        apply_strided_run(run_base, steps, count, callable,
+                          std::make_index_sequence<N>());
+
+        if (++block == blocks) {
+            block = 0;
+            for (size_t d = outer_rank; d-- > 0;) {
+                for (size_t k = 0; k < N; k++)
+                    base[k] += loop.strides[k][d];
+                if (++index[d] < loop.shape[d])
+                    break;
+                for (size_t k = 0; k < N; k++)
+                    base[k] -= loop.strides[k][d] * loop.shape[d];
+                index[d] = 0;
+            }
+        }
+    }
+}
+} // namespace detail
+
+/**
+ * Strided counterpart of apply() for elementwise kernels.
+ *
+ * Walks `shape` once for N operands described by `strides` (element strides,
+ * 0 for broadcast dims) and calls `callable(offset_0, ..., offset_N-1)` for
+ * every element. Contiguous dims are coalesced and the innermost run is a
+ * plain counted loop, so simple callables vectorize. With num_threads > 1
+ * the runs (split into blocks when there are few of them) are distributed
+ * over OpenMP threads; callables must then only write their own element.
+ */
+template <size_t N, class Callable>
+void apply_strided(gsl::span<const size_t> shape,
+                   const std::array<gsl::span<const size_t>, N> &strides,
+                   Callable &&callable,
+                   [[maybe_unused]] size_t num_threads = 1) noexcept {
+    const auto loop = detail::coalesce_strided_loop<N>(shape, strides);
+    size_t outer_size = 1;
+    for (size_t d = 0; d + 1 < loop.shape.size(); d++)
+        outer_size *= loop.shape[d];
+    const auto inner_size = loop.shape.back();
+    const auto size = outer_size * inner_size;
+    if (size == 0)
+        return;
+
+#ifdef NNCASE_OPENMP
+    if (num_threads > 1 && size >= detail::apply_strided_parallel_threshold) {
+        size_t blocks = 1;
+        if (outer_size < num_threads)
+            blocks = std::max(
+                (size_t)1,
+                std::min((num_threads + outer_size - 1) / outer_size,
+                         inner_size / detail::apply_strided_min_block));
+        const auto block_size = (inner_size + blocks - 1) / blocks;
+        blocks = (inner_size + block_size - 1) / block_size;
+        const auto tasks = outer_size * blocks;
+        const auto threads = (int64_t)std::min(num_threads, tasks);
+#pragma omp parallel for num_threads(threads)
+        for (int64_t t = 0; t < threads; t++) {
+            detail::apply_strided_tasks(loop, blocks, block_size,
+                                        tasks * t / threads,
+                                        tasks * (t + 1) / threads, callable);
+        }
+        return;
+    }
+#endif
+    detail::apply_strided_tasks(loop, 1, inner_size, 0, outer_size, callable);
+}
+
+/**
+ * Strides of an operand of `in_shape` broadcast to `out_shape`: leading and
+ * extent-1 dims get stride 0.
+ */
+inline strides_t broadcast_strides(gsl::span<const size_t> in_shape,
+                                   gsl::span<const size_t> in_strides,
+                                   gsl::span<const size_t> out_shape) {
+    strides_t strides(out_shape.size());
+    const auto ext = out_shape.size() - in_shape.size();
+    for (size_t i = 0; i < out_shape.size(); i++)
+        strides[i] =
+            i < ext || in_shape[i - ext] == 1 ? 0 : in_strides[i - ext];
+    return strides;
+}
+
 END_NS_NNCASE_KERNELS_STACKVM
@@ -0,0 +1,61 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <nncase/runtime/result.h>
+#include <string>
+
+BEGIN_NS_NNCASE_KERNELS
+
+/**
+ * Instruction set levels the x86_64 kernels are built for. Each level
+ * implies the ones before it:
+ *   sse4_2: SSE4.2
+ *   avx2:   AVX, AVX2, FMA and F16C
+ *   avx512: avx2 plus AVX-512 F, BW, DQ and VL
+ *   avx512_vnni: avx512 plus AVX512-VNNI
+ *   avx512_bf16: avx512_vnni plus AVX512-BF16
+ */
+enum class cpu_isa_t : uint8_t {
+    generic,
+    sse4_2,
+    avx2,
+    avx512,
+    avx512_vnni,
+    avx512_bf16,
+};
+
+NNCASE_API const char *to_string(cpu_isa_t isa) noexcept;
+
+/** Highest level supported by both this CPU and the OS (saved registers). */
+NNCASE_API cpu_isa_t detected_cpu_isa() noexcept;
+
+/**
+ * Level the dispatched kernels run at. Defaults to detected_cpu_isa(),
+ * lowered by the NNCASE_KERNEL_ISA environment variable
+ * (generic, sse4.2, avx2, avx512, avx512_vnni or avx512_bf16) when it is set
+ * at startup.
+ */
+NNCASE_API cpu_isa_t kernel_isa() noexcept;
+
+/**
+ * Overrides the level the dispatched kernels run at. Returns not_supported
+ * when `isa` is above detected_cpu_isa().
+ */
+NNCASE_API result<void> set_kernel_isa(cpu_isa_t isa) noexcept;
+
+/** Human readable CPU features and kernel variant selection. */
+NNCASE_API std::string kernel_variant_report();
+
+END_NS_NNCASE_KERNELS
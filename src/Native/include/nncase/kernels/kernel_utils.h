@@ -17,9 +17,11 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <nncase/kernels/stackvm/resize_image.h>
 #include <nncase/runtime/datatypes.h>
 #include <numeric>
+#include <type_traits>
 
 #ifdef __GNUC__
 #define CXX_RESTRICT __restrict__
@@ -220,6 +222,26 @@ constexpr T quantize(float value, const quant_param_t &param) noexcept {
                     (int32_t)std::numeric_limits<T>::max());
 }
 
+// Floating point to integer conversions saturate to the range of the
+// destination and map NaN to 0, where static_cast is undefined.
+template <class TOutput, class TInput>
+inline TOutput saturate_cast(TInput value) noexcept {
+    if constexpr (std::is_integral_v<TOutput> &&
+                  !std::is_same_v<TOutput, bool> &&
+                  !std::is_integral_v<TInput>) {
+        const auto f = static_cast<float>(value);
+        if (std::isnan(f))
+            return 0;
+        if (f <= (float)std::numeric_limits<TOutput>::lowest())
+            return std::numeric_limits<TOutput>::lowest();
+        if (f >= (float)std::numeric_limits<TOutput>::max())
+            return std::numeric_limits<TOutput>::max();
+        return static_cast<TOutput>(f);
+    } else {
+        return static_cast<TOutput>(value);
+    }
+}
+
 inline std::pair<float, float>
 get_resize_scales(gsl::span<const size_t> in_shape, int32_t out_h,
                   int32_t out_w, bool align_corners) {
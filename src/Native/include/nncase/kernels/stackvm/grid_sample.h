@@ -0,0 +1,66 @@
+/* Copyright 2019-2023 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <nncase/compiler_defs.h>
+#include <nncase/runtime/stackvm/opcode.h>
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+
+// Mirrors x at low and high until it lies in [low, high], with the same
+// arithmetic as onnxruntime. The fold count stays in float, so coordinates
+// far outside the input do not overflow an integer conversion.
+inline float grid_sample_reflect(float x, float low, float high) noexcept {
+    const auto range = high - low;
+    if (range <= 0)
+        return low;
+    if (x < low || x > high) {
+        if (!std::isfinite(x))
+            return x;
+        const auto dx = x < low ? low - x : x - high;
+        const auto n = std::floor(dx / range);
+        const auto r = dx - n * range;
+        const auto even = std::fmod(n, 2.f) == 0;
+        return (x < low) == even ? low + r : high - r;
+    }
+    return x;
+}
+
+// Input coordinate of a normalized grid value along a dim of the given size,
+// after the padding mode. The result is clamped to a range that still lies
+// fully outside the input, so it converts to an integer safely; NaN maps
+// outside as well.
+inline float grid_sample_source_coordinate(
+    float v, size_t size, bool align_corners,
+    runtime::stackvm::grid_sample_padding_mode_t padding_mode) noexcept {
+    using runtime::stackvm::grid_sample_padding_mode_t;
+    const auto extent = (float)size;
+    auto x = align_corners ? (v + 1) / 2 * (extent - 1)
+                           : ((v + 1) * extent - 1) / 2;
+    // reflect at pixel centers with align_corners, else at pixel edges
+    if (padding_mode == grid_sample_padding_mode_t::reflection)
+        x = align_corners ? grid_sample_reflect(x, 0.f, extent - 1)
+                          : grid_sample_reflect(x, -0.5f, extent - 0.5f);
+    if (padding_mode != grid_sample_padding_mode_t::zeros)
+        x = std::min(std::max(x, 0.f), extent - 1);
+    if (!(x >= -2.f))
+        return -2.f;
+    return std::min(x, extent + 1);
+}
+
+END_NS_NNCASE_KERNELS_MODULE
@@ -0,0 +1,43 @@
+/* Copyright 2019-2023 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include <nncase/kernels/kernel_context.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/result.h>
+#include <nncase/value.h>
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+
+// u8 x i8 kernels that requantize the int32 accumulators to target_type
+// (u8, i8 or i32) with per-tensor or per-channel output scales. They have no
+// IR op or stackvm tensor function yet, so they are declared here rather
+// than in the generated tensor_ops.h.
+
+NNCASE_API result<value_t>
+quantized_conv2d(typecode_t target_type, value_t input, value_t weights,
+                 value_t bias, value_t stride, value_t padding,
+                 value_t dilation, value_t groups, value_t fused_clamp,
+                 value_t input_zero_point, value_t output_scales,
+                 value_t output_zero_point, value_t output = nullptr,
+                 kernel_context &context = default_kernel_context());
+
+NNCASE_API result<value_t>
+quantized_mat_mul(typecode_t target_type, value_t lhs, value_t rhs,
+                  value_t lhs_zero_point, value_t output_scales,
+                  value_t output_zero_point, value_t output = nullptr,
+                  kernel_context &context = default_kernel_context());
+
+END_NS_NNCASE_KERNELS_MODULE
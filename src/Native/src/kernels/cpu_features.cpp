@@ -0,0 +1,241 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <nncase/kernels/cpu_features.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NNCASE_X86_CPUID 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace nncase;
+using namespace nncase::kernels;
+
+namespace {
+struct cpu_features {
+    bool sse4_2 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512dq = false;
+    bool avx512vl = false;
+    bool avx512vnni = false;
+    bool avx512bf16 = false;
+    bool os_ymm = false;
+    bool os_zmm = false;
+};
+
+#ifdef NNCASE_X86_CPUID
+void cpuid(uint32_t leaf, uint32_t sub_leaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+    __cpuidex(reinterpret_cast<int *>(regs), (int)leaf, (int)sub_leaf);
+#else
+    __cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t xgetbv0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+#endif
+}
+#endif
+
+cpu_features query_cpu_features() noexcept {
+    cpu_features f;
+#ifdef NNCASE_X86_CPUID
+    uint32_t regs[4];
+    cpuid(0, 0, regs);
+    const uint32_t max_leaf = regs[0];
+    if (max_leaf < 1)
+        return f;
+
+    cpuid(1, 0, regs);
+    const uint32_t ecx1 = regs[2];
+    f.sse4_2 = ecx1 & (1u << 20);
+    f.fma = ecx1 & (1u << 12);
+    f.f16c = ecx1 & (1u << 29);
+    f.avx = ecx1 & (1u << 28);
+
+    // AVX state must also be enabled by the OS, see XCR0
+    if (ecx1 & (1u << 27)) {
+        const uint64_t xcr0 = xgetbv0();
+        f.os_ymm = (xcr0 & 0x6) == 0x6;
+        f.os_zmm = (xcr0 & 0xe6) == 0xe6;
+    }
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        const uint32_t ebx7 = regs[1];
+        const uint32_t max_sub_leaf7 = regs[0];
+        const uint32_t ecx7 = regs[2];
+        f.avx2 = ebx7 & (1u << 5);
+        f.avx512f = ebx7 & (1u << 16);
+        f.avx512dq = ebx7 & (1u << 17);
+        f.avx512bw = ebx7 & (1u << 30);
+        f.avx512vl = ebx7 & (1u << 31);
+        f.avx512vnni = ecx7 & (1u << 11);
+
+        if (max_sub_leaf7 >= 1) {
+            cpuid(7, 1, regs);
+            f.avx512bf16 = regs[0] & (1u << 5);
+        }
+    }
+#endif
+    return f;
+}
+
+const cpu_features &host_cpu_features() noexcept {
+    static const cpu_features features = query_cpu_features();
+    return features;
+}
+
+cpu_isa_t isa_from_features(const cpu_features &f) noexcept {
+    const bool avx2 = f.os_ymm && f.avx && f.avx2 && f.fma && f.f16c;
+    const bool avx512 = avx2 && f.os_zmm && f.avx512f && f.avx512bw &&
+                        f.avx512dq && f.avx512vl;
+    if (avx512 && f.avx512vnni && f.avx512bf16)
+        return cpu_isa_t::avx512_bf16;
+    if (avx512 && f.avx512vnni)
+        return cpu_isa_t::avx512_vnni;
+    if (avx512)
+        return cpu_isa_t::avx512;
+    if (avx2)
+        return cpu_isa_t::avx2;
+    if (f.sse4_2)
+        return cpu_isa_t::sse4_2;
+    return cpu_isa_t::generic;
+}
+
+bool parse_isa(const char *name, cpu_isa_t &isa) noexcept {
+    for (auto candidate : {cpu_isa_t::generic, cpu_isa_t::sse4_2,
+                           cpu_isa_t::avx2, cpu_isa_t::avx512,
+                           cpu_isa_t::avx512_vnni,
+                           cpu_isa_t::avx512_bf16}) {
+        if (!strcmp(name, to_string(candidate))) {
+            isa = candidate;
+            return true;
+        }
+    }
+
+    if (!strcmp(name, "sse4_2")) {
+        isa = cpu_isa_t::sse4_2;
+        return true;
+    }
+    return false;
+}
+
+struct kernel_isa_holder {
+    std::atomic<cpu_isa_t> isa;
+    const char *env_value = nullptr;
+    bool env_applied = false;
+
+    kernel_isa_holder() : isa(detected_cpu_isa()) {
+        env_value = std::getenv("NNCASE_KERNEL_ISA");
+        cpu_isa_t requested;
+        if (env_value && parse_isa(env_value, requested) &&
+            requested <= detected_cpu_isa()) {
+            isa = requested;
+            env_applied = true;
+        }
+    }
+};
+
+kernel_isa_holder &kernel_isa_state() noexcept {
+    static kernel_isa_holder holder;
+    return holder;
+}
+} // namespace
+
+const char *kernels::to_string(cpu_isa_t isa) noexcept {
+    switch (isa) {
+    case cpu_isa_t::sse4_2:
+        return "sse4.2";
+    case cpu_isa_t::avx2:
+        return "avx2";
+    case cpu_isa_t::avx512:
+        return "avx512";
+    case cpu_isa_t::avx512_vnni:
+        return "avx512_vnni";
+    case cpu_isa_t::avx512_bf16:
+        return "avx512_bf16";
+    default:
+        return "generic";
+    }
+}
+
+cpu_isa_t kernels::detected_cpu_isa() noexcept {
+    static const cpu_isa_t isa = isa_from_features(host_cpu_features());
+    return isa;
+}
+
+cpu_isa_t kernels::kernel_isa() noexcept {
+    return kernel_isa_state().isa.load(std::memory_order_relaxed);
+}
+
+result<void> kernels::set_kernel_isa(cpu_isa_t isa) noexcept {
+    if (isa > detected_cpu_isa())
+        return err(std::errc::not_supported);
+    kernel_isa_state().isa.store(isa, std::memory_order_relaxed);
+    return ok();
+}
+
+std::string kernels::kernel_variant_report() {
+    auto &f = host_cpu_features();
+    auto &state = kernel_isa_state();
+    std::string report = "cpu features:";
+    auto feature = [&](bool present, const char *name) {
+        if (present)
+            report.append(" ").append(name);
+    };
+    feature(f.sse4_2, "sse4.2");
+    feature(f.avx && f.os_ymm, "avx");
+    feature(f.avx2 && f.os_ymm, "avx2");
+    feature(f.fma && f.os_ymm, "fma");
+    feature(f.f16c, "f16c");
+    feature(f.avx512f && f.os_zmm, "avx512f");
+    feature(f.avx512bw && f.os_zmm, "avx512bw");
+    feature(f.avx512dq && f.os_zmm, "avx512dq");
+    feature(f.avx512vl && f.os_zmm, "avx512vl");
+    feature(f.avx512vnni && f.os_zmm, "avx512vnni");
+    feature(f.avx512bf16 && f.os_zmm, "avx512bf16");
+
+    report.append("\ndetected isa: ").append(to_string(detected_cpu_isa()));
+    report.append("\nkernel isa: ").append(to_string(kernel_isa()));
+    if (state.env_value) {
+        report.append("\nNNCASE_KERNEL_ISA=").append(state.env_value);
+        if (!state.env_applied)
+            report.append(" (ignored)");
+    }
+#ifdef NNCASE_KERNEL_ISA_DISPATCH
+    report.append("\nkernel variants: runtime dispatch");
+#else
+    report.append("\nkernel variants: fixed at build time");
+#endif
+    return report;
+}
@@ -0,0 +1,41 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+result<void> optimized::activation(
+    NNCASE_UNUSED activation_op_t op, NNCASE_UNUSED typecode_t typecode,
+    NNCASE_UNUSED const gsl::byte *input, NNCASE_UNUSED gsl::byte *output,
+    NNCASE_UNUSED size_t count, NNCASE_UNUSED const gsl::byte *alpha,
+    NNCASE_UNUSED const gsl::byte *gamma,
+    NNCASE_UNUSED kernel_context &context) noexcept {
+    return err(std::errc::not_supported);
+}
+
+result<void> optimized::prelu(NNCASE_UNUSED typecode_t typecode,
+                              NNCASE_UNUSED const gsl::byte *input,
+                              NNCASE_UNUSED const gsl::byte *slope,
+                              NNCASE_UNUSED gsl::byte *output,
+                              NNCASE_UNUSED gsl::span<const size_t> in_shape,
+                              NNCASE_UNUSED gsl::span<const size_t> slope_shape,
+                              NNCASE_UNUSED kernel_context &context) noexcept {
+    return err(std::errc::not_supported);
+}
@@ -0,0 +1,154 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Input is [block... x batch, channels..., spatial...] and output is
+ * [batch, channels..., spatial x block - crops...]. The source offset of an
+ * output element is a sum of one term per output dim, so the innermost dim
+ * reads through a precomputed offset table and the outer dims only add a
+ * per-row base.
+ */
+template <class T>
+void batch_to_space_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape,
+                         gsl::span<const size_t> block_shape,
+                         const paddings_t &crops,
+                         gsl::span<const size_t> in_strides,
+                         gsl::span<const size_t> out_shape,
+                         gsl::span<const size_t> out_strides,
+                         kernel_context &context) {
+    const auto rank = in_shape.size();
+    const auto spatial_start = rank - block_shape.size();
+    const auto batch = out_shape[0];
+
+    // moving one block phase along spatial dim d steps this far in input
+    std::vector<size_t> phase_strides(block_shape.size());
+    auto phase_stride = batch * in_strides[0];
+    for (size_t d = block_shape.size(); d-- > 0;) {
+        phase_strides[d] = phase_stride;
+        phase_stride *= block_shape[d];
+    }
+
+    auto source_offset = [&](size_t d, size_t index) {
+        const auto s = d - spatial_start;
+        const auto pos = index + (size_t)crops[s].before;
+        return (pos % block_shape[s]) * phase_strides[s] +
+               (pos / block_shape[s]) * in_strides[d];
+    };
+
+    const auto row_width = out_shape[rank - 1];
+    std::vector<size_t> columns(row_width);
+    for (size_t x = 0; x < row_width; x++)
+        columns[x] = source_offset(rank - 1, x);
+
+    const auto rows = compute_size(out_shape.subspan(0, rank - 1));
+    const auto out_col_stride = out_strides[rank - 1];
+    NNCASE_UNUSED const auto threads =
+        rows * row_width * sizeof(T) < parallel_copy_threshold
+            ? 1
+            : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t r = 0; r < (int64_t)rows; r++) {
+        size_t src = 0, dst = 0;
+        auto rest = (size_t)r;
+        for (size_t d = rank - 1; d-- > 0;) {
+            const auto index = rest % out_shape[d];
+            rest /= out_shape[d];
+            dst += index * out_strides[d];
+            src += d < spatial_start ? index * in_strides[d]
+                                     : source_offset(d, index);
+        }
+
+        auto src_row = input + src;
+        auto dst_row = output + dst;
+        if (out_col_stride == 1) {
+            for (size_t x = 0; x < row_width; x++)
+                dst_row[x] = src_row[columns[x]];
+        } else {
+            for (size_t x = 0; x < row_width; x++)
+                dst_row[x * out_col_stride] = src_row[columns[x]];
+        }
+    }
+}
+} // namespace
+
+#define BATCH_TO_SPACE_IMPL(size, type)                                        \
+    case size:                                                                 \
+        batch_to_space_impl(reinterpret_cast<const type *>(input),             \
+                            reinterpret_cast<type *>(output), in_shape,        \
+                            block_shape, crops, in_strides, out_shape,         \
+                            out_strides, context);                             \
+        return ok()
+
+result<void> optimized::batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    const auto rank = in_shape.size();
+    const auto block_size = compute_size(block_shape);
+    if (block_shape.empty() || block_shape.size() >= rank ||
+        out_shape.size() != rank || out_strides.size() != rank ||
+        crops.size() < block_shape.size() || block_size == 0 ||
+        in_shape[0] % block_size != 0)
+        return err(std::errc::not_supported);
+
+    // the kernel writes every element of out_shape, so it must be exactly the
+    // shape the block layout produces
+    if (out_shape[0] != in_shape[0] / block_size)
+        return err(std::errc::not_supported);
+    const auto spatial_start = rank - block_shape.size();
+    for (size_t d = 1; d < rank; d++) {
+        auto expected = in_shape[d];
+        if (d >= spatial_start) {
+            const auto s = d - spatial_start;
+            const auto extent = expected * block_shape[s];
+            if (crops[s].before < 0 || crops[s].after < 0 ||
+                (size_t)crops[s].sum() > extent)
+                return err(std::errc::not_supported);
+            expected = extent - crops[s].sum();
+        }
+        if (out_shape[d] != expected)
+            return err(std::errc::not_supported);
+    }
+    if (compute_size(out_shape) == 0)
+        return ok();
+
+    switch (runtime::get_bytes(type)) {
+        BATCH_TO_SPACE_IMPL(1, uint8_t);
+        BATCH_TO_SPACE_IMPL(2, uint16_t);
+        BATCH_TO_SPACE_IMPL(4, uint32_t);
+        BATCH_TO_SPACE_IMPL(8, uint64_t);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
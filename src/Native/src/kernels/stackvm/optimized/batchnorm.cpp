@@ -0,0 +1,97 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// (x - mean) / sqrt(var + eps) * scale + bias is folded into x * a[c] + b[c]
+// per channel, leaving one multiply-add per element.
+result<void> batchnorm_impl(const float *input, const float *scale,
+                            const float *bias, const float *input_mean,
+                            const float *input_var, float *output,
+                            gsl::span<const size_t> in_shape, float epsilon,
+                            NNCASE_UNUSED kernel_context &context) {
+    const auto channels = in_shape[1];
+    const auto outer_size = in_shape[0] * channels;
+    size_t inner_size = 1;
+    for (size_t i = 2; i < in_shape.size(); i++)
+        inner_size *= in_shape[i];
+
+    std::vector<float> a(channels), b(channels);
+    for (size_t c = 0; c < channels; c++) {
+        a[c] = scale[c] / std::sqrt(input_var[c] + epsilon);
+        b[c] = bias[c] - input_mean[c] * a[c];
+    }
+
+    NNCASE_UNUSED const auto threads =
+        outer_size * inner_size < parallel_threshold ? 1 : context.num_threads;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t i = 0; i < (int64_t)outer_size; i++) {
+        const auto c = (size_t)i % channels;
+        const auto a_c = a[c], b_c = b[c];
+        auto in_ = input + i * inner_size;
+        auto out_ = output + i * inner_size;
+        size_t j = 0;
+#if __AVX2__
+        const __m256 va = _mm256_set1_ps(a_c), vb = _mm256_set1_ps(b_c);
+        for (; j + 8 <= inner_size; j += 8)
+            _mm256_storeu_ps(out_ + j,
+                             _mm256_fmadd_ps(_mm256_loadu_ps(in_ + j), va, vb));
+#endif
+        for (; j < inner_size; j++)
+            out_[j] = in_[j] * a_c + b_c;
+    }
+    return ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::batchnorm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+    const gsl::byte *bias, const gsl::byte *input_mean,
+    const gsl::byte *input_var, gsl::byte *output,
+    gsl::span<const size_t> in_shape, float epsilon,
+    kernel_context &context) noexcept {
+    if (typecode == dt_float32 && in_shape.size() >= 2) {
+        return batchnorm_impl(reinterpret_cast<const float *>(input),
+                              reinterpret_cast<const float *>(scale),
+                              reinterpret_cast<const float *>(bias),
+                              reinterpret_cast<const float *>(input_mean),
+                              reinterpret_cast<const float *>(input_var),
+                              reinterpret_cast<float *>(output), in_shape,
+                              epsilon, context);
+    }
+
+    auto strides = get_default_strides(in_shape);
+    return reference::batchnorm(typecode, input, scale, bias, input_mean,
+                                input_var, output, in_shape, strides, strides,
+                                epsilon);
+}
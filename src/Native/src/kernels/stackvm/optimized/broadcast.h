@@ -0,0 +1,131 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "opt_ops.h"
+#include <algorithm>
+#include <array>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+namespace optimized {
+BEGIN_NS_NNCASE_KERNEL_ISA
+
+/**
+ * Broadcast layout of N contiguous inputs against a contiguous output.
+ *
+ * As in binary, output dims of extent 1 are dropped and neighbouring dims
+ * that broadcast the same inputs are coalesced, leaving an inner run plus a
+ * few outer dims. An input with inner_broadcast set supplies one element to
+ * the whole inner run.
+ */
+template <size_t N> struct broadcast_plan {
+    dims_t outer_shape;
+    std::array<strides_t, N> outer_strides;
+    size_t inner_size = 1;
+    std::array<bool, N> inner_broadcast{};
+};
+
+template <size_t N>
+broadcast_plan<N>
+make_broadcast_plan(const std::array<gsl::span<const size_t>, N> &in_shapes,
+                    gsl::span<const size_t> out_shape) {
+    using broadcast_mask = std::array<bool, N>;
+    dims_t dims;
+    itlib::small_vector<broadcast_mask, 8> broadcasts;
+    for (size_t i = 0; i < out_shape.size(); i++) {
+        if (out_shape[i] == 1)
+            continue;
+        broadcast_mask mask;
+        for (size_t n = 0; n < N; n++) {
+            const auto ext = out_shape.size() - in_shapes[n].size();
+            mask[n] = i < ext || in_shapes[n][i - ext] == 1;
+        }
+        if (!dims.empty() && broadcasts.back() == mask)
+            dims.back() *= out_shape[i];
+        else {
+            dims.push_back(out_shape[i]);
+            broadcasts.push_back(mask);
+        }
+    }
+
+    broadcast_plan<N> plan;
+    if (dims.empty())
+        return plan;
+
+    plan.inner_size = dims.back();
+    plan.inner_broadcast = broadcasts.back();
+
+    const auto outer_rank = dims.size() - 1;
+    plan.outer_shape.assign(dims.begin(), dims.begin() + outer_rank);
+    for (size_t n = 0; n < N; n++) {
+        auto &strides = plan.outer_strides[n];
+        strides.resize(outer_rank);
+        size_t stride = plan.inner_broadcast[n] ? 1 : plan.inner_size;
+        for (size_t i = outer_rank; i-- > 0;) {
+            strides[i] = broadcasts[i][n] ? 0 : stride;
+            if (!broadcasts[i][n])
+                stride *= dims[i];
+        }
+    }
+    return plan;
+}
+
+/**
+ * Calls f(offsets, out_offset, begin, end) for every inner run of the plan,
+ * where offsets[n] is the start of input n's run and [begin, end) the part
+ * of the run to compute. Runs are split into blocks of `parallel_block`
+ * when there are too few of them to keep every thread busy.
+ */
+template <size_t N, class F>
+void for_each_broadcast_run(const broadcast_plan<N> &plan,
+                            NNCASE_UNUSED uint32_t num_threads,
+                            size_t parallel_block, F &&f) {
+    const auto outer_size = runtime::compute_size(plan.outer_shape);
+    if (outer_size == 0 || plan.inner_size == 0)
+        return;
+
+    const auto inner_blocks =
+        outer_size >= num_threads
+            ? 1
+            : (plan.inner_size + parallel_block - 1) / parallel_block;
+    const auto tasks = (int64_t)(outer_size * inner_blocks);
+    const auto block_size =
+        (plan.inner_size + inner_blocks - 1) / inner_blocks;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+    for (int64_t task = 0; task < tasks; task++) {
+        auto outer = (size_t)task / inner_blocks;
+        const auto block = (size_t)task % inner_blocks;
+        const auto out_offset = outer * plan.inner_size;
+        std::array<size_t, N> offsets{};
+        for (size_t i = plan.outer_shape.size(); i-- > 0;) {
+            const auto index = outer % plan.outer_shape[i];
+            outer /= plan.outer_shape[i];
+            for (size_t n = 0; n < N; n++)
+                offsets[n] += index * plan.outer_strides[n][i];
+        }
+
+        const auto begin = block * block_size;
+        f(offsets, out_offset, begin,
+          std::min(begin + block_size, plan.inner_size));
+    }
+}
+
+END_NS_NNCASE_KERNEL_ISA
+} // namespace optimized
+END_NS_NNCASE_KERNELS_MODULE
@@ -0,0 +1,286 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <type_traits>
+#if __AVX__ || __F16C__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <class TInput, class TOutput>
+void cast_block(const TInput *input, TOutput *output, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        output[i] = kernels::detail::saturate_cast<TOutput>(input[i]);
+}
+
+#if __F16C__
+template <> void cast_block(const float *input, half *output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(input + i),
+                                         _MM_FROUND_TO_NEAREST_INT));
+    for (; i < count; i++)
+        output[i] = half::round_to_half(input[i]);
+}
+
+template <> void cast_block(const half *input, float *output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(output + i,
+                         _mm256_cvtph_ps(_mm_loadu_si128(
+                             reinterpret_cast<const __m128i *>(input + i))));
+    for (; i < count; i++)
+        output[i] = input[i];
+}
+#endif
+
+#if __AVX2__
+// Round to nearest even on the upper 16 bits, as round_to_bfloat16 does:
+// add 0x7fff plus the lsb of the result, then NaN is forced to 0x7fc0.
+template <>
+void cast_block(const float *input, bfloat16 *output, size_t count) {
+    const __m256i bias = _mm256_set1_epi32(0x7fff);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i nan = _mm256_set1_epi32(0x7fc0);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i r[2];
+        for (size_t k = 0; k < 2; k++) {
+            const __m256 v = _mm256_loadu_ps(input + i + k * 8);
+            const __m256i u = _mm256_castps_si256(v);
+            const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(u, 16), one);
+            const __m256i rounded = _mm256_srli_epi32(
+                _mm256_add_epi32(u, _mm256_add_epi32(bias, lsb)), 16);
+            r[k] = _mm256_blendv_epi8(
+                rounded, nan,
+                _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+        }
+        // packus works per 128-bit lane, so restore the element order
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i),
+                            _mm256_permute4x64_epi64(
+                                _mm256_packus_epi32(r[0], r[1]),
+                                _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    for (; i < count; i++)
+        output[i] = bfloat16::round_to_bfloat16(input[i]);
+}
+
+template <>
+void cast_block(const bfloat16 *input, float *output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i u = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)));
+        _mm256_storeu_ps(output + i,
+                         _mm256_castsi256_ps(_mm256_slli_epi32(u, 16)));
+    }
+    for (; i < count; i++)
+        output[i] = input[i];
+}
+#endif
+
+#if __AVX__
+// Clamps to [lo, hi] with NaN mapped to 0, then truncates toward zero.
+inline __m256i saturate_cvtt(__m256 v, __m256 lo, __m256 hi) {
+    v = _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+    return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+}
+
+template <>
+void cast_block(const float *input, int32_t *output, size_t count) {
+    // INT32_MAX has no float, so lanes at or above 2^31 are patched after
+    // the conversion to match convert()
+    const __m256 lo = _mm256_set1_ps(-2147483648.f);
+    const __m256 hi = _mm256_set1_ps(2147483648.f);
+    const __m256 max = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(input + i);
+        const __m256 r = _mm256_castsi256_ps(saturate_cvtt(v, lo, hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i),
+                            _mm256_castps_si256(_mm256_blendv_ps(
+                                r, max, _mm256_cmp_ps(v, hi, _CMP_GE_OQ))));
+    }
+    for (; i < count; i++)
+        output[i] = kernels::detail::saturate_cast<int32_t>(input[i]);
+}
+
+template <class T>
+void cast_float_to_narrow(const float *input, T *output, size_t count) {
+    const __m256 lo = _mm256_set1_ps((float)std::numeric_limits<T>::lowest());
+    const __m256 hi = _mm256_set1_ps((float)std::numeric_limits<T>::max());
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = saturate_cvtt(_mm256_loadu_ps(input + i), lo, hi);
+        // the values already fit, so the packs below only narrow the lanes
+        const __m128i v16 =
+            std::is_same_v<T, uint16_t>
+                ? _mm_packus_epi32(_mm256_castsi256_si128(v),
+                                   _mm256_extractf128_si256(v, 1))
+                : _mm_packs_epi32(_mm256_castsi256_si128(v),
+                                  _mm256_extractf128_si256(v, 1));
+        if constexpr (sizeof(T) == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), v16);
+        } else {
+            const __m128i v8 = std::is_signed_v<T> ? _mm_packs_epi16(v16, v16)
+                                                   : _mm_packus_epi16(v16, v16);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + i), v8);
+        }
+    }
+    for (; i < count; i++)
+        output[i] = kernels::detail::saturate_cast<T>(input[i]);
+}
+
+template <>
+void cast_block(const float *input, int16_t *output, size_t count) {
+    cast_float_to_narrow(input, output, count);
+}
+
+template <>
+void cast_block(const float *input, uint16_t *output, size_t count) {
+    cast_float_to_narrow(input, output, count);
+}
+
+template <>
+void cast_block(const float *input, int8_t *output, size_t count) {
+    cast_float_to_narrow(input, output, count);
+}
+
+template <>
+void cast_block(const float *input, uint8_t *output, size_t count) {
+    cast_float_to_narrow(input, output, count);
+}
+
+template <>
+void cast_block(const int32_t *input, float *output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(output + i,
+                         _mm256_cvtepi32_ps(_mm256_loadu_si256(
+                             reinterpret_cast<const __m256i *>(input + i))));
+    for (; i < count; i++)
+        output[i] = (float)input[i];
+}
+
+template <class T>
+void cast_byte_to_float(const T *input, float *output, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i b =
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i));
+        const __m128i b_hi = _mm_srli_si128(b, 4);
+        const __m256i v =
+            std::is_signed_v<T>
+                ? _mm256_insertf128_si256(
+                      _mm256_castsi128_si256(_mm_cvtepi8_epi32(b)),
+                      _mm_cvtepi8_epi32(b_hi), 1)
+                : _mm256_insertf128_si256(
+                      _mm256_castsi128_si256(_mm_cvtepu8_epi32(b)),
+                      _mm_cvtepu8_epi32(b_hi), 1);
+        _mm256_storeu_ps(output + i, _mm256_cvtepi32_ps(v));
+    }
+    for (; i < count; i++)
+        output[i] = (float)input[i];
+}
+
+template <>
+void cast_block(const int8_t *input, float *output, size_t count) {
+    cast_byte_to_float(input, output, count);
+}
+
+template <>
+void cast_block(const uint8_t *input, float *output, size_t count) {
+    cast_byte_to_float(input, output, count);
+}
+#endif
+
+template <class TInput, class TOutput>
+void cast_impl(const TInput *input, TOutput *output, size_t count,
+               kernel_context &context) {
+    for_each_block(
+        count,
+        [&](size_t begin, size_t end) {
+            cast_block(input + begin, output + begin, end - begin);
+        },
+        context);
+}
+} // namespace
+
+#define CAST_IMPL_LV2(input_t, output_t)                                       \
+    if (cmp_type<output_t>(out_type)) {                                        \
+        cast_impl(reinterpret_cast<const input_t *>(input),                    \
+                  reinterpret_cast<output_t *>(output), count, context);       \
+        return ok();                                                           \
+    }
+
+#define CAST_IMPL_LV1(input_t)                                                 \
+    if (cmp_type<input_t>(in_type)) {                                          \
+        CAST_IMPL_LV2(input_t, bool);                                          \
+        CAST_IMPL_LV2(input_t, uint8_t);                                       \
+        CAST_IMPL_LV2(input_t, uint16_t);                                      \
+        CAST_IMPL_LV2(input_t, uint32_t);                                      \
+        CAST_IMPL_LV2(input_t, uint64_t);                                      \
+        CAST_IMPL_LV2(input_t, int8_t);                                        \
+        CAST_IMPL_LV2(input_t, int16_t);                                       \
+        CAST_IMPL_LV2(input_t, int32_t);                                       \
+        CAST_IMPL_LV2(input_t, int64_t);                                       \
+        CAST_IMPL_LV2(input_t, float);                                         \
+    }
+
+result<void> optimized::cast(datatype_t in_type, datatype_t out_type,
+                             const gsl::byte *input, gsl::byte *output,
+                             gsl::span<const size_t> in_shape,
+                             gsl::span<const size_t> in_strides,
+                             gsl::span<const size_t> out_strides,
+                             kernel_context &context) noexcept {
+    if (is_contiguous(in_shape, in_strides) &&
+        is_contiguous(in_shape, out_strides)) {
+        const auto count = compute_size(in_shape);
+        if (cmp_dt(in_type, dt_float32)) {
+            CAST_IMPL_LV2(float, bfloat16);
+            CAST_IMPL_LV2(float, half);
+        }
+        CAST_IMPL_LV1(bool);
+        CAST_IMPL_LV1(uint8_t);
+        CAST_IMPL_LV1(uint16_t);
+        CAST_IMPL_LV1(uint32_t);
+        CAST_IMPL_LV1(uint64_t);
+        CAST_IMPL_LV1(int8_t);
+        CAST_IMPL_LV1(int16_t);
+        CAST_IMPL_LV1(int32_t);
+        CAST_IMPL_LV1(int64_t);
+        CAST_IMPL_LV1(bfloat16);
+        CAST_IMPL_LV1(half);
+        CAST_IMPL_LV1(float);
+    }
+
+    return stackvm::reference::cast(in_type, out_type, input, output, in_shape,
+                                    in_strides, out_strides, context);
+}
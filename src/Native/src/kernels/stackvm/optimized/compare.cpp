@@ -0,0 +1,207 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "broadcast.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <compare_op_t Op, class T> bool compare_scalar(T a, T b) {
+    if constexpr (Op == compare_op_t::equal)
+        return a == b;
+    else if constexpr (Op == compare_op_t::not_equal)
+        return a != b;
+    else if constexpr (Op == compare_op_t::greater_than)
+        return a > b;
+    else if constexpr (Op == compare_op_t::greater_or_equal)
+        return a >= b;
+    else if constexpr (Op == compare_op_t::lower_than)
+        return a < b;
+    else
+        return a <= b;
+}
+
+template <class T> struct avx_compare {
+    static constexpr bool enabled = false;
+};
+
+#if __AVX2__
+template <> struct avx_compare<float> {
+    static constexpr bool enabled = true;
+    using type = __m256;
+    static type load(const float *p) { return _mm256_loadu_ps(p); }
+    static type set1(float v) { return _mm256_set1_ps(v); }
+
+    // All ones in the lanes where `a op b` holds, false for NaN except with
+    // not_equal.
+    template <compare_op_t Op> static __m256i mask(type a, type b) {
+        constexpr int predicate =
+            Op == compare_op_t::equal              ? _CMP_EQ_OQ
+            : Op == compare_op_t::not_equal        ? _CMP_NEQ_UQ
+            : Op == compare_op_t::greater_than     ? _CMP_GT_OQ
+            : Op == compare_op_t::greater_or_equal ? _CMP_GE_OQ
+            : Op == compare_op_t::lower_than       ? _CMP_LT_OQ
+                                                   : _CMP_LE_OQ;
+        return _mm256_castps_si256(_mm256_cmp_ps(a, b, predicate));
+    }
+};
+
+template <> struct avx_compare<int32_t> {
+    static constexpr bool enabled = true;
+    using type = __m256i;
+    static type load(const int32_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+    static type set1(int32_t v) { return _mm256_set1_epi32(v); }
+
+    template <compare_op_t Op> static __m256i mask(type a, type b) {
+        const auto ones = _mm256_set1_epi32(-1);
+        if constexpr (Op == compare_op_t::equal)
+            return _mm256_cmpeq_epi32(a, b);
+        else if constexpr (Op == compare_op_t::not_equal)
+            return _mm256_xor_si256(_mm256_cmpeq_epi32(a, b), ones);
+        else if constexpr (Op == compare_op_t::greater_than)
+            return _mm256_cmpgt_epi32(a, b);
+        else if constexpr (Op == compare_op_t::greater_or_equal)
+            return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), ones);
+        else if constexpr (Op == compare_op_t::lower_than)
+            return _mm256_cmpgt_epi32(b, a);
+        else
+            return _mm256_xor_si256(_mm256_cmpgt_epi32(a, b), ones);
+    }
+};
+
+// Narrows four 8-lane masks to 32 bools in element order.
+__m256i pack_masks(__m256i m0, __m256i m1, __m256i m2, __m256i m3) {
+    // packs work per 128-bit lane, leaving 4-byte groups of m0..m3
+    // interleaved between the two halves
+    const auto bytes = _mm256_packs_epi16(_mm256_packs_epi32(m0, m1),
+                                          _mm256_packs_epi32(m2, m3));
+    const auto ordered = _mm256_permutevar8x32_epi32(
+        bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    return _mm256_and_si256(ordered, _mm256_set1_epi8(1));
+}
+#endif
+
+// out[i] = lhs[i] op rhs[i] over [begin, end), a broadcast side is read
+// from its first element
+template <compare_op_t Op, bool LhsBroadcast, bool RhsBroadcast, class T>
+void compare_run(const T *lhs, const T *rhs, bool *out, size_t begin,
+                 size_t end) {
+    size_t i = begin;
+#if __AVX2__
+    using vec = avx_compare<T>;
+    if constexpr (vec::enabled) {
+        const auto load = [](const T *p, bool broadcast, size_t j) {
+            return broadcast ? vec::set1(*p) : vec::load(p + j);
+        };
+        for (; i + 32 <= end; i += 32) {
+            __m256i masks[4];
+            for (size_t k = 0; k < 4; k++) {
+                const auto j = i + k * 8;
+                masks[k] = vec::template mask<Op>(load(lhs, LhsBroadcast, j),
+                                                  load(rhs, RhsBroadcast, j));
+            }
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out + i),
+                pack_masks(masks[0], masks[1], masks[2], masks[3]));
+        }
+    }
+#endif
+    for (; i < end; i++)
+        out[i] = compare_scalar<Op>(LhsBroadcast ? *lhs : lhs[i],
+                                    RhsBroadcast ? *rhs : rhs[i]);
+}
+
+template <compare_op_t Op, class T>
+result<void> compare_impl(const T *lhs, const T *rhs, bool *output,
+                          gsl::span<const size_t> lhs_shape,
+                          gsl::span<const size_t> rhs_shape,
+                          gsl::span<const size_t> out_shape,
+                          kernel_context &context) noexcept {
+    const auto plan = make_broadcast_plan<2>({lhs_shape, rhs_shape}, out_shape);
+    const auto num_threads = compute_size(out_shape) >= parallel_threshold
+                                 ? context.num_threads
+                                 : 1;
+    for_each_broadcast_run(
+        plan, num_threads, parallel_block,
+        [&](const std::array<size_t, 2> &offsets, size_t out_offset,
+            size_t begin, size_t end) {
+            const auto a = lhs + offsets[0], b = rhs + offsets[1];
+            const auto out = output + out_offset;
+            if (plan.inner_broadcast[0])
+                compare_run<Op, true, false>(a, b, out, begin, end);
+            else if (plan.inner_broadcast[1])
+                compare_run<Op, false, true>(a, b, out, begin, end);
+            else
+                compare_run<Op, false, false>(a, b, out, begin, end);
+        });
+    return ok();
+}
+
+#define COMPARE_IMPL_OP(op)                                                    \
+    case compare_op_t::op:                                                     \
+        return compare_impl<compare_op_t::op>(lhs, rhs, output, lhs_shape,     \
+                                              rhs_shape, out_shape, context)
+
+template <class T>
+result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
+                          bool *output, gsl::span<const size_t> lhs_shape,
+                          gsl::span<const size_t> rhs_shape,
+                          gsl::span<const size_t> out_shape,
+                          kernel_context &context) noexcept {
+    switch (op) {
+        COMPARE_IMPL_OP(equal);
+        COMPARE_IMPL_OP(not_equal);
+        COMPARE_IMPL_OP(greater_than);
+        COMPARE_IMPL_OP(greater_or_equal);
+        COMPARE_IMPL_OP(lower_than);
+        COMPARE_IMPL_OP(lower_or_equal);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
+
+#define COMPARE_IMPL(_ty)                                                      \
+    return compare_impl(op, IN_CAST(_ty, lhs), IN_CAST(_ty, rhs),              \
+                        OUT_CAST(bool, output), lhs_shape, rhs_shape,          \
+                        out_shape, context);
+} // namespace
+
+result<void> optimized::compare(
+    typecode_t typecode, runtime::stackvm::compare_op_t op,
+    const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
+    gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
+    gsl::span<const size_t> rhs_shape, gsl::span<const size_t> rhs_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    if (!is_contiguous(lhs_shape, lhs_strides) ||
+        !is_contiguous(rhs_shape, rhs_strides) ||
+        !is_contiguous(out_shape, out_strides))
+        return err(std::errc::not_supported);
+    TYPE_SELECT(typecode, COMPARE_IMPL);
+}
@@ -18,6 +18,7 @@
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <utility>
+#include <vector>
 #ifdef NNCASE_HALIDE
 #include <hkg/export/HalideBuffer.h>
 #include <hkg/export/halide_conv2d.h>
@@ -549,6 +550,87 @@ result<void> conv2d_depthwise_nxm(
     return ok();
 }
 
+// half and bfloat16 are widened to f32 and lowered to one f32 matmul per
+// image and group: weights [g_oc, k] x im2col [k, out_h * out_w], so the
+// multiply-adds run in the f32 SIMD kernel and the output is rounded once.
+template <typename T>
+result<void> conv2d_half_impl(
+    const T *input, const T *weights, const T *bias, T *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> w_shape,
+    gsl::span<const size_t> bias_strides, const padding &padding_h,
+    const padding &padding_w, int32_t groups, int32_t stride_h,
+    int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    value_range<float> fused_activation, kernels::kernel_context &context) {
+    const auto in_h = in_shape[2], in_w = in_shape[3];
+    const auto filter_h = w_shape[2], filter_w = w_shape[3];
+    const auto out_channels = w_shape[0];
+    const auto g_ic = in_shape[1] / groups;
+    const auto g_oc = out_channels / groups;
+    const auto out_h = kernels::detail::get_windowed_output_size(
+        in_h, (int32_t)filter_h, stride_h, dilation_h, padding_h);
+    const auto out_w = kernels::detail::get_windowed_output_size(
+        in_w, (int32_t)filter_w, stride_w, dilation_w, padding_w);
+    const auto out_size = out_h * out_w;
+    const auto k = g_ic * filter_h * filter_w;
+
+    std::vector<float> weights_f32(out_channels * k);
+    for (size_t i = 0; i < weights_f32.size(); i++)
+        weights_f32[i] = weights[i];
+    std::vector<float> cols(k * out_size);
+    std::vector<float> out_f32(g_oc * out_size);
+    const dims_t lhs_shape{g_oc, k};
+    const dims_t rhs_shape{k, out_size};
+
+    for (size_t b = 0; b < in_shape[0]; b++) {
+        for (size_t g = 0; g < (size_t)groups; g++) {
+            auto in_ = input + (b * in_shape[1] + g * g_ic) * in_h * in_w;
+            auto col = cols.data();
+            for (size_t ic = 0; ic < g_ic; ic++) {
+                auto in_c = in_ + ic * in_h * in_w;
+                for (size_t ky = 0; ky < filter_h; ky++) {
+                    for (size_t kx = 0; kx < filter_w; kx++) {
+                        for (size_t oy = 0; oy < out_h; oy++) {
+                            const auto iy = (int32_t)(oy * stride_h) -
+                                            padding_h.before +
+                                            (int32_t)ky * dilation_h;
+                            const bool row_valid =
+                                iy >= 0 && iy < (int32_t)in_h;
+                            for (size_t ox = 0; ox < out_w; ox++) {
+                                const auto ix = (int32_t)(ox * stride_w) -
+                                                padding_w.before +
+                                                (int32_t)kx * dilation_w;
+                                *col++ =
+                                    row_valid && ix >= 0 && ix < (int32_t)in_w
+                                        ? (float)in_c[iy * in_w + ix]
+                                        : 0.f;
+                            }
+                        }
+                    }
+                }
+            }
+
+            try_(optimized::matmul(
+                dt_float32,
+                reinterpret_cast<const gsl::byte *>(weights_f32.data() +
+                                                    g * g_oc * k),
+                reinterpret_cast<const gsl::byte *>(cols.data()),
+                reinterpret_cast<gsl::byte *>(out_f32.data()), lhs_shape,
+                rhs_shape, context));
+
+            for (size_t oc = 0; oc < g_oc; oc++) {
+                const auto c = g * g_oc + oc;
+                const float bias_v = bias[c * bias_strides[0]];
+                auto src = out_f32.data() + oc * out_size;
+                auto dst = output + (b * out_channels + c) * out_size;
+                for (size_t i = 0; i < out_size; i++)
+                    dst[i] = T(kernels::detail::apply_activation(
+                        src[i] + bias_v, fused_activation));
+            }
+        }
+    }
+    return ok();
+}
+
 #ifdef NNCASE_HALIDE
 #define HALIDE_CONV2D_NXM_S1_S2(KH, KW)                                        \
     if (filter_h == (KH) && filter_w == (KW)) {                                \
@@ -620,6 +702,39 @@ result<void> optimized::conv2d(
     int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     value_range<float> fused_activation,
     NNCASE_UNUSED kernels::kernel_context &context) noexcept {
+    if (typecode == dt_float16 || typecode == dt_bfloat16) {
+        const dims_t out_shape{in_shape[0], w_shape[0],
+                               kernels::detail::get_windowed_output_size(
+                                   in_shape[2], (int32_t)w_shape[2], stride_h,
+                                   dilation_h, padding_h),
+                               kernels::detail::get_windowed_output_size(
+                                   in_shape[3], (int32_t)w_shape[3], stride_w,
+                                   dilation_w, padding_w)};
+        if (runtime::is_contiguous(in_shape, in_strides) &&
+            runtime::is_contiguous(w_shape, w_strides) &&
+            runtime::is_contiguous(out_shape, out_strides)) {
+            if (typecode == dt_float16)
+                return conv2d_half_impl(
+                    IN_CAST(half, input1), IN_CAST(half, weights1),
+                    IN_CAST(half, bias1), OUT_CAST(half, output1), in_shape,
+                    w_shape, bias_strides, padding_h, padding_w, groups,
+                    stride_h, stride_w, dilation_h, dilation_w,
+                    fused_activation, context);
+            return conv2d_half_impl(
+                IN_CAST(bfloat16, input1), IN_CAST(bfloat16, weights1),
+                IN_CAST(bfloat16, bias1), OUT_CAST(bfloat16, output1),
+                in_shape, w_shape, bias_strides, padding_h, padding_w, groups,
+                stride_h, stride_w, dilation_h, dilation_w, fused_activation,
+                context);
+        }
+
+        return stackvm::reference::conv2d(
+            typecode, input1, weights1, bias1, output1, in_shape, in_strides,
+            w_shape, w_strides, bias_strides, out_strides, padding_h,
+            padding_w, groups, stride_h, stride_w, dilation_h, dilation_w,
+            fused_activation, context);
+    }
+
     [[maybe_unused]] auto input = IN_CAST(float, input1);
     [[maybe_unused]] auto weights = IN_CAST(float, weights1);
     [[maybe_unused]] auto bias = IN_CAST(float, bias1);
@@ -685,6 +800,159 @@ result<void> optimized::conv2d(
     return ok();
 }
 
+namespace {
+// [begin, end) of input positions whose scattered output stays inside
+// [0, out_size) for the given kernel tap.
+std::pair<size_t, size_t> conv2d_transpose_valid_range(size_t in_size,
+                                                       size_t out_size,
+                                                       int32_t origin,
+                                                       int32_t stride) {
+    auto begin = origin >= 0 ? 0 : (-(int64_t)origin + stride - 1) / stride;
+    auto end = (int64_t)out_size - origin <= 0
+                   ? 0
+                   : ((int64_t)out_size - origin + stride - 1) / stride;
+    begin = std::min(begin, (int64_t)in_size);
+    end = std::clamp(end, begin, (int64_t)in_size);
+    return {(size_t)begin, (size_t)end};
+}
+
+// GEMM + col2im: for every output channel and kernel tap, the input rows that
+// land inside the output are reduced over the group's input channels into a
+// scratch row (one GEMM row), which is then scatter-added into the output.
+template <typename T>
+result<void> conv2d_transpose_impl(
+    const T *input, T *output, const T *weights, const T *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    const padding &padding_h, const padding &padding_w,
+    value_range<T> fused_activation,
+    NNCASE_UNUSED kernels::kernel_context &context) noexcept {
+    const auto in_h = in_shape[2], in_w = in_shape[3], in_hw = in_h * in_w;
+    const auto out_h = out_shape[2], out_w = out_shape[3],
+               out_hw = out_h * out_w;
+    const auto g_ic = in_shape[1] / groups;
+    const auto g_oc = out_shape[1] / groups;
+    const auto filter_size = (size_t)filter_h * filter_w;
+    // if no cast, openmp will throw error in visual studio
+    const auto out_planes = (int32_t)(in_shape[0] * out_shape[1]);
+
+    std::vector<std::pair<size_t, size_t>> y_ranges(filter_h);
+    std::vector<std::pair<size_t, size_t>> x_ranges(filter_w);
+    for (int32_t ky = 0; ky < filter_h; ky++)
+        y_ranges[ky] = conv2d_transpose_valid_range(
+            in_h, out_h, ky * dilation_h - padding_h.before, stride_h);
+    for (int32_t kx = 0; kx < filter_w; kx++)
+        x_ranges[kx] = conv2d_transpose_valid_range(
+            in_w, out_w, kx * dilation_w - padding_w.before, stride_w);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel num_threads(context.num_threads)
+#endif
+    {
+        std::vector<T> row(in_hw);
+
+#ifdef NNCASE_OPENMP
+#pragma omp for
+#endif
+        for (int32_t plane = 0; plane < out_planes; plane++) {
+            const auto batch = (size_t)plane / out_shape[1];
+            const auto oc = (size_t)plane % out_shape[1];
+            const auto g = oc / g_oc;
+            const T *in_group =
+                input + (batch * in_shape[1] + g * g_ic) * in_hw;
+            const T *w_oc = weights + oc * g_ic * filter_size;
+            T *out = output + (size_t)plane * out_hw;
+            std::fill_n(out, out_hw, bias[oc]);
+
+            for (int32_t ky = 0; ky < filter_h; ky++) {
+                const auto [y_begin, y_end] = y_ranges[ky];
+                for (int32_t kx = 0; kx < filter_w; kx++) {
+                    const auto [x_begin, x_end] = x_ranges[kx];
+                    if (y_begin == y_end || x_begin == x_end)
+                        continue;
+
+                    // GEMM row over the input rows that reach the output
+                    const auto k = (size_t)ky * filter_w + kx;
+                    const auto row_begin = y_begin * in_w;
+                    const auto row_size = (y_end - y_begin) * in_w;
+                    T *r = row.data() + row_begin;
+                    std::fill_n(r, row_size, T(0));
+                    size_t ic = 0;
+                    for (; ic + 4 <= g_ic; ic += 4) {
+                        const T w0 = w_oc[(ic + 0) * filter_size + k];
+                        const T w1 = w_oc[(ic + 1) * filter_size + k];
+                        const T w2 = w_oc[(ic + 2) * filter_size + k];
+                        const T w3 = w_oc[(ic + 3) * filter_size + k];
+                        const T *i0 = in_group + (ic + 0) * in_hw + row_begin;
+                        const T *i1 = in_group + (ic + 1) * in_hw + row_begin;
+                        const T *i2 = in_group + (ic + 2) * in_hw + row_begin;
+                        const T *i3 = in_group + (ic + 3) * in_hw + row_begin;
+                        for (size_t i = 0; i < row_size; i++)
+                            r[i] += i0[i] * w0 + i1[i] * w1 + i2[i] * w2 +
+                                    i3[i] * w3;
+                    }
+
+                    for (; ic < g_ic; ic++) {
+                        const T w0 = w_oc[ic * filter_size + k];
+                        const T *i0 = in_group + ic * in_hw + row_begin;
+                        for (size_t i = 0; i < row_size; i++)
+                            r[i] += i0[i] * w0;
+                    }
+
+                    // col2im
+                    const auto out_x_origin =
+                        (int32_t)kx * dilation_w - padding_w.before;
+                    for (size_t iy = y_begin; iy < y_end; iy++) {
+                        const auto out_y = (int32_t)iy * stride_h +
+                                           ky * dilation_h - padding_h.before;
+                        T *out_row = out + (size_t)out_y * out_w;
+                        const T *in_row = row.data() + iy * in_w;
+                        if (stride_w == 1) {
+                            T *dest = out_row + out_x_origin;
+                            for (size_t ix = x_begin; ix < x_end; ix++)
+                                dest[ix] += in_row[ix];
+                        } else {
+                            for (size_t ix = x_begin; ix < x_end; ix++)
+                                out_row[(int32_t)ix * stride_w +
+                                        out_x_origin] += in_row[ix];
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < out_hw; i++)
+                out[i] =
+                    kernels::detail::apply_activation(out[i], fused_activation);
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> optimized::conv2d_transpose(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *weights, const gsl::byte *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    const padding &padding_h, const padding &padding_w,
+    const value_range<float> &fused_activation,
+    kernels::kernel_context &context) noexcept {
+    if (typecode == dt_float32) {
+        return conv2d_transpose_impl(
+            IN_CAST(float, input), OUT_CAST(float, output),
+            IN_CAST(float, weights), IN_CAST(float, bias), in_shape, groups,
+            out_shape, filter_h, filter_w, stride_h, stride_w, dilation_h,
+            dilation_w, padding_h, padding_w, fused_activation, context);
+    }
+
+    return stackvm::reference::conv2d_transpose(
+        typecode, input, output, weights, bias, in_shape, groups, out_shape,
+        filter_h, filter_w, stride_h, stride_w, dilation_h, dilation_w,
+        padding_h, padding_w, fused_activation);
+}
+
 // result<void> optimized::conv2d(
 //     [[maybe_unused]] typecode_t typecode, const gsl::byte *input,
 //     const gsl::byte *weights, const gsl::byte *bias, gsl::byte *output,
@@ -0,0 +1,190 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// A single innermost scan at least this long is split into blocks that are
+// scanned in parallel and then offset by the preceding block totals.
+constexpr size_t blocked_scan_threshold = 65536;
+// Lane chunks of a strided scan are never narrower than this.
+constexpr size_t min_lane_chunk = 64;
+
+/**
+ * Scans `depth` rows of `width` independent lanes, rows being `stride`
+ * elements apart. Every step adds two rows element-wise, which vectorizes
+ * across the lanes.
+ */
+template <class T>
+void scan_lanes(const T *input, T *output, size_t depth, size_t width,
+                size_t stride, bool exclusive, bool reverse) {
+    auto row = [&](size_t k) {
+        return (reverse ? depth - 1 - k : k) * stride;
+    };
+    if (exclusive)
+        std::fill_n(output + row(0), width, T(0));
+    else
+        std::copy_n(input + row(0), width, output + row(0));
+    for (size_t k = 1; k < depth; k++) {
+        auto prev = output + row(k - 1);
+        auto in = input + row(exclusive ? k - 1 : k);
+        auto out = output + row(k);
+        for (size_t i = 0; i < width; i++)
+            out[i] = T(prev[i] + in[i]);
+    }
+}
+
+// Scans one contiguous lane starting from `carry` and returns the total.
+template <class T>
+T scan_lane(const T *input, T *output, size_t count, T carry, bool exclusive,
+            bool reverse) {
+    auto step = [&](size_t i) {
+        auto value = input[i];
+        if (exclusive) {
+            output[i] = carry;
+            carry = T(carry + value);
+        } else {
+            carry = T(carry + value);
+            output[i] = carry;
+        }
+    };
+    if (reverse) {
+        for (size_t i = count; i-- > 0;)
+            step(i);
+    } else {
+        for (size_t i = 0; i < count; i++)
+            step(i);
+    }
+    return carry;
+}
+
+// Two-pass parallel prefix sum of one long contiguous lane.
+template <class T>
+void scan_lane_blocked(const T *input, T *output, size_t count,
+                       bool exclusive, bool reverse, uint32_t threads) {
+    const auto blocks = (size_t)threads;
+    std::vector<T> offsets(blocks);
+    // block b in scan order, as a memory range
+    auto range = [&](size_t b) {
+        auto begin = count * b / blocks, end = count * (b + 1) / blocks;
+        return reverse ? std::make_pair(count - end, count - begin)
+                       : std::make_pair(begin, end);
+    };
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t b = 0; b < (int64_t)blocks; b++) {
+        auto [lo, hi] = range(b);
+        offsets[b] = scan_lane(input + lo, output + lo, hi - lo, T(0),
+                               exclusive, reverse);
+    }
+
+    T carry = T(0);
+    for (size_t b = 0; b < blocks; b++) {
+        auto total = offsets[b];
+        offsets[b] = carry;
+        carry = T(carry + total);
+    }
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t b = 1; b < (int64_t)blocks; b++) {
+        auto [lo, hi] = range(b);
+        auto offset = offsets[b];
+        for (auto i = lo; i < hi; i++)
+            output[i] = T(output[i] + offset);
+    }
+}
+
+template <class T>
+result<void> cumsum_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape, size_t axis,
+                         bool exclusive, bool reverse,
+                         kernel_context &context) noexcept {
+    const auto outer = compute_size(in_shape.subspan(0, axis));
+    const auto depth = in_shape[axis];
+    const auto inner = compute_size(in_shape.subspan(axis + 1));
+    const auto slice = depth * inner;
+    if (outer * slice == 0)
+        return ok();
+    const auto threads = outer * slice < parallel_threshold
+                             ? 1
+                             : std::max<uint32_t>(1, context.num_threads);
+
+    if (inner == 1) {
+        if (outer < (size_t)threads && depth >= blocked_scan_threshold) {
+            for (size_t o = 0; o < outer; o++)
+                scan_lane_blocked(input + o * slice, output + o * slice,
+                                  depth, exclusive, reverse, threads);
+            return ok();
+        }
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+        for (int64_t o = 0; o < (int64_t)outer; o++)
+            scan_lane(input + o * slice, output + o * slice, depth, T(0),
+                      exclusive, reverse);
+        return ok();
+    }
+
+    // split the lanes so that every thread gets a chunk
+    auto chunks =
+        outer >= (size_t)threads ? 1 : ((size_t)threads + outer - 1) / outer;
+    chunks = std::max<size_t>(
+        1, std::min(chunks, inner / std::min(inner, min_lane_chunk)));
+    const auto chunk = (inner + chunks - 1) / chunks;
+    chunks = (inner + chunk - 1) / chunk;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t task = 0; task < (int64_t)(outer * chunks); task++) {
+        const auto o = (size_t)task / chunks, c = (size_t)task % chunks;
+        const auto lane = c * chunk;
+        const auto base = o * slice + lane;
+        scan_lanes(input + base, output + base, depth,
+                   std::min(chunk, inner - lane), inner, exclusive, reverse);
+    }
+    return ok();
+}
+} // namespace
+
+#define CUMSUM_IMPL(type)                                                      \
+    return cumsum_impl(IN_CAST(type, input), OUT_CAST(type, output),           \
+                       in_shape, axis, exclusive, reverse, context);
+
+result<void> optimized::cumsum(typecode_t typecode, const gsl::byte *input,
+                               gsl::byte *output,
+                               gsl::span<const size_t> in_shape, size_t axis,
+                               bool exclusive, bool reverse,
+                               kernel_context &context) noexcept {
+    if (axis >= in_shape.size())
+        return err(std::errc::invalid_argument);
+    TYPE_SELECT(typecode, CUMSUM_IMPL);
+}
@@ -12,10 +12,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "opt_common.h"
 #include "opt_ops.h"
+#include <algorithm>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
+#include <type_traits>
+#if __AVX__
+#include <immintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -23,8 +29,8 @@ using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
+namespace {
 namespace impl {
-
 template <class TQ>
 void riscv_dequantize(const TQ *CXX_RESTRICT input, float *CXX_RESTRICT output,
                       size_t count, float scale, float bias) {
@@ -45,26 +51,103 @@ void riscv_dequantize(const TQ *CXX_RESTRICT input, float *CXX_RESTRICT output,
         output[count - 1] = (input[count - 1] - bias) * scale;
 }
 
-template <class TQint>
-result<void> dequantize(const TQint *CXX_RESTRICT input,
-                        float *CXX_RESTRICT output, size_t count, float scale,
-                        float bias) {
+#if __AVX__
+inline __m256i load_widen8(const uint8_t *input) {
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input));
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_cvtepu8_epi32(v)),
+                                   _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)), 1);
+}
+
+inline __m256i load_widen8(const int8_t *input) {
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input));
+    return _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_cvtepi8_epi32(v)),
+                                   _mm_cvtepi8_epi32(_mm_srli_si128(v, 4)), 1);
+}
+
+inline __m256i load_widen8(const int16_t *input) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+    return _mm256_insertf128_si256(
+        _mm256_castsi128_si256(_mm_cvtepi16_epi32(v)),
+        _mm_cvtepi16_epi32(_mm_srli_si128(v, 8)), 1);
+}
+
+inline void store_float8(float *output, __m256 v) {
+    _mm256_storeu_ps(output, v);
+}
+
+// Rounds to nearest even on the upper 16 bits, as round_to_bfloat16 does.
+inline __m128i round_to_bfloat16x4(__m128 v) {
+    const __m128i u = _mm_castps_si128(v);
+    const __m128i lsb =
+        _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+    const __m128i rounded = _mm_srli_epi32(
+        _mm_add_epi32(u, _mm_add_epi32(_mm_set1_epi32(0x7fff), lsb)), 16);
+    return _mm_blendv_epi8(rounded, _mm_set1_epi32(0x7fc0),
+                           _mm_castps_si128(_mm_cmpunord_ps(v, v)));
+}
+
+inline void store_float8(bfloat16 *output, __m256 v) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i *>(output),
+        _mm_packus_epi32(round_to_bfloat16x4(_mm256_castps256_ps128(v)),
+                         round_to_bfloat16x4(_mm256_extractf128_ps(v, 1))));
+}
+
+// Dequantizes whole groups of 8 and returns how many elements were done.
+template <class TQint, class TFloat>
+size_t avx_dequantize(const TQint *CXX_RESTRICT input,
+                      TFloat *CXX_RESTRICT output, size_t count, float scale,
+                      float bias) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 vbias = _mm256_set1_ps(bias);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_cvtepi32_ps(load_widen8(input + i));
+        store_float8(output + i,
+                     _mm256_mul_ps(_mm256_sub_ps(v, vbias), vscale));
+    }
+    return i;
+}
+#endif
+
+template <class TQint, class TFloat>
+void dequantize_block(const TQint *CXX_RESTRICT input,
+                      TFloat *CXX_RESTRICT output, size_t count, float scale,
+                      float bias) {
+    size_t i = 0;
 #if __riscv
-    riscv_dequantize(input, output, count, scale, bias);
-#else
-    for (size_t i = 0; i < count; i++) {
-        output[i] = (input[i] - bias) * scale;
+    if constexpr (std::is_same_v<TFloat, float>) {
+        riscv_dequantize(input, output, count, scale, bias);
+        return;
     }
+#elif __AVX__
+    i = avx_dequantize(input, output, count, scale, bias);
 #endif
+    for (; i < count; i++)
+        output[i] = (TFloat)((input[i] - bias) * scale);
+}
+
+template <class TQint, class TFloat>
+result<void> dequantize(const TQint *CXX_RESTRICT input,
+                        TFloat *CXX_RESTRICT output, size_t count, float scale,
+                        float bias, kernel_context &context) {
+    for_each_block(
+        count,
+        [&](size_t begin, size_t end) {
+            dequantize_block(input + begin, output + begin, end - begin, scale,
+                             bias);
+        },
+        context);
     return ok();
 }
 } // namespace impl
+} // namespace
 
 #define DEQUANTIZE_IMPL(qint_t, float_t)                                       \
     if (cmp_type<qint_t>(in_type) && cmp_type<float_t>(out_type)) {            \
         return impl::dequantize(reinterpret_cast<const qint_t *>(input),       \
                                 reinterpret_cast<float_t *>(output),           \
-                                compute_size(in_shape), scale, bias);          \
+                                compute_size(in_shape), scale, bias, context); \
     }
 
 result<void> optimized::dequantize(
@@ -72,9 +155,12 @@ result<void> optimized::dequantize(
     gsl::byte *output, gsl::span<const size_t> in_shape,
     NNCASE_UNUSED gsl::span<const size_t> in_strides,
     NNCASE_UNUSED gsl::span<const size_t> out_strides, float scale, float bias,
-    NNCASE_UNUSED kernel_context &context) noexcept {
+    kernel_context &context) noexcept {
     DEQUANTIZE_IMPL(uint8_t, float)
     DEQUANTIZE_IMPL(int8_t, float)
     DEQUANTIZE_IMPL(int16_t, float)
+    DEQUANTIZE_IMPL(uint8_t, bfloat16)
+    DEQUANTIZE_IMPL(int8_t, bfloat16)
+    DEQUANTIZE_IMPL(int16_t, bfloat16)
     return err(std::errc::not_supported);
 }
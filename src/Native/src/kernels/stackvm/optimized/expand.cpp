@@ -0,0 +1,83 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+
+namespace {
+/**
+ * Materializes a numpy-style broadcast as a tile: the input is aligned to
+ * the output rank and every dim of extent 1 is repeated. Returns false when
+ * the shapes do not broadcast or the layout is not contiguous.
+ */
+bool broadcast_as_tile(typecode_t typecode, const gsl::byte *input,
+                       gsl::byte *output, gsl::span<const size_t> input_shape,
+                       gsl::span<const size_t> input_strides,
+                       gsl::span<const size_t> out_shape,
+                       gsl::span<const size_t> out_strides,
+                       kernel_context &context) {
+    if (input_shape.size() > out_shape.size() ||
+        !is_contiguous(input_shape, input_strides) ||
+        !is_contiguous(out_shape, out_strides))
+        return false;
+
+    dims_t in_shape(out_shape.size() - input_shape.size(), 1);
+    in_shape.insert(in_shape.end(), input_shape.begin(), input_shape.end());
+    dims_t repeats(out_shape.size());
+    for (size_t i = 0; i < out_shape.size(); i++) {
+        if (in_shape[i] != out_shape[i] && in_shape[i] != 1)
+            return false;
+        repeats[i] = in_shape[i] == out_shape[i] ? 1 : out_shape[i];
+    }
+
+    return optimized::tile(typecode, input, output, in_shape, out_shape,
+                           get_default_strides(in_shape), out_strides,
+                           repeats, context)
+        .is_ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::expand(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    if (broadcast_as_tile(typecode, input, output, input_shape, input_strides,
+                          out_shape, out_strides, context))
+        return ok();
+    return reference::expand(typecode, input, output, input_shape,
+                             input_strides, out_shape, out_strides, context);
+}
+
+result<void> nncase::kernels::stackvm::optimized::broadcast(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    if (broadcast_as_tile(typecode, input, output, input_shape, input_strides,
+                          out_shape, out_strides, context))
+        return ok();
+    return reference::broadcast(typecode, input, output, input_shape,
+                                input_strides, out_shape, out_strides,
+                                context);
+}
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "opt_common.h"
 #include "opt_ops.h"
 #include <cstring>
 #include <nncase/kernels/kernel_utils.h>
@@ -40,22 +41,39 @@ gather_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
     size_t block_size =
         std::accumulate(in_shape.begin() + axis + 1, in_shape.end(), 1,
                         std::multiplies<size_t>{});
+    const auto axis_dim = in_shape[axis];
+    const auto blocks = outer_count * indices_count;
+    NNCASE_UNUSED const auto threads =
+        blocks * block_size * sizeof(T) < parallel_copy_threshold
+            ? 1
+            : context.num_threads;
 
-    auto *in_ptr = input;
-    auto *out_ptr = output;
-    for (size_t o = 0; o < outer_count; ++o) {
+    // One block per (outer, index) pair. With axis 0 there is a single outer
+    // block and every index copies one contiguous row, as in an embedding
+    // lookup.
+    if (block_size == 1) {
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(context.num_threads)
+#pragma omp parallel for num_threads(threads)
 #endif
-        for (int i = 0; i < indices_count; ++i) {
-            auto *o_ptr = out_ptr + i * block_size;
-            auto indices_ptr =
-                indices[i] >= 0 ? indices[i] : indices[i] + in_shape[axis];
-            memcpy(o_ptr, in_ptr + (indices_ptr * block_size),
-                   block_size * sizeof(T));
+        for (int64_t b = 0; b < (int64_t)blocks; b++) {
+            const auto o = (size_t)b / indices_count,
+                       i = (size_t)b % indices_count;
+            output[b] =
+                input[o * axis_dim + wrap_index(indices[i], axis_dim)];
+        }
+    } else {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+        for (int64_t b = 0; b < (int64_t)blocks; b++) {
+            const auto o = (size_t)b / indices_count,
+                       i = (size_t)b % indices_count;
+            const auto *in_ptr =
+                input +
+                (o * axis_dim + wrap_index(indices[i], axis_dim)) *
+                    block_size;
+            memcpy(output + b * block_size, in_ptr, block_size * sizeof(T));
         }
-        in_ptr += in_shape[axis] * block_size;
-        out_ptr += indices_count * block_size;
     }
     return ok();
 }
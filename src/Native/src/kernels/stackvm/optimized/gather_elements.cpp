@@ -13,19 +13,172 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_common.h"
 #include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
-#include <nncase/runtime/allocator.h>
-#include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Where one output row, the innermost axis, reads from: element j comes from
+ * `in_row[indices[j] * axis_stride + j * col_stride]`. col_stride is zero
+ * when the gather axis is the innermost one.
+ */
+struct row_layout {
+    size_t count;
+    size_t axis_dim;
+    size_t axis_stride;
+    size_t col_stride;
+    size_t out_stride;
+};
+
+#if __AVX2__
+// Eight indices as int32, negative ones wrapped.
+template <class IndicesT>
+__m256i load_indices(const IndicesT *indices, __m256i axis_dim) {
+    __m256i index;
+    if constexpr (sizeof(IndicesT) == 4) {
+        index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices));
+    } else {
+        // low halves of the int64 lanes, in range when the offsets are
+        const auto low = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        const auto lo = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices)),
+            low);
+        const auto hi = _mm256_permutevar8x32_epi32(
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(indices + 4)),
+            low);
+        index = _mm256_permute2x128_si256(lo, hi, 0x20);
+    }
+    const auto negative = _mm256_cmpgt_epi32(_mm256_setzero_si256(), index);
+    return _mm256_add_epi32(index, _mm256_and_si256(negative, axis_dim));
+}
+
+// Gathers the first `count` rounded down to eight elements of a row with
+// 32-bit offsets and returns how many it wrote.
+template <class T, class IndicesT>
+size_t gather_row_avx2(const T *in_row, T *out_row, const IndicesT *indices,
+                       const row_layout &row) {
+    const auto axis_dim = _mm256_set1_epi32((int32_t)row.axis_dim);
+    const auto axis_stride = _mm256_set1_epi32((int32_t)row.axis_stride);
+    const auto col_step = _mm256_set1_epi32((int32_t)(8 * row.col_stride));
+    auto col_offset = _mm256_mullo_epi32(
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+        _mm256_set1_epi32((int32_t)row.col_stride));
+
+    size_t j = 0;
+    for (; j + 8 <= row.count; j += 8) {
+        const auto offset = _mm256_add_epi32(
+            _mm256_mullo_epi32(load_indices(indices + j, axis_dim),
+                               axis_stride),
+            col_offset);
+        col_offset = _mm256_add_epi32(col_offset, col_step);
+        if constexpr (sizeof(T) == 4) {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out_row + j),
+                _mm256_i32gather_epi32(reinterpret_cast<const int *>(in_row),
+                                       offset, 4));
+        } else {
+            const auto in = reinterpret_cast<const long long *>(in_row);
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out_row + j),
+                _mm256_i32gather_epi64(in, _mm256_castsi256_si128(offset), 8));
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out_row + j + 4),
+                _mm256_i32gather_epi64(
+                    in, _mm256_extracti128_si256(offset, 1), 8));
+        }
+    }
+    return j;
+}
+#endif
+
+template <class T, class IndicesT>
+void gather_row(const T *in_row, T *out_row, const IndicesT *indices,
+                const row_layout &row, NNCASE_UNUSED bool fits_int32) {
+    size_t j = 0;
+#if __AVX2__
+    if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {
+        if (fits_int32 && row.out_stride == 1)
+            j = gather_row_avx2(in_row, out_row, indices, row);
+    }
+#endif
+    for (; j < row.count; j++) {
+        out_row[j * row.out_stride] =
+            in_row[wrap_index(indices[j], row.axis_dim) * row.axis_stride +
+                   j * row.col_stride];
+    }
+}
+
+template <class T, class IndicesT>
+result<void> gather_elements_impl(
+    const T *input, T *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, const IndicesT *indices,
+    size_t axis, kernel_context &context) noexcept {
+    const auto rank = out_shape.size();
+    const auto last = rank - 1;
+    const row_layout row{out_shape[last], in_shape[axis], in_strides[axis],
+                         axis == last ? 0 : in_strides[last],
+                         out_strides[last]};
+    const auto rows = compute_size(out_shape) / row.count;
+
+    size_t max_offset = 0;
+    for (size_t i = 0; i < rank; i++)
+        max_offset += (in_shape[i] - 1) * in_strides[i];
+    const bool fits_int32 =
+        max_offset <= (size_t)std::numeric_limits<int32_t>::max();
+
+    NNCASE_UNUSED const auto threads =
+        rows * row.count * sizeof(T) < parallel_copy_threshold
+            ? 1
+            : context.num_threads;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t r = 0; r < (int64_t)rows; r++) {
+        // the axis position comes from the indices, so it is left out of the
+        // input base
+        size_t in_offset = 0, out_offset = 0, rest = (size_t)r;
+        for (size_t i = last; i-- > 0;) {
+            const auto position = rest % out_shape[i];
+            rest /= out_shape[i];
+            if (i != axis)
+                in_offset += position * in_strides[i];
+            out_offset += position * out_strides[i];
+        }
+        gather_row(input + in_offset, output + out_offset,
+                   indices + (size_t)r * row.count, row, fits_int32);
+    }
+    return ok();
+}
+} // namespace
+
+#define GATHER_ELEMENTS_IMPL(size, type)                                       \
+    case size:                                                                 \
+        return integer_cast(indices_type, indices, [&](auto &&indices_value) { \
+            return gather_elements_impl(reinterpret_cast<const type *>(input), \
+                                        reinterpret_cast<type *>(output),      \
+                                        in_shape, out_shape, in_strides,       \
+                                        out_strides, indices_value, axis,      \
+                                        context);                              \
+        });
 
 result<void> nncase::kernels::stackvm::optimized::gather_elements(
     datatype_t type, const gsl::byte *input, gsl::byte *output,
@@ -34,8 +187,16 @@ result<void> nncase::kernels::stackvm::optimized::gather_elements(
     datatype_t indices_type, const gsl::byte *indices,
     gsl::span<const size_t> indices_shape, size_t axis,
     kernel_context &context) noexcept {
+    if (out_shape.empty() || compute_size(out_shape) == 0 ||
+        compute_size(in_shape) == 0 || axis >= out_shape.size() ||
+        in_shape.size() != out_shape.size() ||
+        in_strides.size() != in_shape.size() ||
+        out_strides.size() != out_shape.size() ||
+        !std::equal(indices_shape.begin(), indices_shape.end(),
+                    out_shape.begin(), out_shape.end()))
+        return reference::gather_elements(
+            type, input, output, in_shape, out_shape, in_strides, out_strides,
+            indices_type, indices, indices_shape, axis, context);
 
-    return reference::gather_elements(type, input, output, in_shape, out_shape,
-                                      in_strides, out_strides, indices_type,
-                                      indices, indices_shape, axis, context);
+    TYPE_IMPL_SELECT(type, GATHER_ELEMENTS_IMPL);
 }
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "opt_common.h"
 #include "opt_ops.h"
 #include <cstring>
 #include <nncase/kernels/kernel_utils.h>
@@ -57,26 +58,35 @@ gather_nd_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
     size_t indices_batch_block_size =
         std::accumulate(indices_shape.begin() + batch_dims, indices_shape.end(),
                         1, std::multiplies<size_t>{});
-    for (size_t i = 0; i < batch_size; ++i) {
+    const auto blocks = batch_size * indices_block_count;
+    NNCASE_UNUSED const auto threads =
+        blocks * block_size * sizeof(T) < parallel_copy_threshold
+            ? 1
+            : context.num_threads;
+
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(context.num_threads)
+#pragma omp parallel for num_threads(threads)
 #endif
-        for (int j = 0; j < indices_block_count; ++j) {
-            const auto *indices_ptr = indices + j * indices_list_size;
-            auto *out_ptr = output + j * block_size;
-            auto *batch_begin_input = input;
-            // set batch_dims value used for select input
+    for (int64_t j = 0; j < (int64_t)blocks; ++j) {
+        const auto batch = (size_t)j / indices_block_count;
+        const auto *indices_ptr = indices +
+                                  batch * indices_batch_block_size +
+                                  (j % indices_block_count) * indices_list_size;
+        const auto *batch_begin_input = input + batch * input_batch_block_size;
+        auto *out_ptr = output + batch * output_batch_block_size +
+                        (j % indices_block_count) * block_size;
 
-            // get offset
-            for (size_t k = 0; k < indices_list_size; ++k) {
-                batch_begin_input +=
-                    indices_ptr[k] * in_strides[k + batch_dims];
-            }
-            memcpy(out_ptr, batch_begin_input, block_size * sizeof(T));
+        // get offset
+        size_t in_offset = 0;
+        for (size_t k = 0; k < indices_list_size; ++k) {
+            in_offset += wrap_index(indices_ptr[k], in_shape[k + batch_dims]) *
+                         in_strides[k + batch_dims];
         }
-        input += input_batch_block_size;
-        output += output_batch_block_size;
-        indices += indices_batch_block_size;
+        if (block_size == 1)
+            *out_ptr = batch_begin_input[in_offset];
+        else
+            memcpy(out_ptr, batch_begin_input + in_offset,
+                   block_size * sizeof(T));
     }
     return ok();
 }
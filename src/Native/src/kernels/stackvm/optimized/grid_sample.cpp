@@ -0,0 +1,272 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/stackvm/grid_sample.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+struct sample_params {
+    size_t channels;
+    size_t in_h, in_w;
+    size_t out_h, out_w;
+    size_t in_c_stride, in_h_stride, in_w_stride;
+    size_t grid_n_stride, grid_h_stride, grid_w_stride, grid_c_stride;
+    size_t out_n_stride, out_c_stride, out_h_stride, out_w_stride;
+    bool align_corners;
+    grid_sample_padding_mode_t padding_mode;
+};
+
+/**
+ * Sampling taps of one output row, stored tap-major: the element offset of
+ * tap k for column x is offsets[k * out_w + x]. Taps that fall outside the
+ * input have offset -1 and weight 0 and must not be read: padding samples
+ * are exactly 0 even when the input holds Inf or NaN.
+ */
+template <size_t Taps> struct row_table {
+    explicit row_table(size_t out_w)
+        : offsets(Taps * out_w), weights(Taps * out_w) {}
+
+    std::vector<int32_t> offsets;
+    std::vector<float> weights;
+};
+
+template <size_t Taps>
+void build_row(const float *grid, const sample_params &p,
+               row_table<Taps> &table) {
+    auto in_bounds = [&](int32_t y, int32_t x) {
+        return y >= 0 && y < (int32_t)p.in_h && x >= 0 && x < (int32_t)p.in_w;
+    };
+    auto offset_of = [&](int32_t y, int32_t x) {
+        return (int32_t)(y * p.in_h_stride + x * p.in_w_stride);
+    };
+
+    for (size_t ox = 0; ox < p.out_w; ox++) {
+        auto g = grid + ox * p.grid_w_stride;
+        auto x = grid_sample_source_coordinate(g[0], p.in_w, p.align_corners,
+                                               p.padding_mode);
+        auto y = grid_sample_source_coordinate(
+            g[p.grid_c_stride], p.in_h, p.align_corners, p.padding_mode);
+        if constexpr (Taps == 1) {
+            auto xi = (int32_t)std::nearbyint(x);
+            auto yi = (int32_t)std::nearbyint(y);
+            auto valid = in_bounds(yi, xi);
+            table.offsets[ox] = valid ? offset_of(yi, xi) : -1;
+            table.weights[ox] = valid ? 1.f : 0.f;
+        } else {
+            auto x_w = (int32_t)std::floor(x), y_n = (int32_t)std::floor(y);
+            auto lw = x - x_w, nw = y - y_n;
+            auto rw = 1.f - lw, sw = 1.f - nw;
+            const int32_t ys[4] = {y_n, y_n, y_n + 1, y_n + 1};
+            const int32_t xs[4] = {x_w, x_w + 1, x_w, x_w + 1};
+            const float ws[4] = {rw * sw, lw * sw, rw * nw, lw * nw};
+            for (size_t k = 0; k < 4; k++) {
+                auto valid = in_bounds(ys[k], xs[k]);
+                table.offsets[k * p.out_w + ox] =
+                    valid ? offset_of(ys[k], xs[k]) : -1;
+                table.weights[k * p.out_w + ox] = valid ? ws[k] : 0.f;
+            }
+        }
+    }
+}
+
+// Channels are contiguous in both input and output: every output pixel is a
+// weighted sum of Taps channel vectors.
+template <size_t Taps>
+void sample_channels_last(const float *input, float *output,
+                          const row_table<Taps> &table,
+                          const sample_params &p) {
+    for (size_t ox = 0; ox < p.out_w; ox++) {
+        // only the taps inside the input are read
+        const float *src[Taps];
+        float w[Taps];
+        size_t valid = 0;
+        for (size_t k = 0; k < Taps; k++) {
+            auto offset = table.offsets[k * p.out_w + ox];
+            if (offset >= 0) {
+                src[valid] = input + offset;
+                w[valid++] = table.weights[k * p.out_w + ox];
+            }
+        }
+        auto dst = output + ox * p.out_w_stride;
+        size_t c = 0;
+#if __AVX2__
+        __m256 wv[Taps];
+        for (size_t k = 0; k < valid; k++)
+            wv[k] = _mm256_set1_ps(w[k]);
+        for (; c + 8 <= p.channels; c += 8) {
+            auto acc = _mm256_setzero_ps();
+            for (size_t k = 0; k < valid; k++)
+                acc = _mm256_fmadd_ps(wv[k], _mm256_loadu_ps(src[k] + c), acc);
+            _mm256_storeu_ps(dst + c, acc);
+        }
+#endif
+        for (; c < p.channels; c++) {
+            auto acc = 0.f;
+            for (size_t k = 0; k < valid; k++)
+                acc += w[k] * src[k][c];
+            dst[c] = acc;
+        }
+    }
+}
+
+// Any other layout: walk the channels and gather each output row through
+// the shared tap table.
+template <size_t Taps>
+void sample_planar(const float *input, float *output,
+                   const row_table<Taps> &table, const sample_params &p) {
+    auto offsets = table.offsets.data();
+    auto weights = table.weights.data();
+    for (size_t c = 0; c < p.channels; c++) {
+        auto src = input + c * p.in_c_stride;
+        auto dst = output + c * p.out_c_stride;
+        size_t ox = 0;
+#if __AVX2__
+        if (p.out_w_stride == 1) {
+            for (; ox + 8 <= p.out_w; ox += 8) {
+                auto acc = _mm256_setzero_ps();
+                for (size_t k = 0; k < Taps; k++) {
+                    auto idx = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i *>(offsets +
+                                                          k * p.out_w + ox));
+                    auto w = _mm256_loadu_ps(weights + k * p.out_w + ox);
+                    // lanes with a negative offset gather 0 without a load
+                    auto mask = _mm256_castsi256_ps(
+                        _mm256_cmpgt_epi32(idx, _mm256_set1_epi32(-1)));
+                    auto v = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), src,
+                                                      idx, mask, 4);
+                    acc = _mm256_fmadd_ps(w, v, acc);
+                }
+                _mm256_storeu_ps(dst + ox, acc);
+            }
+        }
+#endif
+        for (; ox < p.out_w; ox++) {
+            auto acc = 0.f;
+            for (size_t k = 0; k < Taps; k++) {
+                auto offset = offsets[k * p.out_w + ox];
+                if (offset >= 0)
+                    acc += weights[k * p.out_w + ox] * src[offset];
+            }
+            dst[ox * p.out_w_stride] = acc;
+        }
+    }
+}
+
+template <size_t Taps>
+void grid_sample_impl(const float *input, const float *grid, float *output,
+                      size_t batch, gsl::span<const size_t> in_strides,
+                      const sample_params &p, kernel_context &context) {
+    const auto rows = batch * p.out_h;
+    const auto channels_last = p.in_c_stride == 1 && p.out_c_stride == 1;
+    const auto out_size = rows * p.out_w * p.channels;
+    const auto threads =
+        out_size < parallel_heavy_threshold ? 1 : context.num_threads;
+    // a few blocks per thread so uneven rows still balance
+    const auto blocks = std::min<size_t>(rows, (size_t)threads * 4);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t b = 0; b < (int64_t)blocks; b++) {
+        row_table<Taps> table(p.out_w);
+        const auto begin = rows * b / blocks, end = rows * (b + 1) / blocks;
+        for (auto row = begin; row < end; row++) {
+            const auto n = row / p.out_h, oy = row % p.out_h;
+            build_row(grid + n * p.grid_n_stride + oy * p.grid_h_stride, p,
+                      table);
+            auto src = input + n * in_strides[0];
+            auto dst = output + n * p.out_n_stride + oy * p.out_h_stride;
+            if (channels_last)
+                sample_channels_last(src, dst, table, p);
+            else
+                sample_planar(src, dst, table, p);
+        }
+    }
+}
+} // namespace
+
+result<void> optimized::grid_sample(
+    typecode_t type, const gsl::byte *input, const gsl::byte *grid,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> grid_shape,
+    gsl::span<const size_t> grid_strides, gsl::span<const size_t> out_strides,
+    grid_sample_align_corners_t align_corners, grid_sample_mode_t mode,
+    grid_sample_padding_mode_t padding_mode, kernel_context &context) noexcept {
+    auto fallback = [&] {
+        return reference::grid_sample(type, input, grid, output, in_shape,
+                                      in_strides, grid_shape, grid_strides,
+                                      out_strides, align_corners, mode,
+                                      padding_mode, context);
+    };
+    if (type != dt_float32 || mode == grid_sample_mode_t::cubic ||
+        in_shape.size() != 4 || grid_shape.size() != 4 ||
+        grid_shape[3] != 2 || grid_shape[0] != in_shape[0])
+        return fallback();
+
+    sample_params p;
+    p.channels = in_shape[1];
+    p.in_h = in_shape[2];
+    p.in_w = in_shape[3];
+    p.out_h = grid_shape[1];
+    p.out_w = grid_shape[2];
+    p.in_c_stride = in_strides[1];
+    p.in_h_stride = in_strides[2];
+    p.in_w_stride = in_strides[3];
+    p.grid_n_stride = grid_strides[0];
+    p.grid_h_stride = grid_strides[1];
+    p.grid_w_stride = grid_strides[2];
+    p.grid_c_stride = grid_strides[3];
+    p.out_n_stride = out_strides[0];
+    p.out_c_stride = out_strides[1];
+    p.out_h_stride = out_strides[2];
+    p.out_w_stride = out_strides[3];
+    p.align_corners =
+        align_corners == grid_sample_align_corners_t::align_corners;
+    p.padding_mode = padding_mode;
+    if (in_shape[0] == 0 || p.channels == 0 || p.out_h == 0 || p.out_w == 0)
+        return ok();
+    // tap offsets within one image plane are kept as int32 for the gathers
+    if (p.in_h == 0 || p.in_w == 0 ||
+        (p.in_h - 1) * p.in_h_stride + (p.in_w - 1) * p.in_w_stride >
+            (size_t)std::numeric_limits<int32_t>::max())
+        return fallback();
+
+    auto in = IN_CAST(float, input);
+    auto g = IN_CAST(float, grid);
+    auto out = OUT_CAST(float, output);
+    if (mode == grid_sample_mode_t::nearest_neighbor)
+        grid_sample_impl<1>(in, g, out, in_shape[0], in_strides, p, context);
+    else
+        grid_sample_impl<4>(in, g, out, in_shape[0], in_strides, p, context);
+    return ok();
+}
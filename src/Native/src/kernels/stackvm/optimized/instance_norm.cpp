@@ -0,0 +1,125 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// sum(x[i] - shift)^Power, Power in {1, 2}, with 2 x 8 lanes of partial
+// sums under AVX2.
+template <int Power>
+float group_sum(const float *x, size_t n, float shift = 0.f) {
+    auto term = [=](float v) {
+        return Power == 1 ? v : (v - shift) * (v - shift);
+    };
+    size_t i = 0;
+    float sum = 0.f;
+#if __AVX2__
+    const __m256 vshift = _mm256_set1_ps(shift);
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        const __m256 v0 = _mm256_loadu_ps(x + i);
+        const __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        if constexpr (Power == 1) {
+            acc0 = _mm256_add_ps(acc0, v0);
+            acc1 = _mm256_add_ps(acc1, v1);
+        } else {
+            const __m256 d0 = _mm256_sub_ps(v0, vshift);
+            const __m256 d1 = _mm256_sub_ps(v1, vshift);
+            acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        }
+    }
+    sum = _mm256_reduce_add_ps(_mm256_add_ps(acc0, acc1));
+#endif
+    for (; i < n; i++)
+        sum += term(x[i]);
+    return sum;
+}
+
+// Every (n, c) plane is one normalization group: a mean pass, a variance
+// pass around the mean, then the scale/bias pass, with groups spread over
+// threads.
+result<void> instance_norm_impl(const float *input, const float *scale,
+                                const float *bias, float *output,
+                                gsl::span<const size_t> in_shape,
+                                float epsilon,
+                                NNCASE_UNUSED kernel_context &context) {
+    const auto channels = in_shape[1];
+    const auto groups = in_shape[0] * channels;
+    size_t group_size = 1;
+    for (size_t i = 2; i < in_shape.size(); i++)
+        group_size *= in_shape[i];
+    if (group_size == 0)
+        return ok();
+
+    NNCASE_UNUSED const auto threads =
+        groups * group_size < parallel_threshold ? 1 : context.num_threads;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t g = 0; g < (int64_t)groups; g++) {
+        const auto c = (size_t)g % channels;
+        auto in_ = input + g * group_size;
+        auto out_ = output + g * group_size;
+
+        const float mean = group_sum<1>(in_, group_size) / group_size;
+        const float sum2 = group_sum<2>(in_, group_size, mean);
+        const float a = scale[c] / std::sqrt(sum2 / group_size + epsilon);
+        const float b = bias[c] - mean * a;
+
+        size_t i = 0;
+#if __AVX2__
+        const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+        for (; i + 8 <= group_size; i += 8)
+            _mm256_storeu_ps(out_ + i,
+                             _mm256_fmadd_ps(_mm256_loadu_ps(in_ + i), va, vb));
+#endif
+        for (; i < group_size; i++)
+            out_[i] = in_[i] * a + b;
+    }
+    return ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::instance_norm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+    const gsl::byte *bias, gsl::byte *output, gsl::span<const size_t> in_shape,
+    float epsilon, kernel_context &context) noexcept {
+    if (typecode == dt_float32 && in_shape.size() >= 2) {
+        return instance_norm_impl(reinterpret_cast<const float *>(input),
+                                  reinterpret_cast<const float *>(scale),
+                                  reinterpret_cast<const float *>(bias),
+                                  reinterpret_cast<float *>(output), in_shape,
+                                  epsilon, context);
+    }
+
+    auto strides = get_default_strides(in_shape);
+    return reference::instance_norm(typecode, input, scale, bias, output,
+                                    in_shape, strides, strides, epsilon);
+}
@@ -27,7 +27,9 @@ using namespace nncase::kernels::stackvm::optimized;
 result<void> nncase::kernels::stackvm::optimized::layer_norm(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
     const gsl::byte *scale, const gsl::byte *bias,
-    gsl::span<const size_t> in_shape, int32_t axis, float epsilon) {
+    gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+    bool use_mean, bool channel_first,
+    NNCASE_UNUSED kernel_context &context) {
     return reference::layer_norm(typecode, input, output, scale, bias, in_shape,
-                                 axis, epsilon);
+                                 axis, epsilon, use_mean, channel_first);
 }
@@ -31,12 +31,11 @@ using namespace nncase::kernels::stackvm::optimized;
 //    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
 //    gsl::span<const size_t> out_strides, int32_t axis) noexcept;
 
-result<void> optimized::log_softmax(typecode_t typecode, const gsl::byte *input,
-                                    gsl::byte *output,
-                                    gsl::span<const size_t> in_shape,
-                                    gsl::span<const size_t> in_strides,
-                                    gsl::span<const size_t> out_strides,
-                                    int32_t axis) noexcept {
+result<void> optimized::log_softmax(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, int32_t axis,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     return reference::log_softmax(typecode, input, output, in_shape, in_strides,
                                   out_strides, axis);
 }
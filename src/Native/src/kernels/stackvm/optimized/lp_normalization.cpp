@@ -0,0 +1,165 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+constexpr size_t lp_norm_block = 256;
+
+// Normalizes one contiguous row, used when axis is the innermost dimension.
+void lp_normalize_row(const float *in_, float *out_, size_t n, int64_t p) {
+    size_t i = 0;
+    float norm = 0.f;
+#if __AVX2__
+    const __m256 sign = _mm256_set1_ps(-0.f);
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(in_ + i);
+        acc = _mm256_add_ps(acc, p == 1 ? _mm256_andnot_ps(sign, v)
+                                        : _mm256_mul_ps(v, v));
+    }
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(acc),
+                           _mm256_extractf128_ps(acc, 1));
+    s4 = _mm_add_ps(s4, _mm_movehl_ps(s4, s4));
+    s4 = _mm_add_ss(s4, _mm_movehdup_ps(s4));
+    norm = _mm_cvtss_f32(s4);
+#endif
+    for (; i < n; i++)
+        norm += p == 1 ? std::fabs(in_[i]) : in_[i] * in_[i];
+
+    const auto v = p == 1 ? norm : std::sqrt(norm);
+    const auto scale = v == 0.f ? 0.f : 1.f / v;
+    i = 0;
+#if __AVX2__
+    const __m256 scale8 = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out_ + i,
+                         _mm256_mul_ps(_mm256_loadu_ps(in_ + i), scale8));
+#endif
+    for (; i < n; i++)
+        out_[i] = in_[i] * scale;
+}
+
+// y = x / norm_p(x) along axis, p in {1, 2}. Each task owns one outer index
+// and a block of inner positions and accumulates the norms row by row, so
+// the inner loops stay contiguous. Zero norms produce zero outputs.
+result<void> lp_normalization_impl(const float *input, float *output,
+                                   gsl::span<const size_t> in_shape,
+                                   size_t axis, int64_t p,
+                                   NNCASE_UNUSED kernel_context &context) {
+    size_t outer_size = 1;
+    for (size_t i = 0; i < axis; i++)
+        outer_size *= in_shape[i];
+    const auto axis_size = in_shape[axis];
+    size_t inner_size = 1;
+    for (size_t i = axis + 1; i < in_shape.size(); i++)
+        inner_size *= in_shape[i];
+    NNCASE_UNUSED const auto threads =
+        outer_size * axis_size * inner_size < parallel_threshold
+            ? 1
+            : context.num_threads;
+    if (inner_size == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+        for (int64_t o = 0; o < (int64_t)outer_size; o++)
+            lp_normalize_row(input + o * axis_size, output + o * axis_size,
+                             axis_size, p);
+        return ok();
+    }
+
+    const auto blocks = (inner_size + lp_norm_block - 1) / lp_norm_block;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+        const auto o = (size_t)t / blocks;
+        const auto j = ((size_t)t % blocks) * lp_norm_block;
+        const auto count = std::min(lp_norm_block, inner_size - j);
+        auto in_ = input + o * axis_size * inner_size + j;
+        auto out_ = output + o * axis_size * inner_size + j;
+
+        float norm[lp_norm_block];
+        std::fill_n(norm, count, 0.f);
+        for (size_t k = 0; k < axis_size; k++) {
+            auto in_k = in_ + k * inner_size;
+            size_t i = 0;
+#if __AVX2__
+            const __m256 sign = _mm256_set1_ps(-0.f);
+            for (; i + 8 <= count; i += 8) {
+                const __m256 v = _mm256_loadu_ps(in_k + i);
+                const __m256 term = p == 1 ? _mm256_andnot_ps(sign, v)
+                                           : _mm256_mul_ps(v, v);
+                _mm256_storeu_ps(
+                    norm + i, _mm256_add_ps(_mm256_loadu_ps(norm + i), term));
+            }
+#endif
+            if (p == 1) {
+                for (; i < count; i++)
+                    norm[i] += std::fabs(in_k[i]);
+            } else {
+                for (; i < count; i++)
+                    norm[i] += in_k[i] * in_k[i];
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const auto v = p == 1 ? norm[i] : std::sqrt(norm[i]);
+            norm[i] = v == 0.f ? 0.f : 1.f / v;
+        }
+
+        for (size_t k = 0; k < axis_size; k++) {
+            auto in_k = in_ + k * inner_size;
+            auto out_k = out_ + k * inner_size;
+            size_t i = 0;
+#if __AVX2__
+            for (; i + 8 <= count; i += 8)
+                _mm256_storeu_ps(out_k + i,
+                                 _mm256_mul_ps(_mm256_loadu_ps(in_k + i),
+                                               _mm256_loadu_ps(norm + i)));
+#endif
+            for (; i < count; i++)
+                out_k[i] = in_k[i] * norm[i];
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::lp_normalization(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, size_t axis, int64_t p,
+    kernel_context &context) noexcept {
+    if (typecode != dt_float32 || (p != 1 && p != 2))
+        return err(std::errc::not_supported);
+    return lp_normalization_impl(reinterpret_cast<const float *>(input),
+                                 reinterpret_cast<float *>(output), in_shape,
+                                 axis, p, context);
+}
@@ -0,0 +1,123 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include "x86_64/avx_mathfun.h"
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+constexpr size_t lrn_block = 256;
+
+// y = x / (bias + alpha / size * sum(x[c'] ^ 2))^beta, c' in
+// [c - floor((size - 1) / 2), c + ceil((size - 1) / 2)].
+// Each task owns one batch and a block of spatial positions, so the window
+// sums are accumulated straight from the input rows.
+result<void> lrn_impl(const float *input, float alpha, float beta, float bias,
+                      int size, float *output, gsl::span<const size_t> in_shape,
+                      NNCASE_UNUSED kernel_context &context) {
+    const auto batches = in_shape[0];
+    const auto channels = (int64_t)in_shape[1];
+    size_t inner_size = 1;
+    for (size_t i = 2; i < in_shape.size(); i++)
+        inner_size *= in_shape[i];
+    const auto blocks = (inner_size + lrn_block - 1) / lrn_block;
+    const auto lo = (int64_t)(size - 1) / 2;
+    const auto hi = (int64_t)size / 2;
+    const auto scale = alpha / size;
+    NNCASE_UNUSED const auto threads =
+        batches * in_shape[1] * inner_size < parallel_heavy_threshold
+            ? 1
+            : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(batches * blocks); t++) {
+        const auto n = (size_t)t / blocks;
+        const auto j = ((size_t)t % blocks) * lrn_block;
+        const auto count = std::min(lrn_block, inner_size - j);
+        auto in_ = input + n * channels * inner_size + j;
+        auto out_ = output + n * channels * inner_size + j;
+
+        float acc[lrn_block];
+        for (int64_t c = 0; c < channels; c++) {
+            std::fill_n(acc, count, 0.f);
+            const auto begin = std::max((int64_t)0, c - lo);
+            const auto end = std::min(channels - 1, c + hi);
+            for (auto k = begin; k <= end; k++) {
+                auto in_k = in_ + k * inner_size;
+                size_t i = 0;
+#if __AVX2__
+                for (; i + 8 <= count; i += 8) {
+                    const __m256 v = _mm256_loadu_ps(in_k + i);
+                    const __m256 a = _mm256_loadu_ps(acc + i);
+                    _mm256_storeu_ps(acc + i, _mm256_fmadd_ps(v, v, a));
+                }
+#endif
+                for (; i < count; i++)
+                    acc[i] += in_k[i] * in_k[i];
+            }
+
+            auto in_c = in_ + c * inner_size;
+            auto out_c = out_ + c * inner_size;
+            size_t i = 0;
+#if __AVX2__
+            // x * (acc * scale + bias)^-beta
+            const __m256 vscale = _mm256_set1_ps(scale);
+            const __m256 vbias = _mm256_set1_ps(bias);
+            const __m256 vbeta = _mm256_set1_ps(-beta);
+            for (; i + 8 <= count; i += 8) {
+                const __m256 d = _mm256_fmadd_ps(_mm256_loadu_ps(acc + i),
+                                                 vscale, vbias);
+                _mm256_storeu_ps(out_c + i,
+                                 _mm256_mul_ps(_mm256_loadu_ps(in_c + i),
+                                               pow256_ps(d, vbeta)));
+            }
+#endif
+            for (; i < count; i++)
+                out_c[i] = in_c[i] / std::pow(acc[i] * scale + bias, beta);
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::lrn(
+    typecode_t typecode, const gsl::byte *input, float alpha, float beta,
+    float bias, int size, gsl::byte *output, gsl::span<const size_t> in_shape,
+    kernel_context &context) noexcept {
+    if (typecode == dt_float32 && in_shape.size() >= 2) {
+        return lrn_impl(reinterpret_cast<const float *>(input), alpha, beta,
+                        bias, size, reinterpret_cast<float *>(output),
+                        in_shape, context);
+    }
+
+    auto strides = get_default_strides(in_shape);
+    return reference::lrn(typecode, input, alpha, beta, bias, size, output,
+                          in_shape, strides, strides);
+}
@@ -0,0 +1,177 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+void sigmoid_inplace(float *x, size_t count, kernel_context &context) {
+    auto data = reinterpret_cast<gsl::byte *>(x);
+    if (optimized::activation(activation_op_t::sigmoid, dt_float32, data, data,
+                              count, nullptr, nullptr, context)
+            .is_ok())
+        return;
+    for (size_t i = 0; i < count; i++)
+        x[i] = 1.f / (1.f + std::exp(-x[i]));
+}
+
+void tanh_inplace(const float *x, float *output, size_t count,
+                  kernel_context &context) {
+    dims_t shape{count};
+    strides_t strides{1};
+    if (optimized::unary(dt_float32, unary_op_t::tanh,
+                         reinterpret_cast<const gsl::byte *>(x),
+                         reinterpret_cast<gsl::byte *>(output), shape, strides,
+                         shape, strides, context)
+            .is_ok())
+        return;
+    for (size_t i = 0; i < count; i++)
+        output[i] = std::tanh(x[i]);
+}
+
+// Rows of `input` become columns of `output`.
+void transpose_2d(const float *input, float *output, size_t rows,
+                  size_t cols) {
+    for (size_t r = 0; r < rows; r++)
+        for (size_t c = 0; c < cols; c++)
+            output[c * rows + r] = input[r * cols + c];
+}
+
+/**
+ * Runs the recurrence of one direction. `x_gates` holds W·x + Wb + Rb for
+ * every step, [seq_len, batch, 4 * hidden] in iofc order, and is updated in
+ * place. `r_t` is R transposed to [hidden, 4 * hidden]. h and c live in
+ * output_h and output_c, which already hold the initial state.
+ */
+void lstm_direction(float *x_gates, const float *r_t, float *output,
+                    float *h, float *c, size_t seq_len, size_t batch,
+                    size_t hidden, size_t directions, size_t d, bool reverse,
+                    kernel_context &context) {
+    const auto gates = 4 * hidden;
+    std::vector<float> tanh_c(hidden);
+    for (size_t s = 0; s < seq_len; s++) {
+        const auto t = reverse ? seq_len - 1 - s : s;
+        for (size_t b = 0; b < batch; b++) {
+            auto g = x_gates + (t * batch + b) * gates;
+            auto h_b = h + b * hidden;
+            auto c_b = c + b * hidden;
+            for (size_t i = 0; i < hidden; i++) {
+                const auto h_i = h_b[i];
+                const auto r_row = r_t + i * gates;
+                for (size_t j = 0; j < gates; j++)
+                    g[j] += h_i * r_row[j];
+            }
+
+            // i, o and f are adjacent, c follows
+            sigmoid_inplace(g, 3 * hidden, context);
+            tanh_inplace(g + 3 * hidden, g + 3 * hidden, hidden, context);
+            const auto g_i = g, g_o = g + hidden, g_f = g + 2 * hidden,
+                       g_c = g + 3 * hidden;
+            for (size_t o = 0; o < hidden; o++)
+                c_b[o] = g_f[o] * c_b[o] + g_i[o] * g_c[o];
+            tanh_inplace(c_b, tanh_c.data(), hidden, context);
+            for (size_t o = 0; o < hidden; o++)
+                h_b[o] = g_o[o] * tanh_c[o];
+
+            std::memcpy(output + ((t * directions + d) * batch + b) * hidden,
+                        h_b, sizeof(float) * hidden);
+        }
+    }
+}
+} // namespace
+
+result<void> optimized::lstm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *w_xc,
+    const gsl::byte *w_rc, const gsl::byte *bias, const gsl::byte *init_h,
+    const gsl::byte *init_c, gsl::byte *output, gsl::byte *output_h,
+    gsl::byte *output_c, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> w_xc_shape, gsl::span<const size_t> w_rc_shape,
+    lstmdirection_t direction, kernel_context &context) noexcept {
+    if (typecode != dt_float32 || in_shape.size() != 3 ||
+        w_xc_shape.size() != 3 || w_rc_shape.size() != 3)
+        return err(std::errc::not_supported);
+
+    const auto seq_len = in_shape[0], batch = in_shape[1],
+               input_size = in_shape[2];
+    const auto directions = w_xc_shape[0], hidden = w_rc_shape[2];
+    const auto gates = 4 * hidden;
+    if (w_xc_shape[1] != gates || w_xc_shape[2] != input_size ||
+        w_rc_shape[0] != directions || w_rc_shape[1] != gates)
+        return err(std::errc::not_supported);
+
+    auto x = IN_CAST(float, input);
+    auto w = IN_CAST(float, w_xc);
+    auto r = IN_CAST(float, w_rc);
+    auto b = IN_CAST(float, bias);
+    auto out = OUT_CAST(float, output);
+    auto out_h = OUT_CAST(float, output_h);
+    auto out_c = OUT_CAST(float, output_c);
+
+    // input projection of all steps, one GEMM per direction
+    const auto rows = seq_len * batch;
+    std::vector<float> x_gates(directions * rows * gates);
+    std::vector<float> w_t(input_size * gates);
+    std::vector<float> r_t(directions * hidden * gates);
+    for (size_t d = 0; d < directions; d++) {
+        auto x_gates_d = x_gates.data() + d * rows * gates;
+        transpose_2d(w + d * gates * input_size, w_t.data(), gates,
+                     input_size);
+        try_(optimized::matmul(dt_float32, IN_CAST(gsl::byte, x),
+                               IN_CAST(gsl::byte, w_t.data()),
+                               OUT_CAST(gsl::byte, x_gates_d),
+                               dims_t{rows, input_size},
+                               dims_t{input_size, gates}, context));
+
+        // bias is [directions, 8 * hidden], Wb then Rb
+        auto wb = b + d * 2 * gates, rb = wb + gates;
+        for (size_t i = 0; i < rows; i++) {
+            auto g = x_gates_d + i * gates;
+            for (size_t j = 0; j < gates; j++)
+                g[j] += wb[j] + rb[j];
+        }
+        transpose_2d(r + d * gates * hidden, r_t.data() + d * hidden * gates,
+                     gates, hidden);
+    }
+
+    const auto state_size = directions * batch * hidden;
+    std::memcpy(out_h, init_h, sizeof(float) * state_size);
+    std::memcpy(out_c, init_c, sizeof(float) * state_size);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(                                          \
+        std::min<uint32_t>(context.num_threads, directions))
+#endif
+    for (int64_t d = 0; d < (int64_t)directions; d++) {
+        lstm_direction(x_gates.data() + d * rows * gates,
+                       r_t.data() + d * hidden * gates, out,
+                       out_h + d * batch * hidden, out_c + d * batch * hidden,
+                       seq_len, batch, hidden, directions, d,
+                       direction == lstmdirection_t::reverse || d == 1,
+                       context);
+    }
+    return ok();
+}
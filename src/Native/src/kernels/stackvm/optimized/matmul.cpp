@@ -0,0 +1,298 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include "x86_64/avx_half.h"
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+#if __AVX512BF16__ && __AVX512F__
+#define GEMM_BF16 1
+#endif
+
+#if __AVX__
+namespace {
+// Register block: 4 lhs rows by one 16-column rhs panel.
+constexpr size_t gemm_rows = 4;
+constexpr size_t gemm_panel = 16;
+
+inline __m256 fmadd(__m256 a, __m256 b, __m256 c) {
+#if __FMA__
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+// rhs [k, n] widened to f32 panels of [k][16] columns, zero padded past n.
+template <class T>
+void pack_rhs(const T *rhs, size_t k, size_t n, float *packed) {
+    const auto panels = (n + gemm_panel - 1) / gemm_panel;
+    for (size_t p = 0; p < panels; p++) {
+        const auto cols = std::min(gemm_panel, n - p * gemm_panel);
+        for (size_t kk = 0; kk < k; kk++) {
+            auto src = rhs + kk * n + p * gemm_panel;
+            auto dst = packed + (p * k + kk) * gemm_panel;
+            if (cols == gemm_panel) {
+                _mm256_storeu_ps(dst, f32x8<T>::load(src));
+                _mm256_storeu_ps(dst + 8, f32x8<T>::load(src + 8));
+            } else {
+                for (size_t c = 0; c < gemm_panel; c++)
+                    dst[c] = c < cols ? (float)src[c] : 0.f;
+            }
+        }
+    }
+}
+
+template <class T>
+void store_row(T *output, const __m256 (&acc)[2], size_t cols) {
+    if (cols == gemm_panel) {
+        f32x8<T>::store(output, acc[0]);
+        f32x8<T>::store(output + 8, acc[1]);
+    } else {
+        float tmp[gemm_panel];
+        _mm256_storeu_ps(tmp, acc[0]);
+        _mm256_storeu_ps(tmp + 8, acc[1]);
+        for (size_t c = 0; c < cols; c++)
+            output[c] = narrow_from_f32<T>(tmp[c]);
+    }
+}
+
+// output[m, n] = lhs[m, k] x rhs[k, n] for one batch unit, lhs already f32.
+template <class T>
+void gemm_f32(const float *lhs, const float *packed, T *output, size_t m,
+              size_t k, size_t n, NNCASE_UNUSED kernel_context &context) {
+    const auto row_blocks = (m + gemm_rows - 1) / gemm_rows;
+    const auto panels = (n + gemm_panel - 1) / gemm_panel;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(row_blocks * panels); t++) {
+        const auto i0 = ((size_t)t / panels) * gemm_rows;
+        const auto p = (size_t)t % panels;
+        const auto b = packed + p * k * gemm_panel;
+
+        // rows past m repeat the last row and are discarded
+        const float *a[gemm_rows];
+        for (size_t r = 0; r < gemm_rows; r++)
+            a[r] = lhs + std::min(i0 + r, m - 1) * k;
+
+        __m256 acc[gemm_rows][2];
+        for (size_t r = 0; r < gemm_rows; r++)
+            acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+        for (size_t kk = 0; kk < k; kk++) {
+            const __m256 b0 = _mm256_loadu_ps(b + kk * gemm_panel);
+            const __m256 b1 = _mm256_loadu_ps(b + kk * gemm_panel + 8);
+            for (size_t r = 0; r < gemm_rows; r++) {
+                const __m256 va = _mm256_broadcast_ss(a[r] + kk);
+                acc[r][0] = fmadd(va, b0, acc[r][0]);
+                acc[r][1] = fmadd(va, b1, acc[r][1]);
+            }
+        }
+
+        const auto cols = std::min(gemm_panel, n - p * gemm_panel);
+        for (size_t r = 0; r < std::min(gemm_rows, m - i0); r++)
+            store_row(output + (i0 + r) * n + p * gemm_panel, acc[r], cols);
+    }
+}
+
+#if GEMM_BF16
+// rhs [k, n] packed as [panel][k / 2][16][2] bf16, so one (k, k + 1) pair of
+// a lhs row, broadcast as an int32, feeds vdpbf16ps for 16 columns. Odd k
+// and columns past n are zero padded.
+void pack_rhs_bf16(const bfloat16 *rhs, size_t k, size_t n,
+                   bfloat16 *packed) {
+    const auto k2 = (k + 1) / 2;
+    const auto panels = (n + gemm_panel - 1) / gemm_panel;
+    std::fill_n(packed, panels * k2 * gemm_panel * 2, bfloat16(0.f));
+    for (size_t kk = 0; kk < k; kk++)
+        for (size_t j = 0; j < n; j++)
+            packed[((j / gemm_panel * k2 + kk / 2) * gemm_panel +
+                    j % gemm_panel) *
+                       2 +
+                   kk % 2] = rhs[kk * n + j];
+}
+
+void gemm_bf16(const bfloat16 *lhs, const bfloat16 *packed, bfloat16 *output,
+               size_t m, size_t k, size_t n,
+               NNCASE_UNUSED kernel_context &context) {
+    const auto k2 = (k + 1) / 2;
+    const auto row_blocks = (m + gemm_rows - 1) / gemm_rows;
+    const auto panels = (n + gemm_panel - 1) / gemm_panel;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(row_blocks * panels); t++) {
+        const auto i0 = ((size_t)t / panels) * gemm_rows;
+        const auto p = (size_t)t % panels;
+        const auto b = packed + p * k2 * gemm_panel * 2;
+
+        const bfloat16 *a[gemm_rows];
+        for (size_t r = 0; r < gemm_rows; r++)
+            a[r] = lhs + std::min(i0 + r, m - 1) * k;
+
+        __m512 acc[gemm_rows];
+        for (size_t r = 0; r < gemm_rows; r++)
+            acc[r] = _mm512_setzero_ps();
+        for (size_t kq = 0; kq < k2; kq++) {
+            const __m512i vb = _mm512_loadu_si512(b + kq * gemm_panel * 2);
+            for (size_t r = 0; r < gemm_rows; r++) {
+                uint32_t pair = 0;
+                if (kq * 2 + 1 < k)
+                    std::memcpy(&pair, a[r] + kq * 2, 4);
+                else
+                    std::memcpy(&pair, a[r] + kq * 2, 2);
+                acc[r] = _mm512_dpbf16_ps(
+                    acc[r], (__m512bh)_mm512_set1_epi32((int32_t)pair),
+                    (__m512bh)vb);
+            }
+        }
+
+        const auto cols = std::min(gemm_panel, n - p * gemm_panel);
+        for (size_t r = 0; r < std::min(gemm_rows, m - i0); r++) {
+            const __m256 v[2] = {_mm512_castps512_ps256(acc[r]),
+                                 _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                                     _mm512_castps_pd(acc[r]), 1))};
+            store_row(output + (i0 + r) * n + p * gemm_panel, v, cols);
+        }
+    }
+}
+#endif
+
+template <class T>
+result<void> matmul_impl(const T *input_a, const T *input_b, T *output,
+                         gsl::span<const size_t> in_a_shape_,
+                         gsl::span<const size_t> in_b_shape_,
+                         kernel_context &context) noexcept {
+    dims_t in_a_shape = in_a_shape_;
+    dims_t in_b_shape = in_b_shape_;
+    if (in_a_shape.size() == 1)
+        in_a_shape.insert(in_a_shape.begin(), 1);
+    if (in_b_shape.size() == 1)
+        in_b_shape.insert(in_b_shape.end(), 1);
+    const auto new_a_shape = to_4d(in_a_shape);
+    const auto new_b_shape = to_4d(in_b_shape);
+    const auto m = new_a_shape[2], k = new_a_shape[3], n = new_b_shape[3];
+    const auto batches = std::max(new_a_shape[0], new_b_shape[0]);
+    const auto channels = std::max(new_a_shape[1], new_b_shape[1]);
+    if (m == 0 || n == 0 || batches == 0 || channels == 0)
+        return ok();
+
+    const auto a_unit_size = m * k, b_unit_size = k * n;
+    const auto ab_size = a_unit_size * new_a_shape[1];
+    const auto bb_size = b_unit_size * new_b_shape[1];
+    const auto panels = (n + gemm_panel - 1) / gemm_panel;
+
+    // rhs units are packed once and reused while the same unit is
+    // broadcast; half precision lhs units are widened to f32 rows.
+#if GEMM_BF16
+    constexpr bool use_bf16_dot = std::is_same_v<T, bfloat16>;
+    std::vector<bfloat16> packed_bf16;
+#else
+    constexpr bool use_bf16_dot = false;
+#endif
+    std::vector<float> packed_f32;
+    std::vector<float> lhs_f32(
+        std::is_same_v<T, float> || use_bf16_dot ? 0 : a_unit_size);
+    const T *packed_from = nullptr;
+    for (size_t b = 0; b < batches; b++) {
+        const auto an = new_a_shape[0] == 1 ? 0 : b;
+        const auto bn = new_b_shape[0] == 1 ? 0 : b;
+        for (size_t c = 0; c < channels; c++) {
+            const auto ac = new_a_shape[1] == 1 ? 0 : c;
+            const auto bc = new_b_shape[1] == 1 ? 0 : c;
+            const auto a = input_a + an * ab_size + ac * a_unit_size;
+            const auto b_unit = input_b + bn * bb_size + bc * b_unit_size;
+            auto out = output + (b * channels + c) * m * n;
+
+            if constexpr (use_bf16_dot) {
+#if GEMM_BF16
+                if (b_unit != packed_from) {
+                    packed_bf16.resize(panels * ((k + 1) / 2) * gemm_panel *
+                                       2);
+                    pack_rhs_bf16(b_unit, k, n, packed_bf16.data());
+                    packed_from = b_unit;
+                }
+                gemm_bf16(a, packed_bf16.data(), out, m, k, n, context);
+#endif
+            } else {
+                if (b_unit != packed_from) {
+                    packed_f32.resize(panels * k * gemm_panel);
+                    pack_rhs(b_unit, k, n, packed_f32.data());
+                    packed_from = b_unit;
+                }
+
+                const float *lhs;
+                if constexpr (std::is_same_v<T, float>) {
+                    lhs = a;
+                } else {
+                    size_t i = 0;
+                    for (; i + 8 <= a_unit_size; i += 8)
+                        _mm256_storeu_ps(lhs_f32.data() + i,
+                                         f32x8<T>::load(a + i));
+                    for (; i < a_unit_size; i++)
+                        lhs_f32[i] = a[i];
+                    lhs = lhs_f32.data();
+                }
+                gemm_f32(lhs, packed_f32.data(), out, m, k, n, context);
+            }
+        }
+    }
+    return ok();
+}
+} // namespace
+#endif
+
+result<void> optimized::matmul(typecode_t typecode, const gsl::byte *input_a,
+                               const gsl::byte *input_b, gsl::byte *output,
+                               gsl::span<const size_t> in_a_shape,
+                               gsl::span<const size_t> in_b_shape,
+                               kernel_context &context) noexcept {
+#if __AVX__
+    switch (typecode) {
+    case dt_float32:
+        return matmul_impl(IN_CAST(float, input_a), IN_CAST(float, input_b),
+                           OUT_CAST(float, output), in_a_shape, in_b_shape,
+                           context);
+    case dt_float16:
+        return matmul_impl(IN_CAST(half, input_a), IN_CAST(half, input_b),
+                           OUT_CAST(half, output), in_a_shape, in_b_shape,
+                           context);
+    case dt_bfloat16:
+        return matmul_impl(IN_CAST(bfloat16, input_a),
+                           IN_CAST(bfloat16, input_b),
+                           OUT_CAST(bfloat16, output), in_a_shape, in_b_shape,
+                           context);
+    default:
+        break;
+    }
+#endif
+
+    return stackvm::reference::matmul(typecode, input_a, input_b, output,
+                                      in_a_shape, in_b_shape, context);
+}
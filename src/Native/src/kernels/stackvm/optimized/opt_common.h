@@ -13,7 +13,10 @@
  * limitations under the License.
  */
 #pragma once
+#include "opt_ops.h"
+#include <algorithm>
 #include <cstring>
+#include <nncase/kernels/kernel_context.h>
 #if __riscv_vector
 #include "riscv64/utils.h"
 #define _STR(x) #x
@@ -91,4 +94,49 @@ inline void *opt_memcpy(void *dst, const void *src, size_t n) {
 #else
     return memcpy(dst, src, n);
 #endif
-}
\ No newline at end of file
+}
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+namespace optimized {
+BEGIN_NS_NNCASE_KERNEL_ISA
+
+// Work smaller than these runs on the calling thread, where starting the
+// OpenMP team would cost more than it saves.
+// Elements, for kernels doing a few operations per element.
+constexpr size_t parallel_threshold = 32768;
+// Elements, for kernels doing tens of operations per element.
+constexpr size_t parallel_heavy_threshold = 16384;
+// Bytes written, for kernels that only move data.
+constexpr size_t parallel_copy_threshold = 65536;
+// Parallel elementwise loops, and inner runs too long for the outer loop to
+// keep every thread busy, are split into blocks of this size.
+constexpr size_t parallel_block = 8192;
+
+// Negative indices count back from the end of the axis.
+template <class IndicesT> size_t wrap_index(IndicesT index, size_t dim) {
+    return index < 0 ? (size_t)(index + (IndicesT)dim) : (size_t)index;
+}
+
+// Calls body(begin, end) over [0, count), in parallel blocks of
+// parallel_block elements once count reaches parallel_threshold.
+template <class TBody>
+void for_each_block(size_t count, TBody &&body,
+                    NNCASE_UNUSED kernel_context &context) {
+    if (count < parallel_threshold) {
+        body(0, count);
+        return;
+    }
+
+    const auto blocks = (count + parallel_block - 1) / parallel_block;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t b = 0; b < (int64_t)blocks; b++) {
+        const auto begin = (size_t)b * parallel_block;
+        body(begin, std::min(count, begin + parallel_block));
+    }
+}
+
+END_NS_NNCASE_KERNEL_ISA
+} // namespace optimized
+END_NS_NNCASE_KERNELS_MODULE
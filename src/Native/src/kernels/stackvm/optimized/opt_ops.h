@@ -24,6 +24,19 @@
 #include <nncase/runtime/stackvm/opcode.h>
 #include <nncase/tensor.h>
 #include <nncase/value.h>
+
+// With x86 runtime dispatch, the kernels in these blocks are compiled once
+// per ISA level with NNCASE_KERNEL_ISA naming the level, so each build lands
+// in its own inline namespace. x86_64/dispatch.cpp defines the plain entry
+// points and forwards to the level chosen by kernels::kernel_isa().
+#ifdef NNCASE_KERNEL_ISA
+#define BEGIN_NS_NNCASE_KERNEL_ISA inline namespace NNCASE_KERNEL_ISA {
+#define END_NS_NNCASE_KERNEL_ISA }
+#else
+#define BEGIN_NS_NNCASE_KERNEL_ISA
+#define END_NS_NNCASE_KERNEL_ISA
+#endif
+
 BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
 namespace optimized {
 
@@ -40,6 +53,16 @@ conv2d(typecode_t typecode, const gsl::byte *input, const gsl::byte *weights,
        int32_t dilation_w, value_range<float> fused_activation,
        NNCASE_UNUSED kernels::kernel_context &context) noexcept;
 
+NNCASE_API result<void> conv2d_transpose(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *weights, const gsl::byte *bias,
+    gsl::span<const size_t> in_shape, int32_t groups,
+    gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    const padding &padding_h, const padding &padding_w,
+    const value_range<float> &fused_activation,
+    kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 gather_nd(datatype_t type, const gsl::byte *input, gsl::byte *output,
           gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
@@ -48,6 +71,35 @@ gather_nd(datatype_t type, const gsl::byte *input, gsl::byte *output,
           const gsl::byte *indices, gsl::span<const size_t> indices_shape,
           size_t batch_dims, kernel_context &context) noexcept;
 
+NNCASE_API result<void>
+scatter_nd(datatype_t type, const gsl::byte *input, gsl::byte *output,
+           gsl::span<const size_t> in_shape, datatype_t indices_type,
+           const gsl::byte *indices, gsl::span<const size_t> indices_shape,
+           const gsl::byte *updates, gsl::span<const size_t> updates_shape,
+           kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> space_to_batch(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &paddings, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> reverse_sequence(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> sequence_lens,
+    int64_t batch_axis, int64_t time_axis, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void>
 reduce(typecode_t typecode, nncase::runtime::stackvm::reduce_op_t op,
        const gsl::byte *init_value, const gsl::byte *input, gsl::byte *output,
@@ -56,6 +108,32 @@ reduce(typecode_t typecode, nncase::runtime::stackvm::reduce_op_t op,
        bool keep_dims,
        kernel_context &context = default_kernel_context()) noexcept;
 
+NNCASE_API result<void>
+reduce_arg(typecode_t input_typecode, typecode_t output_typecode,
+           runtime::stackvm::reduce_arg_op_t op, const gsl::byte *input,
+           gsl::byte *output, gsl::span<const size_t> in_shape,
+           gsl::span<const size_t> in_strides,
+           gsl::span<const size_t> out_strides, gsl::span<const size_t> axes,
+           bool keep_dims, bool select_last_idx,
+           kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> reduce_window2d(
+    nncase::runtime::stackvm::reduce_op_t op, const float *input,
+    float init_value, float *output, gsl::span<const size_t> in_shape,
+    const padding &padding_h, const padding &padding_w, int32_t filter_h,
+    int32_t filter_w, int32_t stride_h, int32_t stride_w, int32_t dilation_h,
+    int32_t dilation_w, value_range<float> fused_activation,
+    bool count_include_pad,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> cast(datatype_t in_type, datatype_t out_type,
+                             const gsl::byte *input, gsl::byte *output,
+                             gsl::span<const size_t> in_shape,
+                             gsl::span<const size_t> in_strides,
+                             gsl::span<const size_t> out_strides,
+                             kernel_context &context) noexcept;
+END_NS_NNCASE_KERNEL_ISA
+
 NNCASE_API result<void>
 concat(datatype_t type, gsl::span<const gsl::byte *const> inputs,
        gsl::byte *output, gsl::span<const size_t> out_shape,
@@ -63,12 +141,14 @@ concat(datatype_t type, gsl::span<const gsl::byte *const> inputs,
        size_t axis, gsl::span<const size_t> concat_dims,
        kernel_context &context) noexcept;
 
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void>
 dequantize(datatype_t in_type, datatype_t out_type, const gsl::byte *input,
            gsl::byte *output, gsl::span<const size_t> in_shape,
            NNCASE_UNUSED gsl::span<const size_t> in_strides,
            NNCASE_UNUSED gsl::span<const size_t> out_strides, float scale,
            float bias, NNCASE_UNUSED kernel_context &context) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 
 NNCASE_API result<void>
 gather(datatype_t type, const gsl::byte *input, gsl::byte *output,
@@ -78,6 +158,7 @@ gather(datatype_t type, const gsl::byte *input, gsl::byte *output,
        gsl::span<const size_t> indices_shape, size_t axis,
        kernel_context &context) noexcept;
 
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void> gather_elements(
     datatype_t type, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
@@ -85,12 +166,52 @@ NNCASE_API result<void> gather_elements(
     datatype_t indices_type, const gsl::byte *indices,
     gsl::span<const size_t> indices_shape, size_t axis,
     kernel_context &context = default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
+
+BEGIN_NS_NNCASE_KERNEL_ISA
+NNCASE_API result<void> grid_sample(
+    typecode_t type, const gsl::byte *input, const gsl::byte *grid,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> grid_shape,
+    gsl::span<const size_t> grid_strides, gsl::span<const size_t> out_strides,
+    runtime::stackvm::grid_sample_align_corners_t align_corners,
+    runtime::stackvm::grid_sample_mode_t mode,
+    runtime::stackvm::grid_sample_padding_mode_t padding_mode,
+    kernel_context &context = default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
+
+BEGIN_NS_NNCASE_KERNEL_ISA
+NNCASE_API result<void>
+layer_norm(typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+           const gsl::byte *scale, const gsl::byte *bias,
+           gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+           bool use_mean = true, bool channel_first = false,
+           kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void> layer_norm(typecode_t typecode, const gsl::byte *input,
-                                   gsl::byte *output, const gsl::byte *scale,
-                                   const gsl::byte *bias,
-                                   gsl::span<const size_t> in_shape,
-                                   int32_t axis, float epsilon);
+NNCASE_API result<void>
+batchnorm(typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+          const gsl::byte *bias, const gsl::byte *input_mean,
+          const gsl::byte *input_var, gsl::byte *output,
+          gsl::span<const size_t> in_shape, float epsilon,
+          kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+instance_norm(typecode_t typecode, const gsl::byte *input,
+              const gsl::byte *scale, const gsl::byte *bias, gsl::byte *output,
+              gsl::span<const size_t> in_shape, float epsilon,
+              kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+lp_normalization(typecode_t typecode, const gsl::byte *input,
+                 gsl::byte *output, gsl::span<const size_t> in_shape,
+                 size_t axis, int64_t p,
+                 kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+lrn(typecode_t typecode, const gsl::byte *input, float alpha, float beta,
+    float bias, int size, gsl::byte *output, gsl::span<const size_t> in_shape,
+    kernel_context &context = default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 
 NNCASE_API result<void> one_hot(datatype_t type, datatype_t indices_type,
                                 const gsl::byte *indices, gsl::byte *output,
@@ -101,6 +222,7 @@ NNCASE_API result<void> one_hot(datatype_t type, datatype_t indices_type,
                                 runtime::stackvm::one_hot_mode_t mode,
                                 kernel_context &context) noexcept;
 
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void>
 quantize(datatype_t in_type, datatype_t out_type, const gsl::byte *input,
          gsl::byte *output, gsl::span<const size_t> in_shape,
@@ -108,6 +230,41 @@ quantize(datatype_t in_type, datatype_t out_type, const gsl::byte *input,
          NNCASE_UNUSED gsl::span<const size_t> out_strides, float scale,
          float bias, NNCASE_UNUSED kernel_context &context) noexcept;
 
+// u8 activations x i8 weights with int32 accumulation. out_scales holds one
+// requantization scale or one per output column (channel); out_type int32
+// returns the raw accumulators (with bias) and ignores the scales. Results
+// are clamped to out_range, after requantization for u8 and i8 outputs.
+NNCASE_API result<void> quantized_matmul(
+    datatype_t out_type, const uint8_t *lhs, const int8_t *rhs,
+    const int32_t *bias, gsl::byte *output, size_t m, size_t n, size_t k,
+    int32_t lhs_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> quantized_conv2d(
+    datatype_t out_type, const uint8_t *input, const int8_t *weights,
+    const int32_t *bias, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> w_shape, const padding &padding_h,
+    const padding &padding_w, int32_t groups, int32_t stride_h,
+    int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    int32_t input_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+// Philox4x32-10 streams keyed by the seed; element i depends only on the
+// seed and i, so the result does not change with the thread count.
+NNCASE_API result<void>
+random_normal(typecode_t type, gsl::byte *output,
+              gsl::span<const size_t> out_shape, float mean, float std,
+              float seed,
+              kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+random_uniform(typecode_t type, gsl::byte *output,
+               gsl::span<const size_t> out_shape, float low, float high,
+               float seed,
+               kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 resize_bilinear(typecode_t type, const gsl::byte *input, gsl::byte *output,
                 gsl::span<const size_t> in_shape,
@@ -124,6 +281,7 @@ NNCASE_API result<void> resize_nearest_neighbor(
     get_coordinate_func_t get_coordinate_func,
     get_nearest_pixel_func_t get_nearset_func,
     kernel_context &context) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 
 NNCASE_API result<void>
 slice(datatype_t type, const gsl::byte *input, gsl::byte *output,
@@ -132,6 +290,52 @@ slice(datatype_t type, const gsl::byte *input, gsl::byte *output,
       const axes_t &ends, const axes_t &strides,
       NNCASE_UNUSED kernel_context &context) noexcept;
 
+/**
+ * Pads a contiguous tensor into a contiguous output of `out_shape`. Inner
+ * rows are copied whole and borders come from per-axis index tables, for
+ * every pad mode. Returns not_supported for interior padding, callers then
+ * use the reference kernel.
+ */
+NNCASE_API result<void>
+pad(datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
+    const paddings_t &paddings, runtime::stackvm::pad_mode_t mode,
+    const gsl::byte *pad_value,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+enum class activation_op_t {
+    relu,
+    softsign,
+    softplus,
+    sigmoid,
+    swish,
+    hard_swish,
+    erf,
+    elu,
+    celu,
+    leaky_relu,
+    gelu,
+    selu,
+    hard_sigmoid,
+};
+
+BEGIN_NS_NNCASE_KERNEL_ISA
+NNCASE_API result<void>
+cumsum(typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+       gsl::span<const size_t> in_shape, size_t axis, bool exclusive,
+       bool reverse,
+       kernel_context &context = default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
+
+BEGIN_NS_NNCASE_KERNEL_ISA
+result<void>
+compare(typecode_t typecode, runtime::stackvm::compare_op_t op,
+        const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
+        gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
+        gsl::span<const size_t> rhs_shape, gsl::span<const size_t> rhs_strides,
+        gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+        kernel_context &context = default_kernel_context()) noexcept;
+
 result<void>
 binary(typecode_t typecode, runtime::stackvm::binary_op_t op,
        const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
@@ -147,6 +351,25 @@ unary(typecode_t dtype, runtime::stackvm::unary_op_t op, const gsl::byte *in,
       gsl::span<const size_t> out_strides,
       kernel_context &context = default_kernel_context()) noexcept;
 
+/**
+ * Applies an activation to `count` contiguous float32, float16 or bfloat16
+ * elements. `alpha` and `gamma` point to one element of the same type and
+ * are only read by ops that take them. `input` and `output` may be the same
+ * buffer. Returns not_supported when the target has no vector path, callers
+ * then use the reference kernel.
+ */
+NNCASE_API result<void>
+activation(activation_op_t op, typecode_t typecode, const gsl::byte *input,
+           gsl::byte *output, size_t count, const gsl::byte *alpha,
+           const gsl::byte *gamma,
+           kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void>
+prelu(typecode_t typecode, const gsl::byte *input, const gsl::byte *slope,
+      gsl::byte *output, gsl::span<const size_t> in_shape,
+      gsl::span<const size_t> slope_shape,
+      kernel_context &context = default_kernel_context()) noexcept;
+
 // template <typename T>
 // NNCASE_API result<void> matmul(const T *input_a, const T *input_b, const T
 // *bias, T *output,
@@ -157,18 +380,43 @@ unary(typecode_t dtype, runtime::stackvm::unary_op_t op, const gsl::byte *in,
 //                               gsl::span<const size_t> out_strides,
 //                               value_range<float> fused_activation) noexcept;
 
+NNCASE_API result<void>
+matmul(typecode_t typecode, const gsl::byte *input_a, const gsl::byte *input_b,
+       gsl::byte *output, gsl::span<const size_t> in_a_shape,
+       gsl::span<const size_t> in_b_shape,
+       kernel_context &context = default_kernel_context()) noexcept;
+
+/**
+ * float32 LSTM over contiguous [seq, batch, input] data with ONNX weight
+ * layouts and iofc gate order. The input projection of all steps is one
+ * matmul per direction, directions run in parallel. Returns not_supported
+ * for other types, callers then use the reference kernel.
+ */
+NNCASE_API result<void>
+lstm(typecode_t typecode, const gsl::byte *input, const gsl::byte *w_xc,
+     const gsl::byte *w_rc, const gsl::byte *bias, const gsl::byte *init_h,
+     const gsl::byte *init_c, gsl::byte *output, gsl::byte *output_h,
+     gsl::byte *output_c, gsl::span<const size_t> in_shape,
+     gsl::span<const size_t> w_xc_shape, gsl::span<const size_t> w_rc_shape,
+     runtime::stackvm::lstmdirection_t direction,
+     kernel_context &context = default_kernel_context()) noexcept;
+
 // template <typename T>
 NNCASE_API result<void>
 softmax(typecode_t typecode, const gsl::byte *input, gsl::byte *output,
         gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
-        gsl::span<const size_t> out_strides, int32_t axis, float beta) noexcept;
+        gsl::span<const size_t> out_strides, int32_t axis, float beta,
+        kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void> log_softmax(typecode_t typecode, const gsl::byte *input,
                                     gsl::byte *output,
                                     gsl::span<const size_t> in_shape,
                                     gsl::span<const size_t> in_strides,
                                     gsl::span<const size_t> out_strides,
-                                    int32_t axis) noexcept;
+                                    int32_t axis,
+                                    kernel_context &context =
+                                        default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 
 template <typename T>
 NNCASE_API result<void>
@@ -177,36 +425,56 @@ sigmoid(const T *input, T *output, gsl::span<const size_t> in_shape,
         gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
         kernel_context &context = default_kernel_context()) noexcept;
 
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void>
 where(datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
       gsl::byte *output, gsl::span<const size_t> cond_shape,
       gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
       gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
       gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-      gsl::span<const size_t> out_strides);
+      gsl::span<const size_t> out_strides,
+      kernel_context &context = default_kernel_context());
+END_NS_NNCASE_KERNEL_ISA
 
 NNCASE_API result<void>
 tile(datatype_t dt, const gsl::byte *input, gsl::byte *output,
      gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
      gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-     gsl::span<const size_t> repeats);
+     gsl::span<const size_t> repeats,
+     kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void> topk(typecode_t typecode, const gsl::byte *input,
-                             gsl::byte *output_values, int64_t *output_indices,
-                             gsl::span<const size_t> in_shape,
-                             gsl::span<const size_t> in_strides,
-                             gsl::span<const size_t> output_values_shape,
-                             gsl::span<const size_t> output_values_strides,
-                             gsl::span<const size_t> output_indices_shape,
-                             gsl::span<const size_t> output_indices_strides,
-                             const int64_t k, const int32_t axis,
-                             const bool largest, const bool sorted) noexcept;
+NNCASE_API result<void> expand(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> broadcast(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> input_shape, gsl::span<const size_t> input_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+BEGIN_NS_NNCASE_KERNEL_ISA
+NNCASE_API result<void>
+topk(typecode_t typecode, const gsl::byte *input, gsl::byte *output_values,
+     int64_t *output_indices, gsl::span<const size_t> in_shape,
+     gsl::span<const size_t> in_strides,
+     gsl::span<const size_t> output_values_shape,
+     gsl::span<const size_t> output_values_strides,
+     gsl::span<const size_t> output_indices_shape,
+     gsl::span<const size_t> output_indices_strides, const int64_t k,
+     const int32_t axis, const bool largest, const bool sorted,
+     kernel_context &context = default_kernel_context()) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 
+BEGIN_NS_NNCASE_KERNEL_ISA
 NNCASE_API result<void> transpose(datatype_t type, const gsl::byte *src,
                                   gsl::byte *dest, const dims_t &in_shape,
                                   const dims_t &perm,
                                   const strides_t &in_strides,
                                   const strides_t &out_strides,
                                   kernel_context &context) noexcept;
+END_NS_NNCASE_KERNEL_ISA
 } // namespace optimized
 END_NS_NNCASE_KERNELS_MODULE
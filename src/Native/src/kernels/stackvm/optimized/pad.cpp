@@ -0,0 +1,202 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Source position along one axis for every output position, or -1 where
+ * the constant is written. Output positions in [copy_begin, copy_end) read
+ * consecutive sources starting at copy_begin - before, so they are copied
+ * as one run; only the borders go through the table.
+ */
+struct axis_map {
+    std::vector<int64_t> src;
+    size_t copy_begin;
+    size_t copy_end;
+    int64_t before;
+};
+
+// Same index rules as get_in_index in reference/pad.cpp.
+bool make_axis_map(axis_map &map, size_t in_dim, size_t out_dim,
+                   const padding &pad, pad_mode_t mode) {
+    const auto n = (int64_t)in_dim;
+    map.before = pad.before;
+    map.copy_begin = (size_t)std::clamp<int64_t>(pad.before, 0, out_dim);
+    map.copy_end = (size_t)std::clamp<int64_t>(pad.before + n,
+                                               map.copy_begin, out_dim);
+    map.src.resize(out_dim);
+    for (size_t o = 0; o < out_dim; o++) {
+        const auto c = (int64_t)o - pad.before;
+        int64_t s = c;
+        if (c < 0) {
+            if (mode == pad_mode_t::reflect)
+                s = -c;
+            else if (mode == pad_mode_t::symmetric)
+                s = -c - 1;
+            else if (mode == pad_mode_t::edge)
+                s = 0;
+            else
+                s = -1;
+        } else if (c > n - 1) {
+            if (mode == pad_mode_t::reflect)
+                s = std::abs(n - 2 - (c - n));
+            else if (mode == pad_mode_t::symmetric)
+                s = n - 1 - (c - n);
+            else if (mode == pad_mode_t::edge)
+                s = n - 1;
+            else
+                s = -1;
+        }
+
+        // the reference reads out of bounds here, let it handle the case
+        if (s >= n || (s < 0 && mode != pad_mode_t::constant))
+            return false;
+        map.src[o] = s;
+    }
+    return true;
+}
+
+template <class T> void fill(T *dst, size_t count, T value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    if (std::all_of(bytes, bytes + sizeof(T),
+                    [&](uint8_t b) { return b == bytes[0]; }))
+        memset(dst, bytes[0], count * sizeof(T));
+    else
+        std::fill_n(dst, count, value);
+}
+
+// Writes one output row along the innermost padded axis, whose elements
+// are contiguous blocks of `block` values.
+template <class T>
+void pad_row(const T *in_row, T *out_row, const axis_map &map, size_t block,
+             T value) {
+    auto border = [&](size_t begin, size_t end) {
+        for (size_t o = begin; o < end; o++) {
+            if (map.src[o] < 0)
+                fill(out_row + o * block, block, value);
+            else
+                opt_memcpy(out_row + o * block, in_row + map.src[o] * block,
+                           block * sizeof(T));
+        }
+    };
+
+    border(0, map.copy_begin);
+    opt_memcpy(out_row + map.copy_begin * block,
+               in_row + (map.copy_begin - map.before) * block,
+               (map.copy_end - map.copy_begin) * block * sizeof(T));
+    border(map.copy_end, map.src.size());
+}
+
+template <class T>
+result<void> pad_impl(const T *input, T *output,
+                      gsl::span<const size_t> in_shape,
+                      gsl::span<const size_t> out_shape,
+                      const paddings_t &paddings, pad_mode_t mode, T value,
+                      NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto rank = in_shape.size();
+    const auto out_size = compute_size(out_shape);
+    size_t axis = rank;
+    while (axis > 0 && paddings[axis - 1].before == 0 &&
+           paddings[axis - 1].after == 0)
+        axis--;
+    if (axis == 0) {
+        opt_memcpy(output, input, out_size * sizeof(T));
+        return ok();
+    }
+
+    // trailing unpadded axes are copied as part of each row element
+    axis--;
+    std::vector<axis_map> maps(axis + 1);
+    for (size_t i = 0; i <= axis; i++) {
+        if (!make_axis_map(maps[i], in_shape[i], out_shape[i], paddings[i],
+                           mode))
+            return err(std::errc::not_supported);
+    }
+
+    const auto in_strides = get_default_strides(in_shape);
+    const size_t block = axis + 1 < rank ? in_strides[axis] : 1;
+    const size_t out_row_size = out_shape[axis] * block;
+    const auto rows = (int64_t)(out_size / std::max<size_t>(out_row_size, 1));
+    NNCASE_UNUSED const auto threads =
+        out_size * sizeof(T) < parallel_copy_threshold ? 1
+                                                       : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t r = 0; r < rows; r++) {
+        T *out_row = output + r * out_row_size;
+        size_t in_offset = 0;
+        bool constant_row = false;
+        auto rest = (size_t)r;
+        for (size_t i = axis; i-- > 0;) {
+            const auto s = maps[i].src[rest % out_shape[i]];
+            rest /= out_shape[i];
+            if (s < 0) {
+                constant_row = true;
+                break;
+            }
+            in_offset += (size_t)s * in_strides[i];
+        }
+
+        if (constant_row)
+            fill(out_row, out_row_size, value);
+        else
+            pad_row(input + in_offset, out_row, maps[axis], block, value);
+    }
+    return ok();
+}
+} // namespace
+
+#define PAD_IMPL(size, type)                                                   \
+    case size:                                                                 \
+        return pad_impl(reinterpret_cast<const type *>(input),                 \
+                        reinterpret_cast<type *>(output), in_shape, out_shape, \
+                        paddings, mode, *reinterpret_cast<const type *>(       \
+                                            pad_value),                        \
+                        context)
+
+result<void> optimized::pad(datatype_t type, const gsl::byte *input,
+                            gsl::byte *output, gsl::span<const size_t> in_shape,
+                            gsl::span<const size_t> out_shape,
+                            const paddings_t &paddings, pad_mode_t mode,
+                            const gsl::byte *pad_value,
+                            kernel_context &context) noexcept {
+    if (in_shape.empty() || compute_size(in_shape) == 0 ||
+        std::any_of(paddings.begin(), paddings.end(),
+                    [](const padding &p) { return p.interior != 0; }))
+        return err(std::errc::not_supported);
+
+    switch (runtime::get_bytes(type)) {
+        PAD_IMPL(1, uint8_t);
+        PAD_IMPL(2, uint16_t);
+        PAD_IMPL(4, uint32_t);
+        PAD_IMPL(8, uint64_t);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
@@ -12,10 +12,16 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "opt_common.h"
 #include "opt_ops.h"
+#include <algorithm>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
+#include <type_traits>
+#if __AVX__
+#include <immintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -23,6 +29,7 @@ using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
+namespace {
 namespace impl {
 #if __riscv
 template <class TQ>
@@ -55,29 +62,92 @@ void riscv_quantize(const float *CXX_RESTRICT input, TQ *CXX_RESTRICT output,
 }
 #endif
 
-template <class TQ>
-result<void> quantize(const float *CXX_RESTRICT input, TQ *CXX_RESTRICT output,
-                      size_t count, float scale, float bias) {
+#if __AVX__
+inline __m256 load_float8(const float *input) {
+    return _mm256_loadu_ps(input);
+}
+
+inline __m256 load_float8(const bfloat16 *input) {
+    // bfloat16 is the upper half of a float
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm256_castsi256_ps(_mm256_insertf128_si256(
+        _mm256_castsi128_si256(_mm_unpacklo_epi16(zero, v)),
+        _mm_unpackhi_epi16(zero, v), 1));
+}
+
+// Quantizes whole groups of 8 and returns how many elements were done.
+// Clamping in float before the conversion fuses the saturation into the
+// rounding cvtps, which rounds to nearest even like lrintf.
+template <class TFloat, class TQ>
+size_t avx_quantize(const TFloat *CXX_RESTRICT input, TQ *CXX_RESTRICT output,
+                    size_t count, float scale, float bias) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 vbias = _mm256_set1_ps(bias);
+    const __m256 lo = _mm256_set1_ps((float)std::numeric_limits<TQ>::lowest());
+    const __m256 hi = _mm256_set1_ps((float)std::numeric_limits<TQ>::max());
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_add_ps(_mm256_div_ps(load_float8(input + i), vscale),
+                                 vbias);
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        const __m256i q = _mm256_cvtps_epi32(v);
+        const __m128i q16 = _mm_packs_epi32(_mm256_castsi256_si128(q),
+                                            _mm256_extractf128_si256(q, 1));
+        if constexpr (sizeof(TQ) == 2) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), q16);
+        } else {
+            const __m128i q8 = std::is_signed_v<TQ>
+                                   ? _mm_packs_epi16(q16, q16)
+                                   : _mm_packus_epi16(q16, q16);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + i), q8);
+        }
+    }
+    return i;
+}
+#endif
+
+template <class TFloat, class TQ>
+void quantize_block(const TFloat *CXX_RESTRICT input, TQ *CXX_RESTRICT output,
+                    size_t count, float scale, float bias) {
+    size_t i = 0;
 #if __riscv
-    riscv_quantize(input, output, count, scale, bias);
-#else
-    for (size_t i = 0; i < count; i++) {
-        auto qvalue = (int32_t)std::nearbyintf(input[i] / scale + bias);
+    if constexpr (std::is_same_v<TFloat, float>) {
+        riscv_quantize(input, output, count, scale, bias);
+        return;
+    }
+#elif __AVX__
+    i = avx_quantize(input, output, count, scale, bias);
+#endif
+    for (; i < count; i++) {
+        auto qvalue = (int32_t)std::nearbyintf((float)input[i] / scale + bias);
         output[i] = (TQ)kernels::detail::clamp(
             qvalue, (int32_t)std::numeric_limits<TQ>::lowest(),
             (int32_t)std::numeric_limits<TQ>::max());
     }
-#endif
-    return ok();
 }
 
+template <class TFloat, class TQ>
+result<void> quantize(const TFloat *CXX_RESTRICT input,
+                      TQ *CXX_RESTRICT output, size_t count, float scale,
+                      float bias, kernel_context &context) {
+    for_each_block(
+        count,
+        [&](size_t begin, size_t end) {
+            quantize_block(input + begin, output + begin, end - begin, scale,
+                           bias);
+        },
+        context);
+    return ok();
+}
 } // namespace impl
+} // namespace
 
 #define QUANTIZE_IMPL(float_t, qint_t)                                         \
     if (cmp_type<float_t>(in_type) && cmp_type<qint_t>(out_type)) {            \
         return impl::quantize(reinterpret_cast<const float_t *>(input),        \
                               reinterpret_cast<qint_t *>(output),              \
-                              compute_size(in_shape), scale, bias);            \
+                              compute_size(in_shape), scale, bias, context);   \
     }
 
 result<void> optimized::quantize(
@@ -85,9 +155,12 @@ result<void> optimized::quantize(
     gsl::byte *output, gsl::span<const size_t> in_shape,
     NNCASE_UNUSED gsl::span<const size_t> in_strides,
     NNCASE_UNUSED gsl::span<const size_t> out_strides, float scale, float bias,
-    NNCASE_UNUSED kernel_context &context) noexcept {
+    kernel_context &context) noexcept {
     QUANTIZE_IMPL(float, uint8_t)
     QUANTIZE_IMPL(float, int8_t)
     QUANTIZE_IMPL(float, int16_t)
+    QUANTIZE_IMPL(bfloat16, uint8_t)
+    QUANTIZE_IMPL(bfloat16, int8_t)
+    QUANTIZE_IMPL(bfloat16, int16_t)
     return err(std::errc::not_supported);
-}
\ No newline at end of file
+}
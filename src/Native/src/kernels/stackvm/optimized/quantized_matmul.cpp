@@ -0,0 +1,370 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <type_traits>
+#include <vector>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+#if __AVX512VNNI__ && __AVX512VL__
+#define QGEMM_VNNI 1
+#endif
+
+namespace {
+// Register block: 4 lhs rows by 2 panels of 8 rhs columns.
+constexpr size_t qgemm_rows = 4;
+constexpr size_t qgemm_panel = 8;
+constexpr size_t qgemm_panels = 2;
+
+// rhs packed as [panel][k / 4][8 columns][4 k]: 4 consecutive k of one lhs
+// row, broadcast as an int32, line up with the 4 k of each of 8 columns,
+// which is the operand layout of maddubs and vpdpbusd.
+//
+// maddubs adds two u8 x i8 products into a saturating int16, which is exact
+// only while |w| <= 64. Wider weights are split as w = (w >> 1) + (w - (w >>
+// 1)) into lo and hi, and both halves are accumulated.
+struct packed_rhs {
+    size_t k4;
+    size_t panels;
+    std::vector<int8_t> lo, hi;
+    std::vector<int32_t> col_sums;
+};
+
+void pack_rhs(const int8_t *rhs, size_t rs_k, size_t rs_n, size_t n, size_t k,
+              packed_rhs &packed) {
+    bool split = false;
+#if __AVX2__ && !QGEMM_VNNI
+    for (size_t kk = 0; kk < k && !split; kk++)
+        for (size_t j = 0; j < n && !split; j++) {
+            const auto w = rhs[kk * rs_k + j * rs_n];
+            split = w < -64 || w > 64;
+        }
+#endif
+
+    packed.k4 = (k + 3) / 4;
+    packed.panels = (n + qgemm_panel - 1) / qgemm_panel;
+    const auto size = packed.panels * packed.k4 * qgemm_panel * 4;
+    packed.lo.assign(size, 0);
+    packed.hi.assign(split ? size : 0, 0);
+    packed.col_sums.assign(n, 0);
+    for (size_t j = 0; j < n; j++) {
+        const auto p = j / qgemm_panel;
+        for (size_t kk = 0; kk < k; kk++) {
+            const auto w = rhs[kk * rs_k + j * rs_n];
+            const auto index = ((p * packed.k4 + kk / 4) * qgemm_panel +
+                                j % qgemm_panel) *
+                                   4 +
+                               kk % 4;
+            packed.col_sums[j] += w;
+            if (split) {
+                packed.lo[index] = (int8_t)(w >> 1);
+                packed.hi[index] = (int8_t)(w - (w >> 1));
+            } else {
+                packed.lo[index] = w;
+            }
+        }
+    }
+}
+
+// 4 consecutive lhs bytes, zero padded past k.
+inline int32_t load_quad(const uint8_t *a, size_t kq, size_t k) {
+    int32_t v = 0;
+    if (kq * 4 + 4 <= k)
+        std::memcpy(&v, a + kq * 4, 4);
+    else
+        for (size_t i = kq * 4; i < k; i++)
+            v |= (int32_t)a[i] << (8 * (i - kq * 4));
+    return v;
+}
+
+// acc[r][c] = sum_k a[r][k] * b[k][c] for qgemm_rows rows and np panels.
+void qgemm_block(const uint8_t *const *a, size_t k, const packed_rhs &b,
+                 size_t panel, size_t np,
+                 int32_t (&acc)[qgemm_rows][qgemm_panel * qgemm_panels]) {
+#if __AVX2__
+    __m256i vacc[qgemm_rows][qgemm_panels];
+    for (size_t r = 0; r < qgemm_rows; r++)
+        for (size_t p = 0; p < qgemm_panels; p++)
+            vacc[r][p] = _mm256_setzero_si256();
+
+    const auto panel_stride = b.k4 * qgemm_panel * 4;
+#if !QGEMM_VNNI
+    const __m256i ones = _mm256_set1_epi16(1);
+    const auto split = !b.hi.empty();
+    __m256i vb_hi[qgemm_panels];
+#endif
+    for (size_t kq = 0; kq < b.k4; kq++) {
+        __m256i vb[qgemm_panels];
+        for (size_t p = 0; p < np; p++) {
+            const auto offset =
+                (panel + p) * panel_stride + kq * qgemm_panel * 4;
+            vb[p] = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(b.lo.data() + offset));
+#if !QGEMM_VNNI
+            if (split)
+                vb_hi[p] = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i *>(b.hi.data() + offset));
+#endif
+        }
+
+        for (size_t r = 0; r < qgemm_rows; r++) {
+            const __m256i va = _mm256_set1_epi32(load_quad(a[r], kq, k));
+            for (size_t p = 0; p < np; p++) {
+#if QGEMM_VNNI
+                vacc[r][p] = _mm256_dpbusd_epi32(vacc[r][p], va, vb[p]);
+#else
+                vacc[r][p] = _mm256_add_epi32(
+                    vacc[r][p],
+                    _mm256_madd_epi16(_mm256_maddubs_epi16(va, vb[p]), ones));
+                if (split)
+                    vacc[r][p] = _mm256_add_epi32(
+                        vacc[r][p],
+                        _mm256_madd_epi16(_mm256_maddubs_epi16(va, vb_hi[p]),
+                                          ones));
+#endif
+            }
+        }
+    }
+
+    for (size_t r = 0; r < qgemm_rows; r++)
+        for (size_t p = 0; p < np; p++)
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(acc[r] + p * qgemm_panel),
+                vacc[r][p]);
+#else
+    const auto panel_stride = b.k4 * qgemm_panel * 4;
+    for (size_t r = 0; r < qgemm_rows; r++) {
+        for (size_t c = 0; c < np * qgemm_panel; c++) {
+            const auto p = panel + c / qgemm_panel;
+            int32_t sum = 0;
+            for (size_t kk = 0; kk < k; kk++)
+                sum += (int32_t)a[r][kk] *
+                       b.lo[p * panel_stride +
+                            ((kk / 4) * qgemm_panel + c % qgemm_panel) * 4 +
+                            kk % 4];
+            acc[r][c] = sum;
+        }
+    }
+#endif
+}
+
+struct qgemm_epilogue {
+    int32_t lhs_zero_point;
+    const int32_t *bias;
+    gsl::span<const float> scales;
+    int32_t out_zero_point;
+    // out_range narrowed to the output type
+    int32_t out_min, out_max;
+};
+
+template <class TOutput>
+void store_result(TOutput *output, int32_t value, float scale,
+                  const qgemm_epilogue &epilogue) {
+    if constexpr (std::is_same_v<TOutput, int32_t>) {
+        *output = std::clamp(value, epilogue.out_min, epilogue.out_max);
+    } else {
+        // clamped as float so that huge products cannot overflow the cast
+        const auto q =
+            std::nearbyintf(value * scale) + (float)epilogue.out_zero_point;
+        *output = (TOutput)std::clamp(q, (float)epilogue.out_min,
+                                      (float)epilogue.out_max);
+    }
+}
+
+qgemm_epilogue make_epilogue(datatype_t out_type, int32_t lhs_zero_point,
+                             const int32_t *bias,
+                             gsl::span<const float> scales,
+                             int32_t out_zero_point,
+                             value_range<int32_t> out_range) {
+    auto low = out_range.min, high = out_range.max;
+    if (cmp_type<uint8_t>(out_type)) {
+        low = std::max(low, (int32_t)std::numeric_limits<uint8_t>::lowest());
+        high = std::min(high, (int32_t)std::numeric_limits<uint8_t>::max());
+    } else if (cmp_type<int8_t>(out_type)) {
+        low = std::max(low, (int32_t)std::numeric_limits<int8_t>::lowest());
+        high = std::min(high, (int32_t)std::numeric_limits<int8_t>::max());
+    }
+    return {lhs_zero_point, bias, scales, out_zero_point, low, high};
+}
+
+// output[i * ldo_m + j * ldo_n] for lhs rows of lda bytes.
+template <class TOutput>
+void qgemm(const uint8_t *lhs, size_t lda, const packed_rhs &rhs, size_t m,
+           size_t n, size_t k, const qgemm_epilogue &epilogue,
+           TOutput *output, size_t ldo_m, size_t ldo_n,
+           NNCASE_UNUSED kernel_context &context) {
+    const auto row_blocks = (m + qgemm_rows - 1) / qgemm_rows;
+    const auto panel_blocks = (rhs.panels + qgemm_panels - 1) / qgemm_panels;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(row_blocks * panel_blocks); t++) {
+        const auto i0 = ((size_t)t / panel_blocks) * qgemm_rows;
+        const auto panel = ((size_t)t % panel_blocks) * qgemm_panels;
+        const auto np = std::min(qgemm_panels, rhs.panels - panel);
+
+        // rows past m repeat the last row and are discarded
+        const uint8_t *a[qgemm_rows];
+        for (size_t r = 0; r < qgemm_rows; r++)
+            a[r] = lhs + std::min(i0 + r, m - 1) * lda;
+        int32_t acc[qgemm_rows][qgemm_panel * qgemm_panels];
+        qgemm_block(a, k, rhs, panel, np, acc);
+
+        const auto j0 = panel * qgemm_panel;
+        const auto cols = std::min(np * qgemm_panel, n - j0);
+        for (size_t r = 0; r < std::min(qgemm_rows, m - i0); r++) {
+            for (size_t c = 0; c < cols; c++) {
+                const auto j = j0 + c;
+                auto value = acc[r][c] -
+                             epilogue.lhs_zero_point * rhs.col_sums[j];
+                if (epilogue.bias)
+                    value += epilogue.bias[j];
+                const auto scale = epilogue.scales.empty() ? 1.f
+                                   : epilogue.scales.size() == 1
+                                       ? epilogue.scales[0]
+                                       : epilogue.scales[j];
+                store_result(output + (i0 + r) * ldo_m + j * ldo_n, value,
+                             scale, epilogue);
+            }
+        }
+    }
+}
+
+// [out_h * out_w, ic * filter_h * filter_w] patches of one image.
+void im2col(const uint8_t *input, uint8_t *cols, size_t in_h, size_t in_w,
+            size_t in_channels, size_t filter_h, size_t filter_w, size_t out_h,
+            size_t out_w, const padding &padding_h, const padding &padding_w,
+            int32_t stride_h, int32_t stride_w, int32_t dilation_h,
+            int32_t dilation_w, uint8_t pad_value) {
+    for (size_t oy = 0; oy < out_h; oy++) {
+        for (size_t ox = 0; ox < out_w; ox++) {
+            const auto y0 = (int32_t)oy * stride_h - padding_h.before;
+            const auto x0 = (int32_t)ox * stride_w - padding_w.before;
+            for (size_t ic = 0; ic < in_channels; ic++) {
+                auto in_ = input + ic * in_h * in_w;
+                for (size_t ky = 0; ky < filter_h; ky++) {
+                    const auto iy = y0 + (int32_t)ky * dilation_h;
+                    const auto row_valid = iy >= 0 && iy < (int32_t)in_h;
+                    for (size_t kx = 0; kx < filter_w; kx++) {
+                        const auto ix = x0 + (int32_t)kx * dilation_w;
+                        *cols++ = row_valid && ix >= 0 && ix < (int32_t)in_w
+                                      ? in_[iy * in_w + ix]
+                                      : pad_value;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#define QGEMM_IMPL(_ty, lhs, lda, m, n, k, output, ldo_m, ldo_n)              \
+    if (cmp_type<_ty>(out_type)) {                                             \
+        qgemm(lhs, lda, packed, m, n, k, epilogue,                             \
+              reinterpret_cast<_ty *>(output), ldo_m, ldo_n, context);         \
+    }
+
+#define QGEMM_SELECT(...)                                                      \
+    QGEMM_IMPL(int32_t, __VA_ARGS__)                                           \
+    else QGEMM_IMPL(uint8_t, __VA_ARGS__) else QGEMM_IMPL(int8_t,             \
+                                                            __VA_ARGS__)
+} // namespace
+
+result<void> optimized::quantized_matmul(
+    datatype_t out_type, const uint8_t *lhs, const int8_t *rhs,
+    const int32_t *bias, gsl::byte *output, size_t m, size_t n, size_t k,
+    int32_t lhs_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context) noexcept {
+    if (!cmp_type<int32_t>(out_type) && !cmp_type<uint8_t>(out_type) &&
+        !cmp_type<int8_t>(out_type))
+        return err(std::errc::not_supported);
+    if (m == 0 || n == 0)
+        return ok();
+
+    packed_rhs packed;
+    pack_rhs(rhs, n, 1, n, k, packed);
+    const auto epilogue = make_epilogue(out_type, lhs_zero_point, bias,
+                                        out_scales, out_zero_point, out_range);
+    QGEMM_SELECT(lhs, k, m, n, k, output, n, 1);
+    return ok();
+}
+
+result<void> optimized::quantized_conv2d(
+    datatype_t out_type, const uint8_t *input, const int8_t *weights,
+    const int32_t *bias, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> w_shape, const padding &padding_h,
+    const padding &padding_w, int32_t groups, int32_t stride_h,
+    int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    int32_t input_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context) noexcept {
+    if (!cmp_type<int32_t>(out_type) && !cmp_type<uint8_t>(out_type) &&
+        !cmp_type<int8_t>(out_type))
+        return err(std::errc::not_supported);
+
+    const auto batch = in_shape[0], in_h = in_shape[2], in_w = in_shape[3];
+    const auto out_channels = w_shape[0], g_ic = w_shape[1];
+    const auto filter_h = w_shape[2], filter_w = w_shape[3];
+    const auto g_oc = out_channels / groups;
+    const auto out_h = kernels::detail::get_windowed_output_size(
+        in_h, (int32_t)filter_h, stride_h, dilation_h, padding_h);
+    const auto out_w = kernels::detail::get_windowed_output_size(
+        in_w, (int32_t)filter_w, stride_w, dilation_w, padding_w);
+    const auto out_size = out_h * out_w;
+    const auto k = g_ic * filter_h * filter_w;
+    const auto elem_bytes = runtime::get_bytes(out_type);
+    if (out_size == 0 || g_oc == 0)
+        return ok();
+
+    // im2col as [out_h * out_w, k] so that it is the u8 lhs; padded taps
+    // hold the input zero point and so contribute nothing after correction.
+    std::vector<uint8_t> cols(out_size * k);
+    for (size_t g = 0; g < (size_t)groups; g++) {
+        packed_rhs packed;
+        pack_rhs(weights + g * g_oc * k, 1, k, g_oc, k, packed);
+        const auto epilogue = make_epilogue(
+            out_type, input_zero_point, bias ? bias + g * g_oc : nullptr,
+            out_scales.size() > 1 ? out_scales.subspan(g * g_oc, g_oc)
+                                  : out_scales,
+            out_zero_point, out_range);
+
+        for (size_t b = 0; b < batch; b++) {
+            const auto in_ =
+                input + (b * in_shape[1] + g * g_ic) * in_h * in_w;
+            im2col(in_, cols.data(), in_h, in_w, g_ic, filter_h, filter_w,
+                   out_h, out_w, padding_h, padding_w, stride_h, stride_w,
+                   dilation_h, dilation_w, (uint8_t)input_zero_point);
+
+            auto out_ = output + (b * out_channels + g * g_oc) * out_size *
+                                     elem_bytes;
+            QGEMM_SELECT(cols.data(), k, out_size, g_oc, k, out_, 1, out_size);
+        }
+    }
+    return ok();
+}
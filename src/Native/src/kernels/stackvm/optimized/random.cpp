@@ -0,0 +1,402 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Values are produced in groups of 32: word k of the Philox block with
+ * counter 8 * g + j becomes element 32 * g + 8 * k + j. Every element thus
+ * depends only on the seed and its own position, so any split of the groups
+ * across threads gives the same tensor, and the AVX2 path can store whole
+ * vectors without transposing.
+ */
+constexpr size_t group_size = 32;
+constexpr size_t group_lanes = 8;
+
+constexpr uint32_t philox_m0 = 0xD2511F53, philox_m1 = 0xCD9E8D57;
+constexpr uint32_t philox_w0 = 0x9E3779B9, philox_w1 = 0xBB67AE85;
+constexpr size_t philox_rounds = 10;
+
+// maps the top 24 bits of a random word onto [0, 1)
+constexpr float word_scale = 1.f / 16777216.f;
+constexpr float quarter_turn_scale = 1.f / 4194304.f;
+constexpr float half_pi = 1.57079632679489661923f;
+constexpr float sqrt_half = 0.707106781186547524f;
+
+/**
+ * The scalar and AVX2 transforms below perform the same IEEE operations in
+ * the same order, so every ISA level produces bit-identical samples for a
+ * seed. Each multiply-add is an explicit fma and no plain product feeds an
+ * add, which keeps -ffp-contract from fusing them differently per build;
+ * log and sincos are evaluated with their own polynomials rather than libm.
+ * Keep the two versions in lockstep.
+ */
+constexpr float log_p[] = {7.0376836292E-2f,  -1.1514610310E-1f,
+                           1.1676998740E-1f,  -1.2420140846E-1f,
+                           1.4249322787E-1f,  -1.6668057665E-1f,
+                           2.0000714765E-1f,  -2.4999993993E-1f,
+                           3.3333331174E-1f};
+constexpr float log_q1 = -2.12194440e-4f, log_q2 = 0.693359375f;
+constexpr float sin_p[] = {-1.9515295891E-4f, 8.3321608736E-3f,
+                           -1.6666654611E-1f};
+constexpr float cos_p[] = {2.443315711809948E-005f, -1.388731625493765E-003f,
+                           4.166664568298827E-002f};
+
+struct philox_key {
+    uint32_t k0, k1;
+};
+
+philox_key make_key(float seed) {
+    uint32_t bits;
+    std::memcpy(&bits, &seed, sizeof(bits));
+    return {bits, 0};
+}
+
+void philox4x32(uint64_t counter, philox_key key, uint32_t words[4]) {
+    uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32), c2 = 0,
+             c3 = 0;
+    for (size_t r = 0; r < philox_rounds; r++) {
+        const auto p0 = (uint64_t)philox_m0 * c0;
+        const auto p1 = (uint64_t)philox_m1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ key.k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ key.k1;
+        c3 = (uint32_t)p0;
+        key.k0 += philox_w0;
+        key.k1 += philox_w1;
+    }
+    words[0] = c0;
+    words[1] = c1;
+    words[2] = c2;
+    words[3] = c3;
+}
+
+float to_unit(uint32_t word) { return (float)(word >> 8) * word_scale; }
+
+// ln of (word >> 8) + 1 scaled onto (0, 1], for each lane. Every step runs
+// across all lanes before the next, so the lanes' chains overlap.
+void log_unit(const uint32_t *words, float *out) {
+    float x[group_lanes], e[group_lanes], z[group_lanes], y[group_lanes];
+    for (size_t j = 0; j < group_lanes; j++) {
+        auto v = (float)((words[j] >> 8) + 1) * word_scale;
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        e[j] = (float)((int32_t)(bits >> 23) - 126);
+        bits = (bits & 0x007fffff) | 0x3f000000;
+        float m;
+        std::memcpy(&m, &bits, sizeof(m));
+        // m in [0.5, 1), folded onto [sqrt(0.5) - 1, sqrt(2) - 1); adding
+        // zero instead of branching keeps random lanes off the predictor
+        const auto small = m < sqrt_half;
+        e[j] = e[j] - (small ? 1.f : 0.f);
+        x[j] = m - 1.f;
+        x[j] = x[j] + (small ? m : 0.f);
+        z[j] = x[j] * x[j];
+        y[j] = log_p[0];
+    }
+    for (size_t i = 1; i < std::size(log_p); i++)
+        for (size_t j = 0; j < group_lanes; j++)
+            y[j] = std::fma(y[j], x[j], log_p[i]);
+    for (size_t j = 0; j < group_lanes; j++) {
+        y[j] = y[j] * x[j];
+        y[j] = y[j] * z[j];
+        y[j] = std::fma(e[j], log_q1, y[j]);
+    }
+    for (size_t j = 0; j < group_lanes; j++)
+        y[j] = std::fma(-0.5f, z[j], y[j]);
+    for (size_t j = 0; j < group_lanes; j++)
+        out[j] = std::fma(e[j], log_q2, x[j] + y[j]);
+}
+
+// sin and cos of 2 * pi * to_unit(word), for each lane
+void sincos_turn(const uint32_t *words, float *sin_v, float *cos_v) {
+    uint32_t q[group_lanes];
+    float a[group_lanes], z[group_lanes], ps[group_lanes], pc[group_lanes];
+    for (size_t j = 0; j < group_lanes; j++) {
+        // split the angle into quarter turns q and a remainder in
+        // [-1/8, 1/8] turn, all in integers so the reduction is exact
+        const auto k = words[j] >> 8;
+        q[j] = (k + (1u << 21)) >> 22;
+        a[j] = (float)((int32_t)k - (int32_t)(q[j] << 22)) *
+               quarter_turn_scale * half_pi;
+        z[j] = a[j] * a[j];
+        ps[j] = std::fma(sin_p[0], z[j], sin_p[1]);
+        pc[j] = std::fma(cos_p[0], z[j], cos_p[1]);
+    }
+    for (size_t j = 0; j < group_lanes; j++) {
+        ps[j] = std::fma(ps[j], z[j], sin_p[2]);
+        pc[j] = std::fma(pc[j], z[j], cos_p[2]);
+    }
+    for (size_t j = 0; j < group_lanes; j++) {
+        const auto s = std::fma(ps[j] * z[j], a[j], a[j]);
+        const auto c =
+            std::fma(pc[j] * z[j], z[j], std::fma(-0.5f, z[j], 1.f));
+        uint32_t s_bits, c_bits;
+        std::memcpy(&s_bits, &s, sizeof(s_bits));
+        std::memcpy(&c_bits, &c, sizeof(c_bits));
+        // odd quarter turns swap sin and cos; bit 1 of q (of q + 1 for
+        // cos), moved to the sign bit, negates them
+        const auto swap = 0u - (q[j] & 1);
+        auto sin_bits = (s_bits & ~swap) | (c_bits & swap);
+        auto cos_bits = (c_bits & ~swap) | (s_bits & swap);
+        sin_bits ^= (q[j] & 2) << 30;
+        cos_bits ^= ((q[j] + 1) & 2) << 30;
+        std::memcpy(&sin_v[j], &sin_bits, sizeof(sin_bits));
+        std::memcpy(&cos_v[j], &cos_bits, sizeof(cos_bits));
+    }
+}
+
+struct uniform_dist {
+    float low, range;
+
+    void operator()(const uint32_t (&words)[4][group_lanes],
+                    float *out) const {
+        for (size_t k = 0; k < 4; k++)
+            for (size_t j = 0; j < group_lanes; j++)
+                out[k * group_lanes + j] =
+                    std::fma(range, to_unit(words[k][j]), low);
+    }
+};
+
+// Box-Muller over the word pairs (0, 1) and (2, 3)
+struct normal_dist {
+    float mean, std;
+
+    void operator()(const uint32_t (&words)[4][group_lanes],
+                    float *out) const {
+        for (size_t k = 0; k < 4; k += 2) {
+            float r[group_lanes], s[group_lanes], c[group_lanes];
+            log_unit(words[k], r);
+            for (size_t j = 0; j < group_lanes; j++)
+                r[j] = std::sqrt(-2.f * r[j]);
+            sincos_turn(words[k + 1], s, c);
+            for (size_t j = 0; j < group_lanes; j++) {
+                out[k * group_lanes + j] = std::fma(std, r[j] * c[j], mean);
+                out[(k + 1) * group_lanes + j] =
+                    std::fma(std, r[j] * s[j], mean);
+            }
+        }
+    }
+};
+
+#if __AVX2__
+// Low and high halves of the 32x32 products of every lane with m.
+void mulhilo8(__m256i a, uint32_t m, __m256i &lo, __m256i &hi) {
+    const auto mv = _mm256_set1_epi32((int32_t)m);
+    const auto even = _mm256_mul_epu32(a, mv);
+    const auto odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), mv);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Eight Philox blocks for counters base .. base + 7, word-major.
+void philox4x32x8(uint64_t base, philox_key key, __m256i words[4]) {
+    auto c0 = _mm256_add_epi32(_mm256_set1_epi32((int32_t)(uint32_t)base),
+                               _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    auto c1 = _mm256_set1_epi32((int32_t)(uint32_t)(base >> 32));
+    auto c2 = _mm256_setzero_si256(), c3 = _mm256_setzero_si256();
+    for (size_t r = 0; r < philox_rounds; r++) {
+        __m256i lo0, hi0, lo1, hi1;
+        mulhilo8(c0, philox_m0, lo0, hi0);
+        mulhilo8(c2, philox_m1, lo1, hi1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1),
+                              _mm256_set1_epi32((int32_t)key.k0));
+        c1 = lo1;
+        c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3),
+                              _mm256_set1_epi32((int32_t)key.k1));
+        c3 = lo0;
+        key.k0 += philox_w0;
+        key.k1 += philox_w1;
+    }
+    words[0] = c0;
+    words[1] = c1;
+    words[2] = c2;
+    words[3] = c3;
+}
+
+__m256 to_unit(__m256i words) {
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(words, 8)),
+                         _mm256_set1_ps(word_scale));
+}
+
+__m256 log_unit(__m256i words) {
+    auto x = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(
+                               _mm256_srli_epi32(words, 8),
+                               _mm256_set1_epi32(1))),
+                           _mm256_set1_ps(word_scale));
+    auto bits = _mm256_castps_si256(x);
+    auto e = _mm256_cvtepi32_ps(
+        _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    bits = _mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+        _mm256_set1_epi32(0x3f000000));
+    const auto m = _mm256_castsi256_ps(bits);
+    const auto small =
+        _mm256_cmp_ps(m, _mm256_set1_ps(sqrt_half), _CMP_LT_OQ);
+    e = _mm256_blendv_ps(e, _mm256_sub_ps(e, _mm256_set1_ps(1.f)), small);
+    x = _mm256_sub_ps(m, _mm256_set1_ps(1.f));
+    x = _mm256_blendv_ps(x, _mm256_add_ps(x, m), small);
+
+    const auto z = _mm256_mul_ps(x, x);
+    auto y = _mm256_set1_ps(log_p[0]);
+    for (size_t i = 1; i < std::size(log_p); i++)
+        y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(log_p[i]));
+    y = _mm256_mul_ps(y, x);
+    y = _mm256_mul_ps(y, z);
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(log_q1), y);
+    y = _mm256_fmadd_ps(_mm256_set1_ps(-0.5f), z, y);
+    x = _mm256_add_ps(x, y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(log_q2), x);
+}
+
+void sincos_turn(__m256i words, __m256 &sin_v, __m256 &cos_v) {
+    const auto k = _mm256_srli_epi32(words, 8);
+    const auto q = _mm256_srli_epi32(
+        _mm256_add_epi32(k, _mm256_set1_epi32(1 << 21)), 22);
+    const auto a = _mm256_mul_ps(
+        _mm256_mul_ps(
+            _mm256_cvtepi32_ps(_mm256_sub_epi32(k, _mm256_slli_epi32(q, 22))),
+            _mm256_set1_ps(quarter_turn_scale)),
+        _mm256_set1_ps(half_pi));
+
+    const auto z = _mm256_mul_ps(a, a);
+    auto ps = _mm256_fmadd_ps(_mm256_set1_ps(sin_p[0]), z,
+                              _mm256_set1_ps(sin_p[1]));
+    ps = _mm256_fmadd_ps(ps, z, _mm256_set1_ps(sin_p[2]));
+    const auto s = _mm256_fmadd_ps(_mm256_mul_ps(ps, z), a, a);
+    auto pc = _mm256_fmadd_ps(_mm256_set1_ps(cos_p[0]), z,
+                              _mm256_set1_ps(cos_p[1]));
+    pc = _mm256_fmadd_ps(pc, z, _mm256_set1_ps(cos_p[2]));
+    const auto c = _mm256_fmadd_ps(
+        _mm256_mul_ps(pc, z), z,
+        _mm256_fmadd_ps(_mm256_set1_ps(-0.5f), z, _mm256_set1_ps(1.f)));
+
+    const auto one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+    const auto swap = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+    // same swap and negation as the scalar version
+    const auto sin_sign = _mm256_castsi256_ps(
+        _mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+    const auto cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+    sin_v = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sin_sign);
+    cos_v = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cos_sign);
+}
+
+void store_group(const uniform_dist &dist, const __m256i words[4],
+                 float *out) {
+    const auto low = _mm256_set1_ps(dist.low);
+    const auto range = _mm256_set1_ps(dist.range);
+    for (size_t k = 0; k < 4; k++)
+        _mm256_storeu_ps(out + k * group_lanes,
+                         _mm256_fmadd_ps(range, to_unit(words[k]), low));
+}
+
+void store_group(const normal_dist &dist, const __m256i words[4],
+                 float *out) {
+    const auto mean = _mm256_set1_ps(dist.mean);
+    const auto std = _mm256_set1_ps(dist.std);
+    for (size_t k = 0; k < 4; k += 2) {
+        const auto r = _mm256_sqrt_ps(
+            _mm256_mul_ps(_mm256_set1_ps(-2.f), log_unit(words[k])));
+        __m256 s, c;
+        sincos_turn(words[k + 1], s, c);
+        _mm256_storeu_ps(out + k * group_lanes,
+                         _mm256_fmadd_ps(std, _mm256_mul_ps(r, c), mean));
+        _mm256_storeu_ps(out + (k + 1) * group_lanes,
+                         _mm256_fmadd_ps(std, _mm256_mul_ps(r, s), mean));
+    }
+}
+#endif
+
+template <class Dist>
+void fill_group(uint64_t group, philox_key key, const Dist &dist,
+                float *out) {
+    const auto base = group * group_lanes;
+#if __AVX2__
+    __m256i words[4];
+    philox4x32x8(base, key, words);
+    store_group(dist, words, out);
+#else
+    uint32_t words[4][group_lanes];
+    for (size_t j = 0; j < group_lanes; j++) {
+        uint32_t block[4];
+        philox4x32(base + j, key, block);
+        for (size_t k = 0; k < 4; k++)
+            words[k][j] = block[k];
+    }
+    dist(words, out);
+#endif
+}
+
+template <class Dist>
+void generate(float *output, size_t count, float seed, const Dist &dist,
+              kernel_context &context) {
+    const auto key = make_key(seed);
+    const auto groups = count / group_size;
+    NNCASE_UNUSED const auto threads =
+        count < parallel_threshold ? 1 : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t g = 0; g < (int64_t)groups; g++)
+        fill_group(g, key, dist, output + g * group_size);
+
+    if (auto tail = count % group_size) {
+        float last[group_size];
+        fill_group(groups, key, dist, last);
+        std::memcpy(output + groups * group_size, last, tail * sizeof(float));
+    }
+}
+} // namespace
+
+result<void> optimized::random_normal(typecode_t type, gsl::byte *output,
+                                      gsl::span<const size_t> out_shape,
+                                      float mean, float std, float seed,
+                                      kernel_context &context) noexcept {
+    if (type != dt_float32)
+        return err(nncase_errc::datatype_mismatch);
+    generate(OUT_CAST(float, output), compute_size(out_shape), seed,
+             normal_dist{mean, std}, context);
+    return ok();
+}
+
+result<void> optimized::random_uniform(typecode_t type, gsl::byte *output,
+                                       gsl::span<const size_t> out_shape,
+                                       float low, float high, float seed,
+                                       kernel_context &context) noexcept {
+    if (type != dt_float32)
+        return err(nncase_errc::datatype_mismatch);
+    generate(OUT_CAST(float, output), compute_size(out_shape), seed,
+             uniform_dist{low, high - low}, context);
+    return ok();
+}
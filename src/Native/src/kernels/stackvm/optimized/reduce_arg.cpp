@@ -0,0 +1,269 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../reference/ref_ops.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <type_traits>
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Output columns handled by one task when the reduced axis is not innermost.
+constexpr size_t reduce_arg_column_block = 64;
+
+// Ties are exact: the first index wins unless Last, in which case an equal
+// value moves the result to the later index. NaN never wins.
+template <bool Max, bool Last, class T> inline bool better(T a, T b) {
+    if constexpr (Max)
+        return Last ? a >= b : a > b;
+    else
+        return Last ? a <= b : a < b;
+}
+
+#if __AVX2__
+template <bool Max, bool Last>
+constexpr int better_cmp =
+    Max ? (Last ? _CMP_GE_OQ : _CMP_GT_OQ) : (Last ? _CMP_LE_OQ : _CMP_LT_OQ);
+
+// Lane l keeps the best of in_[0] and in_[1 + 8j + l]. Each lane sees its
+// elements in order, so the lanes merge by value and then by index, and the
+// tail past the last full vector follows in order.
+template <bool Max, bool Last>
+size_t reduce_arg_row_avx2(const float *in_, size_t axis_size) {
+    __m256 best = _mm256_set1_ps(in_[0]);
+    __m256i best_idx = _mm256_setzero_si256();
+    __m256i idx = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8);
+    const __m256i step = _mm256_set1_epi32(8);
+    size_t k = 1;
+    for (; k + 8 <= axis_size; k += 8) {
+        const __m256 v = _mm256_loadu_ps(in_ + k);
+        const __m256 mask = _mm256_cmp_ps(v, best, better_cmp<Max, Last>);
+        best = _mm256_blendv_ps(best, v, mask);
+        best_idx = _mm256_castps_si256(
+            _mm256_blendv_ps(_mm256_castsi256_ps(best_idx),
+                             _mm256_castsi256_ps(idx), mask));
+        idx = _mm256_add_epi32(idx, step);
+    }
+
+    float lane_best[8];
+    int32_t lane_idx[8];
+    _mm256_storeu_ps(lane_best, best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lane_idx), best_idx);
+    float result = lane_best[0];
+    size_t result_idx = (size_t)lane_idx[0];
+    for (size_t l = 1; l < 8; l++) {
+        const auto i = (size_t)lane_idx[l];
+        if (better<Max, false>(lane_best[l], result) ||
+            (lane_best[l] == result && (Last ? i > result_idx
+                                             : i < result_idx))) {
+            result = lane_best[l];
+            result_idx = i;
+        }
+    }
+    for (; k < axis_size; k++) {
+        if (better<Max, Last>(in_[k], result)) {
+            result = in_[k];
+            result_idx = k;
+        }
+    }
+    return result_idx;
+}
+
+// Scans 8 columns at a time; returns the number of columns written.
+template <bool Max, bool Last, class TOutput>
+size_t reduce_arg_columns_avx2(const float *in_, TOutput *out_, size_t n,
+                               size_t axis_size, size_t inner_size) {
+    size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m256 best = _mm256_loadu_ps(in_ + c);
+        __m256i best_idx = _mm256_setzero_si256();
+        for (size_t k = 1; k < axis_size; k++) {
+            const __m256 v = _mm256_loadu_ps(in_ + k * inner_size + c);
+            const __m256 mask = _mm256_cmp_ps(v, best, better_cmp<Max, Last>);
+            best = _mm256_blendv_ps(best, v, mask);
+            best_idx = _mm256_castps_si256(_mm256_blendv_ps(
+                _mm256_castsi256_ps(best_idx),
+                _mm256_castsi256_ps(_mm256_set1_epi32((int32_t)k)), mask));
+        }
+        if constexpr (std::is_same_v<TOutput, int32_t>) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_ + c),
+                                best_idx);
+        } else {
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out_ + c),
+                _mm256_cvtepi32_epi64(_mm256_castsi256_si128(best_idx)));
+            _mm256_storeu_si256(
+                reinterpret_cast<__m256i *>(out_ + c + 4),
+                _mm256_cvtepi32_epi64(_mm256_extracti128_si256(best_idx, 1)));
+        }
+    }
+    return c;
+}
+#endif
+
+template <bool Max, bool Last, class T, class TOutput>
+void reduce_arg_impl(const T *input, TOutput *output, size_t outer_size,
+                     size_t axis_size, size_t inner_size,
+                     NNCASE_UNUSED kernel_context &context) {
+    // the vector paths keep indices in int32 lanes
+    NNCASE_UNUSED const auto vectorize =
+        std::is_same_v<T, float> &&
+        axis_size <= (size_t)std::numeric_limits<int32_t>::max();
+    if (inner_size == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t i = 0; i < (int64_t)outer_size; i++) {
+            auto in_ = input + i * axis_size;
+#if __AVX2__
+            if constexpr (std::is_same_v<T, float>) {
+                if (vectorize) {
+                    output[i] =
+                        (TOutput)reduce_arg_row_avx2<Max, Last>(in_, axis_size);
+                    continue;
+                }
+            }
+#endif
+            T best = in_[0];
+            size_t best_idx = 0;
+            for (size_t k = 1; k < axis_size; k++) {
+                if (better<Max, Last>(in_[k], best)) {
+                    best = in_[k];
+                    best_idx = k;
+                }
+            }
+            output[i] = (TOutput)best_idx;
+        }
+        return;
+    }
+
+    const auto blocks =
+        (inner_size + reduce_arg_column_block - 1) / reduce_arg_column_block;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+        const auto i = (size_t)t / blocks;
+        const auto j = ((size_t)t % blocks) * reduce_arg_column_block;
+        const auto n = std::min(reduce_arg_column_block, inner_size - j);
+        auto in_ = input + i * axis_size * inner_size + j;
+        auto out_ = output + i * inner_size + j;
+
+        size_t c0 = 0;
+#if __AVX2__
+        if constexpr (std::is_same_v<T, float>) {
+            if (vectorize)
+                c0 = reduce_arg_columns_avx2<Max, Last>(in_, out_, n,
+                                                        axis_size, inner_size);
+        }
+#endif
+
+        // scan row by row so that every load is contiguous
+        T best[reduce_arg_column_block];
+        TOutput best_idx[reduce_arg_column_block];
+        std::copy(in_ + c0, in_ + n, best + c0);
+        std::fill(best_idx + c0, best_idx + n, (TOutput)0);
+        for (size_t k = 1; k < axis_size; k++) {
+            auto in_k = in_ + k * inner_size;
+            for (size_t c = c0; c < n; c++) {
+                if (better<Max, Last>(in_k[c], best[c])) {
+                    best[c] = in_k[c];
+                    best_idx[c] = (TOutput)k;
+                }
+            }
+        }
+        std::copy(best_idx + c0, best_idx + n, out_ + c0);
+    }
+}
+
+template <class T, class TOutput>
+void reduce_arg_impl(reduce_arg_op_t op, bool select_last_idx, const T *input,
+                     TOutput *output, size_t outer_size, size_t axis_size,
+                     size_t inner_size, kernel_context &context) {
+    if (op == reduce_arg_op_t::arg_max) {
+        if (select_last_idx)
+            reduce_arg_impl<true, true>(input, output, outer_size, axis_size,
+                                        inner_size, context);
+        else
+            reduce_arg_impl<true, false>(input, output, outer_size, axis_size,
+                                         inner_size, context);
+    } else {
+        if (select_last_idx)
+            reduce_arg_impl<false, true>(input, output, outer_size, axis_size,
+                                         inner_size, context);
+        else
+            reduce_arg_impl<false, false>(input, output, outer_size,
+                                          axis_size, inner_size, context);
+    }
+}
+} // namespace
+
+#define REDUCE_ARG_IMPL(_ty)                                                   \
+    {                                                                          \
+        if (output_typecode == dt_int32)                                       \
+            reduce_arg_impl(op, select_last_idx, IN_CAST(_ty, input),          \
+                            OUT_CAST(int32_t, output), outer_size, axis_size,  \
+                            inner_size, context);                              \
+        else                                                                   \
+            reduce_arg_impl(op, select_last_idx, IN_CAST(_ty, input),          \
+                            OUT_CAST(int64_t, output), outer_size, axis_size,  \
+                            inner_size, context);                              \
+        return ok();                                                           \
+    }
+
+result<void> optimized::reduce_arg(
+    typecode_t input_typecode, typecode_t output_typecode, reduce_arg_op_t op,
+    const gsl::byte *input, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    gsl::span<const size_t> axes, bool keep_dims, bool select_last_idx,
+    kernel_context &context) noexcept {
+    const auto axis = axes.size() == 1 ? axes[0] : in_shape.size();
+    if (axis < in_shape.size() &&
+        (op == reduce_arg_op_t::arg_max || op == reduce_arg_op_t::arg_min) &&
+        (output_typecode == dt_int32 || output_typecode == dt_int64) &&
+        is_contiguous(
+            kernels::detail::get_reduced_shape(in_shape, axes, keep_dims),
+            out_strides)) {
+        const auto axis_size = in_shape[axis];
+        size_t outer_size = 1;
+        for (size_t i = 0; i < axis; i++)
+            outer_size *= in_shape[i];
+        size_t inner_size = 1;
+        for (size_t i = axis + 1; i < in_shape.size(); i++)
+            inner_size *= in_shape[i];
+
+        if (axis_size != 0) {
+            if (outer_size == 0 || inner_size == 0)
+                return ok();
+            TYPE_SELECT(input_typecode, REDUCE_ARG_IMPL);
+        }
+    }
+
+    return stackvm::reference::reduce_arg(
+        input_typecode, output_typecode, op, input, output, in_shape,
+        in_strides, out_strides, axes, keep_dims, select_last_idx, context);
+}
@@ -0,0 +1,347 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+struct window_op_max {
+    static float scalar(float a, float b) noexcept { return std::max(a, b); }
+#if __AVX__
+    static __m256 vector(__m256 a, __m256 b) noexcept {
+        return _mm256_max_ps(a, b);
+    }
+#endif
+};
+
+struct window_op_min {
+    static float scalar(float a, float b) noexcept { return std::min(a, b); }
+#if __AVX__
+    static __m256 vector(__m256 a, __m256 b) noexcept {
+        return _mm256_min_ps(a, b);
+    }
+#endif
+};
+
+struct window_op_sum {
+    static float scalar(float a, float b) noexcept { return a + b; }
+#if __AVX__
+    static __m256 vector(__m256 a, __m256 b) noexcept {
+        return _mm256_add_ps(a, b);
+    }
+#endif
+};
+
+struct window_shape {
+    size_t in_h, in_w, out_h, out_w;
+    padding padding_h, padding_w;
+    int32_t filter_h, filter_w, stride_h, stride_w, dilation_h, dilation_w;
+};
+
+// Filter taps [begin, end) that land inside the input, computed the same
+// way as the reference so empty and partial windows agree.
+void valid_taps(int32_t origin, int32_t filter, int32_t dilation, size_t size,
+                int32_t &begin, int32_t &end) noexcept {
+    begin = std::max(0, (-origin + dilation - 1) / dilation);
+    end = std::min(filter, ((int32_t)size - origin + dilation - 1) / dilation);
+    end = std::max(begin, end);
+}
+
+/**
+ * Pools one plane with separable passes. The valid input rows of a window
+ * row are first reduced into `col`, then `col` is split into stride_w
+ * phases so that every filter column of every interior output is a unit
+ * stride load. Windows that touch the padding are computed one by one.
+ *
+ * Padded taps take part as zeros and the initial value is folded in once,
+ * which is what the reference does.
+ */
+template <class Op, bool Mean>
+void reduce_window2d_plane(const float *input, float init_value,
+                           float *output, const window_shape &ws,
+                           value_range<float> fused_activation,
+                           bool count_include_pad, size_t out_y_begin,
+                           size_t out_y_end) noexcept {
+    const auto in_w = ws.in_w;
+    const auto stride = (size_t)ws.stride_w;
+    const auto phase_len = (in_w + stride - 1) / stride;
+    const auto area = ws.filter_h * ws.filter_w;
+    std::vector<float> col(in_w);
+    std::vector<float> phases(stride > 1 ? stride * phase_len : 0);
+
+    // outputs whose window lies inside the row along x
+    const auto span_w = ws.dilation_w * (ws.filter_w - 1);
+    const auto first_x = ((int64_t)ws.padding_w.before + ws.stride_w - 1) /
+                         ws.stride_w;
+    const auto last_x = (int64_t)in_w - 1 - span_w + ws.padding_w.before;
+    const auto interior_begin = (size_t)std::min<int64_t>(first_x, ws.out_w);
+    const auto interior_end = std::max(
+        interior_begin,
+        last_x < 0 ? 0
+                   : (size_t)std::min<int64_t>(last_x / ws.stride_w + 1,
+                                               ws.out_w));
+
+    // phase and offset of each filter column for interior outputs
+    std::vector<const float *> taps(ws.filter_w);
+
+    auto finish = [&](float value, bool padded, int32_t count) {
+        value = Op::scalar(init_value, value);
+        if (padded)
+            value = Op::scalar(value, 0.f);
+        if constexpr (Mean)
+            value /= (float)(count_include_pad ? area : count);
+        return kernels::detail::apply_activation(value, fused_activation);
+    };
+    // no tap inside the input, the window only sees padding
+    auto finish_empty = [&]() {
+        auto value = Op::scalar(init_value, 0.f);
+        if constexpr (Mean)
+            value /= (float)(count_include_pad ? area : 0);
+        return kernels::detail::apply_activation(value, fused_activation);
+    };
+
+    for (size_t oy = out_y_begin; oy < out_y_end; oy++) {
+        auto out_row = output + oy * ws.out_w;
+        const int32_t in_y_origin =
+            (int32_t)oy * ws.stride_h - ws.padding_h.before;
+        int32_t ky_begin, ky_end;
+        valid_taps(in_y_origin, ws.filter_h, ws.dilation_h, ws.in_h,
+                   ky_begin, ky_end);
+        const auto rows = ky_end - ky_begin;
+        if (rows == 0) {
+            std::fill_n(out_row, ws.out_w, finish_empty());
+            continue;
+        }
+
+        // vertical pass
+        auto row_of = [&](int32_t ky) {
+            return input + (in_y_origin + ws.dilation_h * ky) * in_w;
+        };
+        const float *reduced = row_of(ky_begin);
+        if (rows > 1) {
+            std::memcpy(col.data(), reduced, sizeof(float) * in_w);
+            for (int32_t ky = ky_begin + 1; ky < ky_end; ky++) {
+                auto src = row_of(ky);
+                size_t x = 0;
+#if __AVX__
+                for (; x + 8 <= in_w; x += 8)
+                    _mm256_storeu_ps(
+                        col.data() + x,
+                        Op::vector(_mm256_loadu_ps(col.data() + x),
+                                   _mm256_loadu_ps(src + x)));
+#endif
+                for (; x < in_w; x++)
+                    col[x] = Op::scalar(col[x], src[x]);
+            }
+            reduced = col.data();
+        }
+
+        // horizontal pass, first the windows that touch the padding
+        const bool padded_y = rows != ws.filter_h;
+        auto border = [&](size_t ox) {
+            const int32_t in_x_origin =
+                (int32_t)ox * ws.stride_w - ws.padding_w.before;
+            int32_t kx_begin, kx_end;
+            valid_taps(in_x_origin, ws.filter_w, ws.dilation_w, in_w,
+                       kx_begin, kx_end);
+            if (kx_begin == kx_end) {
+                out_row[ox] = finish_empty();
+                return;
+            }
+
+            auto value = reduced[in_x_origin + ws.dilation_w * kx_begin];
+            for (int32_t kx = kx_begin + 1; kx < kx_end; kx++)
+                value = Op::scalar(
+                    value, reduced[in_x_origin + ws.dilation_w * kx]);
+            const auto count = rows * (kx_end - kx_begin);
+            out_row[ox] = finish(value, count != area, count);
+        };
+        for (size_t ox = 0; ox < interior_begin; ox++)
+            border(ox);
+        for (size_t ox = interior_end; ox < ws.out_w; ox++)
+            border(ox);
+        if (interior_begin == interior_end)
+            continue;
+
+        // then the interior, reading every tap at unit stride
+        const float *phased = reduced;
+        if (stride > 1) {
+            for (size_t p = 0; p < stride; p++) {
+                auto dest = phases.data() + p * phase_len;
+                for (size_t x = p, j = 0; x < in_w; x += stride, j++)
+                    dest[j] = reduced[x];
+            }
+            phased = phases.data();
+        }
+        for (int32_t kx = 0; kx < ws.filter_w; kx++) {
+            const auto off =
+                (int64_t)ws.dilation_w * kx - ws.padding_w.before;
+            const auto p = ((off % ws.stride_w) + ws.stride_w) % ws.stride_w;
+            taps[kx] = phased + p * phase_len + (off - p) / ws.stride_w;
+        }
+
+        const auto count = rows * ws.filter_w;
+        size_t ox = interior_begin;
+#if __AVX__
+        const auto init = _mm256_set1_ps(init_value);
+        const auto zero = _mm256_setzero_ps();
+        const auto divisor =
+            _mm256_set1_ps((float)(count_include_pad ? area : count));
+        const auto lo = _mm256_set1_ps(fused_activation.min);
+        const auto hi = _mm256_set1_ps(fused_activation.max);
+        for (; ox + 8 <= interior_end; ox += 8) {
+            auto value = _mm256_loadu_ps(taps[0] + ox);
+            for (int32_t kx = 1; kx < ws.filter_w; kx++)
+                value = Op::vector(value, _mm256_loadu_ps(taps[kx] + ox));
+            value = Op::vector(init, value);
+            if (padded_y)
+                value = Op::vector(value, zero);
+            if constexpr (Mean)
+                value = _mm256_div_ps(value, divisor);
+            value = _mm256_min_ps(_mm256_max_ps(value, lo), hi);
+            _mm256_storeu_ps(out_row + ox, value);
+        }
+#endif
+        for (; ox < interior_end; ox++) {
+            auto value = taps[0][ox];
+            for (int32_t kx = 1; kx < ws.filter_w; kx++)
+                value = Op::scalar(value, taps[kx][ox]);
+            out_row[ox] = finish(value, padded_y, count);
+        }
+    }
+}
+
+template <class Op, bool Mean>
+void reduce_window2d_impl(const float *input, float init_value, float *output,
+                          gsl::span<const size_t> in_shape,
+                          const window_shape &ws,
+                          value_range<float> fused_activation,
+                          bool count_include_pad,
+                          NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto planes = in_shape[0] * in_shape[1];
+    // a single image with few channels is split along the output rows
+    size_t row_blocks = 1;
+    if (planes < (size_t)context.num_threads)
+        row_blocks = std::min(ws.out_h, ((size_t)context.num_threads +
+                                         planes - 1) /
+                                            planes);
+    row_blocks = std::max<size_t>(row_blocks, 1);
+    const auto rows_per_block = (ws.out_h + row_blocks - 1) / row_blocks;
+    const auto tasks = (int64_t)(planes * row_blocks);
+    const auto in_plane = ws.in_h * ws.in_w;
+    const auto out_plane = ws.out_h * ws.out_w;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t task = 0; task < tasks; task++) {
+        const auto plane = (size_t)task / row_blocks;
+        const auto begin = ((size_t)task % row_blocks) * rows_per_block;
+        const auto end = std::min(begin + rows_per_block, ws.out_h);
+        if (begin < end)
+            reduce_window2d_plane<Op, Mean>(
+                input + plane * in_plane, init_value,
+                output + plane * out_plane, ws, fused_activation,
+                count_include_pad, begin, end);
+    }
+}
+
+// Windows that cover the whole unpadded image are a reduction over h and w.
+result<void> global_reduce_window2d(reduce_op_t op, const float *input,
+                                    float init_value, float *output,
+                                    gsl::span<const size_t> in_shape,
+                                    value_range<float> fused_activation,
+                                    kernel_context &context) noexcept {
+    const dims_t axes{2, 3};
+    const dims_t out_shape{in_shape[0], in_shape[1], 1, 1};
+    try_(optimized::reduce(dt_float32, op,
+                           reinterpret_cast<const gsl::byte *>(&init_value),
+                           reinterpret_cast<const gsl::byte *>(input),
+                           reinterpret_cast<gsl::byte *>(output), in_shape,
+                           axes, get_default_strides(in_shape),
+                           get_default_strides(out_shape), true, context));
+    const auto size = in_shape[0] * in_shape[1];
+    for (size_t i = 0; i < size; i++)
+        output[i] =
+            kernels::detail::apply_activation(output[i], fused_activation);
+    return ok();
+}
+} // namespace
+
+result<void> optimized::reduce_window2d(
+    reduce_op_t op, const float *input, float init_value, float *output,
+    gsl::span<const size_t> in_shape, const padding &padding_h,
+    const padding &padding_w, int32_t filter_h, int32_t filter_w,
+    int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    value_range<float> fused_activation, bool count_include_pad,
+    kernel_context &context) noexcept {
+    if (op != reduce_op_t::mean && op != reduce_op_t::sum &&
+        op != reduce_op_t::max && op != reduce_op_t::min)
+        return err(std::errc::not_supported);
+
+    if ((size_t)filter_h == in_shape[2] && (size_t)filter_w == in_shape[3] &&
+        padding_h.sum() == 0 && padding_w.sum() == 0 && dilation_h == 1 &&
+        dilation_w == 1)
+        return global_reduce_window2d(op, input, init_value, output, in_shape,
+                                      fused_activation, context);
+
+    const window_shape ws{
+        in_shape[2],
+        in_shape[3],
+        kernels::detail::get_windowed_output_size(in_shape[2], filter_h,
+                                                  stride_h, dilation_h,
+                                                  padding_h),
+        kernels::detail::get_windowed_output_size(in_shape[3], filter_w,
+                                                  stride_w, dilation_w,
+                                                  padding_w),
+        padding_h,
+        padding_w,
+        filter_h,
+        filter_w,
+        stride_h,
+        stride_w,
+        dilation_h,
+        dilation_w};
+
+#define REDUCE_WINDOW2D_IMPL(reduce_op, window_op, mean)                       \
+    case reduce_op:                                                            \
+        reduce_window2d_impl<window_op, mean>(input, init_value, output,       \
+                                              in_shape, ws, fused_activation,  \
+                                              count_include_pad, context);     \
+        return ok()
+
+    switch (op) {
+        REDUCE_WINDOW2D_IMPL(reduce_op_t::mean, window_op_sum, true);
+        REDUCE_WINDOW2D_IMPL(reduce_op_t::sum, window_op_sum, false);
+        REDUCE_WINDOW2D_IMPL(reduce_op_t::max, window_op_max, false);
+        REDUCE_WINDOW2D_IMPL(reduce_op_t::min, window_op_min, false);
+    default:
+        return err(std::errc::not_supported);
+    }
+#undef REDUCE_WINDOW2D_IMPL
+}
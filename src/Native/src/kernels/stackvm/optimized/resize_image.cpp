@@ -13,7 +13,15 @@
  * limitations under the License.
  */
 #include "opt_ops.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <nncase/kernels/kernel_utils.h>
+#include <type_traits>
+#include <vector>
+#if __AVX__
+#include <immintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -22,64 +30,258 @@ using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
 namespace {
+// Source index pair and interpolation weight for one output row or column,
+// computed once per call instead of once per output pixel.
+struct bilinear_axis {
+    std::vector<int32_t> i0;
+    std::vector<int32_t> i1;
+    std::vector<float> w1;
+    std::vector<float> w0;
+
+    bilinear_axis(int32_t out_size, float scale, bool half_pixel_centers,
+                  size_t in_size)
+        : i0(out_size), i1(out_size), w1(out_size), w0(out_size) {
+        for (int32_t o = 0; o < out_size; o++) {
+            float in;
+            kernels::detail::set_resize_bilinear(o, scale, half_pixel_centers,
+                                                 in_size, in, i0[o], i1[o]);
+            w1[o] = in - i0[o];
+            w0[o] = 1 - w1[o];
+        }
+    }
+};
 
-template <class T>
-result<void> resize_bilinear_impl(
-    const T *input, T *output, gsl::span<const size_t> in_shape,
-    NNCASE_UNUSED gsl::span<const size_t> in_strides,
-    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
-    int32_t out_w, bool align_corners, NNCASE_UNUSED bool half_pixel_centers,
-    NNCASE_UNUSED kernel_context &context) noexcept {
-    auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
-                                                     align_corners);
-    auto height_scale = scales.first;
-    auto width_scale = scales.second;
-    const float rounding_offset =
-        std::numeric_limits<T>::is_integer ? .5f : .0f;
-    dims_t in_index(4), out_index(4);
-
-    const auto in_img_size = in_shape[2] * in_shape[3];
-    const auto out_img_size = out_w * out_h;
+// Weights of the u8 path are fixed point with this many fraction bits.
+constexpr int32_t resize_coef_bits = 11;
+constexpr int32_t resize_coef_one = 1 << resize_coef_bits;
 
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto in_batch = input + (size_t)batch * in_shape[1] * in_img_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_w * out_h;
+/**
+ * Splits batch * channels planes of out_h rows into tasks. Each task gets
+ * whole planes when there are enough of them to keep every thread busy,
+ * otherwise the rows of a plane are split too.
+ */
+template <class TBody>
+void for_each_row_block(size_t planes, int32_t out_h,
+                        NNCASE_UNUSED kernel_context &context, TBody &&body) {
+    size_t row_blocks = 1;
+    if (planes < (size_t)context.num_threads)
+        row_blocks = std::min((size_t)out_h,
+                              ((size_t)context.num_threads + planes - 1) /
+                                  planes);
+    const auto rows_per_block = ((size_t)out_h + row_blocks - 1) / row_blocks;
+    const auto tasks = (int64_t)(planes * row_blocks);
 #ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
+#pragma omp parallel for num_threads(context.num_threads)
 #endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto in_c = in_batch + (size_t)oc * in_img_size;
-            auto *output_ptr = begin_output_ptr + oc * out_img_size;
-            for (int oy = 0; oy < out_h; oy++) {
-                float in_y;
-                int32_t in_y0, in_y1;
-                kernels::detail::set_resize_bilinear(
-                    oy, height_scale, half_pixel_centers, in_shape[2], in_y,
-                    in_y0, in_y1);
+    for (int64_t task = 0; task < tasks; task++) {
+        const auto plane = (size_t)task / row_blocks;
+        const auto begin = ((size_t)task % row_blocks) * rows_per_block;
+        const auto end = std::min(begin + rows_per_block, (size_t)out_h);
+        if (begin < end)
+            body(plane, (int32_t)begin, (int32_t)end);
+    }
+}
 
-                for (int ox = 0; ox < out_w; ox++) {
-                    float in_x;
-                    int32_t in_x0, in_x1;
-                    kernels::detail::set_resize_bilinear(
-                        ox, width_scale, half_pixel_centers, in_shape[3], in_x,
-                        in_x0, in_x1);
+// Interpolates one input row along x into a row of out_w floats.
+void resize_row_f32(const float *in_row, float *out_row,
+                    const bilinear_axis &xs, int32_t out_w) {
+    int32_t ox = 0;
+#if __AVX2__
+    for (; ox + 8 <= out_w; ox += 8) {
+        const auto v0 = _mm256_i32gather_ps(
+            in_row,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&xs.i0[ox])),
+            4);
+        const auto v1 = _mm256_i32gather_ps(
+            in_row,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&xs.i1[ox])),
+            4);
+        const auto r = _mm256_add_ps(
+            _mm256_mul_ps(v0, _mm256_loadu_ps(&xs.w0[ox])),
+            _mm256_mul_ps(v1, _mm256_loadu_ps(&xs.w1[ox])));
+        _mm256_storeu_ps(out_row + ox, r);
+    }
+#endif
+    for (; ox < out_w; ox++)
+        out_row[ox] = in_row[xs.i0[ox]] * xs.w0[ox] +
+                      in_row[xs.i1[ox]] * xs.w1[ox];
+}
 
-                    auto v0 = in_c[in_y0 * in_shape[3] + in_x0];
-                    auto v1 = in_c[in_y1 * in_shape[3] + in_x0];
-                    auto v2 = in_c[in_y0 * in_shape[3] + in_x1];
-                    auto v3 = in_c[in_y1 * in_shape[3] + in_x1];
+// Blends two x-interpolated rows along y.
+void blend_rows_f32(const float *r0, const float *r1, float *out_row,
+                    float w0, float w1, int32_t out_w) {
+    int32_t ox = 0;
+#if __AVX__
+    const auto vw0 = _mm256_set1_ps(w0);
+    const auto vw1 = _mm256_set1_ps(w1);
+    for (; ox + 8 <= out_w; ox += 8) {
+        const auto r =
+            _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(r0 + ox), vw0),
+                          _mm256_mul_ps(_mm256_loadu_ps(r1 + ox), vw1));
+        _mm256_storeu_ps(out_row + ox, r);
+    }
+#endif
+    for (; ox < out_w; ox++)
+        out_row[ox] = r0[ox] * w0 + r1[ox] * w1;
+}
 
-                    auto a0 = (1 - (in_y - in_y0)) * (1 - (in_x - in_x0));
-                    auto a1 = (in_y - in_y0) * (1 - (in_x - in_x0));
-                    auto a2 = (1 - (in_y - in_y0)) * (in_x - in_x0);
-                    auto a3 = (in_y - in_y0) * (in_x - in_x0);
+void resize_row_u8(const uint8_t *in_row, int32_t *out_row,
+                   const std::vector<int32_t> &x0,
+                   const std::vector<int32_t> &x1,
+                   const std::vector<int32_t> &wx, int32_t out_w) {
+    for (int32_t ox = 0; ox < out_w; ox++)
+        out_row[ox] = in_row[x0[ox]] * (resize_coef_one - wx[ox]) +
+                      in_row[x1[ox]] * wx[ox];
+}
 
-                    *output_ptr++ = T(v0 * a0 + v1 * a1 + v2 * a2 + v3 * a3 +
-                                      rounding_offset);
+// Blends two rows scaled by resize_coef_one, rounding half up like the
+// reference does for integer types.
+void blend_rows_u8(const int32_t *r0, const int32_t *r1, uint8_t *out_row,
+                   int32_t wy, int32_t out_w) {
+    constexpr int32_t shift = resize_coef_bits * 2;
+    constexpr int32_t round = 1 << (shift - 1);
+    const auto wy0 = resize_coef_one - wy;
+    int32_t ox = 0;
+#if __AVX2__
+    const auto vw0 = _mm256_set1_epi32(wy0);
+    const auto vw1 = _mm256_set1_epi32(wy);
+    const auto vround = _mm256_set1_epi32(round);
+    for (; ox + 8 <= out_w; ox += 8) {
+        const auto a =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r0 + ox));
+        const auto b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r1 + ox));
+        const auto sum = _mm256_add_epi32(
+            _mm256_add_epi32(_mm256_mullo_epi32(a, vw0),
+                             _mm256_mullo_epi32(b, vw1)),
+            vround);
+        const auto r = _mm256_srai_epi32(sum, shift);
+        const auto r16 = _mm_packus_epi32(_mm256_castsi256_si128(r),
+                                          _mm256_extracti128_si256(r, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out_row + ox),
+                         _mm_packus_epi16(r16, r16));
+    }
+#endif
+    for (; ox < out_w; ox++)
+        out_row[ox] =
+            (uint8_t)((r0[ox] * wy0 + r1[ox] * wy + round) >> shift);
+}
+
+/**
+ * Separable bilinear resize: input rows are interpolated along x into two
+ * cached rows, which are then blended along y. Consecutive output rows
+ * usually share source rows when upsampling, so each input row is
+ * interpolated along x about once per task.
+ */
+template <class TRow, class TIn, class TOut, class TResizeRow, class TBlend>
+void resize_bilinear_separable(const TIn *input, TOut *output,
+                               gsl::span<const size_t> in_shape,
+                               const bilinear_axis &ys, int32_t out_h,
+                               int32_t out_w, kernel_context &context,
+                               TResizeRow &&resize_row, TBlend &&blend) {
+    const auto in_img_size = in_shape[2] * in_shape[3];
+    const auto out_img_size = (size_t)out_h * out_w;
+    for_each_row_block(
+        in_shape[0] * in_shape[1], out_h, context,
+        [&](size_t plane, int32_t begin, int32_t end) {
+            auto in_c = input + plane * in_img_size;
+            auto out_c = output + plane * out_img_size;
+            std::vector<TRow> rows((size_t)out_w * 2);
+            TRow *r0 = rows.data(), *r1 = rows.data() + out_w;
+            int32_t y0 = -1, y1 = -1;
+            for (int32_t oy = begin; oy < end; oy++) {
+                const auto in_y0 = ys.i0[oy], in_y1 = ys.i1[oy];
+                if (y0 != in_y0) {
+                    if (y1 == in_y0) {
+                        std::swap(r0, r1);
+                        std::swap(y0, y1);
+                    } else {
+                        resize_row(in_c + in_y0 * in_shape[3], r0);
+                        y0 = in_y0;
+                    }
                 }
+                if (y1 != in_y1) {
+                    resize_row(in_c + in_y1 * in_shape[3], r1);
+                    y1 = in_y1;
+                }
+                blend(r0, r1, out_c + (size_t)oy * out_w, oy);
             }
-        }
+        });
+}
+
+template <class T>
+result<void> resize_bilinear_impl(
+    const T *input, T *output, gsl::span<const size_t> in_shape,
+    NNCASE_UNUSED gsl::span<const size_t> in_strides,
+    NNCASE_UNUSED gsl::span<const size_t> out_strides, int32_t out_h,
+    int32_t out_w, bool align_corners, NNCASE_UNUSED bool half_pixel_centers,
+    kernel_context &context) noexcept {
+    auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
+                                                     align_corners);
+    const bilinear_axis ys(out_h, scales.first, half_pixel_centers,
+                           in_shape[2]);
+    const bilinear_axis xs(out_w, scales.second, half_pixel_centers,
+                           in_shape[3]);
+
+    if constexpr (std::is_same_v<T, float>) {
+        resize_bilinear_separable<float>(
+            input, output, in_shape, ys, out_h, out_w, context,
+            [&](const float *in_row, float *out_row) {
+                resize_row_f32(in_row, out_row, xs, out_w);
+            },
+            [&](const float *r0, const float *r1, float *out_row,
+                int32_t oy) {
+                blend_rows_f32(r0, r1, out_row, ys.w0[oy], ys.w1[oy], out_w);
+            });
+    } else if constexpr (std::is_same_v<T, uint8_t>) {
+        // Weights are clamped to [0, 1]; they only fall outside when both
+        // source indices are equal, so the result is unchanged.
+        auto to_fixed = [](float w) {
+            return (int32_t)std::lround(std::clamp(w, 0.f, 1.f) *
+                                        resize_coef_one);
+        };
+        std::vector<int32_t> wx(out_w), wy(out_h);
+        std::transform(xs.w1.begin(), xs.w1.end(), wx.begin(), to_fixed);
+        std::transform(ys.w1.begin(), ys.w1.end(), wy.begin(), to_fixed);
+        resize_bilinear_separable<int32_t>(
+            input, output, in_shape, ys, out_h, out_w, context,
+            [&](const uint8_t *in_row, int32_t *out_row) {
+                resize_row_u8(in_row, out_row, xs.i0, xs.i1, wx, out_w);
+            },
+            [&](const int32_t *r0, const int32_t *r1, uint8_t *out_row,
+                int32_t oy) {
+                blend_rows_u8(r0, r1, out_row, wy[oy], out_w);
+            });
+    } else {
+        const float rounding_offset =
+            std::numeric_limits<T>::is_integer ? .5f : .0f;
+        const auto in_img_size = in_shape[2] * in_shape[3];
+        const auto out_img_size = (size_t)out_h * out_w;
+        for_each_row_block(
+            in_shape[0] * in_shape[1], out_h, context,
+            [&](size_t plane, int32_t begin, int32_t end) {
+                auto in_c = input + plane * in_img_size;
+                auto *output_ptr = output + plane * out_img_size +
+                                   (size_t)begin * out_w;
+                for (int32_t oy = begin; oy < end; oy++) {
+                    auto row0 = in_c + ys.i0[oy] * in_shape[3];
+                    auto row1 = in_c + ys.i1[oy] * in_shape[3];
+                    for (int32_t ox = 0; ox < out_w; ox++) {
+                        auto v0 = row0[xs.i0[ox]];
+                        auto v1 = row1[xs.i0[ox]];
+                        auto v2 = row0[xs.i1[ox]];
+                        auto v3 = row1[xs.i1[ox]];
+
+                        auto a0 = ys.w0[oy] * xs.w0[ox];
+                        auto a1 = ys.w1[oy] * xs.w0[ox];
+                        auto a2 = ys.w0[oy] * xs.w1[ox];
+                        auto a3 = ys.w1[oy] * xs.w1[ox];
+
+                        *output_ptr++ = T(v0 * a0 + v1 * a1 + v2 * a2 +
+                                          v3 * a3 + rounding_offset);
+                    }
+                }
+            });
     }
     return ok();
 }
@@ -93,48 +295,42 @@ result<void> resize_nearest_neighbor_impl(
     NNCASE_UNUSED bool half_pixel_centers,
     get_coordinate_func_t get_coordinate_func,
     get_nearest_pixel_func_t get_nearset_func,
-    NNCASE_UNUSED kernel_context &context) noexcept {
+    kernel_context &context) noexcept {
     auto scales = kernels::detail::get_resize_scales(in_shape, out_h, out_w,
                                                      align_corners);
-    auto height_scale = scales.first;
-    auto width_scale = scales.second;
+    auto nearest_index = [&](int32_t o, float scale, int32_t out_size,
+                             size_t in_size) {
+        auto i = get_nearset_func(
+            get_coordinate_func(o, scale, out_size, in_size, 0, 0));
+        return (size_t)std::clamp(i, (int64_t)0, (int64_t)in_size - 1);
+    };
+    std::vector<size_t> in_ys(out_h), in_xs(out_w);
+    for (int32_t oy = 0; oy < out_h; oy++)
+        in_ys[oy] = nearest_index(oy, scales.first, out_h, in_shape[2]);
+    for (int32_t ox = 0; ox < out_w; ox++)
+        in_xs[ox] = nearest_index(ox, scales.second, out_w, in_shape[3]);
 
     const auto in_image_size = in_shape[2] * in_shape[3];
-    const auto out_image_size = out_h * out_w;
-    for (size_t batch = 0; batch < in_shape[0]; batch++) {
-        auto *begin_input_ptr = input + batch * in_shape[1] * in_image_size;
-        auto *begin_output_ptr = output + batch * in_shape[1] * out_image_size;
-#ifdef NNCASE_OPENMP
-#pragma omp parallel for num_threads(                                          \
-    kernels::default_kernel_context().num_threads)
-#endif
-        for (int oc = 0; oc < in_shape[1]; oc++) {
-            auto *input_ptr = begin_input_ptr + oc * in_image_size;
-            auto *output_ptr = begin_output_ptr + oc * out_image_size;
-
-            for (int oy = 0; oy < out_h; oy++) {
-                auto iy = get_coordinate_func(oy, height_scale, out_h,
-                                              in_shape[2], 0, 0);
-                int64_t in_y = get_nearset_func(iy);
-                if (in_y < 0)
-                    in_y = 0;
-                if (in_y >= in_shape[2])
-                    in_y = in_shape[2] - 1;
-                auto *in_row = input_ptr + in_y * in_shape[3];
-
-                for (int ox = 0; ox < out_w; ox++) {
-                    auto ix = get_coordinate_func(ox, width_scale, out_w,
-                                                  in_shape[3], 0, 0);
-                    int64_t in_x = get_nearset_func(ix);
-                    if (in_x < 0)
-                        in_x = 0;
-                    if (in_x >= in_shape[3])
-                        in_x = in_shape[3] - 1;
-                    *output_ptr++ = in_row[in_x];
+    const auto out_image_size = (size_t)out_h * out_w;
+    for_each_row_block(
+        in_shape[0] * in_shape[1], out_h, context,
+        [&](size_t plane, int32_t begin, int32_t end) {
+            auto *input_ptr = input + plane * in_image_size;
+            auto *output_ptr = output + plane * out_image_size;
+            for (int32_t oy = begin; oy < end; oy++) {
+                auto *out_row = output_ptr + (size_t)oy * out_w;
+                // upsampled rows repeat the row above them
+                if (oy != begin && in_ys[oy] == in_ys[oy - 1]) {
+                    std::memcpy(out_row, out_row - out_w,
+                                sizeof(T) * out_w);
+                    continue;
                 }
+
+                auto *in_row = input_ptr + in_ys[oy] * in_shape[3];
+                for (int32_t ox = 0; ox < out_w; ox++)
+                    out_row[ox] = in_row[in_xs[ox]];
             }
-        }
-    }
+        });
     return ok();
 }
 
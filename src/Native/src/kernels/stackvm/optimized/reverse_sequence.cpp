@@ -0,0 +1,91 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Everything after the later of the batch and time axes is a contiguous
+ * block that moves as a unit, so each row of the leading dims is a single
+ * memcpy from its (possibly reversed) time step.
+ */
+void reverse_sequence_impl(const gsl::byte *input, gsl::byte *output,
+                           gsl::span<const size_t> in_shape,
+                           gsl::span<const size_t> sequence_lens,
+                           size_t batch_axis, size_t time_axis,
+                           size_t element_size, kernel_context &context) {
+    const auto last_axis = std::max(batch_axis, time_axis);
+    const auto rows = compute_size(in_shape.subspan(0, last_axis + 1));
+    const auto block_bytes =
+        compute_size(in_shape.subspan(last_axis + 1)) * element_size;
+    // strides of the batch and time axes, counted in rows
+    const auto row_strides = get_default_strides(
+        in_shape.subspan(0, last_axis + 1));
+    const auto batch_stride = row_strides[batch_axis];
+    const auto time_stride = row_strides[time_axis];
+    const auto batch = in_shape[batch_axis], steps = in_shape[time_axis];
+    NNCASE_UNUSED const auto threads =
+        rows * block_bytes < parallel_copy_threshold ? 1 : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t r = 0; r < (int64_t)rows; r++) {
+        const auto b = (size_t)r / batch_stride % batch;
+        const auto t = (size_t)r / time_stride % steps;
+        const auto length = std::min(sequence_lens[b], steps);
+        auto src = (size_t)r;
+        if (t < length)
+            src = src - t * time_stride + (length - 1 - t) * time_stride;
+        std::memcpy(output + r * block_bytes, input + src * block_bytes,
+                    block_bytes);
+    }
+}
+} // namespace
+
+result<void> optimized::reverse_sequence(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> sequence_lens,
+    int64_t batch_axis, int64_t time_axis, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, kernel_context &context) noexcept {
+    const auto rank = (int64_t)in_shape.size();
+    if (batch_axis < 0)
+        batch_axis += rank;
+    if (time_axis < 0)
+        time_axis += rank;
+    if (batch_axis < 0 || batch_axis >= rank || time_axis < 0 ||
+        time_axis >= rank || batch_axis == time_axis ||
+        sequence_lens.size() < in_shape[batch_axis] ||
+        !is_contiguous(in_shape, in_strides) ||
+        !is_contiguous(in_shape, out_strides))
+        return err(std::errc::not_supported);
+    if (compute_size(in_shape) == 0)
+        return ok();
+
+    reverse_sequence_impl(input, output, in_shape, sequence_lens, batch_axis,
+                          time_axis, runtime::get_bytes(dt), context);
+    return ok();
+}
@@ -157,13 +157,14 @@ result<void> layernorm_impl(const float *input, float *output,
 result<void> nncase::kernels::stackvm::optimized::layer_norm(
     [[maybe_unused]] typecode_t typecode, const gsl::byte *input,
     gsl::byte *output, const gsl::byte *scale, const gsl::byte *bias,
-    gsl::span<const size_t> in_shape, int32_t axis, float epsilon) {
+    gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+    bool use_mean, bool channel_first, NNCASE_UNUSED kernel_context &context) {
 #if __riscv_vector
-    return layernorm_impl(IN_CAST(float, input), OUT_CAST(float, output),
-                          IN_CAST(float, scale), IN_CAST(float, bias), in_shape,
-                          axis, epsilon);
-#else
-    return reference::layer_norm(typecode, input, output, scale, bias, in_shape,
-                                 axis, epsilon);
+    if (use_mean && !channel_first)
+        return layernorm_impl(IN_CAST(float, input), OUT_CAST(float, output),
+                              IN_CAST(float, scale), IN_CAST(float, bias),
+                              in_shape, axis, epsilon);
 #endif
+    return reference::layer_norm(typecode, input, output, scale, bias, in_shape,
+                                 axis, epsilon, use_mean, channel_first);
 }
@@ -182,7 +182,8 @@ optimized::log_softmax([[maybe_unused]] typecode_t typecode,
                        gsl::span<const size_t> in_shape,
                        [[maybe_unused]] gsl::span<const size_t> in_strides,
                        [[maybe_unused]] gsl::span<const size_t> out_strides,
-                       int32_t axis) noexcept {
+                       int32_t axis,
+                       NNCASE_UNUSED kernel_context &context) noexcept {
     result<void> ret_value = ok();
 #if __riscv_vector
     log_softmax_impl(IN_CAST(float, input), OUT_CAST(float, output), in_shape,
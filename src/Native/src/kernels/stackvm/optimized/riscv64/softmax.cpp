@@ -1013,12 +1013,12 @@ result<void> optimized_safe_softmax(const __float16_t *input,
 #define OUT_CAST(_ty, _name) reinterpret_cast<_ty *>(_name)
 
 // template <typename T>
-result<void> optimized::softmax([[maybe_unused]] typecode_t typecode,
-                                const gsl::byte *input, gsl::byte *output,
-                                gsl::span<const size_t> in_shape,
-                                gsl::span<const size_t> in_strides,
-                                gsl::span<const size_t> out_strides,
-                                int32_t axis, float beta) noexcept {
+result<void> optimized::softmax(
+    [[maybe_unused]] typecode_t typecode, const gsl::byte *input,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    int32_t axis, float beta,
+    NNCASE_UNUSED kernel_context &context) noexcept {
 #if __riscv_vector
     if (typecode == typecode_t::dt_float16) {
         return optimized_safe_softmax(IN_CAST(__float16_t, input),
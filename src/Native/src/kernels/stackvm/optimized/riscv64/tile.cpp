@@ -260,7 +260,7 @@ result<void> nncase::kernels::stackvm::optimized::tile(
     datatype_t dt, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    gsl::span<const size_t> repeats) {
+    gsl::span<const size_t> repeats, NNCASE_UNUSED kernel_context &context) {
     if (in_shape.size() > 4) {
         return tile_apply_impl(input, output, in_shape, out_shape, in_strides,
                                out_strides, repeats);
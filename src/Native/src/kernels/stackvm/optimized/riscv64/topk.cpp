@@ -322,6 +322,7 @@ result<void> kernels::stackvm::optimized::topk(
     gsl::span<const size_t> output_values_strides,
     gsl::span<const size_t> output_indices_shape,
     gsl::span<const size_t> output_indices_strides, const int64_t k,
-    const int32_t axis, const bool largest, const bool sorted) noexcept {
+    const int32_t axis, const bool largest, const bool sorted,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     TYPE_SELECT(typecode, TOPK_IMPL);
 }
@@ -178,7 +178,7 @@ result<void> nncase::kernels::stackvm::optimized::where(
     gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
     gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-    gsl::span<const size_t> out_strides) {
+    gsl::span<const size_t> out_strides, kernel_context &context) {
 
 #if __riscv_vector
     // 这里做一步转换，明确下 cond 数据类型， c++ 中的 sizeof(bool) == 1，对于
@@ -204,5 +204,5 @@ result<void> nncase::kernels::stackvm::optimized::where(
 
     return reference::where(dt, cond, x, y, output, cond_shape, x_shape,
                             y_shape, out_shape, cond_strides, x_strides,
-                            y_strides, out_strides);
+                            y_strides, out_strides, context);
 }
@@ -0,0 +1,89 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <class T, class IndicesT>
+result<void> scatter_nd_impl(const T *input, T *output,
+                             gsl::span<const size_t> in_shape,
+                             const IndicesT *indices,
+                             gsl::span<const size_t> indices_shape,
+                             const T *updates,
+                             gsl::span<const size_t> updates_shape,
+                             NNCASE_UNUSED kernel_context &context) noexcept {
+    if (indices_shape.empty() || indices_shape.back() > in_shape.size())
+        return err(std::errc::not_supported);
+
+    const auto index_depth = indices_shape.back();
+    const auto in_strides = get_default_strides(in_shape);
+    const auto update_count =
+        std::accumulate(indices_shape.begin(), indices_shape.end() - 1,
+                        (size_t)1, std::multiplies<size_t>{});
+    const auto block_size =
+        std::accumulate(in_shape.begin() + index_depth, in_shape.end(),
+                        (size_t)1, std::multiplies<size_t>{});
+    if (compute_size(updates_shape) != update_count * block_size)
+        return err(std::errc::not_supported);
+
+    if (output != input)
+        memcpy(output, input, compute_size(in_shape) * sizeof(T));
+
+    // Updates are applied in order so that the last of any duplicate indices
+    // wins, as in the reference kernel.
+    for (size_t u = 0; u < update_count; u++) {
+        const auto *index = indices + u * index_depth;
+        size_t out_offset = 0;
+        for (size_t k = 0; k < index_depth; k++)
+            out_offset += wrap_index(index[k], in_shape[k]) * in_strides[k];
+
+        if (block_size == 1)
+            output[out_offset] = updates[u];
+        else
+            memcpy(output + out_offset, updates + u * block_size,
+                   block_size * sizeof(T));
+    }
+    return ok();
+}
+} // namespace
+
+#define SCATTER_ND_IMPL(size, type)                                            \
+    case size:                                                                 \
+        return integer_cast(indices_type, indices, [&](auto &&indices_value) { \
+            return scatter_nd_impl(reinterpret_cast<const type *>(input),      \
+                                   reinterpret_cast<type *>(output), in_shape, \
+                                   indices_value, indices_shape,               \
+                                   reinterpret_cast<const type *>(updates),    \
+                                   updates_shape, context);                    \
+        });
+
+result<void> nncase::kernels::stackvm::optimized::scatter_nd(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, datatype_t indices_type,
+    const gsl::byte *indices, gsl::span<const size_t> indices_shape,
+    const gsl::byte *updates, gsl::span<const size_t> updates_shape,
+    kernel_context &context) noexcept {
+    TYPE_IMPL_SELECT(type, SCATTER_ND_IMPL);
+}
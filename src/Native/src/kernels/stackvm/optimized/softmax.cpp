@@ -30,12 +30,11 @@ using namespace nncase::kernels::stackvm::optimized;
 //    gsl::span<const size_t> out_strides, int32_t axis, float beta) noexcept;
 
 // template <typename T>
-result<void> optimized::softmax(typecode_t typecode, const gsl::byte *input,
-                                gsl::byte *output,
-                                gsl::span<const size_t> in_shape,
-                                gsl::span<const size_t> in_strides,
-                                gsl::span<const size_t> out_strides,
-                                int32_t axis, float beta) noexcept {
+result<void> optimized::softmax(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, int32_t axis, float beta,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     return stackvm::reference::softmax(typecode, input, output, in_shape,
                                        in_strides, out_strides, axis, beta);
 }
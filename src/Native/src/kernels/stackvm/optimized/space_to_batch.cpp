@@ -0,0 +1,165 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "opt_common.h"
+#include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+size_t ceil_div(size_t a, size_t b) { return (a + b - 1) / b; }
+
+/**
+ * Input is [batch, spatial..., remain...] and output is
+ * [block... x batch, spatial / block..., remain...]. The trailing remain
+ * dims form a contiguous block, so every output row along the last spatial
+ * dim is a strided run of block copies framed by zero padding.
+ */
+template <class T>
+void space_to_batch_impl(const T *input, T *output,
+                         gsl::span<const size_t> in_shape,
+                         gsl::span<const size_t> block_shape,
+                         const paddings_t &paddings,
+                         gsl::span<const size_t> out_shape,
+                         kernel_context &context) {
+    const auto spatial = block_shape.size();
+    const auto batch = in_shape[0];
+    const auto block = compute_size(in_shape.subspan(spatial + 1));
+    const auto in_strides = get_default_strides(in_shape);
+    const auto rows = compute_size(out_shape.subspan(0, spatial));
+    const auto row_width = out_shape[spatial];
+    const auto row_size = row_width * block;
+    const auto last_block = block_shape[spatial - 1];
+    const auto last_pad = (size_t)paddings[spatial - 1].before;
+    const auto last_extent = in_shape[spatial];
+    NNCASE_UNUSED const auto threads =
+        rows * row_size * sizeof(T) < parallel_copy_threshold
+            ? 1
+            : context.num_threads;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t r = 0; r < (int64_t)rows; r++) {
+        // split the row index into the output batch and leading spatial
+        // indices, and the output batch into block phase and input batch
+        size_t spatial_index[8] = {};
+        auto rest = (size_t)r;
+        for (size_t d = spatial - 1; d > 0; d--) {
+            spatial_index[d - 1] = rest % out_shape[d];
+            rest /= out_shape[d];
+        }
+        const auto n = rest % batch;
+        auto phase = rest / batch;
+        size_t block_index[8] = {};
+        for (size_t d = spatial; d-- > 0;) {
+            block_index[d] = phase % block_shape[d];
+            phase /= block_shape[d];
+        }
+
+        auto dst = output + r * row_size;
+        auto src = input + n * in_strides[0];
+        auto valid = true;
+        for (size_t d = 0; d + 1 < spatial; d++) {
+            const auto pos = spatial_index[d] * block_shape[d] +
+                             block_index[d];
+            const auto pad = (size_t)paddings[d].before;
+            if (pos < pad || pos - pad >= in_shape[d + 1]) {
+                valid = false;
+                break;
+            }
+            src += (pos - pad) * in_strides[d + 1];
+        }
+        if (!valid) {
+            std::fill_n(dst, row_size, T(0));
+            continue;
+        }
+
+        // output columns [begin, end) land inside the input
+        const auto phase_last = block_index[spatial - 1];
+        const auto begin = std::min(
+            row_width, last_pad > phase_last
+                           ? ceil_div(last_pad - phase_last, last_block)
+                           : 0);
+        const auto end = std::max(
+            begin, std::min(row_width,
+                            last_extent + last_pad > phase_last
+                                ? ceil_div(last_extent + last_pad - phase_last,
+                                           last_block)
+                                : 0));
+        std::fill_n(dst, begin * block, T(0));
+        std::fill_n(dst + end * block, (row_width - end) * block, T(0));
+        auto src_col = src + (begin * last_block + phase_last - last_pad) *
+                                 in_strides[spatial];
+        const auto src_step = last_block * in_strides[spatial];
+        if (block == 1) {
+            for (auto x = begin; x < end; x++, src_col += src_step)
+                dst[x] = *src_col;
+        } else {
+            for (auto x = begin; x < end; x++, src_col += src_step)
+                std::memcpy(dst + x * block, src_col, block * sizeof(T));
+        }
+    }
+}
+} // namespace
+
+#define SPACE_TO_BATCH_IMPL(size, type)                                        \
+    case size:                                                                 \
+        space_to_batch_impl(reinterpret_cast<const type *>(input),             \
+                            reinterpret_cast<type *>(output), in_shape,        \
+                            block_shape, paddings, out_shape, context);        \
+        return ok()
+
+result<void> optimized::space_to_batch(
+    datatype_t dt, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &paddings, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    const auto spatial = block_shape.size();
+    if (spatial == 0 || spatial > 8 || in_shape.size() < spatial + 1 ||
+        out_shape.size() != in_shape.size() || paddings.size() < spatial ||
+        !is_contiguous(in_shape, in_strides) ||
+        !is_contiguous(out_shape, out_strides))
+        return err(std::errc::not_supported);
+    if (out_shape[0] != in_shape[0] * compute_size(block_shape))
+        return err(std::errc::not_supported);
+    for (size_t d = 0; d < spatial; d++) {
+        if (block_shape[d] == 0 || paddings[d].before < 0 ||
+            paddings[d].after < 0 ||
+            out_shape[d + 1] * block_shape[d] !=
+                in_shape[d + 1] + paddings[d].sum())
+            return err(std::errc::not_supported);
+    }
+    if (compute_size(out_shape) == 0)
+        return ok();
+
+    switch (runtime::get_bytes(dt)) {
+        SPACE_TO_BATCH_IMPL(1, uint8_t);
+        SPACE_TO_BATCH_IMPL(2, uint16_t);
+        SPACE_TO_BATCH_IMPL(4, uint32_t);
+        SPACE_TO_BATCH_IMPL(8, uint64_t);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
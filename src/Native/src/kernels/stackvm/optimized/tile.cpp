@@ -13,25 +13,166 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_common.h"
 #include "opt_ops.h"
+#include <algorithm>
+#include <cstring>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
-#ifdef __riscv_vector
-#include <riscv_vector.h>
-#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+/**
+ * Tile layout with output dims of extent 1 dropped and neighbouring dims
+ * coalesced where they are both copied as is or both pure broadcasts.
+ * Output axis i holds repeats[i] copies of input axis i.
+ */
+struct tile_plan {
+    dims_t in_shape;
+    dims_t repeats;
+    strides_t in_strides;
+    strides_t out_strides;
+};
+
+tile_plan make_tile_plan(gsl::span<const size_t> in_shape,
+                         gsl::span<const size_t> out_shape) {
+    tile_plan plan;
+    for (size_t i = 0; i < out_shape.size(); i++) {
+        if (out_shape[i] == 1)
+            continue;
+        const auto dim = in_shape[i], repeat = out_shape[i] / in_shape[i];
+        if (!plan.in_shape.empty() && repeat == 1 &&
+            plan.repeats.back() == 1)
+            plan.in_shape.back() *= dim;
+        else if (!plan.in_shape.empty() && dim == 1 &&
+                 plan.in_shape.back() == 1)
+            plan.repeats.back() *= repeat;
+        else {
+            plan.in_shape.push_back(dim);
+            plan.repeats.push_back(repeat);
+        }
+    }
+    if (plan.in_shape.empty()) {
+        plan.in_shape.push_back(1);
+        plan.repeats.push_back(1);
+    }
+
+    const auto rank = plan.in_shape.size();
+    plan.in_strides.resize(rank);
+    plan.out_strides.resize(rank);
+    size_t in_stride = 1, out_stride = 1;
+    for (size_t i = rank; i-- > 0;) {
+        plan.in_strides[i] = in_stride;
+        plan.out_strides[i] = out_stride;
+        in_stride *= plan.in_shape[i];
+        out_stride *= plan.in_shape[i] * plan.repeats[i];
+    }
+    return plan;
+}
+
+// Fills `count` copies of the first `size` bytes at dst, doubling the
+// copied span with every memcpy.
+void replicate(gsl::byte *dst, size_t size, size_t count) {
+    const auto total = size * count;
+    for (size_t done = size; done < total;) {
+        const auto n = std::min(done, total - done);
+        std::memcpy(dst + done, dst, n);
+        done += n;
+    }
+}
+
+// Writes the output block of `axis` and the axes inside it: each input
+// slice is tiled first, then the whole block is replicated.
+template <class T>
+void tile_block(const tile_plan &plan, size_t axis, const T *input,
+                T *output) {
+    const auto dim = plan.in_shape[axis], repeat = plan.repeats[axis];
+    if (axis + 1 == plan.in_shape.size()) {
+        if (dim == 1) {
+            std::fill_n(output, repeat, *input);
+        } else {
+            std::memcpy(output, input, dim * sizeof(T));
+            replicate(reinterpret_cast<gsl::byte *>(output), dim * sizeof(T),
+                      repeat);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < dim; i++)
+        tile_block(plan, axis + 1, input + i * plan.in_strides[axis],
+                   output + i * plan.out_strides[axis]);
+    replicate(reinterpret_cast<gsl::byte *>(output),
+              dim * plan.out_strides[axis] * sizeof(T), repeat);
+}
+
+template <class T>
+result<void> tile_impl(const T *input, T *output,
+                       gsl::span<const size_t> in_shape,
+                       gsl::span<const size_t> out_shape,
+                       kernel_context &context) {
+    const auto plan = make_tile_plan(in_shape, out_shape);
+    const auto out_size = compute_size(out_shape);
+    const auto num_threads =
+        out_size * sizeof(T) < parallel_copy_threshold ? 1
+                                                       : context.num_threads;
+
+    // Threads write disjoint output blocks of the outer `axis` dims, each
+    // built from its own input slice. One thread tiles the whole output.
+    size_t axis = 0, blocks = 1;
+    while (num_threads > 1 && blocks < 4 * num_threads &&
+           axis + 1 < plan.in_shape.size()) {
+        blocks *= plan.in_shape[axis] * plan.repeats[axis];
+        axis++;
+    }
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+    for (int64_t b = 0; b < (int64_t)blocks; b++) {
+        size_t in_offset = 0, out_offset = 0, rest = (size_t)b;
+        for (size_t i = axis; i-- > 0;) {
+            const auto out_dim = plan.in_shape[i] * plan.repeats[i];
+            const auto position = rest % out_dim;
+            rest /= out_dim;
+            in_offset += position % plan.in_shape[i] * plan.in_strides[i];
+            out_offset += position * plan.out_strides[i];
+        }
+        tile_block(plan, axis, input + in_offset, output + out_offset);
+    }
+    return ok();
+}
+
+#define TILE_IMPL(size, type)                                                  \
+    case size:                                                                 \
+        return tile_impl(IN_CAST(type, input), OUT_CAST(type, output),         \
+                         in_shape, out_shape, context);
+} // namespace
 
 result<void> nncase::kernels::stackvm::optimized::tile(
     datatype_t dt, const gsl::byte *input, gsl::byte *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    gsl::span<const size_t> repeats) {
+    gsl::span<const size_t> repeats, kernel_context &context) {
+    if (compute_size(out_shape) == 0)
+        return ok();
+
+    bool supported = in_shape.size() == out_shape.size() &&
+                     is_contiguous(in_shape, in_strides) &&
+                     is_contiguous(out_shape, out_strides);
+    for (size_t i = 0; supported && i < in_shape.size(); i++)
+        supported = in_shape[i] != 0 && out_shape[i] % in_shape[i] == 0;
+    if (supported) {
+        TYPE_IMPL_SELECT(dt, TILE_IMPL);
+    }
+
     return reference::tile(dt, input, output, in_shape, out_shape, in_strides,
                            out_strides, repeats);
-}
\ No newline at end of file
+}
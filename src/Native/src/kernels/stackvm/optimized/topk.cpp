@@ -1,4 +1,3 @@
-
 /* Copyright 2019-2021 Canaan Inc.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
@@ -14,15 +13,21 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "opt_common.h"
 #include "opt_ops.h"
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
-#include <queue>
-#ifdef __riscv_vector
-#include <riscv_vector.h>
+#include <type_traits>
+#if __AVX__
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
 #endif
 
 using namespace nncase;
@@ -30,6 +35,344 @@ using namespace nncase::runtime;
 using namespace nncase::runtime::stackvm;
 using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Values tested at once against the selection bound, two AVX vectors of
+// float.
+constexpr size_t filter_block = 16;
+
+// Up to this k a bounded heap beats collecting candidates.
+constexpr size_t heap_max_k = 16;
+
+template <class T> using candidate_t = std::pair<T, size_t>;
+
+template <bool Largest, class T> bool beats(T a, T b) {
+    if constexpr (Largest)
+        return a > b;
+    else
+        return a < b;
+}
+
+// Bit j is set when x[j] passes `bound` or is NaN, for filter_block values.
+template <bool Largest, class T>
+uint32_t candidate_mask(const T *x, T bound) {
+#if __AVX__
+    if constexpr (std::is_same_v<T, float>) {
+        // negated ordered compares are true for NaN
+        constexpr int predicate = Largest ? _CMP_NLT_UQ : _CMP_NGT_UQ;
+        const auto t = _mm256_set1_ps(bound);
+        const auto lo = _mm256_cmp_ps(_mm256_loadu_ps(x), t, predicate);
+        const auto hi = _mm256_cmp_ps(_mm256_loadu_ps(x + 8), t, predicate);
+        return (uint32_t)_mm256_movemask_ps(lo) |
+               (uint32_t)_mm256_movemask_ps(hi) << 8;
+    }
+#endif
+    // most blocks have no candidate, test that first so it vectorizes
+    int hit = 0;
+    for (size_t j = 0; j < filter_block; j++)
+        hit |= !beats<Largest>(bound, x[j]);
+    if (!hit)
+        return 0;
+
+    uint32_t mask = 0;
+    for (size_t j = 0; j < filter_block; j++)
+        mask |= (uint32_t)!beats<Largest>(bound, x[j]) << j;
+    return mask;
+}
+
+size_t lowest_bit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return (size_t)__builtin_ctz(mask);
+#endif
+}
+
+// Calls f(i) for the i in [begin, n) that may pass bound(), which is read
+// once per block. Stops early when f returns false.
+template <bool Largest, class T, class Bound, class F>
+bool for_each_candidate(const T *x, size_t begin, size_t n, Bound &&bound,
+                        F &&f) {
+    size_t i = begin;
+    for (; i + filter_block <= n; i += filter_block) {
+        for (auto mask = candidate_mask<Largest>(x + i, bound()); mask;
+             mask &= mask - 1) {
+            if (!f(i + lowest_bit(mask)))
+                return false;
+        }
+    }
+
+    for (; i < n; i++) {
+        if (!f(i))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Keeps the k best of x in `heap`, sorted like the output. Replays the
+ * std::priority_queue of reference/topk.cpp push for push: a min-heap of
+ * (value, index) for largest, a max-heap for smallest, fed in axis order
+ * and replaced only on a strict improvement. Ties therefore resolve the
+ * same way, NaN included. Values that cannot beat the current worst kept
+ * value are masked out a block at a time.
+ */
+template <bool Largest, class T>
+void heap_select(const T *x, size_t n, size_t k,
+                 std::vector<candidate_t<T>> &heap) {
+    std::conditional_t<Largest, std::greater<candidate_t<T>>,
+                       std::less<candidate_t<T>>>
+        comp;
+    heap.clear();
+    for (size_t i = 0; i < k; i++) {
+        heap.emplace_back(x[i], i);
+        std::push_heap(heap.begin(), heap.end(), comp);
+    }
+
+    for_each_candidate<Largest>(
+        x, k, n, [&] { return heap.front().first; },
+        [&](size_t i) {
+            if (beats<Largest>(x[i], heap.front().first)) {
+                std::pop_heap(heap.begin(), heap.end(), comp);
+                heap.back() = {x[i], i};
+                std::push_heap(heap.begin(), heap.end(), comp);
+            }
+            return true;
+        });
+
+    // pops in the reference order, the first pop lands last
+    std::sort_heap(heap.begin(), heap.end(), comp);
+}
+
+/**
+ * Same result as heap_select without the per-element heap updates, for
+ * large k. Let v be the k-th best value. The heap ends up with every value
+ * better than v plus the m copies of v it still needs. It stops admitting
+ * v once the k-th value not worse than v has been seen. From then on each
+ * better value evicts the lowest index copy for largest and the highest
+ * for smallest. So largest keeps the last m copies up to that point and
+ * smallest keeps the first m copies.
+ *
+ * Candidates not worse than a running bound on v are collected in index
+ * order. The bound is raised by selecting among them whenever the buffer
+ * doubles, and SIMD masks skip values below it. Returns false
+ * on NaN, where only the heap replay matches the reference.
+ */
+template <bool Largest, class T>
+bool threshold_select(const T *x, size_t n, size_t k,
+                      std::vector<candidate_t<T>> &candidates,
+                      std::vector<candidate_t<T>> &selected) {
+    auto better = [](const candidate_t<T> &a, const candidate_t<T> &b) {
+        return beats<Largest>(a.first, b.first);
+    };
+    auto kth_best = [&]() {
+        selected.assign(candidates.begin(), candidates.end());
+        std::nth_element(selected.begin(), selected.begin() + (k - 1),
+                         selected.end(), better);
+        return selected[k - 1].first;
+    };
+
+    // the worst of any k values bounds the k-th best from below
+    candidates.clear();
+    for (size_t i = 0; i < k; i++) {
+        if (x[i] != x[i])
+            return false;
+        candidates.emplace_back(x[i], i);
+    }
+
+    auto bound = std::min_element(candidates.begin(), candidates.end(),
+                                  [&](auto &a, auto &b) { return better(b, a); })
+                     ->first;
+    size_t next_compact = 2 * k;
+    auto collect = [&](size_t i) {
+        const auto v = x[i];
+        if (v != v)
+            return false;
+        if (beats<Largest>(bound, v))
+            return true;
+
+        candidates.emplace_back(v, i);
+        if (candidates.size() >= next_compact) {
+            bound = kth_best();
+            candidates.erase(std::remove_if(candidates.begin(),
+                                            candidates.end(),
+                                            [&](const candidate_t<T> &c) {
+                                                return beats<Largest>(
+                                                    bound, c.first);
+                                            }),
+                             candidates.end());
+            next_compact = std::max(2 * k, 2 * candidates.size());
+        }
+        return true;
+    };
+    if (!for_each_candidate<Largest>(
+            x, k, n, [&] { return bound; }, collect))
+        return false;
+
+    const auto kth = kth_best();
+    size_t better_count = 0;
+    for (auto &c : candidates)
+        better_count += beats<Largest>(c.first, kth);
+
+    // copies of kth up to the k-th value not worse than it
+    const auto ties = k - better_count;
+    size_t seen = 0, ties_seen = 0;
+    for (size_t c = 0; c < candidates.size() && seen < k; c++) {
+        if (!beats<Largest>(kth, candidates[c].first)) {
+            ties_seen += !beats<Largest>(candidates[c].first, kth);
+            seen++;
+        }
+    }
+
+    const auto first_tie = Largest ? ties_seen - ties : 0;
+    const auto last_tie = Largest ? ties_seen : ties;
+    selected.clear();
+    size_t tie = 0;
+    for (auto &c : candidates) {
+        if (beats<Largest>(c.first, kth)) {
+            selected.push_back(c);
+        } else if (!beats<Largest>(kth, c.first)) {
+            if (tie >= first_tie && tie < last_tie)
+                selected.push_back(c);
+            tie++;
+        }
+    }
+
+    if constexpr (Largest)
+        std::sort(selected.begin(), selected.end(),
+                  std::greater<candidate_t<T>>());
+    else
+        std::sort(selected.begin(), selected.end(),
+                  std::less<candidate_t<T>>());
+    return true;
+}
+
+// quick_partition and quick_select of reference/topk.cpp, which fix the
+// order of unsorted outputs.
+template <class T>
+int64_t quick_partition(std::vector<candidate_t<T>> &nums, int64_t lo,
+                        int64_t hi, bool largest) {
+    int64_t i = lo;
+    int64_t j = hi + 1;
+    T pivot = nums[lo].first;
+
+    while (true) {
+        if (largest) {
+            while (++i < hi && nums[i].first > pivot)
+                ;
+            while (--j > lo && nums[j].first < pivot)
+                ;
+        } else {
+            while (++i < hi && nums[i].first < pivot)
+                ;
+            while (--j > lo && nums[j].first > pivot)
+                ;
+        }
+
+        if (i >= j)
+            break;
+        std::swap(nums[i], nums[j]);
+    }
+
+    std::swap(nums[lo], nums[j]);
+    return j;
+}
+
+template <class T>
+void quick_select(std::vector<candidate_t<T>> &nums, int64_t lo, int64_t hi,
+                  int64_t k, bool largest) {
+    while (lo < hi) {
+        auto idx = quick_partition(nums, lo, hi, largest);
+        if (idx == k)
+            return;
+        if (idx > k)
+            hi = idx - 1;
+        else
+            lo = idx + 1;
+    }
+}
+
+// Processes slices [begin, end), reusing one set of scratch buffers.
+template <class T>
+void topk_slices(const T *input, T *values, int64_t *indices, size_t begin,
+                 size_t end, size_t axis_dim, size_t inner, size_t k,
+                 bool largest, bool sorted) {
+    // std::vector<bool> has no data()
+    auto column = std::make_unique<T[]>(inner == 1 ? 0 : axis_dim);
+    std::vector<candidate_t<T>> scratch, candidates;
+
+    for (size_t s = begin; s < end; s++) {
+        const auto o = s / inner, i = s % inner;
+        const T *x = input + o * axis_dim * inner + i;
+        if (inner != 1) {
+            for (size_t a = 0; a < axis_dim; a++)
+                column[a] = x[a * inner];
+            x = column.get();
+        }
+
+        if (sorted) {
+            if (largest) {
+                if (k <= heap_max_k ||
+                    !threshold_select<true>(x, axis_dim, k, candidates,
+                                            scratch))
+                    heap_select<true>(x, axis_dim, k, scratch);
+            } else {
+                if (k <= heap_max_k ||
+                    !threshold_select<false>(x, axis_dim, k, candidates,
+                                             scratch))
+                    heap_select<false>(x, axis_dim, k, scratch);
+            }
+        } else {
+            scratch.clear();
+            for (size_t a = 0; a < axis_dim; a++)
+                scratch.emplace_back(x[a], a);
+            quick_select(scratch, 0, (int64_t)axis_dim - 1, (int64_t)k,
+                         largest);
+        }
+
+        auto out_values = values + o * k * inner + i;
+        auto out_indices = indices + o * k * inner + i;
+        for (size_t j = 0; j < k; j++) {
+            out_values[j * inner] = scratch[j].first;
+            out_indices[j * inner] = (int64_t)scratch[j].second;
+        }
+    }
+}
+
+template <class T>
+result<void> topk_impl(const T *input, T *output_values,
+                       int64_t *output_indices,
+                       gsl::span<const size_t> in_shape, size_t axis,
+                       size_t k, bool largest, bool sorted,
+                       NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto axis_dim = in_shape[axis];
+    const auto inner = compute_size(in_shape.subspan(axis + 1));
+    const auto slices = compute_size(in_shape) / axis_dim;
+    const auto chunks = (int64_t)std::min<size_t>(
+        compute_size(in_shape) < parallel_heavy_threshold
+            ? 1
+            : std::max<size_t>(context.num_threads, 1),
+        slices);
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t c = 0; c < chunks; c++) {
+        topk_slices(input, output_values, output_indices, slices * c / chunks,
+                    slices * (c + 1) / chunks, axis_dim, inner, k, largest,
+                    sorted);
+    }
+    return ok();
+}
+} // namespace
+
+#define TOPK_IMPL(_ty)                                                         \
+    return topk_impl(IN_CAST(_ty, input), OUT_CAST(_ty, output_values),        \
+                     output_indices, in_shape, (size_t)positive_axis,          \
+                     (size_t)k, largest, sorted, context)
 
 result<void> nncase::kernels::stackvm::optimized::topk(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output_values,
@@ -39,7 +382,18 @@ result<void> nncase::kernels::stackvm::optimized::topk(
     gsl::span<const size_t> output_values_strides,
     gsl::span<const size_t> output_indices_shape,
     gsl::span<const size_t> output_indices_strides, const int64_t k,
-    const int32_t axis, const bool largest, const bool sorted) noexcept {
+    const int32_t axis, const bool largest, const bool sorted,
+    kernel_context &context) noexcept {
+    const auto positive_axis =
+        axis < 0 ? axis + (int32_t)in_shape.size() : axis;
+    if (positive_axis >= 0 && (size_t)positive_axis < in_shape.size() &&
+        k > 0 && (size_t)k <= in_shape[positive_axis] &&
+        is_contiguous(in_shape, in_strides) &&
+        is_contiguous(output_values_shape, output_values_strides) &&
+        is_contiguous(output_indices_shape, output_indices_strides)) {
+        TYPE_SELECT(typecode, TOPK_IMPL);
+    }
+
     return reference::topk(typecode, input, output_values, output_indices,
                            in_shape, in_strides, output_values_shape,
                            output_values_strides, output_indices_shape,
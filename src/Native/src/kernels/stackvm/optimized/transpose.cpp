@@ -13,11 +13,19 @@
  * limitations under the License.
  */
 
+#include "../reference/ref_ops.h"
 #include "opt_common.h"
 #include "opt_ops.h"
+#include <algorithm>
 #include <cstring>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX__
+#include <immintrin.h>
+#elif __SSE2__
+#include <emmintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -25,86 +33,300 @@ using namespace nncase::kernels;
 using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 
-#define UNFOLD_OUTPUT_ASSIGN_4(_output_ptr)                                    \
-    auto *o0 = _output_ptr + 0;                                                \
-    auto *o1 = _output_ptr + 1;                                                \
-    auto *o2 = _output_ptr + 2;                                                \
-    auto *o3 = _output_ptr + 3;
+namespace {
+constexpr size_t max_transpose_rank = 8;
+// Edge of the square tile copied by one task; a multiple of every register
+// block size below.
+constexpr size_t transpose_tile = 32;
 
-#define DIV_4(arg)                                                             \
-    auto res = div((arg), 4);                                                  \
-    size_t res_quot = size_t(res.quot);                                        \
-    size_t res_rem = size_t(res.rem);
+// dst[i * dst_stride + j] = src[j * src_stride + i] for a rows x cols block.
+template <class T>
+void transpose_block(const T *src, size_t src_stride, T *dst,
+                     size_t dst_stride, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows; i++)
+        for (size_t j = 0; j < cols; j++)
+            dst[i * dst_stride + j] = src[j * src_stride + i];
+}
+
+// Covers the block with Block x Block register transposes and finishes the
+// ragged right and bottom edges with scalar copies.
+template <size_t Block, class T, class TKernel>
+void transpose_block_simd(TKernel &&kernel, const T *src, size_t src_stride,
+                          T *dst, size_t dst_stride, size_t rows,
+                          size_t cols) {
+    const auto rows_b = rows / Block * Block, cols_b = cols / Block * Block;
+    for (size_t i = 0; i < rows_b; i += Block)
+        for (size_t j = 0; j < cols_b; j += Block)
+            kernel(src + j * src_stride + i, src_stride,
+                   dst + i * dst_stride + j, dst_stride);
+    for (size_t i = 0; i < rows; i++)
+        for (size_t j = i < rows_b ? cols_b : 0; j < cols; j++)
+            dst[i * dst_stride + j] = src[j * src_stride + i];
+}
+
+#if __AVX__
+void transpose8x8(const uint32_t *src, size_t src_stride, uint32_t *dst,
+                  size_t dst_stride) {
+    auto in = reinterpret_cast<const float *>(src);
+    auto out = reinterpret_cast<float *>(dst);
+    __m256 r[8], t[8];
+    for (size_t k = 0; k < 8; k++)
+        r[k] = _mm256_loadu_ps(in + k * src_stride);
+    for (size_t k = 0; k < 8; k += 2) {
+        t[k] = _mm256_unpacklo_ps(r[k], r[k + 1]);
+        t[k + 1] = _mm256_unpackhi_ps(r[k], r[k + 1]);
+    }
+    for (size_t k = 0; k < 8; k += 4) {
+        r[k] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[k + 1] = _mm256_shuffle_ps(t[k], t[k + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[k + 2] =
+            _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[k + 3] =
+            _mm256_shuffle_ps(t[k + 1], t[k + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (size_t k = 0; k < 4; k++) {
+        _mm256_storeu_ps(out + k * dst_stride,
+                         _mm256_permute2f128_ps(r[k], r[k + 4], 0x20));
+        _mm256_storeu_ps(out + (k + 4) * dst_stride,
+                         _mm256_permute2f128_ps(r[k], r[k + 4], 0x31));
+    }
+}
+
+template <>
+void transpose_block(const uint32_t *src, size_t src_stride, uint32_t *dst,
+                     size_t dst_stride, size_t rows, size_t cols) {
+    transpose_block_simd<8>(transpose8x8, src, src_stride, dst, dst_stride,
+                            rows, cols);
+}
+#endif
+
+#if __SSE2__
+// Four rounds of interleaving, each doubling the width of the moved unit:
+// 8, 16, 32, then 64 bits.
+void transpose16x16(const uint8_t *src, size_t src_stride, uint8_t *dst,
+                    size_t dst_stride) {
+    __m128i a[16], b[16];
+    for (size_t k = 0; k < 16; k++)
+        a[k] = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + k * src_stride));
+    for (size_t k = 0; k < 8; k++) {
+        b[2 * k] = _mm_unpacklo_epi8(a[2 * k], a[2 * k + 1]);
+        b[2 * k + 1] = _mm_unpackhi_epi8(a[2 * k], a[2 * k + 1]);
+    }
+    for (size_t m = 0; m < 4; m++) {
+        for (size_t c = 0; c < 2; c++) {
+            a[4 * m + 2 * c] =
+                _mm_unpacklo_epi16(b[4 * m + c], b[4 * m + 2 + c]);
+            a[4 * m + 2 * c + 1] =
+                _mm_unpackhi_epi16(b[4 * m + c], b[4 * m + 2 + c]);
+        }
+    }
+    for (size_t o = 0; o < 2; o++) {
+        for (size_t c = 0; c < 4; c++) {
+            b[8 * o + 2 * c] =
+                _mm_unpacklo_epi32(a[8 * o + c], a[8 * o + 4 + c]);
+            b[8 * o + 2 * c + 1] =
+                _mm_unpackhi_epi32(a[8 * o + c], a[8 * o + 4 + c]);
+        }
+    }
+    for (size_t c = 0; c < 8; c++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * c * dst_stride),
+                         _mm_unpacklo_epi64(b[c], b[8 + c]));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(dst + (2 * c + 1) * dst_stride),
+            _mm_unpackhi_epi64(b[c], b[8 + c]));
+    }
+}
+
+template <>
+void transpose_block(const uint8_t *src, size_t src_stride, uint8_t *dst,
+                     size_t dst_stride, size_t rows, size_t cols) {
+    transpose_block_simd<16>(transpose16x16, src, src_stride, dst, dst_stride,
+                             rows, cols);
+}
+#endif
+
+// Drops unit axes and merges input axes that stay adjacent and in order in
+// the output, so that e.g. NCHW -> NHWC becomes a 3-D [N, C, HW] -> [N, HW,
+// C] transpose.
+void coalesce_axes(gsl::span<const size_t> in_shape,
+                   gsl::span<const size_t> perm, dims_t &new_shape,
+                   dims_t &new_perm) {
+    // runs of input axes that stay together, in output order; unit axes
+    // are dropped and never break a run
+    dims_t groups_begin, groups_end;
+    for (size_t i = 0; i < perm.size(); i++) {
+        const auto axis = perm[i];
+        if (in_shape[axis] == 1)
+            continue;
+        bool extends = !groups_end.empty() && groups_end.back() < axis;
+        for (auto a = extends ? groups_end.back() + 1 : axis; a < axis; a++)
+            extends = extends && in_shape[a] == 1;
+        if (extends) {
+            groups_end.back() = axis;
+        } else {
+            groups_begin.push_back(axis);
+            groups_end.push_back(axis);
+        }
+    }
+
+    // rank the groups by their position in the input
+    dims_t order(groups_begin.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return groups_begin[a] < groups_begin[b];
+    });
+
+    new_shape.assign(order.size(), 1);
+    new_perm.assign(order.size(), 0);
+    for (size_t r = 0; r < order.size(); r++) {
+        const auto g = order[r];
+        for (auto a = groups_begin[g]; a <= groups_end[g]; a++)
+            new_shape[r] *= in_shape[a];
+        new_perm[g] = r;
+    }
+}
 
-// todo: fix, for 3d
-namespace {
 template <class T>
-result<void> transpose_impl(const T *input, T *output, const dims_t &in_shape,
-                            const dims_t &perm) {
-    dims_t out_shape(in_shape.size());
-    for (size_t i = 0; i < 4; i++) {
+void transpose_impl(const T *input, T *output, const dims_t &in_shape,
+                    const dims_t &perm, NNCASE_UNUSED kernel_context &context) {
+    const auto rank = in_shape.size();
+    const auto in_strides = get_default_strides(in_shape);
+    dims_t out_shape(rank);
+    for (size_t i = 0; i < rank; i++)
         out_shape[i] = in_shape[perm[i]];
+    const auto out_strides = get_default_strides(out_shape);
+
+    // input stride of every output axis
+    dims_t src_strides(rank);
+    for (size_t i = 0; i < rank; i++)
+        src_strides[i] = in_strides[perm[i]];
+
+    // after coalescing the innermost input axis is never the innermost
+    // output axis: output axis `col_axis` walks the input contiguously and
+    // the last output axis walks the output contiguously, which makes a 2-D
+    // transpose tiled over those two axes.
+    size_t col_axis = 0;
+    while (perm[col_axis] != rank - 1)
+        col_axis++;
+    const auto rows = out_shape[col_axis];
+    const auto cols = out_shape[rank - 1];
+    const auto row_tiles = (rows + transpose_tile - 1) / transpose_tile;
+    const auto col_tiles = (cols + transpose_tile - 1) / transpose_tile;
+
+    dims_t batch_axes;
+    for (size_t i = 0; i < rank - 1; i++)
+        if (i != col_axis)
+            batch_axes.push_back(i);
+    size_t batches = 1;
+    for (auto a : batch_axes)
+        batches *= out_shape[a];
+
+    const auto tasks = batches * row_tiles * col_tiles;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)tasks; t++) {
+        auto rest = (size_t)t;
+        const auto tj = rest % col_tiles;
+        rest /= col_tiles;
+        const auto ti = rest % row_tiles;
+        rest /= row_tiles;
+
+        size_t src_offset = 0, dst_offset = 0;
+        for (size_t k = batch_axes.size(); k-- > 0;) {
+            const auto a = batch_axes[k];
+            const auto index = rest % out_shape[a];
+            rest /= out_shape[a];
+            src_offset += index * src_strides[a];
+            dst_offset += index * out_strides[a];
+        }
+
+        const auto i = ti * transpose_tile, j = tj * transpose_tile;
+        src_offset += i + j * src_strides[rank - 1];
+        dst_offset += i * out_strides[col_axis] + j;
+        transpose_block(input + src_offset, src_strides[rank - 1],
+                        output + dst_offset, out_strides[col_axis],
+                        std::min(transpose_tile, rows - i),
+                        std::min(transpose_tile, cols - j));
     }
-    DIV_4(out_shape[3])
-    size_t move_distance =
-        std::accumulate(in_shape.begin() + perm[3] + 1, in_shape.end(), 1,
-                        std::multiplies<size_t>());
-
-    auto out_img_size = out_shape[2] * out_shape[3];
-    for (size_t b = 0; b < out_shape[0]; b++) {
-        // #pragma omp parallel for
-        // num_threads(kernels::default_kernel_context().num_threads)
-        for (size_t c = 0; c < out_shape[1]; c++) {
-            dims_t index(4);
-            index[perm[0]] = b;
-            index[perm[1]] = c;
-            auto *output_ptr =
-                output + b * out_shape[1] * out_img_size + c * out_img_size;
-            for (size_t h = 0; h < out_shape[2]; h++) {
-                index[perm[2]] = h;
-                auto *input_ptr = input + linear_index(in_shape, index);
-                for (size_t w = 0; w < res_quot; w++) {
-                    auto *i0 = input_ptr + 0 * move_distance;
-                    auto *i1 = input_ptr + 1 * move_distance;
-                    auto *i2 = input_ptr + 2 * move_distance;
-                    auto *i3 = input_ptr + 3 * move_distance;
-                    UNFOLD_OUTPUT_ASSIGN_4(output_ptr);
-                    *o0 = *i0;
-                    *o1 = *i1;
-                    *o2 = *i2;
-                    *o3 = *i3;
-                    input_ptr += 4 * move_distance;
-                    output_ptr += 4;
-                }
-                for (size_t w = 0; w < res_rem; w++) {
-                    *output_ptr = *input_ptr;
-                    input_ptr += move_distance;
-                    ++output_ptr;
-                }
-            }
+}
+
+// The innermost axis stays in place: copy contiguous runs of inner_size.
+void transpose_rows(const gsl::byte *input, gsl::byte *output,
+                    const dims_t &in_shape, const dims_t &perm,
+                    size_t inner_bytes, NNCASE_UNUSED kernel_context &context) {
+    const auto rank = in_shape.size() - 1;
+    const auto in_strides = get_default_strides(in_shape);
+    size_t rows = 1;
+    dims_t out_shape(rank), src_strides(rank);
+    for (size_t i = 0; i < rank; i++) {
+        out_shape[i] = in_shape[perm[i]];
+        src_strides[i] = in_strides[perm[i]] / in_shape.back();
+        rows *= out_shape[i];
+    }
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t r = 0; r < (int64_t)rows; r++) {
+        auto rest = (size_t)r;
+        size_t src_row = 0;
+        for (size_t k = rank; k-- > 0;) {
+            src_row += (rest % out_shape[k]) * src_strides[k];
+            rest /= out_shape[k];
         }
+        std::memcpy(output + r * inner_bytes, input + src_row * inner_bytes,
+                    inner_bytes);
     }
-    return ok();
 }
 
 #define TRANSPOSE_IMPL(size, type)                                             \
     case size:                                                                 \
-        return transpose_impl(reinterpret_cast<const type *>(src),             \
-                              reinterpret_cast<type *>(dest), in_shape, perm)
+        transpose_impl(reinterpret_cast<const type *>(src),                    \
+                       reinterpret_cast<type *>(dest), new_shape, new_perm,    \
+                       context);                                               \
+        return ok()
 } // namespace
 
 result<void> kernels::stackvm::optimized::transpose(
     datatype_t type, const gsl::byte *src, gsl::byte *dest,
-    const dims_t &in_shape, const dims_t &perm,
-    [[maybe_unused]] const strides_t &in_strides,
-    [[maybe_unused]] const strides_t &out_strides,
-    [[maybe_unused]] kernel_context &context) noexcept {
-    switch (runtime::get_bytes(type)) {
+    const dims_t &in_shape, const dims_t &perm, const strides_t &in_strides,
+    const strides_t &out_strides, kernel_context &context) noexcept {
+    const auto elem_bytes = runtime::get_bytes(type);
+    dims_t out_shape(perm.size());
+    for (size_t i = 0; i < perm.size(); i++)
+        out_shape[i] = in_shape[perm[i]];
+    if (in_shape.size() > max_transpose_rank ||
+        !is_contiguous(in_shape, in_strides) ||
+        !is_contiguous(out_shape, out_strides))
+        return stackvm::reference::transpose(type, src, dest, in_shape, perm,
+                                             in_strides, out_strides, context);
+
+    if (compute_size(in_shape) == 0)
+        return ok();
+
+    dims_t new_shape, new_perm;
+    coalesce_axes(in_shape, perm, new_shape, new_perm);
+    if (new_shape.size() <= 1) {
+        std::memcpy(dest, src, compute_size(in_shape) * elem_bytes);
+        return ok();
+    }
+
+    if (new_perm.back() == new_shape.size() - 1) {
+        transpose_rows(src, dest, new_shape, new_perm,
+                       new_shape.back() * elem_bytes, context);
+        return ok();
+    }
+
+    switch (elem_bytes) {
         TRANSPOSE_IMPL(1, uint8_t);
         TRANSPOSE_IMPL(2, uint16_t);
         TRANSPOSE_IMPL(4, uint32_t);
         TRANSPOSE_IMPL(8, uint64_t);
     default:
-        return err(std::errc::not_supported);
+        return stackvm::reference::transpose(type, src, dest, in_shape, perm,
+                                             in_strides, out_strides, context);
     }
-}
\ No newline at end of file
+}
@@ -13,11 +13,17 @@
  * limitations under the License.
  */
 #include "../reference/ref_ops.h"
+#include "broadcast.h"
+#include "opt_common.h"
 #include "opt_ops.h"
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/runtime_op_utility.h>
 #include <nncase/runtime/util.h>
+#if __AVX2__
+#include <immintrin.h>
+#endif
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -26,14 +32,145 @@ using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 using namespace nncase::runtime::stackvm;
 
+namespace {
+#if __AVX2__
+// Elements of T in one AVX2 register, selected with a byte blend.
+template <class T> struct avx_select {
+    static constexpr size_t lanes = 32 / sizeof(T);
+
+    static __m256i load(const T *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    static __m256i set1(T v) {
+        if constexpr (sizeof(T) == 1)
+            return _mm256_set1_epi8((char)v);
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_set1_epi16((short)v);
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_set1_epi32((int)v);
+        else
+            return _mm256_set1_epi64x((long long)v);
+    }
+
+    // All ones in the elements whose condition is false.
+    static __m256i false_mask(const bool *cond) {
+        const auto zero = _mm256_setzero_si256();
+        if constexpr (sizeof(T) == 1) {
+            return _mm256_cmpeq_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cond)),
+                zero);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_cmpeq_epi16(
+                _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(cond))),
+                zero);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_cmpeq_epi32(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i *>(cond))),
+                zero);
+        } else {
+            int32_t bytes;
+            std::memcpy(&bytes, cond, sizeof(bytes));
+            return _mm256_cmpeq_epi64(
+                _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes)), zero);
+        }
+    }
+};
+#endif
+
+// out[i] = cond[i] ? x[i] : y[i] over [begin, end), a broadcast side is
+// read from its first element
+template <bool XBroadcast, bool YBroadcast, class T>
+void where_run(const bool *cond, const T *x, const T *y, T *out,
+               size_t begin, size_t end) {
+    size_t i = begin;
+#if __AVX2__
+    using vec = avx_select<T>;
+    const auto load = [](const T *p, bool broadcast, size_t j) {
+        return broadcast ? vec::set1(*p) : vec::load(p + j);
+    };
+    for (; i + vec::lanes <= end; i += vec::lanes) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(out + i),
+            _mm256_blendv_epi8(load(x, XBroadcast, i), load(y, YBroadcast, i),
+                               vec::false_mask(cond + i)));
+    }
+#endif
+    for (; i < end; i++)
+        out[i] = cond[i] ? (XBroadcast ? *x : x[i]) : (YBroadcast ? *y : y[i]);
+}
+
+// One condition for the whole run: a copy or a fill of the chosen side.
+template <class T>
+void select_run(bool cond, const T *x, bool x_broadcast, const T *y,
+               bool y_broadcast, T *out, size_t begin, size_t end) {
+    const auto src = cond ? x : y;
+    if (cond ? x_broadcast : y_broadcast)
+        std::fill(out + begin, out + end, *src);
+    else
+        std::memcpy(out + begin, src + begin, (end - begin) * sizeof(T));
+}
+
+template <class T>
+result<void> where_impl(const bool *cond, const T *x, const T *y, T *output,
+                        gsl::span<const size_t> cond_shape,
+                        gsl::span<const size_t> x_shape,
+                        gsl::span<const size_t> y_shape,
+                        gsl::span<const size_t> out_shape,
+                        kernel_context &context) {
+    const auto plan =
+        make_broadcast_plan<3>({cond_shape, x_shape, y_shape}, out_shape);
+    const auto num_threads = compute_size(out_shape) >= parallel_threshold
+                                 ? context.num_threads
+                                 : 1;
+    const auto x_broadcast = plan.inner_broadcast[1],
+               y_broadcast = plan.inner_broadcast[2];
+    for_each_broadcast_run(
+        plan, num_threads, parallel_block,
+        [&](const std::array<size_t, 3> &offsets, size_t out_offset,
+            size_t begin, size_t end) {
+            const auto c = cond + offsets[0];
+            const auto a = x + offsets[1], b = y + offsets[2];
+            const auto out = output + out_offset;
+            if (plan.inner_broadcast[0])
+                select_run(*c, a, x_broadcast, b, y_broadcast, out, begin,
+                           end);
+            else if (x_broadcast && y_broadcast)
+                where_run<true, true>(c, a, b, out, begin, end);
+            else if (x_broadcast)
+                where_run<true, false>(c, a, b, out, begin, end);
+            else if (y_broadcast)
+                where_run<false, true>(c, a, b, out, begin, end);
+            else
+                where_run<false, false>(c, a, b, out, begin, end);
+        });
+    return ok();
+}
+} // namespace
+
+#define WHERE_IMPL(size, type)                                                 \
+    case size:                                                                 \
+        return where_impl(cond, IN_CAST(type, x), IN_CAST(type, y),            \
+                          OUT_CAST(type, output), cond_shape, x_shape,         \
+                          y_shape, out_shape, context);
+
 result<void> nncase::kernels::stackvm::optimized::where(
     datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
     gsl::byte *output, gsl::span<const size_t> cond_shape,
     gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
     gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-    gsl::span<const size_t> out_strides) {
+    gsl::span<const size_t> out_strides, kernel_context &context) {
+    if (is_contiguous(cond_shape, cond_strides) &&
+        is_contiguous(x_shape, x_strides) &&
+        is_contiguous(y_shape, y_strides) &&
+        is_contiguous(out_shape, out_strides)) {
+        TYPE_IMPL_SELECT(dt, WHERE_IMPL);
+    }
+
     return reference::where(dt, cond, x, y, output, cond_shape, x_shape,
                             y_shape, out_shape, cond_strides, x_strides,
-                            y_strides, out_strides);
+                            y_strides, out_strides, context);
 }
@@ -0,0 +1,344 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../opt_common.h"
+#include "../opt_ops.h"
+#include "avx_half.h"
+#include "avx_mathfun.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+__m256 select_negative(__m256 x, __m256 negative, __m256 positive) {
+    return _mm256_blendv_ps(
+        positive, negative,
+        _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+}
+
+__m256 clamp01(__m256 x) {
+    return _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()),
+                         _mm256_set1_ps(1.f));
+}
+
+__m256 sigmoid256_ps(__m256 x) {
+    const auto one = _mm256_set1_ps(1.f);
+    return _mm256_div_ps(
+        one, _mm256_add_ps(
+                 one, exp256_ps(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+struct activation_op_relu {
+    __m256 operator()(__m256 x) const {
+        return _mm256_max_ps(x, _mm256_setzero_ps());
+    }
+};
+
+struct activation_op_softsign {
+    __m256 operator()(__m256 x) const {
+        const auto abs = _mm256_andnot_ps(_mm256_set1_ps(-0.f), x);
+        return _mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.f), abs));
+    }
+};
+
+// max(x, 0) + log1p(exp(-|x|)), log1p(u) is log(1 + u) * u / ((1 + u) - 1)
+// so that small u are not lost when added to 1
+struct activation_op_softplus {
+    __m256 operator()(__m256 x) const {
+        const auto one = _mm256_set1_ps(1.f);
+        const auto abs = _mm256_andnot_ps(_mm256_set1_ps(-0.f), x);
+        const auto u = exp256_ps(_mm256_sub_ps(_mm256_setzero_ps(), abs));
+        const auto w = _mm256_add_ps(one, u);
+        const auto w_1 = _mm256_sub_ps(w, one);
+        auto log1p = _mm256_div_ps(_mm256_mul_ps(log256_ps(w), u), w_1);
+        log1p =
+            _mm256_blendv_ps(log1p, u, _mm256_cmp_ps(w_1, _mm256_setzero_ps(),
+                                                     _CMP_EQ_OQ));
+        return _mm256_add_ps(_mm256_max_ps(x, _mm256_setzero_ps()), log1p);
+    }
+};
+
+struct activation_op_sigmoid {
+    __m256 operator()(__m256 x) const { return sigmoid256_ps(x); }
+};
+
+struct activation_op_swish {
+    __m256 operator()(__m256 x) const {
+        return _mm256_mul_ps(x, sigmoid256_ps(x));
+    }
+};
+
+struct activation_op_hard_swish {
+    __m256 operator()(__m256 x) const {
+        const auto y = _mm256_comp_fmadd_ps(x, _mm256_set1_ps(1.f / 6),
+                                            _mm256_set1_ps(0.5f));
+        return _mm256_mul_ps(x, clamp01(y));
+    }
+};
+
+struct activation_op_erf {
+    __m256 operator()(__m256 x) const { return erf256_ps(x); }
+};
+
+struct activation_op_elu {
+    __m256 alpha;
+
+    __m256 operator()(__m256 x) const {
+        const auto neg = _mm256_mul_ps(
+            alpha, _mm256_sub_ps(exp256_ps(x), _mm256_set1_ps(1.f)));
+        return select_negative(x, neg, x);
+    }
+};
+
+struct activation_op_celu {
+    __m256 alpha;
+
+    __m256 operator()(__m256 x) const {
+        const auto zero = _mm256_setzero_ps();
+        const auto neg = _mm256_mul_ps(
+            alpha, _mm256_sub_ps(exp256_ps(_mm256_div_ps(x, alpha)),
+                                 _mm256_set1_ps(1.f)));
+        return _mm256_add_ps(_mm256_max_ps(x, zero),
+                             _mm256_min_ps(neg, zero));
+    }
+};
+
+struct activation_op_leaky_relu {
+    __m256 alpha;
+
+    __m256 operator()(__m256 x) const {
+        return select_negative(x, _mm256_mul_ps(alpha, x), x);
+    }
+};
+
+// 0.5 * y * (1 + erf(y / sqrt(2))) with y = alpha * x
+struct activation_op_gelu {
+    __m256 alpha;
+
+    __m256 operator()(__m256 x) const {
+        const auto y = _mm256_mul_ps(alpha, x);
+        const auto e =
+            erf256_ps(_mm256_mul_ps(y, _mm256_set1_ps(0.70710678118654752f)));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), y),
+                             _mm256_add_ps(_mm256_set1_ps(1.f), e));
+    }
+};
+
+struct activation_op_selu {
+    __m256 alpha;
+    __m256 gamma;
+
+    __m256 operator()(__m256 x) const {
+        const auto neg = _mm256_mul_ps(
+            gamma, _mm256_sub_ps(_mm256_mul_ps(alpha, exp256_ps(x)), alpha));
+        return _mm256_blendv_ps(
+            _mm256_mul_ps(x, gamma), neg,
+            _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LE_OQ));
+    }
+};
+
+struct activation_op_hard_sigmoid {
+    __m256 alpha;
+    __m256 gamma;
+
+    __m256 operator()(__m256 x) const {
+        return clamp01(_mm256_comp_fmadd_ps(x, alpha, gamma));
+    }
+};
+
+// The tail goes through the same vector code on a padded copy, so every
+// element is rounded the same way.
+template <class T, class Op>
+void activation_span(const T *input, T *output, size_t count, const Op &op) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        f32x8<T>::store(output + i, op(f32x8<T>::load(input + i)));
+    if (i < count) {
+        float tmp[8] = {};
+        for (size_t j = i; j < count; j++)
+            tmp[j - i] = (float)input[j];
+        _mm256_storeu_ps(tmp, op(_mm256_loadu_ps(tmp)));
+        for (size_t j = i; j < count; j++)
+            output[j] = narrow_from_f32<T>(tmp[j - i]);
+    }
+}
+
+template <class T, class Op>
+void activation_impl(const T *input, T *output, size_t count, const Op &op,
+                     kernel_context &context) {
+    for_each_block(
+        count,
+        [&](size_t begin, size_t end) {
+            activation_span(input + begin, output + begin, end - begin, op);
+        },
+        context);
+}
+
+template <class T>
+result<void> activation_impl(activation_op_t op, const T *input, T *output,
+                             size_t count, const T *alpha_mem,
+                             const T *gamma_mem, kernel_context &context) {
+    const auto alpha =
+        _mm256_set1_ps(alpha_mem ? static_cast<float>(*alpha_mem) : 0.f);
+    const auto gamma =
+        _mm256_set1_ps(gamma_mem ? static_cast<float>(*gamma_mem) : 0.f);
+#define ACTIVATION_IMPL(name, ...)                                             \
+    case activation_op_t::name:                                                \
+        activation_impl(input, output, count,                                  \
+                        activation_op_##name{__VA_ARGS__}, context);           \
+        return ok()
+
+    switch (op) {
+        ACTIVATION_IMPL(relu);
+        ACTIVATION_IMPL(softsign);
+        ACTIVATION_IMPL(softplus);
+        ACTIVATION_IMPL(sigmoid);
+        ACTIVATION_IMPL(swish);
+        ACTIVATION_IMPL(hard_swish);
+        ACTIVATION_IMPL(erf);
+        ACTIVATION_IMPL(elu, alpha);
+        ACTIVATION_IMPL(celu, alpha);
+        ACTIVATION_IMPL(leaky_relu, alpha);
+        ACTIVATION_IMPL(gelu, alpha);
+        ACTIVATION_IMPL(selu, alpha, gamma);
+        ACTIVATION_IMPL(hard_sigmoid, alpha, gamma);
+    default:
+        return err(std::errc::not_supported);
+    }
+#undef ACTIVATION_IMPL
+}
+
+/**
+ * prelu with the slope broadcast from the right. The slope may vary along
+ * one contiguous range of axes only; each run of `inner` elements then
+ * shares one slope, or, when the range is innermost, the slopes are loaded
+ * alongside the input.
+ */
+template <class T>
+result<void> prelu_impl(const T *input, const T *slope, T *output,
+                        gsl::span<const size_t> in_shape,
+                        gsl::span<const size_t> slope_shape,
+                        kernel_context &context) {
+    const auto rank = in_shape.size();
+    if (slope_shape.size() > rank)
+        return err(std::errc::not_supported);
+
+    const auto slope_dim = [&](size_t axis) -> size_t {
+        const auto offset = rank - slope_shape.size();
+        return axis < offset ? 1 : slope_shape[axis - offset];
+    };
+    size_t first = rank, last = 0;
+    for (size_t axis = 0; axis < rank; axis++) {
+        if (slope_dim(axis) != 1) {
+            first = std::min(first, axis);
+            last = axis;
+        }
+    }
+
+    const auto count = compute_size(in_shape);
+    if (first == rank) {
+        activation_impl(
+            input, output, count,
+            activation_op_leaky_relu{_mm256_set1_ps((float)slope[0])},
+            context);
+        return ok();
+    }
+
+    for (size_t axis = first; axis <= last; axis++) {
+        if (slope_dim(axis) != in_shape[axis])
+            return err(std::errc::not_supported);
+    }
+    size_t channels = 1, inner = 1;
+    for (size_t axis = first; axis <= last; axis++)
+        channels *= in_shape[axis];
+    for (size_t axis = last + 1; axis < rank; axis++)
+        inner *= in_shape[axis];
+    const auto outer = count / (channels * inner);
+
+    if (inner == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t o = 0; o < (int64_t)outer; o++) {
+            auto in = input + o * channels;
+            auto out = output + o * channels;
+            size_t c = 0;
+            for (; c + 8 <= channels; c += 8) {
+                const auto x = f32x8<T>::load(in + c);
+                const auto a = f32x8<T>::load(slope + c);
+                f32x8<T>::store(out + c,
+                                select_negative(x, _mm256_mul_ps(a, x), x));
+            }
+            for (; c < channels; c++) {
+                const auto x = (float)in[c];
+                out[c] = narrow_from_f32<T>(x < 0 ? (float)slope[c] * x : x);
+            }
+        }
+    } else {
+        const auto runs = (int64_t)(outer * channels);
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t r = 0; r < runs; r++) {
+            const auto alpha = _mm256_set1_ps((float)slope[r % channels]);
+            activation_span(input + r * inner, output + r * inner, inner,
+                            activation_op_leaky_relu{alpha});
+        }
+    }
+    return ok();
+}
+} // namespace
+
+#define FLOAT_TYPE_SELECT(typecode, KERNEL)                                    \
+    switch (typecode) {                                                        \
+    case dt_float32:                                                           \
+        return KERNEL(float);                                                  \
+    case dt_float16:                                                           \
+        return KERNEL(half);                                                   \
+    case dt_bfloat16:                                                          \
+        return KERNEL(bfloat16);                                               \
+    default:                                                                   \
+        return err(std::errc::not_supported);                                  \
+    }
+
+result<void> optimized::activation(activation_op_t op, typecode_t typecode,
+                                   const gsl::byte *input, gsl::byte *output,
+                                   size_t count, const gsl::byte *alpha,
+                                   const gsl::byte *gamma,
+                                   kernel_context &context) noexcept {
+#define ACTIVATION_KERNEL(T)                                                   \
+    activation_impl(op, IN_CAST(T, input), OUT_CAST(T, output), count,         \
+                    IN_CAST(T, alpha), IN_CAST(T, gamma), context)
+    FLOAT_TYPE_SELECT(typecode, ACTIVATION_KERNEL);
+#undef ACTIVATION_KERNEL
+}
+
+result<void> optimized::prelu(typecode_t typecode, const gsl::byte *input,
+                              const gsl::byte *slope, gsl::byte *output,
+                              gsl::span<const size_t> in_shape,
+                              gsl::span<const size_t> slope_shape,
+                              kernel_context &context) noexcept {
+#define PRELU_KERNEL(T)                                                        \
+    prelu_impl(IN_CAST(T, input), IN_CAST(T, slope), OUT_CAST(T, output),      \
+               in_shape, slope_shape, context)
+    FLOAT_TYPE_SELECT(typecode, PRELU_KERNEL);
+#undef PRELU_KERNEL
+}
@@ -0,0 +1,124 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "../opt_ops.h"
+#include <immintrin.h>
+#include <nncase/runtime/bfloat16.h>
+#include <nncase/runtime/half.h>
+#include <type_traits>
+
+BEGIN_NS_NNCASE_KERNELS_MODULE(stackvm)
+namespace optimized {
+// f32x8<half> depends on F16C, so each ISA build keeps its own copy.
+BEGIN_NS_NNCASE_KERNEL_ISA
+
+template <class T>
+constexpr bool is_half_float_v =
+    std::is_same_v<T, half> || std::is_same_v<T, bfloat16>;
+
+/**
+ * 8 elements of T widened to one __m256 of f32 and narrowed back on store,
+ * so kernels for half and bfloat16 compute in f32 registers and round once.
+ * Narrowing rounds to nearest even, which is what half(float) and
+ * bfloat16(float) do, so element-wise results match the reference.
+ */
+template <class T> struct f32x8;
+
+template <> struct f32x8<float> {
+    static __m256 load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+};
+
+template <> struct f32x8<half> {
+#if __F16C__
+    static __m256 load(const half *p) {
+        return _mm256_cvtph_ps(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    static void store(half *p, __m256 v) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p),
+                         _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+#else
+    static __m256 load(const half *p) {
+        float tmp[8];
+        for (size_t i = 0; i < 8; i++)
+            tmp[i] = p[i];
+        return _mm256_loadu_ps(tmp);
+    }
+
+    static void store(half *p, __m256 v) {
+        float tmp[8];
+        _mm256_storeu_ps(tmp, v);
+        for (size_t i = 0; i < 8; i++)
+            p[i] = half::round_to_half(tmp[i]);
+    }
+#endif
+};
+
+template <> struct f32x8<bfloat16> {
+#if __AVX2__
+    static __m256 load(const bfloat16 *p) {
+        const __m256i u = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(u, 16));
+    }
+
+    // add 0x7fff plus the lsb of the result, then NaN is forced to 0x7fc0
+    static void store(bfloat16 *p, __m256 v) {
+        const __m256i u = _mm256_castps_si256(v);
+        const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(u, 16),
+                                             _mm256_set1_epi32(1));
+        __m256i r = _mm256_srli_epi32(
+            _mm256_add_epi32(u, _mm256_add_epi32(_mm256_set1_epi32(0x7fff),
+                                                 lsb)),
+            16);
+        r = _mm256_blendv_epi8(
+            r, _mm256_set1_epi32(0x7fc0),
+            _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+        const __m128i packed = _mm_packus_epi32(
+            _mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), packed);
+    }
+#else
+    static __m256 load(const bfloat16 *p) {
+        float tmp[8];
+        for (size_t i = 0; i < 8; i++)
+            tmp[i] = p[i];
+        return _mm256_loadu_ps(tmp);
+    }
+
+    static void store(bfloat16 *p, __m256 v) {
+        float tmp[8];
+        _mm256_storeu_ps(tmp, v);
+        for (size_t i = 0; i < 8; i++)
+            p[i] = bfloat16::round_to_bfloat16(tmp[i]);
+    }
+#endif
+};
+
+template <class T> T narrow_from_f32(float v) {
+    if constexpr (std::is_same_v<T, half>)
+        return half::round_to_half(v);
+    else if constexpr (std::is_same_v<T, bfloat16>)
+        return bfloat16::round_to_bfloat16(v);
+    else
+        return (T)v;
+}
+
+END_NS_NNCASE_KERNEL_ISA
+} // namespace optimized
+END_NS_NNCASE_KERNELS_MODULE
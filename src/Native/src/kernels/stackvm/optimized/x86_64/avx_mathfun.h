@@ -244,6 +244,7 @@ AVX2_INTOP_USING_SSE2(andnot_si128)
 
 /* natural logarithm computed for 8 simultaneous float
    return NaN for x <= 0
+   max error 0.8 ulp over normal inputs
 */
 static CAN_FORCEINLINE __m256 log256_ps(__m256 x) {
     __m256i imm0;
@@ -321,6 +322,7 @@ _PS256_CONST(cephes_exp_p3, 4.1665795894E-2f);
 _PS256_CONST(cephes_exp_p4, 1.6666665459E-1f);
 _PS256_CONST(cephes_exp_p5, 5.0000001201E-1f);
 
+// max error 1 ulp for x in [-87, 88], inputs beyond are clamped
 static CAN_FORCEINLINE __m256 exp256_ps(__m256 x) {
     __m256 tmp = _mm256_setzero_ps(), fx;
     __m256i imm0;
@@ -386,7 +388,8 @@ _PS256_CONST(cephes_tanh_p7, 1.19825839466702e-06f);
 _PS256_CONST(cephes_tanh_p8, 1.18534705686654e-04f);
 _PS256_CONST(cephes_tanh_p9, 2.26843463243900e-03f);
 
-// an approximation of tanh
+// an approximation of tanh, max error 5.3 ulp with FMA and 6.5 ulp without
+// (3.9e-7 absolute)
 static inline __m256 tanh256_ps(const __m256 x) {
     __m256 value = x;
     value = _mm256_max_ps(*(__m256 *)_ps256_tanh_lo, value);
@@ -421,6 +424,55 @@ static inline __m256 tanh256_ps(const __m256 x) {
     return dst;
 }
 
+_PS256_CONST(erf_hi, 4.0f);
+_PS256_CONST(erf_lo, -4.0f);
+
+_PS256_CONST(erf_alpha_1, -1.60960333262415e-02f);
+_PS256_CONST(erf_alpha_3, -2.95459980854025e-03f);
+_PS256_CONST(erf_alpha_5, -7.34990630326855e-04f);
+_PS256_CONST(erf_alpha_7, -5.69250639462346e-05f);
+_PS256_CONST(erf_alpha_9, -2.10102402082508e-06f);
+_PS256_CONST(erf_alpha_11, 2.77068142495902e-08f);
+_PS256_CONST(erf_alpha_13, -2.72614225801306e-10f);
+
+_PS256_CONST(erf_beta_0, -1.42647390514189e-02f);
+_PS256_CONST(erf_beta_2, -7.37332916720468e-03f);
+_PS256_CONST(erf_beta_4, -1.68282697438203e-03f);
+_PS256_CONST(erf_beta_6, -2.13374055278905e-04f);
+_PS256_CONST(erf_beta_8, -1.45660718464996e-05f);
+
+/* rational approximation of erf, an odd degree 13 polynomial over an even
+   degree 8 one. erf(4) rounds to 1 in single precision so inputs are
+   clamped to [-4, 4]. max error 5.5 ulp with FMA and 7.1 ulp without
+   (4.2e-7 absolute)
+*/
+static inline __m256 erf256_ps(const __m256 x) {
+    __m256 value = x;
+    value = _mm256_max_ps(*(__m256 *)_ps256_erf_lo, value);
+    value = _mm256_min_ps(*(__m256 *)_ps256_erf_hi, value);
+
+    __m256 value_squared = _mm256_mul_ps(value, value);
+
+    __m256 p;
+    p = _mm256_comp_fmadd_ps(value_squared, *(__m256 *)_ps256_erf_alpha_13,
+                             *(__m256 *)_ps256_erf_alpha_11);
+    p = _mm256_comp_fmadd_ps(p, value_squared, *(__m256 *)_ps256_erf_alpha_9);
+    p = _mm256_comp_fmadd_ps(p, value_squared, *(__m256 *)_ps256_erf_alpha_7);
+    p = _mm256_comp_fmadd_ps(p, value_squared, *(__m256 *)_ps256_erf_alpha_5);
+    p = _mm256_comp_fmadd_ps(p, value_squared, *(__m256 *)_ps256_erf_alpha_3);
+    p = _mm256_comp_fmadd_ps(p, value_squared, *(__m256 *)_ps256_erf_alpha_1);
+    p = _mm256_mul_ps(p, value);
+
+    __m256 q;
+    q = _mm256_comp_fmadd_ps(value_squared, *(__m256 *)_ps256_erf_beta_8,
+                             *(__m256 *)_ps256_erf_beta_6);
+    q = _mm256_comp_fmadd_ps(q, value_squared, *(__m256 *)_ps256_erf_beta_4);
+    q = _mm256_comp_fmadd_ps(q, value_squared, *(__m256 *)_ps256_erf_beta_2);
+    q = _mm256_comp_fmadd_ps(q, value_squared, *(__m256 *)_ps256_erf_beta_0);
+
+    return _mm256_div_ps(p, q);
+}
+
 _PS256_CONST(minus_cephes_DP1, -0.78515625f);
 _PS256_CONST(minus_cephes_DP2, -2.4187564849853515625e-4f);
 _PS256_CONST(minus_cephes_DP3, -3.77489497744594108e-8f);
@@ -0,0 +1,472 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../reference/ref_ops.h"
+#include "../opt_common.h"
+#include "../opt_ops.h"
+#include "avx_half.h"
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#if __AVX__
+#include <immintrin.h>
+#endif
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+template <class T> struct avx_vec {
+    static constexpr bool enabled = false;
+};
+
+#if __AVX__
+template <> struct avx_vec<float> {
+    static constexpr bool enabled = true;
+    static constexpr size_t lanes = 8;
+    using type = __m256;
+    static type load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, type v) { _mm256_storeu_ps(p, v); }
+    static type set1(float v) { return _mm256_set1_ps(v); }
+};
+
+// half and bfloat16 are widened to f32 lanes and rounded once on store.
+template <class T> struct avx_half_vec {
+    static constexpr bool enabled = true;
+    static constexpr size_t lanes = 8;
+    using type = __m256;
+    static type load(const T *p) { return f32x8<T>::load(p); }
+    static void store(T *p, type v) { f32x8<T>::store(p, v); }
+    static type set1(T v) { return _mm256_set1_ps((float)v); }
+};
+
+template <> struct avx_vec<half> : avx_half_vec<half> {};
+template <> struct avx_vec<bfloat16> : avx_half_vec<bfloat16> {};
+#endif
+
+#if __AVX2__
+template <> struct avx_vec<int32_t> {
+    static constexpr bool enabled = true;
+    static constexpr size_t lanes = 8;
+    using type = __m256i;
+    static type load(const int32_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static void store(int32_t *p, type v) {
+        _mm256_storeu_si256((__m256i *)p, v);
+    }
+    static type set1(int32_t v) { return _mm256_set1_epi32(v); }
+};
+
+template <> struct avx_vec<int64_t> {
+    static constexpr bool enabled = true;
+    static constexpr size_t lanes = 4;
+    using type = __m256i;
+    static type load(const int64_t *p) {
+        return _mm256_loadu_si256((const __m256i *)p);
+    }
+    static void store(int64_t *p, type v) {
+        _mm256_storeu_si256((__m256i *)p, v);
+    }
+    static type set1(int64_t v) { return _mm256_set1_epi64x(v); }
+};
+#endif
+
+template <class T, class... Ts>
+constexpr bool is_any_of_v = (std::is_same_v<T, Ts> || ...);
+
+template <class T>
+constexpr bool is_float_lanes_v = is_any_of_v<T, float, half, bfloat16>;
+
+// Each op provides the scalar semantics of reference::binary and, for the
+// types listed in `vectorizable`, an 8/4-lane AVX body.
+struct binary_op_add {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled &&
+        (is_float_lanes_v<T> || is_any_of_v<T, int32_t, int64_t>);
+
+    template <class T> T operator()(T a, T b) const { return a + b; }
+
+    template <class T, class V> V pack(V a, V b) const {
+        if constexpr (is_float_lanes_v<T>)
+            return _mm256_add_ps(a, b);
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return _mm256_add_epi32(a, b);
+        else
+            return _mm256_add_epi64(a, b);
+    }
+};
+
+struct binary_op_sub {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled &&
+        (is_float_lanes_v<T> || is_any_of_v<T, int32_t, int64_t>);
+
+    template <class T> T operator()(T a, T b) const { return a - b; }
+
+    template <class T, class V> V pack(V a, V b) const {
+        if constexpr (is_float_lanes_v<T>)
+            return _mm256_sub_ps(a, b);
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return _mm256_sub_epi32(a, b);
+        else
+            return _mm256_sub_epi64(a, b);
+    }
+};
+
+struct binary_op_mul {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled &&
+        (is_float_lanes_v<T> || std::is_same_v<T, int32_t>);
+
+    template <class T> T operator()(T a, T b) const { return a * b; }
+
+    template <class T, class V> V pack(V a, V b) const {
+        if constexpr (is_float_lanes_v<T>)
+            return _mm256_mul_ps(a, b);
+        else
+            return _mm256_mullo_epi32(a, b);
+    }
+};
+
+struct binary_op_div {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled && is_float_lanes_v<T>;
+
+    template <class T> T operator()(T a, T b) const { return a / b; }
+
+    template <class T, class V> V pack(V a, V b) const {
+        return _mm256_div_ps(a, b);
+    }
+};
+
+// std::min(a, b) is (b < a ? b : a), which is what min_ps(b, a) computes,
+// so NaN propagation matches the reference as well.
+struct binary_op_min {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled &&
+        (is_float_lanes_v<T> || is_any_of_v<T, int32_t, int64_t>);
+
+    template <class T> T operator()(T a, T b) const { return std::min(a, b); }
+
+    template <class T, class V> V pack(V a, V b) const {
+        if constexpr (is_float_lanes_v<T>)
+            return _mm256_min_ps(b, a);
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return _mm256_min_epi32(a, b);
+        else
+            return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+    }
+};
+
+struct binary_op_max {
+    template <class T>
+    static constexpr bool vectorizable =
+        avx_vec<T>::enabled &&
+        (is_float_lanes_v<T> || is_any_of_v<T, int32_t, int64_t>);
+
+    template <class T> T operator()(T a, T b) const { return std::max(a, b); }
+
+    template <class T, class V> V pack(V a, V b) const {
+        if constexpr (is_float_lanes_v<T>)
+            return _mm256_max_ps(b, a);
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return _mm256_max_epi32(a, b);
+        else
+            return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+    }
+};
+
+struct binary_op_pow {
+    template <class T> static constexpr bool vectorizable = false;
+
+    template <class T> T operator()(T a, T b) const {
+        return (T)std::pow(a, b);
+    }
+
+    template <class T, class V> V pack(V a, V) const { return a; }
+};
+
+struct binary_op_mod {
+    template <class T> static constexpr bool vectorizable = false;
+
+    template <class T> T operator()(T a, T b) const {
+        return (T)std::fmod(a, b);
+    }
+
+    template <class T, class V> V pack(V a, V) const { return a; }
+};
+
+struct binary_op_logical_and {
+    template <class T> static constexpr bool vectorizable = false;
+
+    template <class T> T operator()(T a, T b) const {
+        return static_cast<T>(a && b);
+    }
+
+    template <class T, class V> V pack(V a, V) const { return a; }
+};
+
+// lhs[i] op rhs[i]
+template <class T, class TOp>
+void binary_vv(TOp &op, const T *lhs, const T *rhs, T *out, size_t n) {
+    size_t i = 0;
+    if constexpr (TOp::template vectorizable<T>) {
+        using vec = avx_vec<T>;
+        for (; i + vec::lanes <= n; i += vec::lanes)
+            vec::store(out + i, op.template pack<T>(vec::load(lhs + i),
+                                                    vec::load(rhs + i)));
+    }
+    for (; i < n; i++)
+        out[i] = op(lhs[i], rhs[i]);
+}
+
+// lhs[i] op rhs
+template <class T, class TOp>
+void binary_vs(TOp &op, const T *lhs, T rhs, T *out, size_t n) {
+    size_t i = 0;
+    if constexpr (TOp::template vectorizable<T>) {
+        using vec = avx_vec<T>;
+        const auto b = vec::set1(rhs);
+        for (; i + vec::lanes <= n; i += vec::lanes)
+            vec::store(out + i, op.template pack<T>(vec::load(lhs + i), b));
+    }
+    for (; i < n; i++)
+        out[i] = op(lhs[i], rhs);
+}
+
+// lhs op rhs[i]
+template <class T, class TOp>
+void binary_sv(TOp &op, T lhs, const T *rhs, T *out, size_t n) {
+    size_t i = 0;
+    if constexpr (TOp::template vectorizable<T>) {
+        using vec = avx_vec<T>;
+        const auto a = vec::set1(lhs);
+        for (; i + vec::lanes <= n; i += vec::lanes)
+            vec::store(out + i, op.template pack<T>(a, vec::load(rhs + i)));
+    }
+    for (; i < n; i++)
+        out[i] = op(lhs, rhs[i]);
+}
+
+/**
+ * Broadcast layout of a contiguous binary op.
+ *
+ * Output dims of extent 1 are dropped and neighbouring dims that broadcast
+ * the same inputs are coalesced, so every shape reduces to an inner run plus
+ * at most a few outer dims:
+ *   - same shape:        a single vv run
+ *   - scalar broadcast:  a single vs / sv run
+ *   - channel broadcast: e.g. [N,C,H,W] op [C,1,1] -> outer [N,C], vs run H*W
+ *   - last axis:         e.g. [N,C] op [C] -> outer [N], vv run C
+ *   - general:           any mix of the above across the outer dims
+ */
+struct binary_plan {
+    dims_t outer_shape;
+    strides_t lhs_outer_strides;
+    strides_t rhs_outer_strides;
+    size_t inner_size = 1;
+    bool lhs_inner_broadcast = false;
+    bool rhs_inner_broadcast = false;
+};
+
+binary_plan make_binary_plan(gsl::span<const size_t> lhs_shape,
+                             gsl::span<const size_t> rhs_shape,
+                             gsl::span<const size_t> out_shape) {
+    dims_t dims;
+    itlib::small_vector<std::pair<bool, bool>, 8> broadcasts;
+    const auto lhs_ext = out_shape.size() - lhs_shape.size();
+    const auto rhs_ext = out_shape.size() - rhs_shape.size();
+    for (size_t i = 0; i < out_shape.size(); i++) {
+        if (out_shape[i] == 1)
+            continue;
+        const bool lhs_b = i < lhs_ext || lhs_shape[i - lhs_ext] == 1;
+        const bool rhs_b = i < rhs_ext || rhs_shape[i - rhs_ext] == 1;
+        if (!dims.empty() && broadcasts.back() == std::make_pair(lhs_b, rhs_b))
+            dims.back() *= out_shape[i];
+        else {
+            dims.push_back(out_shape[i]);
+            broadcasts.emplace_back(lhs_b, rhs_b);
+        }
+    }
+
+    binary_plan plan;
+    if (dims.empty())
+        return plan;
+
+    plan.inner_size = dims.back();
+    plan.lhs_inner_broadcast = broadcasts.back().first;
+    plan.rhs_inner_broadcast = broadcasts.back().second;
+
+    const auto outer_rank = dims.size() - 1;
+    plan.outer_shape.assign(dims.begin(), dims.begin() + outer_rank);
+    plan.lhs_outer_strides.resize(outer_rank);
+    plan.rhs_outer_strides.resize(outer_rank);
+    size_t lhs_stride = plan.lhs_inner_broadcast ? 1 : plan.inner_size;
+    size_t rhs_stride = plan.rhs_inner_broadcast ? 1 : plan.inner_size;
+    for (size_t i = outer_rank; i-- > 0;) {
+        plan.lhs_outer_strides[i] = broadcasts[i].first ? 0 : lhs_stride;
+        plan.rhs_outer_strides[i] = broadcasts[i].second ? 0 : rhs_stride;
+        if (!broadcasts[i].first)
+            lhs_stride *= dims[i];
+        if (!broadcasts[i].second)
+            rhs_stride *= dims[i];
+    }
+    return plan;
+}
+
+template <class T, class TOp>
+void binary_run(TOp &op, const binary_plan &plan, const T *lhs, const T *rhs,
+                T *out, size_t begin, size_t end) {
+    const auto n = end - begin;
+    if (plan.lhs_inner_broadcast)
+        binary_sv(op, *lhs, rhs + begin, out + begin, n);
+    else if (plan.rhs_inner_broadcast)
+        binary_vs(op, lhs + begin, *rhs, out + begin, n);
+    else
+        binary_vv(op, lhs + begin, rhs + begin, out + begin, n);
+}
+
+template <class T, class TOp>
+result<void> binary_impl(const T *lhs, const T *rhs, T *out,
+                         gsl::span<const size_t> lhs_shape,
+                         gsl::span<const size_t> rhs_shape,
+                         gsl::span<const size_t> out_shape,
+                         NNCASE_UNUSED kernel_context &context) noexcept {
+    TOp op;
+    const auto plan = make_binary_plan(lhs_shape, rhs_shape, out_shape);
+    const auto outer_size = compute_size(plan.outer_shape);
+    if (outer_size == 0 || plan.inner_size == 0)
+        return ok();
+
+    const auto inner_blocks =
+        outer_size >= context.num_threads
+            ? 1
+            : (plan.inner_size + parallel_block - 1) / parallel_block;
+    const auto tasks = (int64_t)(outer_size * inner_blocks);
+    const auto block_size =
+        (plan.inner_size + inner_blocks - 1) / inner_blocks;
+    NNCASE_UNUSED const auto num_threads =
+        outer_size * plan.inner_size >= parallel_threshold
+            ? context.num_threads
+            : 1;
+
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif
+    for (int64_t task = 0; task < tasks; task++) {
+        auto outer = (size_t)task / inner_blocks;
+        const auto block = (size_t)task % inner_blocks;
+        const T *lhs_p = lhs;
+        const T *rhs_p = rhs;
+        T *out_p = out + outer * plan.inner_size;
+        for (size_t i = plan.outer_shape.size(); i-- > 0;) {
+            const auto index = outer % plan.outer_shape[i];
+            outer /= plan.outer_shape[i];
+            lhs_p += index * plan.lhs_outer_strides[i];
+            rhs_p += index * plan.rhs_outer_strides[i];
+        }
+
+        const auto begin = block * block_size;
+        const auto end = std::min(begin + block_size, plan.inner_size);
+        binary_run(op, plan, lhs_p, rhs_p, out_p, begin, end);
+    }
+    return ok();
+}
+
+#define BINARY_IMPL_OP(op, funct)                                              \
+    case binary_op_t::op:                                                      \
+        return binary_impl<T, funct>(lhs, rhs, out, lhs_shape, rhs_shape,      \
+                                     out_shape, context)
+
+template <class T>
+result<void> binary_impl(binary_op_t op, const T *lhs, const T *rhs, T *out,
+                         gsl::span<const size_t> lhs_shape,
+                         gsl::span<const size_t> rhs_shape,
+                         gsl::span<const size_t> out_shape,
+                         kernel_context &context) noexcept {
+    switch (op) {
+        BINARY_IMPL_OP(add, binary_op_add);
+        BINARY_IMPL_OP(sub, binary_op_sub);
+        BINARY_IMPL_OP(mul, binary_op_mul);
+        BINARY_IMPL_OP(div, binary_op_div);
+        BINARY_IMPL_OP(min, binary_op_min);
+        BINARY_IMPL_OP(max, binary_op_max);
+        BINARY_IMPL_OP(pow, binary_op_pow);
+        BINARY_IMPL_OP(mod, binary_op_mod);
+        BINARY_IMPL_OP(logical_and, binary_op_logical_and);
+    default:
+        return err(std::errc::not_supported);
+    }
+}
+
+#define BINARY_IMPL(_ty)                                                       \
+    return binary_impl(op, IN_CAST(_ty, lhs), IN_CAST(_ty, rhs),               \
+                       OUT_CAST(_ty, out), lhs_shape, rhs_shape, out_shape,    \
+                       context)
+} // namespace
+
+result<void> optimized::binary(
+    typecode_t typecode, runtime::stackvm::binary_op_t op, const gsl::byte *lhs,
+    const gsl::byte *rhs, gsl::byte *out, gsl::span<const size_t> lhs_shape,
+    gsl::span<const size_t> lhs_strides, gsl::span<const size_t> rhs_shape,
+    gsl::span<const size_t> rhs_strides, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> out_strides, kernel_context &context) noexcept {
+    if (is_contiguous(lhs_shape, lhs_strides) &&
+        is_contiguous(rhs_shape, rhs_strides) &&
+        is_contiguous(out_shape, out_strides)) {
+        switch (typecode) {
+        case dt_float32:
+            BINARY_IMPL(float);
+        case dt_float16:
+            BINARY_IMPL(half);
+        case dt_bfloat16:
+            BINARY_IMPL(bfloat16);
+        case dt_float64:
+            BINARY_IMPL(double);
+        case dt_int8:
+            BINARY_IMPL(int8_t);
+        case dt_int16:
+            BINARY_IMPL(int16_t);
+        case dt_int32:
+            BINARY_IMPL(int32_t);
+        case dt_int64:
+            BINARY_IMPL(int64_t);
+        case dt_uint8:
+            BINARY_IMPL(uint8_t);
+        case dt_uint16:
+            BINARY_IMPL(uint16_t);
+        case dt_uint32:
+            BINARY_IMPL(uint32_t);
+        case dt_uint64:
+            BINARY_IMPL(uint64_t);
+        default:
+            break;
+        }
+    }
+
+    return stackvm::reference::binary(typecode, op, lhs, rhs, out, lhs_shape,
+                                      lhs_strides, rhs_shape, rhs_strides,
+                                      out_shape, out_strides, context);
+}
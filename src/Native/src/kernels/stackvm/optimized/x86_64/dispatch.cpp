@@ -0,0 +1,438 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../opt_ops.h"
+#include <nncase/kernels/cpu_features.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+// Each ISA build defines the same entry points in its own namespace, see
+// BEGIN_NS_NNCASE_KERNEL_ISA in opt_ops.h.
+#define DECLARE_ISA_KERNELS(isa)                                               \
+    namespace nncase::kernels::stackvm::optimized::isa {                       \
+    decltype(optimized::activation) activation;                                \
+    decltype(optimized::batchnorm) batchnorm;                                  \
+    decltype(optimized::binary) binary;                                        \
+    decltype(optimized::cast) cast;                                            \
+    decltype(optimized::compare) compare;                                      \
+    decltype(optimized::cumsum) cumsum;                                        \
+    decltype(optimized::dequantize) dequantize;                                \
+    decltype(optimized::gather_elements) gather_elements;                      \
+    decltype(optimized::grid_sample) grid_sample;                              \
+    decltype(optimized::instance_norm) instance_norm;                          \
+    decltype(optimized::layer_norm) layer_norm;                                \
+    decltype(optimized::log_softmax) log_softmax;                              \
+    decltype(optimized::lp_normalization) lp_normalization;                    \
+    decltype(optimized::lrn) lrn;                                              \
+    decltype(optimized::lstm) lstm;                                            \
+    decltype(optimized::matmul) matmul;                                        \
+    decltype(optimized::prelu) prelu;                                          \
+    decltype(optimized::quantize) quantize;                                    \
+    decltype(optimized::quantized_conv2d) quantized_conv2d;                    \
+    decltype(optimized::quantized_matmul) quantized_matmul;                    \
+    decltype(optimized::random_normal) random_normal;                          \
+    decltype(optimized::random_uniform) random_uniform;                        \
+    decltype(optimized::reduce) reduce;                                        \
+    decltype(optimized::reduce_arg) reduce_arg;                                \
+    decltype(optimized::reduce_window2d) reduce_window2d;                      \
+    decltype(optimized::resize_bilinear) resize_bilinear;                      \
+    decltype(optimized::resize_nearest_neighbor) resize_nearest_neighbor;      \
+    decltype(optimized::softmax) softmax;                                      \
+    decltype(optimized::topk) topk;                                            \
+    decltype(optimized::transpose) transpose;                                  \
+    decltype(optimized::unary) unary;                                          \
+    decltype(optimized::where) where;                                          \
+    }
+
+DECLARE_ISA_KERNELS(generic)
+DECLARE_ISA_KERNELS(sse4_2)
+DECLARE_ISA_KERNELS(avx2)
+DECLARE_ISA_KERNELS(avx512)
+DECLARE_ISA_KERNELS(avx512_vnni)
+DECLARE_ISA_KERNELS(avx512_bf16)
+
+#define DISPATCH_ISA_KERNEL(name, ...)                                         \
+    switch (kernel_isa()) {                                                    \
+    case cpu_isa_t::avx512_bf16:                                               \
+        return avx512_bf16::name(__VA_ARGS__);                                 \
+    case cpu_isa_t::avx512_vnni:                                               \
+        return avx512_vnni::name(__VA_ARGS__);                                 \
+    case cpu_isa_t::avx512:                                                    \
+        return avx512::name(__VA_ARGS__);                                      \
+    case cpu_isa_t::avx2:                                                      \
+        return avx2::name(__VA_ARGS__);                                        \
+    case cpu_isa_t::sse4_2:                                                    \
+        return sse4_2::name(__VA_ARGS__);                                      \
+    default:                                                                   \
+        return generic::name(__VA_ARGS__);                                     \
+    }
+
+result<void> optimized::activation(activation_op_t op, typecode_t typecode,
+                                   const gsl::byte *input, gsl::byte *output,
+                                   size_t count, const gsl::byte *alpha,
+                                   const gsl::byte *gamma,
+                                   kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(activation, op, typecode, input, output, count, alpha,
+                        gamma, context);
+}
+
+result<void> optimized::batchnorm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+    const gsl::byte *bias, const gsl::byte *input_mean,
+    const gsl::byte *input_var, gsl::byte *output,
+    gsl::span<const size_t> in_shape, float epsilon,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(batchnorm, typecode, input, scale, bias, input_mean,
+                        input_var, output, in_shape, epsilon, context);
+}
+
+result<void> optimized::binary(
+    typecode_t typecode, runtime::stackvm::binary_op_t op,
+    const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
+    gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
+    gsl::span<const size_t> rhs_shape, gsl::span<const size_t> rhs_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(binary, typecode, op, lhs, rhs, output, lhs_shape,
+                        lhs_strides, rhs_shape, rhs_strides, out_shape,
+                        out_strides, context);
+}
+
+result<void> optimized::cast(datatype_t in_type, datatype_t out_type,
+                             const gsl::byte *input, gsl::byte *output,
+                             gsl::span<const size_t> in_shape,
+                             gsl::span<const size_t> in_strides,
+                             gsl::span<const size_t> out_strides,
+                             kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(cast, in_type, out_type, input, output, in_shape,
+                        in_strides, out_strides, context);
+}
+
+result<void> optimized::compare(
+    typecode_t typecode, runtime::stackvm::compare_op_t op,
+    const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
+    gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
+    gsl::span<const size_t> rhs_shape, gsl::span<const size_t> rhs_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(compare, typecode, op, lhs, rhs, output, lhs_shape,
+                        lhs_strides, rhs_shape, rhs_strides, out_shape,
+                        out_strides, context);
+}
+
+result<void> optimized::cumsum(typecode_t typecode, const gsl::byte *input,
+                               gsl::byte *output,
+                               gsl::span<const size_t> in_shape, size_t axis,
+                               bool exclusive, bool reverse,
+                               kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(cumsum, typecode, input, output, in_shape, axis,
+                        exclusive, reverse, context);
+}
+
+result<void> optimized::dequantize(datatype_t in_type, datatype_t out_type,
+                                   const gsl::byte *input, gsl::byte *output,
+                                   gsl::span<const size_t> in_shape,
+                                   gsl::span<const size_t> in_strides,
+                                   gsl::span<const size_t> out_strides,
+                                   float scale, float bias,
+                                   kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(dequantize, in_type, out_type, input, output, in_shape,
+                        in_strides, out_strides, scale, bias, context);
+}
+
+result<void> optimized::gather_elements(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    datatype_t indices_type, const gsl::byte *indices,
+    gsl::span<const size_t> indices_shape, size_t axis,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(gather_elements, type, input, output, in_shape,
+                        out_shape, in_strides, out_strides, indices_type,
+                        indices, indices_shape, axis, context);
+}
+
+result<void> optimized::grid_sample(
+    typecode_t type, const gsl::byte *input, const gsl::byte *grid,
+    gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> grid_shape,
+    gsl::span<const size_t> grid_strides, gsl::span<const size_t> out_strides,
+    runtime::stackvm::grid_sample_align_corners_t align_corners,
+    runtime::stackvm::grid_sample_mode_t mode,
+    runtime::stackvm::grid_sample_padding_mode_t padding_mode,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(grid_sample, type, input, grid, output, in_shape,
+                        in_strides, grid_shape, grid_strides, out_strides,
+                        align_corners, mode, padding_mode, context);
+}
+
+result<void> optimized::instance_norm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
+    const gsl::byte *bias, gsl::byte *output, gsl::span<const size_t> in_shape,
+    float epsilon, kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(instance_norm, typecode, input, scale, bias, output,
+                        in_shape, epsilon, context);
+}
+
+result<void> optimized::layer_norm(typecode_t typecode, const gsl::byte *input,
+                                   gsl::byte *output, const gsl::byte *scale,
+                                   const gsl::byte *bias,
+                                   gsl::span<const size_t> in_shape,
+                                   int32_t axis, float epsilon, bool use_mean,
+                                   bool channel_first,
+                                   kernel_context &context) {
+    DISPATCH_ISA_KERNEL(layer_norm, typecode, input, output, scale, bias,
+                        in_shape, axis, epsilon, use_mean, channel_first,
+                        context);
+}
+
+result<void> optimized::log_softmax(typecode_t typecode, const gsl::byte *input,
+                                    gsl::byte *output,
+                                    gsl::span<const size_t> in_shape,
+                                    gsl::span<const size_t> in_strides,
+                                    gsl::span<const size_t> out_strides,
+                                    int32_t axis,
+                                    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(log_softmax, typecode, input, output, in_shape,
+                        in_strides, out_strides, axis, context);
+}
+
+result<void> optimized::lp_normalization(typecode_t typecode,
+                                         const gsl::byte *input,
+                                         gsl::byte *output,
+                                         gsl::span<const size_t> in_shape,
+                                         size_t axis, int64_t p,
+                                         kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(lp_normalization, typecode, input, output, in_shape,
+                        axis, p, context);
+}
+
+result<void> optimized::lrn(typecode_t typecode, const gsl::byte *input,
+                            float alpha, float beta, float bias, int size,
+                            gsl::byte *output,
+                            gsl::span<const size_t> in_shape,
+                            kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(lrn, typecode, input, alpha, beta, bias, size, output,
+                        in_shape, context);
+}
+
+result<void> optimized::lstm(
+    typecode_t typecode, const gsl::byte *input, const gsl::byte *w_xc,
+    const gsl::byte *w_rc, const gsl::byte *bias, const gsl::byte *init_h,
+    const gsl::byte *init_c, gsl::byte *output, gsl::byte *output_h,
+    gsl::byte *output_c, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> w_xc_shape, gsl::span<const size_t> w_rc_shape,
+    lstmdirection_t direction, kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(lstm, typecode, input, w_xc, w_rc, bias, init_h,
+                        init_c, output, output_h, output_c, in_shape,
+                        w_xc_shape, w_rc_shape, direction, context);
+}
+
+result<void> optimized::matmul(typecode_t typecode, const gsl::byte *input_a,
+                               const gsl::byte *input_b, gsl::byte *output,
+                               gsl::span<const size_t> in_a_shape,
+                               gsl::span<const size_t> in_b_shape,
+                               kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(matmul, typecode, input_a, input_b, output, in_a_shape,
+                        in_b_shape, context);
+}
+
+result<void> optimized::prelu(typecode_t typecode, const gsl::byte *input,
+                              const gsl::byte *slope, gsl::byte *output,
+                              gsl::span<const size_t> in_shape,
+                              gsl::span<const size_t> slope_shape,
+                              kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(prelu, typecode, input, slope, output, in_shape,
+                        slope_shape, context);
+}
+
+result<void> optimized::quantize(datatype_t in_type, datatype_t out_type,
+                                 const gsl::byte *input, gsl::byte *output,
+                                 gsl::span<const size_t> in_shape,
+                                 gsl::span<const size_t> in_strides,
+                                 gsl::span<const size_t> out_strides,
+                                 float scale, float bias,
+                                 kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(quantize, in_type, out_type, input, output, in_shape,
+                        in_strides, out_strides, scale, bias, context);
+}
+
+result<void> optimized::quantized_conv2d(
+    datatype_t out_type, const uint8_t *input, const int8_t *weights,
+    const int32_t *bias, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> w_shape, const padding &padding_h,
+    const padding &padding_w, int32_t groups, int32_t stride_h,
+    int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
+    int32_t input_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(quantized_conv2d, out_type, input, weights, bias,
+                        output, in_shape, w_shape, padding_h, padding_w,
+                        groups, stride_h, stride_w, dilation_h, dilation_w,
+                        input_zero_point, out_scales, out_zero_point,
+                        out_range, context);
+}
+
+result<void> optimized::quantized_matmul(
+    datatype_t out_type, const uint8_t *lhs, const int8_t *rhs,
+    const int32_t *bias, gsl::byte *output, size_t m, size_t n, size_t k,
+    int32_t lhs_zero_point, gsl::span<const float> out_scales,
+    int32_t out_zero_point, value_range<int32_t> out_range,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(quantized_matmul, out_type, lhs, rhs, bias, output, m,
+                        n, k, lhs_zero_point, out_scales, out_zero_point,
+                        out_range, context);
+}
+
+result<void> optimized::random_normal(typecode_t type, gsl::byte *output,
+                                      gsl::span<const size_t> out_shape,
+                                      float mean, float std, float seed,
+                                      kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(random_normal, type, output, out_shape, mean, std,
+                        seed, context);
+}
+
+result<void> optimized::random_uniform(typecode_t type, gsl::byte *output,
+                                       gsl::span<const size_t> out_shape,
+                                       float low, float high, float seed,
+                                       kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(random_uniform, type, output, out_shape, low, high,
+                        seed, context);
+}
+
+result<void> optimized::reduce(
+    typecode_t typecode, nncase::runtime::stackvm::reduce_op_t op,
+    const gsl::byte *init_value, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> axis,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    bool keep_dims, kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(reduce, typecode, op, init_value, input, output,
+                        in_shape, axis, in_strides, out_strides, keep_dims,
+                        context);
+}
+
+result<void> optimized::reduce_arg(
+    typecode_t input_typecode, typecode_t output_typecode, reduce_arg_op_t op,
+    const gsl::byte *input, gsl::byte *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    gsl::span<const size_t> axes, bool keep_dims, bool select_last_idx,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(reduce_arg, input_typecode, output_typecode, op, input,
+                        output, in_shape, in_strides, out_strides, axes,
+                        keep_dims, select_last_idx, context);
+}
+
+result<void> optimized::reduce_window2d(
+    nncase::runtime::stackvm::reduce_op_t op, const float *input,
+    float init_value, float *output, gsl::span<const size_t> in_shape,
+    const padding &padding_h, const padding &padding_w, int32_t filter_h,
+    int32_t filter_w, int32_t stride_h, int32_t stride_w, int32_t dilation_h,
+    int32_t dilation_w, value_range<float> fused_activation,
+    bool count_include_pad, kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(reduce_window2d, op, input, init_value, output,
+                        in_shape, padding_h, padding_w, filter_h, filter_w,
+                        stride_h, stride_w, dilation_h, dilation_w,
+                        fused_activation, count_include_pad, context);
+}
+
+result<void> optimized::resize_bilinear(
+    typecode_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, int32_t out_h, int32_t out_w,
+    bool align_corners, bool half_pixel_centers,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(resize_bilinear, type, input, output, in_shape,
+                        in_strides, out_strides, out_h, out_w, align_corners,
+                        half_pixel_centers, context);
+}
+
+result<void> optimized::resize_nearest_neighbor(
+    typecode_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, int32_t out_h, int32_t out_w,
+    bool align_corners, bool half_pixel_centers,
+    get_coordinate_func_t get_coordinate_func,
+    get_nearest_pixel_func_t get_nearset_func,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(resize_nearest_neighbor, type, input, output, in_shape,
+                        in_strides, out_strides, out_h, out_w, align_corners,
+                        half_pixel_centers, get_coordinate_func,
+                        get_nearset_func, context);
+}
+
+result<void> optimized::softmax(typecode_t typecode, const gsl::byte *input,
+                                gsl::byte *output,
+                                gsl::span<const size_t> in_shape,
+                                gsl::span<const size_t> in_strides,
+                                gsl::span<const size_t> out_strides,
+                                int32_t axis, float beta,
+                                kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(softmax, typecode, input, output, in_shape, in_strides,
+                        out_strides, axis, beta, context);
+}
+
+result<void> optimized::topk(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output_values,
+    int64_t *output_indices, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> output_values_shape,
+    gsl::span<const size_t> output_values_strides,
+    gsl::span<const size_t> output_indices_shape,
+    gsl::span<const size_t> output_indices_strides, const int64_t k,
+    const int32_t axis, const bool largest, const bool sorted,
+    kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(topk, typecode, input, output_values, output_indices,
+                        in_shape, in_strides, output_values_shape,
+                        output_values_strides, output_indices_shape,
+                        output_indices_strides, k, axis, largest, sorted,
+                        context);
+}
+
+result<void> optimized::transpose(datatype_t type, const gsl::byte *src,
+                                  gsl::byte *dest, const dims_t &in_shape,
+                                  const dims_t &perm,
+                                  const strides_t &in_strides,
+                                  const strides_t &out_strides,
+                                  kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(transpose, type, src, dest, in_shape, perm, in_strides,
+                        out_strides, context);
+}
+
+result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
+                              const gsl::byte *in, gsl::byte *out,
+                              gsl::span<const size_t> shape,
+                              gsl::span<const size_t> in_strides,
+                              gsl::span<const size_t> out_shape,
+                              gsl::span<const size_t> out_strides,
+                              kernel_context &context) noexcept {
+    DISPATCH_ISA_KERNEL(unary, dtype, op, in, out, shape, in_strides, out_shape,
+                        out_strides, context);
+}
+
+result<void> optimized::where(
+    datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
+    gsl::byte *output, gsl::span<const size_t> cond_shape,
+    gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
+    gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
+    gsl::span<const size_t> out_strides, kernel_context &context) {
+    DISPATCH_ISA_KERNEL(where, dt, cond, x, y, output, cond_shape, x_shape,
+                        y_shape, out_shape, cond_strides, x_strides, y_strides,
+                        out_strides, context);
+}
@@ -0,0 +1,206 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../reference/ref_ops.h"
+#include "../opt_common.h"
+#include "../opt_ops.h"
+#include "avx_mathfun.h"
+#include <cmath>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Normalizes one contiguous row of n elements in two passes over the input:
+// mean, then variance around the mean (mean is 0 when !use_mean), followed
+// by the scale/bias pass.
+void layer_norm_row(const float *input, float *output, const float *scale,
+                    const float *bias, size_t n, float epsilon,
+                    bool use_mean) {
+    size_t i = 0;
+    float mean = 0.f;
+    if (use_mean) {
+        __m256 vsum = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8)
+            vsum = _mm256_add_ps(vsum, _mm256_loadu_ps(input + i));
+        float sum = _mm256_reduce_add_ps(vsum);
+        for (; i < n; i++)
+            sum += input[i];
+        mean = sum / n;
+    }
+
+    const __m256 vmean = _mm256_set1_ps(mean);
+    __m256 vsum2 = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= n; i += 8) {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(input + i), vmean);
+        vsum2 = _mm256_comp_fmadd_ps(d, d, vsum2);
+    }
+    float sum2 = _mm256_reduce_add_ps(vsum2);
+    for (; i < n; i++)
+        sum2 += (input[i] - mean) * (input[i] - mean);
+
+    const float rstd = 1.f / std::sqrt(sum2 / n + epsilon);
+    const __m256 vrstd = _mm256_set1_ps(rstd);
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_sub_ps(_mm256_loadu_ps(input + i), vmean);
+        v = _mm256_mul_ps(_mm256_mul_ps(v, vrstd), _mm256_loadu_ps(scale + i));
+        _mm256_storeu_ps(output + i,
+                         _mm256_add_ps(v, _mm256_loadu_ps(bias + i)));
+    }
+    for (; i < n; i++)
+        output[i] = (input[i] - mean) * rstd * scale[i] + bias[i];
+}
+
+// Channel first: normalizes over n channels strided by inner_size, for 8
+// adjacent inner positions at once.
+void layer_norm_columns8(const float *input, float *output, const float *scale,
+                         const float *bias, size_t n, size_t inner_size,
+                         float epsilon, bool use_mean) {
+    const __m256 vn = _mm256_set1_ps((float)n);
+    __m256 vmean = _mm256_setzero_ps();
+    if (use_mean) {
+        for (size_t c = 0; c < n; c++)
+            vmean =
+                _mm256_add_ps(vmean, _mm256_loadu_ps(input + c * inner_size));
+        vmean = _mm256_div_ps(vmean, vn);
+    }
+
+    __m256 vsum2 = _mm256_setzero_ps();
+    for (size_t c = 0; c < n; c++) {
+        const __m256 d =
+            _mm256_sub_ps(_mm256_loadu_ps(input + c * inner_size), vmean);
+        vsum2 = _mm256_comp_fmadd_ps(d, d, vsum2);
+    }
+    const __m256 vrstd = _mm256_div_ps(
+        _mm256_set1_ps(1.f),
+        _mm256_sqrt_ps(_mm256_add_ps(_mm256_div_ps(vsum2, vn),
+                                     _mm256_set1_ps(epsilon))));
+
+    for (size_t c = 0; c < n; c++) {
+        __m256 v =
+            _mm256_sub_ps(_mm256_loadu_ps(input + c * inner_size), vmean);
+        v = _mm256_mul_ps(_mm256_mul_ps(v, vrstd), _mm256_set1_ps(scale[c]));
+        _mm256_storeu_ps(output + c * inner_size,
+                         _mm256_add_ps(v, _mm256_set1_ps(bias[c])));
+    }
+}
+
+void layer_norm_column(const float *input, float *output, const float *scale,
+                       const float *bias, size_t n, size_t inner_size,
+                       float epsilon, bool use_mean) {
+    float mean = 0.f;
+    if (use_mean) {
+        for (size_t c = 0; c < n; c++)
+            mean += input[c * inner_size];
+        mean /= n;
+    }
+
+    float sum2 = 0.f;
+    for (size_t c = 0; c < n; c++) {
+        const auto d = input[c * inner_size] - mean;
+        sum2 += d * d;
+    }
+
+    const float rstd = 1.f / std::sqrt(sum2 / n + epsilon);
+    for (size_t c = 0; c < n; c++)
+        output[c * inner_size] =
+            (input[c * inner_size] - mean) * rstd * scale[c] + bias[c];
+}
+
+result<void> layer_norm_impl(const float *input, float *output,
+                             const float *scale, const float *bias,
+                             gsl::span<const size_t> in_shape, size_t axis,
+                             float epsilon, bool use_mean, bool channel_first,
+                             NNCASE_UNUSED kernel_context &context) {
+    size_t outer_size = 1;
+    for (size_t i = 0; i < axis; i++)
+        outer_size *= in_shape[i];
+
+    if (channel_first && axis != in_shape.size() - 1) {
+        const auto channels = in_shape[axis];
+        size_t inner_size = 1;
+        for (size_t i = axis + 1; i < in_shape.size(); i++)
+            inner_size *= in_shape[i];
+        if (outer_size == 0 || channels == 0 || inner_size == 0)
+            return ok();
+
+        // one task per (outer, 8 inner lanes); the inner tail is scalar
+        const auto blocks = (inner_size + 7) / 8;
+        NNCASE_UNUSED const auto threads =
+            outer_size * channels * inner_size < parallel_threshold
+                ? 1
+                : context.num_threads;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+        for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+            const auto i = (size_t)t / blocks;
+            const auto j = ((size_t)t % blocks) * 8;
+            auto in_ = input + i * channels * inner_size + j;
+            auto out_ = output + i * channels * inner_size + j;
+            if (j + 8 <= inner_size) {
+                layer_norm_columns8(in_, out_, scale, bias, channels,
+                                    inner_size, epsilon, use_mean);
+            } else {
+                for (size_t jj = 0; jj < inner_size - j; jj++)
+                    layer_norm_column(in_ + jj, out_ + jj, scale, bias,
+                                      channels, inner_size, epsilon, use_mean);
+            }
+        }
+        return ok();
+    }
+
+    size_t norm_size = 1;
+    for (size_t i = axis; i < in_shape.size(); i++)
+        norm_size *= in_shape[i];
+    if (outer_size == 0 || norm_size == 0)
+        return ok();
+
+    NNCASE_UNUSED const auto threads =
+        outer_size * norm_size < parallel_threshold ? 1 : context.num_threads;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+    for (int64_t i = 0; i < (int64_t)outer_size; i++)
+        layer_norm_row(input + i * norm_size, output + i * norm_size, scale,
+                       bias, norm_size, epsilon, use_mean);
+    return ok();
+}
+} // namespace
+
+result<void> nncase::kernels::stackvm::optimized::layer_norm(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *scale, const gsl::byte *bias,
+    gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+    bool use_mean, bool channel_first, kernel_context &context) {
+    if (typecode == dt_float32 && !in_shape.empty()) {
+        const auto positive_axis =
+            (size_t)(axis < 0 ? (int32_t)in_shape.size() + axis : axis);
+        return layer_norm_impl(reinterpret_cast<const float *>(input),
+                               reinterpret_cast<float *>(output),
+                               reinterpret_cast<const float *>(scale),
+                               reinterpret_cast<const float *>(bias), in_shape,
+                               positive_axis, epsilon, use_mean, channel_first,
+                               context);
+    }
+
+    return reference::layer_norm(typecode, input, output, scale, bias, in_shape,
+                                 axis, epsilon, use_mean, channel_first);
+}
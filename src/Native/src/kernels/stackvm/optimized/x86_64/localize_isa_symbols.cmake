@@ -0,0 +1,98 @@
+# Compiler launcher for the per-ISA kernel objects (see CMakeLists.txt):
+#   cmake -DISA=<level> -DNM=<nm> -DOBJCOPY=<objcopy> -P localize_isa_symbols.cmake -- <compiler command>
+#
+# The -- keeps cmake from reading the -D options of the compile command.
+#
+# Runs the compiler, then renames every weak function the object defines
+# outside nncase::kernels::stackvm::optimized::<level> (and the COMDAT
+# groups and vtables that carry them) to <name>.nncase_<level>. These are
+# the inline functions and template instantiations of shared headers such
+# as std::vector or dims_t, compiled with the level's -m flags. Unrenamed,
+# the linker keeps one copy of each for the whole library, which may be the
+# AVX-512 one even for callers in baseline code. Renamed, objects of one
+# level still share their copies and every other object uses its own.
+#
+# Finally checks that no weak code symbol outside the level's namespace is
+# left for other objects to bind to.
+
+set(command)
+set(object)
+set(in_command FALSE)
+math(EXPR last "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last})
+    set(arg "${CMAKE_ARGV${i}}")
+    if(in_command)
+        if(previous STREQUAL "-o")
+            set(object "${arg}")
+        endif()
+        list(APPEND command "${arg}")
+        set(previous "${arg}")
+    elseif(arg STREQUAL "--")
+        set(in_command TRUE)
+    endif()
+endforeach()
+
+execute_process(COMMAND ${command} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "compiling for ${ISA} failed")
+endif()
+if(NOT object)
+    message(FATAL_ERROR "no -o <object> in the ${ISA} compile command")
+endif()
+
+string(LENGTH "${ISA}" isa_length)
+set(namespace "9optimized${isa_length}${ISA}")
+set(suffix ".nncase_${ISA}")
+
+# Weak functions (W), COMDAT group signatures that are not symbols of their
+# own (n) and vtables (V) carry code compiled for this level; other weak
+# data does not.
+function(_shared_code_symbols object out)
+    execute_process(COMMAND ${NM} -P "${object}"
+                    OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NM} failed on ${object}")
+    endif()
+    string(REGEX MATCHALL "[^\n]+" lines "${symbols}")
+    set(names)
+    foreach(line ${lines})
+        if(line MATCHES "^([^ ]+) ([A-Za-z])")
+            set(name "${CMAKE_MATCH_1}")
+            set(type "${CMAKE_MATCH_2}")
+            string(FIND "${name}" "${namespace}" in_namespace)
+            if(in_namespace EQUAL -1 AND NOT name MATCHES "\\.nncase_"
+               AND (type STREQUAL "W"
+                    OR (type STREQUAL "n" AND name MATCHES "^_Z")
+                    OR (type STREQUAL "V" AND name MATCHES "^_ZT[VTC]")))
+                list(APPEND names "${name}")
+            endif()
+        endif()
+    endforeach()
+    list(REMOVE_DUPLICATES names)
+    set(${out} "${names}" PARENT_SCOPE)
+endfunction()
+
+_shared_code_symbols("${object}" names)
+if(names)
+    set(map)
+    foreach(name ${names})
+        string(APPEND map "${name} ${name}${suffix}\n")
+    endforeach()
+    file(WRITE "${object}.symbols" "${map}")
+    execute_process(COMMAND ${OBJCOPY} "--redefine-syms=${object}.symbols"
+                            "${object}"
+                    RESULT_VARIABLE result)
+    file(REMOVE "${object}.symbols")
+    if(NOT result EQUAL 0)
+        file(REMOVE "${object}")
+        message(FATAL_ERROR "${OBJCOPY} failed on ${object}")
+    endif()
+endif()
+
+_shared_code_symbols("${object}" leaked)
+if(leaked)
+    file(REMOVE "${object}")
+    string(REPLACE ";" "\n    " leaked "${leaked}")
+    message(FATAL_ERROR "${object} exports ${ISA} code outside its kernel "
+                        "namespace:\n    ${leaked}")
+endif()
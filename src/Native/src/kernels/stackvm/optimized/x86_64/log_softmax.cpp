@@ -0,0 +1,161 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../reference/ref_ops.h"
+#include "../opt_ops.h"
+#include "avx_mathfun.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// log_softmax(x) = x - max - log(sum(exp(x - max))) over one contiguous row.
+// pass 1: reduce_max, pass 2: sum of exp(x - max), then one write pass.
+void log_softmax_row(const float *input, float *output, size_t n) {
+    size_t i = 0;
+    float max_value = std::numeric_limits<float>::lowest();
+    if (n >= 8) {
+        __m256 vmax = _mm256_loadu_ps(input);
+        for (i = 8; i + 8 <= n; i += 8)
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(input + i));
+        max_value = _mm256_reduce_max_ps(vmax);
+    }
+    for (; i < n; i++)
+        max_value = std::max(max_value, input[i]);
+
+    const __m256 vmax = _mm256_set1_ps(max_value);
+    __m256 vsum = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= n; i += 8)
+        vsum = _mm256_add_ps(
+            vsum, exp256_ps(_mm256_sub_ps(_mm256_loadu_ps(input + i), vmax)));
+    float sum = _mm256_reduce_add_ps(vsum);
+    for (; i < n; i++)
+        sum += expf(input[i] - max_value);
+
+    const float bias = max_value + logf(sum);
+    const __m256 vbias = _mm256_set1_ps(bias);
+    for (i = 0; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(output + i,
+                         _mm256_sub_ps(_mm256_loadu_ps(input + i), vbias));
+    for (; i < n; i++)
+        output[i] = input[i] - bias;
+}
+
+// log_softmax over axis_size elements strided by inner_size, for 8 adjacent
+// inner positions at once.
+void log_softmax_columns8(const float *input, float *output, size_t axis_size,
+                          size_t inner_size) {
+    __m256 vmax = _mm256_loadu_ps(input);
+    for (size_t k = 1; k < axis_size; k++)
+        vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(input + k * inner_size));
+
+    __m256 vsum = _mm256_setzero_ps();
+    for (size_t k = 0; k < axis_size; k++)
+        vsum = _mm256_add_ps(
+            vsum, exp256_ps(_mm256_sub_ps(
+                      _mm256_loadu_ps(input + k * inner_size), vmax)));
+
+    const __m256 vbias = _mm256_add_ps(vmax, log256_ps(vsum));
+    for (size_t k = 0; k < axis_size; k++)
+        _mm256_storeu_ps(
+            output + k * inner_size,
+            _mm256_sub_ps(_mm256_loadu_ps(input + k * inner_size), vbias));
+}
+
+void log_softmax_column(const float *input, float *output, size_t axis_size,
+                        size_t inner_size) {
+    float max_value = input[0];
+    for (size_t k = 1; k < axis_size; k++)
+        max_value = std::max(max_value, input[k * inner_size]);
+
+    float sum = 0.f;
+    for (size_t k = 0; k < axis_size; k++)
+        sum += expf(input[k * inner_size] - max_value);
+
+    const float bias = max_value + logf(sum);
+    for (size_t k = 0; k < axis_size; k++)
+        output[k * inner_size] = input[k * inner_size] - bias;
+}
+
+result<void> log_softmax_impl(const float *input, float *output,
+                              gsl::span<const size_t> in_shape, size_t axis,
+                              NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto axis_size = in_shape[axis];
+    size_t outer_size = 1;
+    for (size_t i = 0; i < axis; i++)
+        outer_size *= in_shape[i];
+    size_t inner_size = 1;
+    for (size_t i = axis + 1; i < in_shape.size(); i++)
+        inner_size *= in_shape[i];
+    if (outer_size == 0 || axis_size == 0 || inner_size == 0)
+        return ok();
+
+    if (inner_size == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t i = 0; i < (int64_t)outer_size; i++)
+            log_softmax_row(input + i * axis_size, output + i * axis_size,
+                            axis_size);
+    } else {
+        // one task per (outer, 8 inner lanes); the inner tail is scalar
+        const auto blocks = (inner_size + 7) / 8;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+            const auto i = (size_t)t / blocks;
+            const auto j = ((size_t)t % blocks) * 8;
+            auto in_ = input + i * axis_size * inner_size + j;
+            auto out_ = output + i * axis_size * inner_size + j;
+            if (j + 8 <= inner_size) {
+                log_softmax_columns8(in_, out_, axis_size, inner_size);
+            } else {
+                for (size_t jj = 0; jj < inner_size - j; jj++)
+                    log_softmax_column(in_ + jj, out_ + jj, axis_size,
+                                       inner_size);
+            }
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> optimized::log_softmax(typecode_t typecode, const gsl::byte *input,
+                                    gsl::byte *output,
+                                    gsl::span<const size_t> in_shape,
+                                    gsl::span<const size_t> in_strides,
+                                    gsl::span<const size_t> out_strides,
+                                    int32_t axis,
+                                    kernel_context &context) noexcept {
+    if (typecode == dt_float32 && !in_shape.empty()) {
+        const auto positive_axis =
+            (size_t)(axis < 0 ? (int32_t)in_shape.size() + axis : axis);
+        return log_softmax_impl(reinterpret_cast<const float *>(input),
+                                reinterpret_cast<float *>(output), in_shape,
+                                positive_axis, context);
+    }
+
+    return reference::log_softmax(typecode, input, output, in_shape, in_strides,
+                                  out_strides, axis);
+}
@@ -0,0 +1,250 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../reference/ref_ops.h"
+#include "../opt_ops.h"
+#include "avx_mathfun.h"
+#include <algorithm>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// Rows longer than this are split in halves and reduced recursively
+// (pairwise), which keeps the rounding error of long sums at O(log n).
+constexpr size_t reduce_pairwise_size = 4096;
+// Same for the number of rows accumulated in the outer-axis layout.
+constexpr size_t reduce_pairwise_rows = 128;
+// Output columns handled by one task in the outer-axis layout.
+constexpr size_t reduce_column_block = 64;
+
+CAN_FORCEINLINE float reduce_min_ps(__m256 x) {
+    const __m128 x128 =
+        _mm_min_ps(_mm256_extractf128_ps(x, 1), _mm256_castps256_ps128(x));
+    const __m128 x64 = _mm_min_ps(x128, _mm_movehl_ps(x128, x128));
+    const __m128 x32 = _mm_min_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
+    return _mm_cvtss_f32(x32);
+}
+
+CAN_FORCEINLINE float reduce_mul_ps(__m256 x) {
+    const __m128 x128 =
+        _mm_mul_ps(_mm256_extractf128_ps(x, 1), _mm256_castps256_ps128(x));
+    const __m128 x64 = _mm_mul_ps(x128, _mm_movehl_ps(x128, x128));
+    const __m128 x32 = _mm_mul_ss(x64, _mm_shuffle_ps(x64, x64, 0x55));
+    return _mm_cvtss_f32(x32);
+}
+
+struct reduce_op_sum {
+    static float scalar(float a, float b) { return a + b; }
+    static __m256 pack(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+    static float horizontal(__m256 a) { return _mm256_reduce_add_ps(a); }
+};
+
+struct reduce_op_max {
+    static float scalar(float a, float b) { return std::max(a, b); }
+    static __m256 pack(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+    static float horizontal(__m256 a) { return _mm256_reduce_max_ps(a); }
+};
+
+struct reduce_op_min {
+    static float scalar(float a, float b) { return std::min(a, b); }
+    static __m256 pack(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+    static float horizontal(__m256 a) { return reduce_min_ps(a); }
+};
+
+struct reduce_op_prod {
+    static float scalar(float a, float b) { return a * b; }
+    static __m256 pack(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+    static float horizontal(__m256 a) { return reduce_mul_ps(a); }
+};
+
+// Inner-axis layout: reduces n (> 0) contiguous elements.
+template <class Op> float reduce_row(const float *input, size_t n) {
+    if (n > reduce_pairwise_size) {
+        const auto half = n / 2 / 32 * 32;
+        return Op::scalar(reduce_row<Op>(input, half),
+                          reduce_row<Op>(input + half, n - half));
+    }
+
+    size_t i = 0;
+    float result;
+    if (n >= 32) {
+        __m256 acc0 = _mm256_loadu_ps(input);
+        __m256 acc1 = _mm256_loadu_ps(input + 8);
+        __m256 acc2 = _mm256_loadu_ps(input + 16);
+        __m256 acc3 = _mm256_loadu_ps(input + 24);
+        for (i = 32; i + 32 <= n; i += 32) {
+            acc0 = Op::pack(acc0, _mm256_loadu_ps(input + i));
+            acc1 = Op::pack(acc1, _mm256_loadu_ps(input + i + 8));
+            acc2 = Op::pack(acc2, _mm256_loadu_ps(input + i + 16));
+            acc3 = Op::pack(acc3, _mm256_loadu_ps(input + i + 24));
+        }
+        for (; i + 8 <= n; i += 8)
+            acc0 = Op::pack(acc0, _mm256_loadu_ps(input + i));
+        result = Op::horizontal(
+            Op::pack(Op::pack(acc0, acc1), Op::pack(acc2, acc3)));
+    } else {
+        result = input[i++];
+    }
+
+    for (; i < n; i++)
+        result = Op::scalar(result, input[i]);
+    return result;
+}
+
+// Outer-axis layout: reduces `rows` (> 0) rows of n (<= reduce_column_block)
+// elements, `stride` apart, element-wise into output.
+template <class Op>
+void reduce_columns(const float *input, size_t rows, size_t stride, size_t n,
+                    float *output) {
+    if (rows > reduce_pairwise_rows) {
+        const auto half = rows / 2;
+        float tmp[reduce_column_block];
+        reduce_columns<Op>(input, half, stride, n, output);
+        reduce_columns<Op>(input + half * stride, rows - half, stride, n, tmp);
+        for (size_t j = 0; j < n; j++)
+            output[j] = Op::scalar(output[j], tmp[j]);
+        return;
+    }
+
+    std::copy_n(input, n, output);
+    for (size_t r = 1; r < rows; r++) {
+        auto in_r = input + r * stride;
+        size_t j = 0;
+        for (; j + 8 <= n; j += 8)
+            _mm256_storeu_ps(output + j,
+                             Op::pack(_mm256_loadu_ps(output + j),
+                                      _mm256_loadu_ps(in_r + j)));
+        for (; j < n; j++)
+            output[j] = Op::scalar(output[j], in_r[j]);
+    }
+}
+
+// The reduced axes must form one consecutive block: the input is then
+// outer_size x reduce_size x inner_size.
+bool get_reduce_layout(gsl::span<const size_t> in_shape,
+                       gsl::span<const size_t> axis, size_t &outer_size,
+                       size_t &reduce_size, size_t &inner_size) {
+    if (axis.empty())
+        return false;
+    dims_t sorted_axis(axis.begin(), axis.end());
+    std::sort(sorted_axis.begin(), sorted_axis.end());
+    for (size_t i = 1; i < sorted_axis.size(); i++) {
+        if (sorted_axis[i] != sorted_axis[i - 1] + 1)
+            return false;
+    }
+
+    outer_size = reduce_size = inner_size = 1;
+    for (size_t i = 0; i < in_shape.size(); i++) {
+        if (i < sorted_axis.front())
+            outer_size *= in_shape[i];
+        else if (i > sorted_axis.back())
+            inner_size *= in_shape[i];
+        else
+            reduce_size *= in_shape[i];
+    }
+    return outer_size && reduce_size && inner_size;
+}
+
+template <class Op, class TPostProcess>
+void reduce_impl(float init_value, TPostProcess &&post_process,
+                 const float *input, float *output, size_t outer_size,
+                 size_t reduce_size, size_t inner_size,
+                 NNCASE_UNUSED kernel_context &context) {
+    if (inner_size == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t i = 0; i < (int64_t)outer_size; i++) {
+            const auto v = reduce_row<Op>(input + i * reduce_size, reduce_size);
+            output[i] = post_process(Op::scalar(init_value, v));
+        }
+        return;
+    }
+
+    const auto blocks =
+        (inner_size + reduce_column_block - 1) / reduce_column_block;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+    for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+        const auto i = (size_t)t / blocks;
+        const auto j = ((size_t)t % blocks) * reduce_column_block;
+        const auto n = std::min(reduce_column_block, inner_size - j);
+        auto out_ = output + i * inner_size + j;
+        reduce_columns<Op>(input + i * reduce_size * inner_size + j,
+                           reduce_size, inner_size, n, out_);
+        for (size_t k = 0; k < n; k++)
+            out_[k] = post_process(Op::scalar(init_value, out_[k]));
+    }
+}
+} // namespace
+
+result<void> optimized::reduce(
+    typecode_t typecode, nncase::runtime::stackvm::reduce_op_t op,
+    const gsl::byte *init_value, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> axis,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    bool keep_dims, kernel_context &context) noexcept {
+    size_t outer_size, reduce_size, inner_size;
+    if (typecode == dt_float32 &&
+        is_contiguous(
+            kernels::detail::get_reduced_shape(in_shape, axis, keep_dims),
+            out_strides) &&
+        get_reduce_layout(in_shape, axis, outer_size, reduce_size,
+                          inner_size)) {
+        auto in = IN_CAST(float, input);
+        auto out = OUT_CAST(float, output);
+        // prod starts from 1 and ignores init_value, as the reference does
+        const auto init =
+            op == reduce_op_t::prod ? 1.f : SCALAR_CAST(float, init_value);
+        const auto identity = [](float v) { return v; };
+        switch (op) {
+        case reduce_op_t::mean:
+            reduce_impl<reduce_op_sum>(
+                init, [=](float v) { return v / reduce_size; }, in, out,
+                outer_size, reduce_size, inner_size, context);
+            return ok();
+        case reduce_op_t::sum:
+            reduce_impl<reduce_op_sum>(init, identity, in, out, outer_size,
+                                       reduce_size, inner_size, context);
+            return ok();
+        case reduce_op_t::max:
+            reduce_impl<reduce_op_max>(init, identity, in, out, outer_size,
+                                       reduce_size, inner_size, context);
+            return ok();
+        case reduce_op_t::min:
+            reduce_impl<reduce_op_min>(init, identity, in, out, outer_size,
+                                       reduce_size, inner_size, context);
+            return ok();
+        case reduce_op_t::prod:
+            reduce_impl<reduce_op_prod>(init, identity, in, out, outer_size,
+                                        reduce_size, inner_size, context);
+            return ok();
+        default:
+            break;
+        }
+    }
+
+    return stackvm::reference::reduce(typecode, op, init_value, input, output,
+                                      in_shape, axis, in_strides, out_strides,
+                                      keep_dims, context);
+}
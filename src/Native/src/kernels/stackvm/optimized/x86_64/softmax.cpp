@@ -0,0 +1,218 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../reference/ref_ops.h"
+#include "../opt_ops.h"
+#include "avx_half.h"
+#include "avx_mathfun.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+using namespace nncase::kernels::stackvm::optimized;
+
+namespace {
+// softmax over one contiguous row of n elements.
+// pass 1: reduce_max, pass 2: exp((x - max) * beta) stored to output and
+// summed, then the output is scaled by 1 / sum.
+// half and bfloat16 compute in f32 lanes; pass 2 only sums and pass 3
+// recomputes the exp, so the output is rounded once instead of twice.
+template <class T>
+void softmax_row(const T *input, T *output, size_t n, float beta) {
+    using vec = f32x8<T>;
+    constexpr bool store_exp = std::is_same_v<T, float>;
+    size_t i = 0;
+    float max_value = std::numeric_limits<float>::lowest();
+    if (n >= 8) {
+        __m256 vmax = vec::load(input);
+        for (i = 8; i + 8 <= n; i += 8)
+            vmax = _mm256_max_ps(vmax, vec::load(input + i));
+        max_value = _mm256_reduce_max_ps(vmax);
+    }
+    for (; i < n; i++)
+        max_value = std::max(max_value, (float)input[i]);
+
+    const __m256 vmax = _mm256_set1_ps(max_value);
+    const __m256 vbeta = _mm256_set1_ps(beta);
+    __m256 vsum = _mm256_setzero_ps();
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_sub_ps(vec::load(input + i), vmax);
+        v = exp256_ps(_mm256_mul_ps(v, vbeta));
+        vsum = _mm256_add_ps(vsum, v);
+        if constexpr (store_exp)
+            _mm256_storeu_ps(output + i, v);
+    }
+    float sum = _mm256_reduce_add_ps(vsum);
+    for (; i < n; i++) {
+        const auto v = expf(((float)input[i] - max_value) * beta);
+        if constexpr (store_exp)
+            output[i] = v;
+        sum += v;
+    }
+
+    const float inv_sum = 1.f / sum;
+    const __m256 vinv_sum = _mm256_set1_ps(inv_sum);
+    if constexpr (store_exp) {
+        for (i = 0; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(
+                output + i,
+                _mm256_mul_ps(_mm256_loadu_ps(output + i), vinv_sum));
+        for (; i < n; i++)
+            output[i] *= inv_sum;
+    } else {
+        for (i = 0; i + 8 <= n; i += 8) {
+            __m256 v = _mm256_sub_ps(vec::load(input + i), vmax);
+            v = exp256_ps(_mm256_mul_ps(v, vbeta));
+            vec::store(output + i, _mm256_mul_ps(v, vinv_sum));
+        }
+        for (; i < n; i++)
+            output[i] = narrow_from_f32<T>(
+                expf(((float)input[i] - max_value) * beta) * inv_sum);
+    }
+}
+
+// softmax over axis_size elements strided by inner_size, for 8 adjacent
+// inner positions at once.
+template <class T>
+void softmax_columns8(const T *input, T *output, size_t axis_size,
+                      size_t inner_size, float beta) {
+    using vec = f32x8<T>;
+    constexpr bool store_exp = std::is_same_v<T, float>;
+    __m256 vmax = vec::load(input);
+    for (size_t k = 1; k < axis_size; k++)
+        vmax = _mm256_max_ps(vmax, vec::load(input + k * inner_size));
+
+    const __m256 vbeta = _mm256_set1_ps(beta);
+    __m256 vsum = _mm256_setzero_ps();
+    for (size_t k = 0; k < axis_size; k++) {
+        __m256 v = _mm256_sub_ps(vec::load(input + k * inner_size), vmax);
+        v = exp256_ps(_mm256_mul_ps(v, vbeta));
+        vsum = _mm256_add_ps(vsum, v);
+        if constexpr (store_exp)
+            _mm256_storeu_ps(output + k * inner_size, v);
+    }
+
+    const __m256 vinv_sum = _mm256_div_ps(_mm256_set1_ps(1.f), vsum);
+    for (size_t k = 0; k < axis_size; k++) {
+        auto out_k = output + k * inner_size;
+        if constexpr (store_exp) {
+            _mm256_storeu_ps(out_k,
+                             _mm256_mul_ps(_mm256_loadu_ps(out_k), vinv_sum));
+        } else {
+            __m256 v = _mm256_sub_ps(vec::load(input + k * inner_size), vmax);
+            v = exp256_ps(_mm256_mul_ps(v, vbeta));
+            vec::store(out_k, _mm256_mul_ps(v, vinv_sum));
+        }
+    }
+}
+
+template <class T>
+void softmax_column(const T *input, T *output, size_t axis_size,
+                    size_t inner_size, float beta) {
+    float max_value = input[0];
+    for (size_t k = 1; k < axis_size; k++)
+        max_value = std::max(max_value, (float)input[k * inner_size]);
+
+    float sum = 0.f;
+    for (size_t k = 0; k < axis_size; k++)
+        sum += expf(((float)input[k * inner_size] - max_value) * beta);
+
+    const float inv_sum = 1.f / sum;
+    for (size_t k = 0; k < axis_size; k++)
+        output[k * inner_size] = narrow_from_f32<T>(
+            expf(((float)input[k * inner_size] - max_value) * beta) * inv_sum);
+}
+
+template <class T>
+result<void> softmax_impl(const T *input, T *output,
+                          gsl::span<const size_t> in_shape, size_t axis,
+                          float beta,
+                          NNCASE_UNUSED kernel_context &context) noexcept {
+    const auto axis_size = in_shape[axis];
+    size_t outer_size = 1;
+    for (size_t i = 0; i < axis; i++)
+        outer_size *= in_shape[i];
+    size_t inner_size = 1;
+    for (size_t i = axis + 1; i < in_shape.size(); i++)
+        inner_size *= in_shape[i];
+    if (outer_size == 0 || axis_size == 0 || inner_size == 0)
+        return ok();
+
+    if (inner_size == 1) {
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t i = 0; i < (int64_t)outer_size; i++)
+            softmax_row(input + i * axis_size, output + i * axis_size,
+                        axis_size, beta);
+    } else {
+        // one task per (outer, 8 inner lanes); the inner tail is scalar
+        const auto blocks = (inner_size + 7) / 8;
+#ifdef NNCASE_OPENMP
+#pragma omp parallel for num_threads(context.num_threads)
+#endif
+        for (int64_t t = 0; t < (int64_t)(outer_size * blocks); t++) {
+            const auto i = (size_t)t / blocks;
+            const auto j = ((size_t)t % blocks) * 8;
+            auto in_ = input + i * axis_size * inner_size + j;
+            auto out_ = output + i * axis_size * inner_size + j;
+            if (j + 8 <= inner_size) {
+                softmax_columns8(in_, out_, axis_size, inner_size, beta);
+            } else {
+                for (size_t jj = 0; jj < inner_size - j; jj++)
+                    softmax_column(in_ + jj, out_ + jj, axis_size, inner_size,
+                                   beta);
+            }
+        }
+    }
+    return ok();
+}
+} // namespace
+
+result<void> optimized::softmax(typecode_t typecode, const gsl::byte *input,
+                                gsl::byte *output,
+                                gsl::span<const size_t> in_shape,
+                                gsl::span<const size_t> in_strides,
+                                gsl::span<const size_t> out_strides,
+                                int32_t axis, float beta,
+                                kernel_context &context) noexcept {
+    if (!in_shape.empty()) {
+        const auto positive_axis =
+            (size_t)(axis < 0 ? (int32_t)in_shape.size() + axis : axis);
+        switch (typecode) {
+        case dt_float32:
+            return softmax_impl(IN_CAST(float, input), OUT_CAST(float, output),
+                                in_shape, positive_axis, beta, context);
+        case dt_float16:
+            return softmax_impl(IN_CAST(half, input), OUT_CAST(half, output),
+                                in_shape, positive_axis, beta, context);
+        case dt_bfloat16:
+            return softmax_impl(IN_CAST(bfloat16, input),
+                                OUT_CAST(bfloat16, output), in_shape,
+                                positive_axis, beta, context);
+        default:
+            break;
+        }
+    }
+
+    return stackvm::reference::softmax(typecode, input, output, in_shape,
+                                       in_strides, out_strides, axis, beta);
+}
@@ -14,6 +14,7 @@
  */
 #include "../../reference/ref_ops.h"
 #include "../opt_ops.h"
+#include "avx_half.h"
 #include "avx_mathfun.h"
 #include <iostream>
 #include <nncase/kernels/kernel_utils.h>
@@ -27,16 +28,13 @@ using namespace nncase::kernels::stackvm;
 using namespace nncase::kernels::stackvm::optimized;
 using namespace nncase::runtime::stackvm;
 
+namespace {
 struct unary_op_abs {
     unary_op_abs() : sign_bit_(_mm256_set1_ps(-0.0f)) {}
 
     float operator()(float x) const { return fabsf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_andnot_ps(sign_bit_, vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return _mm256_andnot_ps(sign_bit_, a); }
 
   private:
     __m256 sign_bit_;
@@ -45,62 +43,42 @@ struct unary_op_abs {
 struct unary_op_ceil {
     float operator()(float x) const { return ceilf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_round_ps(
-            vector_a, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
-        _mm256_storeu_ps(b, dst_a);
+    __m256 pack(__m256 a) const {
+        return _mm256_round_ps(a, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
     }
 };
 
 struct unary_op_cos {
     float operator()(float x) const { return cosf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = cos256_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return cos256_ps(a); }
 };
 
 struct unary_op_exp {
     float operator()(float x) const { return expf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = exp256_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return exp256_ps(a); }
 };
 
 struct unary_op_floor {
     float operator()(float x) const { return floorf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_round_ps(
-            vector_a, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
-        _mm256_storeu_ps(b, dst_a);
+    __m256 pack(__m256 a) const {
+        return _mm256_round_ps(a, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
     }
 };
 
 struct unary_op_log {
     float operator()(float x) const { return logf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = log256_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return log256_ps(a); }
 };
 
 struct unary_op_neg {
     float operator()(float x) const { return -(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_sub_ps(_mm256_setzero_ps(), vector_a);
-        _mm256_storeu_ps(b, dst_a);
+    __m256 pack(__m256 a) const {
+        return _mm256_sub_ps(_mm256_setzero_ps(), a);
     }
 };
 
@@ -124,22 +102,16 @@ static float round_onnx(float v) {
 struct unary_op_round {
     float operator()(float x) const { return round_onnx(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_round_ps(
-            vector_a, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
-        _mm256_storeu_ps(b, dst_a);
+    __m256 pack(__m256 a) const {
+        return _mm256_round_ps(a,
+                               (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
     }
 };
 
 struct unary_op_rsqrt {
     float operator()(float x) const { return 1.0f / sqrtf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 aa = _mm256_loadu_ps(a);
-        __m256 bb = _mm256_rsqrt_ps(aa);
-        _mm256_storeu_ps(b, bb);
-    }
+    __m256 pack(__m256 a) const { return _mm256_rsqrt_ps(a); }
 };
 
 struct unary_op_sign {
@@ -147,14 +119,12 @@ struct unary_op_sign {
 
     float operator()(float x) const { return (0.f < x) - (x < 0.f); }
 
-    void pack(const float *a, float *b) {
-        __m256 va = _mm256_loadu_ps(a);
+    __m256 pack(__m256 va) const {
         __m256 positive = _mm256_and_ps(_mm256_cmp_ps(zero_, va, _CMP_LT_OQ),
                                         _mm256_set1_ps(1.0f));
         __m256 negative = _mm256_and_ps(_mm256_cmp_ps(va, zero_, _CMP_LT_OQ),
                                         _mm256_set1_ps(-1.0f));
-        __m256 vb = _mm256_or_ps(positive, negative);
-        _mm256_storeu_ps(b, vb);
+        return _mm256_or_ps(positive, negative);
     }
 
   private:
@@ -164,73 +134,55 @@ struct unary_op_sign {
 struct unary_op_sin {
     float operator()(float x) const { return sinf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = sin256_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return sin256_ps(a); }
 };
 
 struct unary_op_sqrt {
     float operator()(float x) const { return sqrtf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_sqrt_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return _mm256_sqrt_ps(a); }
 };
 
 struct unary_op_square {
     float operator()(float x) const { return x * x; }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = _mm256_mul_ps(vector_a, vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return _mm256_mul_ps(a, a); }
 };
 
 struct unary_op_tanh {
     float operator()(float x) const { return tanhf(x); }
 
-    void pack(const float *a, float *b) {
-        __m256 vector_a = _mm256_loadu_ps(a);
-        __m256 dst_a = tanh256_ps(vector_a);
-        _mm256_storeu_ps(b, dst_a);
-    }
+    __m256 pack(__m256 a) const { return tanh256_ps(a); }
 };
 
-template <typename Top>
-result<void> optimized_unary_impl(const float *CXX_RESTRICT input,
-                                  float *CXX_RESTRICT output,
+// half and bfloat16 are computed in f32 lanes and rounded once on store.
+template <typename Top, class T>
+result<void> optimized_unary_impl(const T *CXX_RESTRICT input,
+                                  T *CXX_RESTRICT output,
                                   gsl::span<const size_t> shape) noexcept {
     Top op;
     size_t n = compute_size(shape);
-    size_t n8 = (n >> 3);
-    size_t n8_left = n & (8 - 1);
-    for (size_t i = 0; i < n8; i++) {
-        op.pack(input, output);
-        input += 8;
-        output += 8;
-    }
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        f32x8<T>::store(output + i, op.pack(f32x8<T>::load(input + i)));
 
-    for (size_t i = 0; i < n8_left; i++) {
-        output[i] = op(input[i]);
+    for (; i < n; i++) {
+        output[i] = narrow_from_f32<T>(op((float)input[i]));
     }
 
     return ok();
 }
 
-result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
-                              const gsl::byte *in, gsl::byte *out,
-                              gsl::span<const size_t> shape,
-                              gsl::span<const size_t> in_strides,
-                              gsl::span<const size_t> out_shape,
-                              gsl::span<const size_t> out_strides,
-                              kernel_context &context) noexcept {
-    auto *input = IN_CAST(float, in);
-    auto *output = OUT_CAST(float, out);
+template <class T>
+result<void> unary_impl(typecode_t dtype, runtime::stackvm::unary_op_t op,
+                        const gsl::byte *in, gsl::byte *out,
+                        gsl::span<const size_t> shape,
+                        gsl::span<const size_t> in_strides,
+                        gsl::span<const size_t> out_shape,
+                        gsl::span<const size_t> out_strides,
+                        kernel_context &context) noexcept {
+    auto *input = IN_CAST(T, in);
+    auto *output = OUT_CAST(T, out);
 
     switch (op) {
     case unary_op_t::abs: {
@@ -276,9 +228,34 @@ result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
         return optimized_unary_impl<unary_op_tanh>(input, output, shape);
     }
     default:
-        return stackvm::reference::unary(dtype, op, in, out, shape, in_strides,
-                                         out_shape, out_strides, context);
+        return kernels::stackvm::reference::unary(dtype, op, in, out, shape,
+                                                  in_strides, out_shape,
+                                                  out_strides, context);
     }
 
     return ok();
 }
+} // namespace
+
+result<void> optimized::unary(typecode_t dtype, runtime::stackvm::unary_op_t op,
+                              const gsl::byte *in, gsl::byte *out,
+                              gsl::span<const size_t> shape,
+                              gsl::span<const size_t> in_strides,
+                              gsl::span<const size_t> out_shape,
+                              gsl::span<const size_t> out_strides,
+                              kernel_context &context) noexcept {
+    switch (dtype) {
+    case dt_float32:
+        return unary_impl<float>(dtype, op, in, out, shape, in_strides,
+                                 out_shape, out_strides, context);
+    case dt_float16:
+        return unary_impl<half>(dtype, op, in, out, shape, in_strides,
+                                out_shape, out_strides, context);
+    case dt_bfloat16:
+        return unary_impl<bfloat16>(dtype, op, in, out, shape, in_strides,
+                                    out_shape, out_strides, context);
+    default:
+        return stackvm::reference::unary(dtype, op, in, out, shape, in_strides,
+                                         out_shape, out_strides, context);
+    }
+}
@@ -12,7 +12,6 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#include "../shape_infer.h"
 #include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -83,13 +82,12 @@ batch_to_space_impl(const T *input, T *output, gsl::span<const size_t> in_shape,
                                    block_shape, crops, in_strides,             \
                                    out_strides, context)
 
-result<void>
-batch_to_space_impl(datatype_t type, const gsl::byte *input, gsl::byte *output,
-                    gsl::span<const size_t> in_shape,
-                    gsl::span<const size_t> block_shape,
-                    const paddings_t &crops, gsl::span<const size_t> in_strides,
-                    gsl::span<const size_t> out_strides,
-                    NNCASE_UNUSED kernel_context &context) noexcept {
+result<void> nncase::kernels::stackvm::reference::batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides,
+    NNCASE_UNUSED kernel_context &context) noexcept {
     switch (runtime::get_bytes(type)) {
         BATCH_TO_SPACE_IMPL(1, uint8_t);
         BATCH_TO_SPACE_IMPL(2, uint16_t);
@@ -99,51 +97,3 @@ batch_to_space_impl(datatype_t type, const gsl::byte *input, gsl::byte *output,
         return err(std::errc::not_supported);
     }
 }
-
-dims_t infer_shape(gsl::span<const size_t> origin_in_shape,
-                   gsl::span<const size_t> block_shape,
-                   const paddings_t &crops) {
-    auto d4 = fixed_dims(0, 2, 3, 1);
-    auto d3 = fixed_dims(0, 2, 1);
-    auto inPerm = origin_in_shape.size() == 4
-                      ? gsl::span<const size_t>{d4.data(), d4.size()}
-                      : gsl::span<const size_t>{d3.data(), d3.size()};
-    auto in_shape =
-        kernels::stackvm::transpose_infer_shape(origin_in_shape, inPerm);
-    auto batch = in_shape[0] / compute_size(block_shape);
-    auto out_shape = dims_t{batch};
-    auto m = block_shape.size();
-    for (size_t i = 0; i < m; ++i) {
-        auto d = in_shape[i + 1] * block_shape[0] - crops[i].sum();
-        out_shape.push_back(d);
-    }
-    auto remain_size = in_shape.size() - 1 - m;
-    if (remain_size > 0) {
-        out_shape.insert(out_shape.end(), in_shape.end() - remain_size,
-                         in_shape.end());
-    }
-    auto outd4 = fixed_dims(0, 3, 1, 2);
-    auto outd3 = fixed_dims(0, 2, 1);
-    auto outPerm = origin_in_shape.size() == 4
-                       ? gsl::span<const size_t>{outd4.data(), outd4.size()}
-                       : gsl::span<const size_t>{outd3.data(), outd3.size()};
-    return kernels::stackvm::transpose_infer_shape(out_shape, outPerm);
-}
-
-result<value_t> kernels::stackvm::batch_to_space(value_t input,
-                                                 value_t block_shape,
-                                                 value_t crops, value_t output,
-                                                 kernel_context &context) {
-    try_input(input_mem, input);
-    try_var(block_shape_value, value_as_dims(block_shape));
-    try_var(crops_value, value_as_paddings(crops));
-    auto dtype = input_tensor->dtype();
-    auto out_shape =
-        infer_shape(input_tensor->shape(), block_shape_value, crops_value);
-    try_output(out_mem, output, dtype, out_shape);
-    try_(batch_to_space_impl(dtype, input_mem, out_mem, input_tensor->shape(),
-                             block_shape_value, crops_value,
-                             input_tensor->strides(), output_tensor->strides(),
-                             context));
-    return ok(output);
-}
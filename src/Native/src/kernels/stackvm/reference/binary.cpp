@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "ref_ops.h"
+#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
@@ -34,21 +35,18 @@ result<void> binary_impl(TOp &&op, const T *lhs, const T *rhs, T *output,
                          gsl::span<const size_t> rhs_strides,
                          gsl::span<const size_t> out_shape,
                          gsl::span<const size_t> out_strides,
-                         NNCASE_UNUSED kernel_context &context) noexcept {
-    if (is_scalar(out_shape)) {
-        output[0] = (T)op(lhs[0], rhs[0]);
-        return ok();
-    }
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto lhs_index =
-            kernels::detail::get_reduced_offset(index, lhs_shape);
-        const auto rhs_index =
-            kernels::detail::get_reduced_offset(index, rhs_shape);
-        const auto a = lhs[offset(lhs_strides, lhs_index)];
-        const auto b = rhs[offset(rhs_strides, rhs_index)];
-        output[offset(out_strides, index)] = (T)op(a, b);
-        return ok();
-    });
+                         kernel_context &context) noexcept {
+    const auto lhs_bstrides =
+        broadcast_strides(lhs_shape, lhs_strides, out_shape);
+    const auto rhs_bstrides =
+        broadcast_strides(rhs_shape, rhs_strides, out_shape);
+    apply_strided<3>(
+        out_shape, {lhs_bstrides, rhs_bstrides, out_strides},
+        [&](size_t a, size_t b, size_t out) {
+            output[out] = (T)op(lhs[a], rhs[b]);
+        },
+        context.num_threads);
+    return ok();
 }
 
 #define BINARY_IMPL_OP(op, funct)                                              \
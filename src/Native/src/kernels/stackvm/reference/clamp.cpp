@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "ref_ops.h"
+#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
@@ -31,14 +32,18 @@ result<void> clamp_impl(const T *input, T min, T max, T *output,
                         gsl::span<const size_t> in_shape,
                         gsl::span<const size_t> in_strides,
                         gsl::span<const size_t> out_strides,
-                        NNCASE_UNUSED kernel_context &context) {
-    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto v = input[offset(index, in_strides)];
-        output[offset(index, out_strides)] = static_cast<T>(
-            std::min(std::max(static_cast<float>(v), static_cast<float>(min)),
-                     static_cast<float>(max)));
-        return ok();
-    });
+                        kernel_context &context) {
+    const auto min_value = static_cast<float>(min);
+    const auto max_value = static_cast<float>(max);
+    apply_strided<2>(
+        in_shape, {in_strides, out_strides},
+        [&](size_t in, size_t out) {
+            output[out] = static_cast<T>(std::min(
+                std::max(static_cast<float>(input[in]), min_value),
+                max_value));
+        },
+        context.num_threads);
+    return ok();
 }
 } // namespace
 
@@ -51,6 +56,6 @@ result<void> nncase::kernels::stackvm::reference::clamp(
     typecode_t type, const gsl::byte *input, const gsl::byte *min,
     const gsl::byte *max, gsl::byte *output, gsl::span<const size_t> in_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
-    NNCASE_UNUSED kernel_context &context) noexcept {
+    kernel_context &context) noexcept {
     TYPE_SELECT(type, CLAMP_IMPL);
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "ref_ops.h"
 #include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -32,24 +33,26 @@ result<void> compare_impl(TOp &&op, const T *input_a, const T *input_b,
                           gsl::span<const size_t> in_b_shape,
                           gsl::span<const size_t> in_b_strides,
                           gsl::span<const size_t> out_shape,
-                          gsl::span<const size_t> out_strides) noexcept {
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto in_a_index =
-            kernels::detail::get_reduced_offset(index, in_a_shape);
-        const auto in_b_index =
-            kernels::detail::get_reduced_offset(index, in_b_shape);
-        const auto a = input_a[offset(in_a_strides, in_a_index)];
-        const auto b = input_b[offset(in_b_strides, in_b_index)];
-        output[offset(out_strides, index)] = static_cast<bool>(op(a, b));
-        return ok();
-    });
+                          gsl::span<const size_t> out_strides,
+                          kernel_context &context) noexcept {
+    const auto in_a_bstrides =
+        broadcast_strides(in_a_shape, in_a_strides, out_shape);
+    const auto in_b_bstrides =
+        broadcast_strides(in_b_shape, in_b_strides, out_shape);
+    apply_strided<3>(
+        out_shape, {in_a_bstrides, in_b_bstrides, out_strides},
+        [&](size_t a, size_t b, size_t out) {
+            output[out] = static_cast<bool>(op(input_a[a], input_b[b]));
+        },
+        context.num_threads);
+    return ok();
 }
-} // namespace
 
 #define COMPARE_IMPL_OP(op, funct)                                             \
     case compare_op_t::op:                                                     \
         return compare_impl(funct, lhs, rhs, output, lhs_shape, lhs_strides,   \
-                            rhs_shape, rhs_strides, out_shape, out_strides)
+                            rhs_shape, rhs_strides, out_shape, out_strides,    \
+                            context)
 
 template <typename T>
 result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
@@ -58,7 +61,8 @@ result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
                           gsl::span<const size_t> rhs_shape,
                           gsl::span<const size_t> rhs_strides,
                           gsl::span<const size_t> out_shape,
-                          gsl::span<const size_t> out_strides) noexcept {
+                          gsl::span<const size_t> out_strides,
+                          kernel_context &context) noexcept {
     switch (op) {
         COMPARE_IMPL_OP(equal, std::equal_to<T>());
         COMPARE_IMPL_OP(not_equal, std::not_equal_to<T>());
@@ -70,41 +74,19 @@ result<void> compare_impl(compare_op_t op, const T *lhs, const T *rhs,
         return err(std::errc::not_supported);
     }
 }
+} // namespace
 
 #define COMPARE_IMPL(_ty)                                                      \
     return compare_impl(op, IN_CAST(_ty, lhs), IN_CAST(_ty, rhs),              \
                         OUT_CAST(bool, output), lhs_shape, lhs_strides,        \
-                        rhs_shape, rhs_strides, out_shape, out_strides);
+                        rhs_shape, rhs_strides, out_shape, out_strides,        \
+                        context);
 
-result<void> compare_impl(typecode_t typecode, compare_op_t op,
-                          const gsl::byte *lhs, const gsl::byte *rhs,
-                          gsl::byte *output, gsl::span<const size_t> lhs_shape,
-                          gsl::span<const size_t> lhs_strides,
-                          gsl::span<const size_t> rhs_shape,
-                          gsl::span<const size_t> rhs_strides,
-                          gsl::span<const size_t> out_shape,
-                          gsl::span<const size_t> out_strides,
-                          NNCASE_UNUSED kernel_context &context) noexcept {
+result<void> nncase::kernels::stackvm::reference::compare(
+    typecode_t typecode, compare_op_t op, const gsl::byte *lhs,
+    const gsl::byte *rhs, gsl::byte *output, gsl::span<const size_t> lhs_shape,
+    gsl::span<const size_t> lhs_strides, gsl::span<const size_t> rhs_shape,
+    gsl::span<const size_t> rhs_strides, gsl::span<const size_t> out_shape,
+    gsl::span<const size_t> out_strides, kernel_context &context) noexcept {
     TYPE_SELECT(typecode, COMPARE_IMPL);
 }
-
-result<value_t>
-kernels::stackvm::compare(compare_op_t compare_op, value_t lhs, value_t rhs,
-                          value_t output,
-                          [[maybe_unused]] kernel_context &context) {
-    try_input(lhs_mem, lhs);
-    try_input(rhs_mem, rhs);
-    if (!cmp_dt(lhs_tensor, rhs_tensor)) {
-        return err(nncase_errc::datatype_mismatch);
-    }
-
-    try_typecode(typecode, lhs_tensor);
-    auto out_shape = nncase::kernels::detail::get_binary_output_shape(
-        lhs_tensor->shape(), rhs_tensor->shape());
-    try_output(out_mem, output, datatype_t::from_type<bool>(), out_shape);
-    try_(compare_impl(
-        typecode, compare_op, lhs_mem, rhs_mem, out_mem, lhs_tensor->shape(),
-        lhs_tensor->strides(), rhs_tensor->shape(), rhs_tensor->strides(),
-        output_tensor->shape(), output_tensor->strides(), context));
-    return ok(output);
-}
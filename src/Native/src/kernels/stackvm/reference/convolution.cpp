@@ -149,7 +149,7 @@ result<void> conv2d_transpose_impl(
     gsl::span<const size_t> out_shape, int32_t filter_h, int32_t filter_w,
     int32_t stride_h, int32_t stride_w, int32_t dilation_h, int32_t dilation_w,
     const padding &padding_h, const padding &padding_w,
-    [[maybe_unused]] const value_range<float> &fused_activation) noexcept {
+    const value_range<float> &fused_activation) noexcept {
     auto output_size = runtime::compute_size(out_shape);
     std::fill(output, output + output_size, 0.f);
     const auto g_ic = in_shape[1] / groups;
@@ -223,12 +223,10 @@ result<void> conv2d_transpose_impl(
     for (size_t i = 0; i < output_size; i++)
         output[i] += bias[i / hw % out_shape[1]];
 
-    //    if (fused_activation != value_range<float>::full())
-    //    {
-    //        for (size_t i = 0; i < output_size; i++)
-    //            output[i] = detail::apply_activation(output[i],
-    //            fused_activation);
-    //    }
+    const value_range<T> activation{(T)fused_activation.min,
+                                    (T)fused_activation.max};
+    for (size_t i = 0; i < output_size; i++)
+        output[i] = kernels::detail::apply_activation(output[i], activation);
     return ok();
 }
 
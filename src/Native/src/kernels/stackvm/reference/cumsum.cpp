@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "ref_ops.h"
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
 #include <nncase/runtime/allocator.h>
@@ -90,23 +91,11 @@ result<void> cumsum_impl(const T *input, T *output,
     return cumsum_impl(IN_CAST(_ty, input), OUT_CAST(_ty, output), in_shape,   \
                        axis, exclusive, reverse);
 
-result<void> cumsum_impl(typecode_t typecode, const gsl::byte *input,
-                         gsl::byte *output, gsl::span<const size_t> in_shape,
-                         int32_t axis, bool exclusive, bool reverse) noexcept {
-    TYPE_SELECT(typecode, CUMSUM_IMPL)
-}
 } // namespace
 
-result<value_t> nncase::kernels::stackvm::cum_sum(
-    value_t input, value_t axis, value_t exclusive, value_t reverse,
-    value_t output, [[maybe_unused]] kernel_context &context) {
-    try_input(input_mem, input);
-    try_output(out_mem, output, input_tensor->dtype(), input_tensor->shape());
-    try_positive_axis(axis_value, axis, input_tensor);
-    try_to_scalar(exclusive_value, exclusive, bool);
-    try_to_scalar(reverse_value, reverse, bool);
-    try_typecode(typecode, input_tensor);
-    try_(cumsum_impl(typecode, input_mem, out_mem, input_tensor->shape(),
-                     axis_value, exclusive_value, reverse_value));
-    return ok(output);
+result<void> nncase::kernels::stackvm::reference::cum_sum(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, int32_t axis, bool exclusive,
+    bool reverse) noexcept {
+    TYPE_SELECT(typecode, CUMSUM_IMPL)
 }
@@ -56,5 +56,8 @@ result<void> nncase::kernels::stackvm::reference::dequantize(
     DEQUANTIZE_IMPL(uint8_t, float);
     DEQUANTIZE_IMPL(int8_t, float);
     DEQUANTIZE_IMPL(int16_t, float);
+    DEQUANTIZE_IMPL(uint8_t, bfloat16);
+    DEQUANTIZE_IMPL(int8_t, bfloat16);
+    DEQUANTIZE_IMPL(int16_t, bfloat16);
     return err(std::errc::not_supported);
 }
\ No newline at end of file
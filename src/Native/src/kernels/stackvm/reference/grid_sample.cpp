@@ -13,7 +13,10 @@
  * limitations under the License.
  */
 #include "ref_ops.h"
+#include <algorithm>
+#include <cmath>
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/stackvm/grid_sample.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
 #include <nncase/runtime/runtime_op_utility.h>
@@ -31,22 +34,21 @@ result<void> grid_sample_impl(
     const T *input, const T *grid, T *output, gsl::span<const size_t> in_shape,
     gsl::span<const size_t> in_strides, gsl::span<const size_t> grid_shape,
     gsl::span<const size_t> grid_strides, gsl::span<const size_t> out_strides,
-    grid_sample_align_corners_t align_corners,
-    NNCASE_UNUSED grid_sample_mode_t mode,
-    NNCASE_UNUSED grid_sample_padding_mode_t padding_mode,
+    grid_sample_align_corners_t align_corners, grid_sample_mode_t mode,
+    grid_sample_padding_mode_t padding_mode,
     NNCASE_UNUSED kernel_context &context) noexcept {
+    if (mode == grid_sample_mode_t::cubic)
+        return err(std::errc::not_supported);
+
     dims_t in_index(4), grid_index(4), out_index(4);
     const int32_t H_in = in_shape[2];
     const int32_t W_in = in_shape[3];
+    const auto align =
+        align_corners == grid_sample_align_corners_t::align_corners;
 
     auto get_input = [&](int32_t in_y, int32_t in_x) {
-        if (padding_mode == grid_sample_padding_mode_t::border) {
-            in_x = std::max(0, std::min(in_x, W_in - 1));
-            in_y = std::max(0, std::min(in_y, H_in - 1));
-        } else if (in_x < 0 || in_x >= W_in || in_y < 0 || in_y >= H_in) {
+        if (in_x < 0 || in_x >= W_in || in_y < 0 || in_y >= H_in)
             return T(0);
-        }
-
         in_index[2] = in_y;
         in_index[3] = in_x;
         return input[offset(in_strides, in_index)];
@@ -68,16 +70,24 @@ result<void> grid_sample_impl(
                 grid_index[3] = 1;
                 auto y_norm = grid[offset(grid_strides, grid_index)];
 
-                float x_src, y_src;
-                int32_t x_w, x_e, y_n, y_s;
-                if (align_corners ==
-                    grid_sample_align_corners_t::align_corners) {
-                    x_src = (x_norm + 1) / 2 * (in_shape[3] - 1);
-                    y_src = (y_norm + 1) / 2 * (in_shape[2] - 1);
-                } else {
-                    x_src = ((x_norm + 1) * in_shape[3] - 1) / 2;
-                    y_src = ((y_norm + 1) * in_shape[2] - 1) / 2;
+                auto x_src = grid_sample_source_coordinate(x_norm, W_in, align,
+                                                           padding_mode);
+                auto y_src = grid_sample_source_coordinate(y_norm, H_in, align,
+                                                           padding_mode);
+
+                if (mode == grid_sample_mode_t::nearest_neighbor) {
+                    auto x_near = (int32_t)std::nearbyint(x_src);
+                    auto y_near = (int32_t)std::nearbyint(y_src);
+                    for (size_t oc = 0; oc < in_shape[1]; oc++) {
+                        in_index[1] = oc;
+                        out_index[1] = oc;
+                        output[offset(out_strides, out_index)] =
+                            get_input(y_near, x_near);
+                    }
+                    continue;
                 }
+
+                int32_t x_w, x_e, y_n, y_s;
                 x_w = (int32_t)std::floor(x_src);
                 y_n = (int32_t)std::floor(y_src);
                 x_e = x_w + 1;
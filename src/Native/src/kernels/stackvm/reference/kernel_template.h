@@ -50,18 +50,16 @@
     }
 
 #define UNARY_OP_TEMPLATE(_name)                                               \
-    result<value_t> nncase::kernels::stackvm::_name(                           \
-        value_t input, value_t output, kernel_context &context) {              \
-        try_input(input_mem, input);                                           \
-        auto dtype = input_tensor->dtype();                                    \
-        try_output_like_input(output_mem, output, input_tensor);               \
-        try_var(typecode, to_typecode(input_tensor->dtype()));                 \
-        if (is_contiguous(input_tensor)) {                                     \
-            try_(UNARY_WITH_DISPTCH(_name##_opt_impl));                        \
+    result<void> nncase::kernels::stackvm::reference::_name(                   \
+        typecode_t typecode, const gsl::byte *input, gsl::byte *output,        \
+        gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,  \
+        gsl::span<const size_t> out_shape,                                     \
+        gsl::span<const size_t> out_strides, kernel_context &context) {        \
+        if (is_contiguous(in_shape, in_strides)) {                             \
+            return UNARY_WITH_DISPTCH(_name##_opt_impl);                       \
         } else {                                                               \
-            try_(UNARY_WITH_DISPTCH(_name##_impl));                            \
+            return UNARY_WITH_DISPTCH(_name##_impl);                           \
         }                                                                      \
-        return ok(output);                                                     \
     }
 
 #define UNARY_TEMPLATE(_name, _compute)                                        \
@@ -71,10 +69,8 @@
     UNARY_OP_TEMPLATE(_name)
 
 #define UNARY_WITH_DISPTCH(_impl_func)                                         \
-    _impl_func##_disptch(typecode, input_mem, output_mem,                      \
-                         input_tensor->shape(), input_tensor->strides(),       \
-                         output_tensor->shape(), output_tensor->strides(),     \
-                         context)
+    _impl_func##_disptch(typecode, input, output, in_shape, in_strides,        \
+                         out_shape, out_strides, context)
 
 #define UNARY_WITH_DISPTCH_OP_TEMPLATE_V2(_impl_func)                          \
     result<void> _impl_func##_disptch(                                         \
@@ -219,27 +215,22 @@
         TYPE_SELECT_WITH_IMPL(type, UNARY_IMPL_FUNC_WRAPPER, _impl_func);      \
     }
 
-#define UNARY_WITH_MUL_DISPTCH(_impl_func)                                     \
-    _impl_func##_disptch(typecode, input_mem, output_mem, _alpha_name_mem,     \
-                         input_tensor->shape(), input_tensor->strides(),       \
-                         output_tensor->shape(), output_tensor->strides(),     \
-                         context)
+#define UNARY_WITH_MUL_DISPTCH(_impl_func, _alpha_name)                        \
+    _impl_func##_disptch(typecode, input, output, _alpha_name, in_shape,       \
+                         in_strides, out_shape, out_strides, context)
 
 #define UNARY_WITH_MUL_OP_TEMPLATE_V2(_name, _alpha_name)                      \
-    result<value_t> nncase::kernels::stackvm::_name(                           \
-        value_t input, value_t _alpha_name, value_t output,                    \
-        kernel_context &context) {                                             \
-        try_input(input_mem, input);                                           \
-        try_input(_alpha_name_mem, _alpha_name);                               \
-        auto dtype = input_tensor->dtype();                                    \
-        try_output_like_input(output_mem, output, input_tensor);               \
-        try_var(typecode, to_typecode(input_tensor->dtype()));                 \
-        if (is_contiguous(input_tensor)) {                                     \
-            try_(UNARY_WITH_MUL_DISPTCH(_name##_contiguous_impl));             \
+    result<void> nncase::kernels::stackvm::reference::_name(                   \
+        typecode_t typecode, const gsl::byte *input, gsl::byte *output,        \
+        const gsl::byte *_alpha_name, gsl::span<const size_t> in_shape,        \
+        gsl::span<const size_t> in_strides, gsl::span<const size_t> out_shape, \
+        gsl::span<const size_t> out_strides, kernel_context &context) {        \
+        if (is_contiguous(in_shape, in_strides)) {                             \
+            return UNARY_WITH_MUL_DISPTCH(_name##_contiguous_impl,             \
+                                          _alpha_name);                        \
         } else {                                                               \
-            try_(UNARY_WITH_MUL_DISPTCH(_name##_impl));                        \
+            return UNARY_WITH_MUL_DISPTCH(_name##_impl, _alpha_name);          \
         }                                                                      \
-        return ok(output);                                                     \
     }
 
 // _alpha_name is a var used in kernel
@@ -368,24 +359,19 @@
         return ok(output);                                                     \
     }
 
-#define UNARY_WITH_DISPTCH_V2(_impl_func)                                      \
-    _impl_func##_disptch(typecode, input_mem, output_mem, _alpha_name_mem,     \
-                         _gamma_name_mem, input_tensor->shape(),               \
-                         input_tensor->strides(), output_tensor->shape(),      \
-                         output_tensor->strides(), context)
+#define UNARY_WITH_DISPTCH_V2(_impl_func, _alpha_name, _gamma_name)            \
+    _impl_func##_disptch(typecode, input, output, _alpha_name, _gamma_name,    \
+                         in_shape, in_strides, out_shape, out_strides,         \
+                         context)
 
 #define ACTIVATION_OP_TEMPLATE_V2(_name, _alpha_name, _gamma_name)             \
-    result<value_t> nncase::kernels::stackvm::_name(                           \
-        value_t input, value_t _alpha_name, value_t _gamma_name,               \
-        value_t output, kernel_context &context) {                             \
-        try_input(input_mem, input);                                           \
-        auto dtype = input_tensor->dtype();                                    \
-        try_input(_alpha_name_mem, _alpha_name);                               \
-        try_input(_gamma_name_mem, _gamma_name);                               \
-        try_var(typecode, to_typecode(input_tensor->dtype()));                 \
-        try_output_like_input(output_mem, output, input_tensor);               \
-        try_(UNARY_WITH_DISPTCH_V2(_name##_impl));                             \
-        return ok(output);                                                     \
+    result<void> nncase::kernels::stackvm::reference::_name(                   \
+        typecode_t typecode, const gsl::byte *input, gsl::byte *output,        \
+        const gsl::byte *_alpha_name, const gsl::byte *_gamma_name,            \
+        gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,  \
+        gsl::span<const size_t> out_shape,                                     \
+        gsl::span<const size_t> out_strides, kernel_context &context) {        \
+        return UNARY_WITH_DISPTCH_V2(_name##_impl, _alpha_name, _gamma_name);  \
     }
 
 #define UNARY_IMPL_FUNC_WRAPPER_V3(_impl_func, type)                           \
@@ -23,14 +23,17 @@ using namespace nncase::kernels::stackvm;
 
 template <class T>
 static void layernorm_impl(int inner_size, const T *src, const T *scale,
-                           const T *bias, float epsilon, T *dst) {
+                           const T *bias, float epsilon, T *dst,
+                           bool use_mean = true, size_t stride = 1) {
     T mean1 = 0;
-    for (auto i = 0; i < inner_size; i++)
-        mean1 += src[i] / inner_size;
+    if (use_mean) {
+        for (auto i = 0; i < inner_size; i++)
+            mean1 += src[i * stride] / inner_size;
+    }
 
     std::vector<T> sub(inner_size, 0);
     for (auto i = 0; i < inner_size; i++)
-        sub[i] = src[i] - mean1;
+        sub[i] = src[i * stride] - mean1;
 
     std::vector<T> pow(inner_size, 0);
     for (auto i = 0; i < inner_size; i++)
@@ -48,13 +51,14 @@ static void layernorm_impl(int inner_size, const T *src, const T *scale,
         div[i] = sub[i] / sqrt;
 
     for (auto i = 0; i < inner_size; i++)
-        dst[i] = div[i] * scale[i] + bias[i];
+        dst[i * stride] = div[i] * scale[i] + bias[i];
 }
 
 template <class T>
 result<void> layer_norm_impl2(const T *input, T *output, const T *scale,
                               const T *bias, gsl::span<const size_t> in_shape,
-                              int32_t axis, float epsilon) {
+                              int32_t axis, float epsilon, bool use_mean,
+                              bool channel_first) {
 
     int ndim = in_shape.size();
     int positive_axis = axis < 0 ? ndim + axis : axis;
@@ -64,12 +68,31 @@ result<void> layer_norm_impl2(const T *input, T *output, const T *scale,
     for (size_t i = 0; i < positive_axis; i++)
         out_side *= in_shape[i];
 
+    // channel first: normalize over the axis dim only, independently for
+    // every position of the dims after it
+    if (channel_first && positive_axis != ndim - 1) {
+        axis_dim = in_shape[positive_axis];
+        size_t inner_side = 1;
+        for (size_t i = positive_axis + 1; i < ndim; i++)
+            inner_side *= in_shape[i];
+
+        for (size_t i = 0; i < out_side; i++) {
+            for (size_t j = 0; j < inner_side; j++)
+                layernorm_impl(axis_dim, input + j, scale, bias, epsilon,
+                               output + j, use_mean, inner_side);
+            input += axis_dim * inner_side;
+            output += axis_dim * inner_side;
+        }
+        return ok();
+    }
+
     for (size_t i = positive_axis; i < ndim; i++) {
         axis_dim *= in_shape[i];
     }
 
     for (size_t i = 0; i < out_side; i++) {
-        layernorm_impl(axis_dim, input, scale, bias, epsilon, output);
+        layernorm_impl(axis_dim, input, scale, bias, epsilon, output,
+                       use_mean);
         input += axis_dim;
         output += axis_dim;
     }
@@ -79,7 +102,7 @@ result<void> layer_norm_impl2(const T *input, T *output, const T *scale,
 #define LAYER_NORM_IMPL(type)                                                  \
     return layer_norm_impl2(IN_CAST(type, input), OUT_CAST(type, output),      \
                             IN_CAST(type, scale), IN_CAST(type, bias),         \
-                            in_shape, axis, epsilon)
+                            in_shape, axis, epsilon, use_mean, channel_first)
 
 #define TYPE_SELECT_LAYER_NORM(_typecode, _impl)                               \
     switch (_typecode) {                                                       \
@@ -114,6 +137,7 @@ result<void> layer_norm_impl2(const T *input, T *output, const T *scale,
 result<void> nncase::kernels::stackvm::reference::layer_norm(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
     const gsl::byte *scale, const gsl::byte *bias,
-    gsl::span<const size_t> in_shape, int32_t axis, float epsilon) {
+    gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+    bool use_mean, bool channel_first) {
     TYPE_SELECT_LAYER_NORM(typecode, LAYER_NORM_IMPL);
 }
@@ -0,0 +1,87 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ref_ops.h"
+#include <cmath>
+#include <nncase/kernels/apply.h>
+#include <nncase/kernels/kernel_utils.h>
+#include <nncase/runtime/runtime_op_utility.h>
+#include <nncase/runtime/util.h>
+#include <vector>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::kernels;
+using namespace nncase::kernels::stackvm;
+
+namespace {
+// y = x / norm_p(x) along axis, p in {1, 2}; zero norms give zero outputs.
+template <typename T>
+result<void> lp_normalization_impl(const T *input, T *output,
+                                   gsl::span<const size_t> in_shape,
+                                   gsl::span<const size_t> in_strides,
+                                   gsl::span<const size_t> out_strides,
+                                   size_t axis, int64_t p) {
+    const auto axes = dims_t{axis};
+    const auto norm_shape =
+        kernels::detail::get_reduced_shape(in_shape, axes, true);
+    const auto norm_strides = get_default_strides(norm_shape);
+    std::vector<float> norm(compute_size(norm_shape), 0.f);
+    auto norm_offset = [&](gsl::span<const size_t> index) {
+        return offset(norm_strides,
+                      kernels::detail::get_reduced_offset(index, axes, true));
+    };
+
+    try_(apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
+        const auto x = static_cast<float>(input[offset(in_strides, index)]);
+        norm[norm_offset(index)] += p == 1 ? std::fabs(x) : x * x;
+        return ok();
+    }));
+    return apply(in_shape, [&](gsl::span<const size_t> index) -> result<void> {
+        const auto n = p == 1 ? norm[norm_offset(index)]
+                              : std::sqrt(norm[norm_offset(index)]);
+        const auto x = static_cast<float>(input[offset(in_strides, index)]);
+        output[offset(out_strides, index)] =
+            static_cast<T>(n == 0.f ? 0.f : x / n);
+        return ok();
+    });
+}
+} // namespace
+
+#define LP_NORMALIZATION_IMPL(type)                                            \
+    return lp_normalization_impl(IN_CAST(type, input), OUT_CAST(type, output), \
+                                 in_shape, in_strides, out_strides, axis, p)
+
+#define TYPE_SELECT_LP_NORMALIZATION(_typecode, _impl)                         \
+    switch (_typecode) {                                                       \
+    case dt_float32:                                                           \
+        _impl(float);                                                          \
+    case dt_float16:                                                           \
+        _impl(half);                                                           \
+    case dt_bfloat16:                                                          \
+        _impl(bfloat16);                                                       \
+    case dt_float64:                                                           \
+        _impl(double);                                                         \
+    default:                                                                   \
+        return err(std::errc::not_supported);                                  \
+    }
+
+result<void> nncase::kernels::stackvm::reference::lp_normalization(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides, size_t axis, int64_t p) {
+    if (p != 1 && p != 2)
+        return err(std::errc::not_supported);
+    TYPE_SELECT_LP_NORMALIZATION(typecode, LP_NORMALIZATION_IMPL);
+}
@@ -66,7 +66,7 @@ result<void> lrn_impl2(typecode_t type, const T *input, float alpha, float beta,
                      static_cast<int64_t>(i - std::floor((size - 1) / 2)));
         auto endV =
             std::min(static_cast<int64_t>(in_shape[1] - 1),
-                     static_cast<int64_t>(i + std::ceil((size - 1) / 2)));
+                     static_cast<int64_t>(i + std::ceil((size - 1) / 2.f)));
         auto begins = axes_t{0, (int64_t)beginV, 0, 0};
         auto ends = axes_t{static_cast<int64_t>(in_shape[0]),
                            static_cast<int64_t>(endV + 1),
@@ -79,7 +79,7 @@ result<void> lrn_impl2(typecode_t type, const T *input, float alpha, float beta,
             std::make_unique<T[]>(runtime::compute_size(tmp_out_shape));
         try_(slice(type, IN_BYTE_CAST(square_data.get()),
                    OUT_CAST(gsl::byte, slice_out.get()), in_shape, in_strides,
-                   out_strides, begins, ends, strides,
+                   tmp_out_strides, begins, ends, strides,
                    default_kernel_context()));
 
         auto keep_dims = true;
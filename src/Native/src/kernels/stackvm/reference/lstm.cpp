@@ -81,7 +81,7 @@ result<void> lstm_impl(const T *input, const T *w_xc, const T *w_rc,
 
                         out_mul1[o] += T(input[in_idx]) * T(w_xc[w_idx]);
                     }
-                    auto b_idx1 = d * w_rc_shape[2] + o;
+                    auto b_idx1 = d * 2 * w_rc_shape[2] + o;
                     out_mul1[o] += bias[b_idx1];
 
                     for (size_t i = 0; i < out_shape[3]; i++) {
@@ -91,7 +91,7 @@ result<void> lstm_impl(const T *input, const T *w_xc, const T *w_rc,
                                      d * w_rc_shape[2] * w_rc_shape[3];
                         out_mul2[o] += T(output_h_tmp[in_idx]) * T(w_rc[w_idx]);
                     }
-                    auto b_idx2 = d * w_rc_shape[2] + hidden_size + o;
+                    auto b_idx2 = d * 2 * w_rc_shape[2] + hidden_size + o;
                     out_mul2[o] += bias[b_idx2];
 
                     out_mul1[o] += out_mul2[o];
@@ -132,7 +132,8 @@ result<void> lstm_impl(const T *input, const T *w_xc, const T *w_rc,
 
                 // ct = ct + c_t_it
                 for (size_t o = 0; o < out_shape[3]; o++) {
-                    output_c_tmp[o + d * out_shape[2] * out_shape[3]] =
+                    output_c_tmp[o + b * out_shape[3] +
+                                 d * out_shape[2] * out_shape[3]] =
                         T(out_mul1[o + out_shape[3] * 2] +
                           out_mul1[o + out_shape[3] * 0]);
                 }
@@ -146,31 +147,33 @@ result<void> lstm_impl(const T *input, const T *w_xc, const T *w_rc,
                 // tanh_ct = tanh(ct_o)
                 for (size_t o = 0; o < out_shape[3]; o++) {
                     out_mul1[o + out_shape[3] * 3] = tanh(float(
-                        output_c_tmp[o + d * out_shape[2] * out_shape[3]]));
+                        output_c_tmp[o + b * out_shape[3] +
+                                     d * out_shape[2] * out_shape[3]]));
                 }
 
                 // ht = ot * tanh_ct
                 for (size_t o = 0; o < out_shape[3]; o++) {
-                    output_h_tmp[o + d * out_shape[2] * out_shape[3]] =
+                    output_h_tmp[o + b * out_shape[3] +
+                                 d * out_shape[2] * out_shape[3]] =
                         T(out_mul1[o + out_shape[3] * 3] *
                           out_mul1[o + out_shape[3] * 1]);
                 }
                 std::memcpy(output + b * out_shape[3] +
                                 d * out_shape[2] * out_shape[3] +
                                 l * out_shape[1] * out_shape[2] * out_shape[3],
-                            output_h_tmp.get() +
+                            output_h_tmp.get() + b * out_shape[3] +
                                 d * out_shape[2] * out_shape[3],
                             sizeof(T) * out_shape[3]);
 
                 if (l == seq_len_loop.back()) {
                     std::memcpy(output_h + b * out_shape[3] +
                                     d * out_shape[2] * out_shape[3],
-                                output_h_tmp.get() +
+                                output_h_tmp.get() + b * out_shape[3] +
                                     d * out_shape[2] * out_shape[3],
                                 sizeof(T) * out_shape[3]);
                     std::memcpy(output_c + b * out_shape[3] +
                                     d * out_shape[2] * out_shape[3],
-                                output_c_tmp.get() +
+                                output_c_tmp.get() + b * out_shape[3] +
                                     d * out_shape[2] * out_shape[3],
                                 sizeof(T) * out_shape[3]);
                 }
@@ -60,5 +60,8 @@ result<void> nncase::kernels::stackvm::reference::quantize(
     QUANTIZE_IMPL(float, uint8_t);
     QUANTIZE_IMPL(float, int8_t);
     QUANTIZE_IMPL(float, int16_t);
+    QUANTIZE_IMPL(bfloat16, uint8_t);
+    QUANTIZE_IMPL(bfloat16, int8_t);
+    QUANTIZE_IMPL(bfloat16, int16_t);
     return err(std::errc::not_supported);
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "ref_ops.h"
 #include <nncase/kernels/kernel_context.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -121,7 +122,7 @@ result<void> reduce_window2d_impl(
             dilation_h, dilation_w, fused_activation, reducer,                 \
             identity_window(), count_include_pad, context)
 
-result<void> reduce_window2d_impl(
+result<void> nncase::kernels::stackvm::reference::reduce_window2d(
     reduce_op_t op, const float *input, float init_value, float *output,
     gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
     gsl::span<const size_t> out_strides, const padding &padding_h,
@@ -142,41 +143,3 @@ result<void> reduce_window2d_impl(
         return err(std::errc::not_supported);
     }
 }
-
-dims_t infer_shape(gsl::span<const size_t> in_shape,
-                   gsl::span<const size_t> filter,
-                   gsl::span<const size_t> stride,
-                   gsl::span<const size_t> dilation,
-                   const paddings_t &paddings) {
-    dims_t new_shape(in_shape);
-    new_shape[2] = kernels::detail::get_windowed_output_size(
-        in_shape[2], filter[0], stride[0], dilation[0], paddings[0]);
-    new_shape[3] = kernels::detail::get_windowed_output_size(
-        in_shape[3], filter[1], stride[1], dilation[1], paddings[1]);
-    return new_shape;
-}
-
-result<value_t> nncase::kernels::stackvm::reduce_window2d(
-    reduce_op_t reduce_op, value_t input, value_t init_value, value_t filter,
-    value_t stride, value_t padding, value_t dilation,
-    [[maybe_unused]] value_t ceil_mode,
-    [[maybe_unused]] value_t count_include_pad, value_t output,
-    kernel_context &context) {
-    try_f32_input(input_mem, input);
-    try_to_scalar(init_v, init_value, float);
-    try_dims(filter_value, filter);
-    try_dims(strides_value, stride);
-    try_dims(dilations_value, dilation);
-    try_paddings(pads, padding);
-    try_to_scalar(count_include_pad_value, count_include_pad, bool);
-    auto out_shape = infer_shape(input_tensor->shape(), filter_value,
-                                 strides_value, dilations_value, pads);
-    try_f32_output(out_mem, output, out_shape);
-    try_(reduce_window2d_impl(
-        reduce_op, input_mem, init_v, out_mem, input_tensor->shape(),
-        input_tensor->strides(), output_tensor->strides(), pads[0], pads[1],
-        filter_value[0], filter_value[1], strides_value[0], strides_value[1],
-        dilations_value[0], dilations_value[1], value_range<float>::full(),
-        count_include_pad_value, context));
-    return ok(output);
-}
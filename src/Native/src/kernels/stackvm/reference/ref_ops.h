@@ -36,16 +36,18 @@ batchnorm(typecode_t typecode, const gsl::byte *input, const gsl::byte *scale,
           gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
           gsl::span<const size_t> out_strides, float epsilon);
 
-NNCASE_API result<void> layer_norm(typecode_t type, const gsl::byte *input,
-                                   gsl::byte *output, const gsl::byte *scale,
-                                   const gsl::byte *bias,
-                                   gsl::span<const size_t> in_shape,
-                                   int32_t axis, float epsilon);
-
 NNCASE_API result<void>
-batch_to_space(tensor input, tensor block_shape, tensor crops,
-               tensor output = nullptr,
-               kernel_context &context = default_kernel_context());
+layer_norm(typecode_t type, const gsl::byte *input, gsl::byte *output,
+           const gsl::byte *scale, const gsl::byte *bias,
+           gsl::span<const size_t> in_shape, int32_t axis, float epsilon,
+           bool use_mean = true, bool channel_first = false);
+
+NNCASE_API result<void> batch_to_space(
+    datatype_t type, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> block_shape,
+    const paddings_t &crops, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context()) noexcept;
 
 NNCASE_API result<void> binary(
     typecode_t typecode, nncase::runtime::stackvm::binary_op_t op,
@@ -66,8 +68,17 @@ cast(typecode_t new_type, tensor input, tensor output = nullptr,
      kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
-celu(tensor input, tensor alpha, tensor output = nullptr,
-     kernel_context &context = default_kernel_context());
+cast(datatype_t in_type, datatype_t out_type, const gsl::byte *input,
+     gsl::byte *output, gsl::span<const size_t> in_shape,
+     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+     kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> celu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> clamp(
     typecode_t type, const gsl::byte *input, const gsl::byte *min,
@@ -75,7 +86,7 @@ NNCASE_API result<void> clamp(
     gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
     NNCASE_UNUSED kernel_context &context = default_kernel_context()) noexcept;
 
-NNCASE_API result<void> compare_impl(
+NNCASE_API result<void> compare(
     typecode_t typecode, nncase::runtime::stackvm::compare_op_t op,
     const gsl::byte *lhs, const gsl::byte *rhs, gsl::byte *output,
     gsl::span<const size_t> lhs_shape, gsl::span<const size_t> lhs_strides,
@@ -115,9 +126,9 @@ NNCASE_API result<void> conv2d_transpose(
     [[maybe_unused]] const value_range<float> &fused_activation) noexcept;
 
 NNCASE_API result<void>
-cum_sum(tensor input, tensor axis, tensor exclusive, tensor reverse,
-        tensor output = nullptr,
-        kernel_context &context = default_kernel_context());
+cum_sum(typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+        gsl::span<const size_t> in_shape, int32_t axis, bool exclusive,
+        bool reverse) noexcept;
 
 NNCASE_API result<void> dequantize(datatype_t in_type, datatype_t out_type,
                                    const gsl::byte *input, gsl::byte *output,
@@ -127,8 +138,18 @@ NNCASE_API result<void> dequantize(datatype_t in_type, datatype_t out_type,
                                    float scale, float bias,
                                    kernel_context &context) noexcept;
 
-NNCASE_API result<void> elu(tensor input, tensor alpha, tensor output = nullptr,
-                            kernel_context &context = default_kernel_context());
+NNCASE_API result<void> elu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
+
+NNCASE_API result<void> erf(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> expand(
     typecode_t typecode, const gsl::byte *input, gsl::byte *output,
@@ -178,13 +199,25 @@ NNCASE_API result<void>
 get_item(tensor input, tensor index, tensor output = nullptr,
          kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-hard_sigmoid(tensor input, tensor alpha, tensor beta, tensor output = nullptr,
-             kernel_context &context = default_kernel_context());
+NNCASE_API result<void> gelu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-hard_swish(tensor input, tensor output = nullptr,
-           kernel_context &context = default_kernel_context());
+NNCASE_API result<void> hard_sigmoid(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha, const gsl::byte *gamma,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
+
+NNCASE_API result<void> hard_swish(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
 hardmax(tensor input, tensor axis, tensor output = nullptr,
@@ -201,13 +234,18 @@ NNCASE_API result<void>
 l2_normalization(tensor input, tensor output = nullptr,
                  kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-leaky_relu(tensor input, tensor alpha, tensor output = nullptr,
-           kernel_context &context = default_kernel_context());
+NNCASE_API result<void> leaky_relu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
-lp_normalization(tensor input, tensor axis, tensor p, tensor output = nullptr,
-                 kernel_context &context = default_kernel_context());
+lp_normalization(typecode_t typecode, const gsl::byte *input,
+                 gsl::byte *output, gsl::span<const size_t> in_shape,
+                 gsl::span<const size_t> in_strides,
+                 gsl::span<const size_t> out_strides, size_t axis, int64_t p);
 
 NNCASE_API result<void> lrn(typecode_t typecode, const gsl::byte *input,
                             float alpha, float beta, float bias, int size,
@@ -315,6 +353,15 @@ reduce_arg(runtime::stackvm::reduce_arg_op_t reduce_arg_op, tensor input,
            tensor output = nullptr,
            kernel_context &context = default_kernel_context());
 
+NNCASE_API result<void>
+reduce_arg(typecode_t input_typecode, typecode_t output_typecode,
+           runtime::stackvm::reduce_arg_op_t op, const gsl::byte *input,
+           gsl::byte *output, gsl::span<const size_t> in_shape,
+           gsl::span<const size_t> in_strides,
+           gsl::span<const size_t> out_strides, gsl::span<const size_t> axes,
+           bool keep_dims, bool select_last_idx,
+           kernel_context &context = default_kernel_context()) noexcept;
+
 NNCASE_API result<void>
 reduce_window2d(runtime::stackvm::reduce_op_t reduce_op, tensor input,
                 tensor init_value, tensor filter, tensor stride, tensor padding,
@@ -322,9 +369,21 @@ reduce_window2d(runtime::stackvm::reduce_op_t reduce_op, tensor input,
                 tensor output = nullptr,
                 kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-relu(tensor input, tensor output = nullptr,
-     kernel_context &context = default_kernel_context());
+NNCASE_API result<void> reduce_window2d(
+    runtime::stackvm::reduce_op_t op, const float *input, float init_value,
+    float *output, gsl::span<const size_t> in_shape,
+    gsl::span<const size_t> in_strides, gsl::span<const size_t> out_strides,
+    const padding &padding_h, const padding &padding_w, int32_t filter_h,
+    int32_t filter_w, int32_t stride_h, int32_t stride_w, int32_t dilation_h,
+    int32_t dilation_w, value_range<float> fused_activation,
+    bool count_include_pad,
+    kernel_context &context = default_kernel_context()) noexcept;
+
+NNCASE_API result<void> relu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
 relu6(tensor input, tensor output = nullptr,
@@ -368,17 +427,22 @@ select(tensor predicate, tensor true_value, tensor false_value,
        tensor output = nullptr,
        kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-selu(tensor input, tensor alpha, tensor gamma, tensor output = nullptr,
-     kernel_context &context = default_kernel_context());
+NNCASE_API result<void> selu(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    const gsl::byte *alpha, const gsl::byte *gamma,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
 shape_of(tensor input, tensor output = nullptr,
          kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-sigmoid(tensor input, tensor output = nullptr,
-        kernel_context &context = default_kernel_context());
+NNCASE_API result<void> sigmoid(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void>
 size_of(tensor input, tensor output = nullptr,
@@ -404,13 +468,17 @@ NNCASE_API result<void> log_softmax(typecode_t typecode, const gsl::byte *input,
                                     gsl::span<const size_t> out_strides,
                                     int32_t axis) noexcept;
 
-NNCASE_API result<void>
-softplus(tensor input, tensor output = nullptr,
-         kernel_context &context = default_kernel_context());
+NNCASE_API result<void> softplus(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
-NNCASE_API result<void>
-softsign(tensor input, tensor output = nullptr,
-         kernel_context &context = default_kernel_context());
+NNCASE_API result<void> softsign(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> space_to_batch(
     datatype_t dt, const gsl::byte *input, gsl::byte *output,
@@ -439,6 +507,12 @@ result<void> stack(datatype_t type, gsl::span<const gsl::byte *const> inputs,
                    gsl::span<const size_t> out_strides, size_t axis,
                    kernel_context &context = default_kernel_context()) noexcept;
 
+NNCASE_API result<void> swish(
+    typecode_t typecode, const gsl::byte *input, gsl::byte *output,
+    gsl::span<const size_t> in_shape, gsl::span<const size_t> in_strides,
+    gsl::span<const size_t> out_shape, gsl::span<const size_t> out_strides,
+    kernel_context &context = default_kernel_context());
+
 NNCASE_API result<void>
 tile(datatype_t dt, const gsl::byte *input, gsl::byte *output,
      gsl::span<const size_t> in_shape, gsl::span<const size_t> out_shape,
@@ -495,7 +569,8 @@ where(datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
       gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
       gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
       gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-      gsl::span<const size_t> out_strides);
+      gsl::span<const size_t> out_strides,
+      kernel_context &context = default_kernel_context());
 
 NNCASE_API result<void> grid_sample(
     typecode_t type, const gsl::byte *input, const gsl::byte *grid,
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "ref_ops.h"
+#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/host_buffer.h>
@@ -32,12 +33,12 @@ result<void> unary_impl(TOp &&op, const T *input, T *output,
                         gsl::span<const size_t> input_strides,
                         gsl::span<const size_t> out_shape,
                         gsl::span<const size_t> out_strides,
-                        NNCASE_UNUSED kernel_context &context) noexcept {
-    return apply(out_shape, [&](gsl::span<const size_t> index) -> result<void> {
-        const auto v = input[offset(input_strides, index)];
-        output[offset(out_strides, index)] = (T)op(v);
-        return ok();
-    });
+                        kernel_context &context) noexcept {
+    apply_strided<2>(
+        out_shape, {input_strides, out_strides},
+        [&](size_t in, size_t out) { output[out] = (T)op(input[in]); },
+        context.num_threads);
+    return ok();
 }
 
 #define UNARY_IMPL_OP(op, funct)                                               \
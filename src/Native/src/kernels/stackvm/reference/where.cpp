@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "ref_ops.h"
+#include <nncase/kernels/apply.h>
 #include <nncase/kernels/kernel_utils.h>
 #include <nncase/runtime/allocator.h>
 #include <nncase/runtime/datatypes.h>
@@ -33,29 +34,25 @@ where_impl(const bool *cond, const T *x, const T *y, T *output,
            gsl::span<const size_t> y_shape, gsl::span<const size_t> out_shape,
            gsl::span<const size_t> cond_strides,
            gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-           gsl::span<const size_t> out_strides) {
-    return apply(out_shape, [&](const auto &index) -> result<void> {
-        const auto cond_index =
-            kernels::detail::get_reduced_offset(index, cond_shape);
-        const auto x_index =
-            kernels::detail::get_reduced_offset(index, x_shape);
-        const auto y_index =
-            kernels::detail::get_reduced_offset(index, y_shape);
-
-        const auto a = cond[offset(cond_strides, cond_index)];
-        const auto b = x[offset(x_strides, x_index)];
-        const auto c = y[offset(y_strides, y_index)];
-
-        output[offset(out_strides, index)] = a ? b : c;
-        return ok();
-    });
+           gsl::span<const size_t> out_strides, kernel_context &context) {
+    const auto cond_bstrides =
+        broadcast_strides(cond_shape, cond_strides, out_shape);
+    const auto x_bstrides = broadcast_strides(x_shape, x_strides, out_shape);
+    const auto y_bstrides = broadcast_strides(y_shape, y_strides, out_shape);
+    apply_strided<4>(
+        out_shape, {cond_bstrides, x_bstrides, y_bstrides, out_strides},
+        [&](size_t c, size_t a, size_t b, size_t out) {
+            output[out] = cond[c] ? x[a] : y[b];
+        },
+        context.num_threads);
+    return ok();
 }
 
 #define WHERE_IMPL(_ty)                                                        \
     return where_impl(cond, IN_CAST(_ty, x), IN_CAST(_ty, y),                  \
                       OUT_CAST(_ty, output), cond_shape, x_shape, y_shape,     \
                       out_shape, cond_strides, x_strides, y_strides,           \
-                      out_strides);
+                      out_strides, context);
 
 result<void> nncase::kernels::stackvm::reference::where(
     datatype_t dt, const bool *cond, const gsl::byte *x, const gsl::byte *y,
@@ -63,7 +60,7 @@ result<void> nncase::kernels::stackvm::reference::where(
     gsl::span<const size_t> x_shape, gsl::span<const size_t> y_shape,
     gsl::span<const size_t> out_shape, gsl::span<const size_t> cond_strides,
     gsl::span<const size_t> x_strides, gsl::span<const size_t> y_strides,
-    gsl::span<const size_t> out_strides) {
+    gsl::span<const size_t> out_strides, kernel_context &context) {
     try_var(tycode, to_typecode(dt));
     TYPE_SELECT(tycode, WHERE_IMPL);
 }
\ No newline at end of file
@@ -262,6 +262,19 @@ inline dims_t pad_infer_shape(gsl::span<const size_t> in_shape,
     return new_shape;
 }
 
+inline dims_t reduce_window2d_infer_shape(gsl::span<const size_t> in_shape,
+                                         gsl::span<const size_t> filter,
+                                         gsl::span<const size_t> stride,
+                                         gsl::span<const size_t> dilation,
+                                         const paddings_t &paddings) {
+    dims_t new_shape(in_shape);
+    new_shape[2] = kernels::detail::get_windowed_output_size(
+        in_shape[2], filter[0], stride[0], dilation[0], paddings[0]);
+    new_shape[3] = kernels::detail::get_windowed_output_size(
+        in_shape[3], filter[1], stride[1], dilation[1], paddings[1]);
+    return new_shape;
+}
+
 inline dims_t space_to_batch_shape_infer(gsl::span<const size_t> in_shape,
                                          gsl::span<const size_t> block_shape,
                                          const paddings_t &paddings) {
@@ -280,6 +293,36 @@ inline dims_t space_to_batch_shape_infer(gsl::span<const size_t> in_shape,
     return out_shape;
 }
 
+inline dims_t
+batch_to_space_infer_shape(gsl::span<const size_t> origin_in_shape,
+                           gsl::span<const size_t> block_shape,
+                           const paddings_t &crops) {
+    auto d4 = fixed_dims(0, 2, 3, 1);
+    auto d3 = fixed_dims(0, 2, 1);
+    auto inPerm = origin_in_shape.size() == 4
+                      ? gsl::span<const size_t>{d4.data(), d4.size()}
+                      : gsl::span<const size_t>{d3.data(), d3.size()};
+    auto in_shape = transpose_infer_shape(origin_in_shape, inPerm);
+    auto batch = in_shape[0] / runtime::compute_size(block_shape);
+    auto out_shape = dims_t{batch};
+    auto m = block_shape.size();
+    for (size_t i = 0; i < m; ++i) {
+        auto d = in_shape[i + 1] * block_shape[i] - crops[i].sum();
+        out_shape.push_back(d);
+    }
+    auto remain_size = in_shape.size() - 1 - m;
+    if (remain_size > 0) {
+        out_shape.insert(out_shape.end(), in_shape.end() - remain_size,
+                         in_shape.end());
+    }
+    auto outd4 = fixed_dims(0, 3, 1, 2);
+    auto outd3 = fixed_dims(0, 2, 1);
+    auto outPerm = origin_in_shape.size() == 4
+                       ? gsl::span<const size_t>{outd4.data(), outd4.size()}
+                       : gsl::span<const size_t>{outd3.data(), outd3.size()};
+    return transpose_infer_shape(out_shape, outPerm);
+}
+
 inline dims_t onehot_infer_shape(gsl::span<const size_t> indices_shape,
                                  size_t depth, size_t axis) {
     dims_t new_shape(indices_shape);
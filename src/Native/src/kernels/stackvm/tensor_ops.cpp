@@ -15,8 +15,12 @@
 #include "optimized/opt_ops.h"
 #include "reference/ref_ops.h"
 #include "shape_infer.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <limits>
 #include <nncase/kernels/kernel_utils.h>
+#include <nncase/kernels/stackvm/quantized_ops.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
 #include <nncase/runtime/runtime_tensor.h>
 #include <nncase/runtime/util.h>
@@ -30,7 +34,7 @@ using namespace nncase::runtime::stackvm;
 result<value_t> nncase::kernels::stackvm::batch_normalization(
     value_t input, value_t scale, value_t bias, value_t input_mean,
     value_t input_var, value_t epsilon, [[maybe_unused]] value_t momentum,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     try_input(input_mem, input);
     try_input(scale_mem, scale);
     try_input(bias_mem, bias);
@@ -39,34 +43,66 @@ result<value_t> nncase::kernels::stackvm::batch_normalization(
     try_float_scalar(eps, epsilon);
     try_output_like_input(output_mem, output, input_tensor);
     try_typecode(typecode, input_tensor);
-    try_(reference::batchnorm(typecode, input_mem, scale_mem, bias_mem,
-                              mean_mem, var_mem, output_mem,
-                              input_tensor->shape(), input_tensor->strides(),
-                              output_tensor->strides(), eps));
+    if (is_contiguous(input_tensor)) {
+        try_(optimized::batchnorm(typecode, input_mem, scale_mem, bias_mem,
+                                  mean_mem, var_mem, output_mem,
+                                  input_tensor->shape(), eps, context));
+    } else {
+        try_(reference::batchnorm(
+            typecode, input_mem, scale_mem, bias_mem, mean_mem, var_mem,
+            output_mem, input_tensor->shape(), input_tensor->strides(),
+            output_tensor->strides(), eps));
+    }
     KERNEL_FINISH;
 }
 
 result<value_t> nncase::kernels::stackvm::layer_norm(
-    int32_t axis, float epsilon, [[maybe_unused]] bool use_mean,
-    [[maybe_unused]] bool channel_first, value_t input, value_t scale,
-    value_t bias, value_t output, [[maybe_unused]] kernel_context &context) {
+    int32_t axis, float epsilon, bool use_mean, bool channel_first,
+    value_t input, value_t scale, value_t bias, value_t output,
+    kernel_context &context) {
     try_input(input_mem, input);
     try_input(scale_mem, scale);
     try_input(bias_mem, bias);
     try_output_like_input(output_mem, output, input_tensor);
     try_typecode(typecode, input_tensor);
-    if (typecode == dt_float32) {
-        CONTIGUOUS_KERNEL(layer_norm, input_tensor, typecode, input_mem,
-                          output_mem, scale_mem, bias_mem,
-                          input_tensor->shape(), axis, epsilon);
+    if (typecode == dt_float32 && is_contiguous(input_tensor)) {
+        try_(optimized::layer_norm(typecode, input_mem, output_mem, scale_mem,
+                                   bias_mem, input_tensor->shape(), axis,
+                                   epsilon, use_mean, channel_first, context));
     } else {
         try_(reference::layer_norm(typecode, input_mem, output_mem, scale_mem,
                                    bias_mem, input_tensor->shape(), axis,
-                                   epsilon));
+                                   epsilon, use_mean, channel_first));
     }
     KERNEL_FINISH;
 }
 
+result<value_t> nncase::kernels::stackvm::batch_to_space(
+    value_t input, value_t block_shape, value_t crops, value_t output,
+    kernel_context &context) {
+    try_in_mem(input);
+    try_dims_v(block_shape);
+    try_paddings(crops_value, crops);
+    auto dtype = input_tensor->dtype();
+    auto out_shape = batch_to_space_infer_shape(
+        input_tensor->shape(), block_shape_value, crops_value);
+    try_out_mem(output, dtype, out_shape);
+
+    if (optimized::batch_to_space(dtype, input_mem, output_mem,
+                                  input_tensor->shape(), block_shape_value,
+                                  crops_value, input_tensor->strides(),
+                                  output_tensor->shape(),
+                                  output_tensor->strides(), context)
+            .is_ok())
+        KERNEL_FINISH;
+
+    try_(reference::batch_to_space(dtype, input_mem, output_mem,
+                                   input_tensor->shape(), block_shape_value,
+                                   crops_value, input_tensor->strides(),
+                                   output_tensor->strides(), context));
+    KERNEL_FINISH;
+}
+
 result<value_t> kernels::stackvm::binary(binary_op_t binary_op, value_t lhs,
                                          value_t rhs, value_t output,
                                          kernel_context &context) {
@@ -103,13 +139,27 @@ result<value_t> kernels::stackvm::broadcast(value_t input, value_t shape,
     try_var(typecode, to_typecode(dtype));
     try_dims(out_shape, shape);
     try_output(out_mem, output, dtype, out_shape);
-    try_(reference::broadcast(typecode, input_mem, out_mem,
+    try_(optimized::broadcast(typecode, input_mem, out_mem,
                               input_tensor->shape(), input_tensor->strides(),
                               output_tensor->shape(), output_tensor->strides(),
                               context));
     return ok(output);
 }
 
+result<value_t> nncase::kernels::stackvm::cast(
+    typecode_t new_type, runtime::stackvm::cast_mode_t cast_mode, value_t input,
+    value_t output, kernel_context &context) {
+    if (cast_mode != runtime::stackvm::cast_mode_t::kdefault)
+        return err(std::errc::not_supported);
+    try_input(input_mem, input);
+    try_output(out_mem, output, new_type, input_tensor->shape());
+    CONTIGUOUS_KERNEL(cast, input_tensor, input_tensor->dtype(), new_type,
+                      input_mem, out_mem, input_tensor->shape(),
+                      input_tensor->strides(), output_tensor->strides(),
+                      context);
+    return ok(output);
+}
+
 result<value_t>
 nncase::kernels::stackvm::clamp(value_t input, value_t min, value_t max,
                                 value_t output,
@@ -125,6 +175,34 @@ nncase::kernels::stackvm::clamp(value_t input, value_t min, value_t max,
     KERNEL_FINISH;
 }
 
+result<value_t>
+nncase::kernels::stackvm::compare(compare_op_t compare_op, value_t lhs,
+                                  value_t rhs, value_t output,
+                                  kernel_context &context) {
+    try_input(lhs_mem, lhs);
+    try_input(rhs_mem, rhs);
+    if (!cmp_dt(lhs_tensor, rhs_tensor)) {
+        return err(nncase_errc::datatype_mismatch);
+    }
+
+    try_typecode(typecode, lhs_tensor);
+    auto out_shape = nncase::kernels::detail::get_binary_output_shape(
+        lhs_tensor->shape(), rhs_tensor->shape());
+    try_output(out_mem, output, datatype_t::from_type<bool>(), out_shape);
+    if (optimized::compare(typecode, compare_op, lhs_mem, rhs_mem, out_mem,
+                           lhs_tensor->shape(), lhs_tensor->strides(),
+                           rhs_tensor->shape(), rhs_tensor->strides(),
+                           output_tensor->shape(), output_tensor->strides(),
+                           context)
+            .is_ok())
+        return ok(output);
+    try_(reference::compare(
+        typecode, compare_op, lhs_mem, rhs_mem, out_mem, lhs_tensor->shape(),
+        lhs_tensor->strides(), rhs_tensor->shape(), rhs_tensor->strides(),
+        output_tensor->shape(), output_tensor->strides(), context));
+    return ok(output);
+}
+
 result<value_t> nncase::kernels::stackvm::concat(int32_t axis, value_t input,
                                                  value_t output,
                                                  kernel_context &context) {
@@ -208,14 +286,25 @@ result<value_t> nncase::kernels::stackvm::conv2d(
     //     pads[1], groups_value, strides[0], strides[1], dilations[0],
     //     dilations[1], value_range<float>{fused_clamp_value[0],
     //     fused_clamp_value[1]}, context);
-    try_(reference::conv2d(
-        typecode, input_mem, weights_mem, bias_mem, out_mem,
-        input_tensor->shape(), input_tensor->strides(), weights_tensor->shape(),
-        weights_tensor->strides(), bias_tensor->strides(),
-        output_tensor->strides(), pads[0], pads[1], groups_value, strides[0],
-        strides[1], dilations[0], dilations[1],
-        value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
-        context));
+    if (typecode == dt_float16 || typecode == dt_bfloat16) {
+        try_(optimized::conv2d(
+            typecode, input_mem, weights_mem, bias_mem, out_mem,
+            input_tensor->shape(), input_tensor->strides(),
+            weights_tensor->shape(), weights_tensor->strides(),
+            bias_tensor->strides(), output_tensor->strides(), pads[0], pads[1],
+            groups_value, strides[0], strides[1], dilations[0], dilations[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+            context));
+    } else {
+        try_(reference::conv2d(
+            typecode, input_mem, weights_mem, bias_mem, out_mem,
+            input_tensor->shape(), input_tensor->strides(),
+            weights_tensor->shape(), weights_tensor->strides(),
+            bias_tensor->strides(), output_tensor->strides(), pads[0], pads[1],
+            groups_value, strides[0], strides[1], dilations[0], dilations[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+            context));
+    }
     return ok(output);
 }
 
@@ -223,8 +312,7 @@ result<value_t> nncase::kernels::stackvm::conv2d_transpose(
     pad_mode_t pad_mode, value_t input, value_t weights, value_t bias,
     value_t output_shape, value_t stride, value_t padding,
     [[maybe_unused]] value_t output_padding, value_t dilation, value_t groups,
-    value_t fused_clamp, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    value_t fused_clamp, value_t output, kernel_context &context) {
     if (pad_mode != pad_mode_t::constant) {
         return err(nncase_errc::runtime_not_found);
     }
@@ -240,18 +328,28 @@ result<value_t> nncase::kernels::stackvm::conv2d_transpose(
     try_dims(out_shape, output_shape);
     try_typecode(typecode, input_tensor);
     try_output(out_mem, output, typecode, out_shape);
-    try_(reference::conv2d_transpose(
-        typecode, input_mem, out_mem, weights_mem, bias_mem,
-        input_tensor->shape(), groups_value, output_tensor->shape(),
-        weights_tensor->shape()[2], weights_tensor->shape()[3], strides[0],
-        strides[1], dilations[0], dilations[1], pads[0], pads[1],
-        value_range<float>{fused_clamp_value[0], fused_clamp_value[1]}));
+    if (is_contiguous(input_tensor) && is_contiguous(weights_tensor)) {
+        try_(optimized::conv2d_transpose(
+            typecode, input_mem, out_mem, weights_mem, bias_mem,
+            input_tensor->shape(), groups_value, output_tensor->shape(),
+            weights_tensor->shape()[2], weights_tensor->shape()[3], strides[0],
+            strides[1], dilations[0], dilations[1], pads[0], pads[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]},
+            context));
+    } else {
+        try_(reference::conv2d_transpose(
+            typecode, input_mem, out_mem, weights_mem, bias_mem,
+            input_tensor->shape(), groups_value, output_tensor->shape(),
+            weights_tensor->shape()[2], weights_tensor->shape()[3], strides[0],
+            strides[1], dilations[0], dilations[1], pads[0], pads[1],
+            value_range<float>{fused_clamp_value[0], fused_clamp_value[1]}));
+    }
     return ok(output);
 }
 
 result<value_t>
 nncase::kernels::stackvm::expand(value_t input, value_t shape, value_t output,
-                                 [[maybe_unused]] kernel_context &context) {
+                                 kernel_context &context) {
     try_input(input_mem, input);
     auto dtype = input_tensor->dtype();
     try_var(typecode, to_typecode(dtype));
@@ -259,12 +357,31 @@ nncase::kernels::stackvm::expand(value_t input, value_t shape, value_t output,
     auto out_shape = kernels::detail::get_binary_output_shape(
         input_tensor->shape(), expand_shape);
     try_output(out_mem, output, dtype, out_shape);
-    try_(reference::expand(typecode, input_mem, out_mem, input_tensor->shape(),
+    try_(optimized::expand(typecode, input_mem, out_mem, input_tensor->shape(),
                            input_tensor->strides(), output_tensor->shape(),
                            output_tensor->strides(), context));
     return ok(output);
 }
 
+result<value_t> nncase::kernels::stackvm::cum_sum(
+    value_t input, value_t axis, value_t exclusive, value_t reverse,
+    value_t output, kernel_context &context) {
+    try_input(input_mem, input);
+    try_output(out_mem, output, input_tensor->dtype(), input_tensor->shape());
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_to_scalar(exclusive_value, exclusive, bool);
+    try_to_scalar(reverse_value, reverse, bool);
+    try_typecode(typecode, input_tensor);
+    if (is_contiguous(input_tensor) &&
+        optimized::cumsum(typecode, input_mem, out_mem, input_tensor->shape(),
+                          axis_value, exclusive_value, reverse_value, context)
+            .is_ok())
+        return ok(output);
+    try_(reference::cum_sum(typecode, input_mem, out_mem, input_tensor->shape(),
+                            axis_value, exclusive_value, reverse_value));
+    return ok(output);
+}
+
 result<value_t> nncase::kernels::stackvm::dequantize(typecode_t target_type,
                                                      value_t input,
                                                      value_t dequant_param,
@@ -364,6 +481,14 @@ result<value_t> nncase::kernels::stackvm::scatter_nd(value_t input,
     auto dtype = input_tensor->dtype();
     auto out_shape = input_tensor->shape();
     try_output(out_mem, output, dtype, out_shape);
+    if (is_contiguous(input_tensor) && is_contiguous(indices_tensor) &&
+        is_contiguous(updates_tensor) &&
+        optimized::scatter_nd(dtype, input_mem, out_mem, input_tensor->shape(),
+                              indices_tensor->dtype(), indices_mem,
+                              indices_tensor->shape(), updates_memm,
+                              updates_tensor->shape(), context)
+            .is_ok())
+        return ok(output);
     try_(reference::scatter_nd(dtype, input_mem, out_mem, input_tensor->shape(),
                                indices_tensor->dtype(), indices_mem,
                                indices_tensor->shape(), updates_memm,
@@ -450,16 +575,23 @@ result<value_t> nncase::kernels::stackvm::get_item(
 
 result<value_t> nncase::kernels::stackvm::instance_normalization(
     value_t input, value_t scale, value_t bias, value_t epsilon, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    kernel_context &context) {
     try_input(input_mem, input);
     try_input(scale_mem, scale);
     try_input(bias_mem, bias);
     try_float_scalar(eps, epsilon);
     try_output_like_input(output_mem, output, input_tensor);
     try_typecode(type, input_tensor);
-    try_(reference::instance_norm(
-        type, input_mem, scale_mem, bias_mem, output_mem, input_tensor->shape(),
-        input_tensor->strides(), output_tensor->strides(), eps));
+    if (is_contiguous(input_tensor)) {
+        try_(optimized::instance_norm(type, input_mem, scale_mem, bias_mem,
+                                      output_mem, input_tensor->shape(), eps,
+                                      context));
+    } else {
+        try_(reference::instance_norm(
+            type, input_mem, scale_mem, bias_mem, output_mem,
+            input_tensor->shape(), input_tensor->strides(),
+            output_tensor->strides(), eps));
+    }
     KERNEL_FINISH;
 }
 
@@ -469,18 +601,21 @@ result<value_t> nncase::kernels::stackvm::l2_normalization(
     return err(std::errc::not_supported);
 }
 
-result<value_t> nncase::kernels::stackvm::log_softmax(
-    value_t input, value_t axis, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+result<value_t> nncase::kernels::stackvm::log_softmax(value_t input,
+                                                     value_t axis,
+                                                     value_t output,
+                                                     kernel_context &context) {
     try_input(in_mem, input);
     try_output_like_input(out_mem, output, input_tensor);
     try_positive_axis(axis_value, axis, input_tensor);
     try_typecode(type, input_tensor);
 
-    if (type == dt_float32) {
-        CONTIGUOUS_KERNEL(log_softmax, input_tensor, type, in_mem, out_mem,
-                          input_tensor->shape(), input_tensor->strides(),
-                          output_tensor->strides(), axis_value);
+    if (type == dt_float32 && is_contiguous(input_tensor)) {
+        try_(optimized::log_softmax(type, in_mem, out_mem,
+                                    input_tensor->shape(),
+                                    input_tensor->strides(),
+                                    output_tensor->strides(), axis_value,
+                                    context));
     } else {
         try_(reference::log_softmax(
             type, in_mem, out_mem, input_tensor->shape(),
@@ -491,16 +626,30 @@ result<value_t> nncase::kernels::stackvm::log_softmax(
 }
 
 result<value_t> nncase::kernels::stackvm::lp_normalization(
-    [[maybe_unused]] value_t input, [[maybe_unused]] value_t axis,
-    [[maybe_unused]] value_t p, [[maybe_unused]] value_t output,
-    [[maybe_unused]] kernel_context &context) {
-    return err(std::errc::not_supported);
+    value_t input, value_t axis, value_t p, value_t output,
+    kernel_context &context) {
+    try_input(input_mem, input);
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_to_integer(p_value, p);
+    try_output_like_input(output_mem, output, input_tensor);
+    try_typecode(typecode, input_tensor);
+    if (is_contiguous(input_tensor) && is_contiguous(output_tensor) &&
+        optimized::lp_normalization(typecode, input_mem, output_mem,
+                                    input_tensor->shape(), axis_value, p_value,
+                                    context)
+            .is_ok())
+        return ok(output);
+    try_(reference::lp_normalization(
+        typecode, input_mem, output_mem, input_tensor->shape(),
+        input_tensor->strides(), output_tensor->strides(), axis_value,
+        p_value));
+    KERNEL_FINISH;
 }
 
 result<value_t>
 nncase::kernels::stackvm::lrn(value_t input, value_t alpha, value_t beta,
                               value_t bias, value_t size, value_t output,
-                              [[maybe_unused]] kernel_context &context) {
+                              kernel_context &context) {
     try_in_mem(input);
     try_float_scalar_v(alpha);
     try_float_scalar_v(beta);
@@ -509,10 +658,16 @@ nncase::kernels::stackvm::lrn(value_t input, value_t alpha, value_t beta,
     auto out_shape = input_tensor->shape();
     try_typecode(typecode, input_tensor);
     try_out_mem(output, typecode, out_shape);
-    try_(reference::lrn(typecode, input_mem, alpha_value, beta_value,
-                        bias_value, size_value, output_mem,
-                        input_tensor->shape(), input_tensor->strides(),
-                        runtime::get_default_strides(out_shape)));
+    if (is_contiguous(input_tensor)) {
+        try_(optimized::lrn(typecode, input_mem, alpha_value, beta_value,
+                            bias_value, size_value, output_mem,
+                            input_tensor->shape(), context));
+    } else {
+        try_(reference::lrn(typecode, input_mem, alpha_value, beta_value,
+                            bias_value, size_value, output_mem,
+                            input_tensor->shape(), input_tensor->strides(),
+                            runtime::get_default_strides(out_shape)));
+    }
     KERNEL_FINISH;
 }
 
@@ -524,8 +679,7 @@ result<value_t> nncase::kernels::stackvm::lstm(
     [[maybe_unused]] value_t activation_alpha,
     [[maybe_unused]] value_t activation_beta, [[maybe_unused]] value_t clip,
     value_t hidden_size, [[maybe_unused]] value_t input_forget,
-    value_t output_size, value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    value_t output_size, value_t output, kernel_context &context) {
     try_in_mem(x);
     try_in_mem(w);
     try_in_mem(r);
@@ -542,6 +696,15 @@ result<value_t> nncase::kernels::stackvm::lstm(
         x_tensor->shape(), initial_h_tensor->shape(), initial_c_tensor->shape(),
         direction, layout, hidden_size_value, output_size_value);
     try_tuple_output(out_tuple, output, dt_float32, output_shapes);
+    if (is_contiguous(x_tensor) && is_contiguous(w_tensor) &&
+        is_contiguous(r_tensor) && is_contiguous(b_tensor) &&
+        is_contiguous(initial_h_tensor) && is_contiguous(initial_c_tensor) &&
+        optimized::lstm(type, x_mem, w_mem, r_mem, b_mem, initial_h_mem,
+                        initial_c_mem, out_tuple[0], out_tuple[1],
+                        out_tuple[2], x_tensor->shape(), w_tensor->shape(),
+                        r_tensor->shape(), direction, context)
+            .is_ok())
+        return ok(output);
     try_(reference::lstm(
         type, x_mem, w_mem, r_mem, b_mem, initial_h_mem, initial_c_mem,
         out_tuple[0], out_tuple[1], out_tuple[2], x_tensor->shape(),
@@ -552,43 +715,43 @@ result<value_t> nncase::kernels::stackvm::lstm(
 
 result<value_t>
 nncase::kernels::stackvm::mat_mul(value_t lhs, value_t rhs, value_t output,
-                                  [[maybe_unused]] kernel_context &context) {
+                                  kernel_context &context) {
     try_input(lhs_mem, lhs);
     try_input(rhs_mem, rhs);
     try_var(out_shape,
             matmul_infer_shape(lhs_tensor->shape(), rhs_tensor->shape()));
     try_output(out_mem, output, lhs_tensor->dtype(), out_shape);
     try_typecode(typecode, lhs_tensor);
-    try_(reference::matmul(typecode, lhs_mem, rhs_mem, out_mem,
-                           lhs_tensor->shape(), rhs_tensor->shape()));
+    try_(optimized::matmul(typecode, lhs_mem, rhs_mem, out_mem,
+                           lhs_tensor->shape(), rhs_tensor->shape(), context));
     return ok(output);
 }
 
 result<value_t>
 nncase::kernels::stackvm::normal(typecode_t type, value_t mean, value_t scale,
                                  value_t seed, value_t shape, value_t output,
-                                 [[maybe_unused]] kernel_context &context) {
+                                 kernel_context &context) {
     try_float_scalar(mean_value, mean);
     try_float_scalar(scale_value, scale);
     try_float_scalar(seed_value, seed);
     try_dims(out_shape, shape);
     try_output(out_mem, output, dt_float32, out_shape);
-    try_(reference::random_normal(type, out_mem, out_shape, mean_value,
-                                  scale_value, seed_value));
+    try_(optimized::random_normal(type, out_mem, out_shape, mean_value,
+                                  scale_value, seed_value, context));
     KERNEL_FINISH;
 }
 
 result<value_t> nncase::kernels::stackvm::normal_like(
     typecode_t type, value_t input, value_t mean, value_t scale, value_t seed,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     to_tensor(in_tensor, input);
     try_float_scalar(mean_value, mean);
     try_float_scalar(scale_value, scale);
     try_float_scalar(seed_value, seed);
     auto out_shape = in_tensor->shape();
     try_output(out_mem, output, dt_float32, out_shape);
-    try_(reference::random_normal(type, out_mem, out_shape, mean_value,
-                                  scale_value, seed_value));
+    try_(optimized::random_normal(type, out_mem, out_shape, mean_value,
+                                  scale_value, seed_value, context));
     KERNEL_FINISH;
 }
 
@@ -649,6 +812,12 @@ nncase::kernels::stackvm::pad(runtime::stackvm::pad_mode_t pad_mode,
     try_output(out_mem, output, input_tensor->dtype(), out_shape);
 
     try_input(pad_value, value);
+    if (is_contiguous(input_tensor) && is_contiguous(output_tensor) &&
+        optimized::pad(input_tensor->dtype(), input_mem, out_mem,
+                       input_tensor->shape(), output_tensor->shape(), paddings,
+                       pad_mode, pad_value, context)
+            .is_ok())
+        return ok(output);
     try_(reference::pad(input_tensor->dtype(), input_mem, out_mem,
                         input_tensor->shape(), input_tensor->strides(),
                         output_tensor->strides(), paddings, pad_mode, pad_value,
@@ -657,6 +826,69 @@ nncase::kernels::stackvm::pad(runtime::stackvm::pad_mode_t pad_mode,
     return ok(output);
 }
 
+// Contiguous tensors go to the vectorized activation when the target has one,
+// everything else falls through to the strided reference kernels.
+#define ACTIVATION_DISPATCH(_name, _alpha_mem, _gamma_mem, ...)                \
+    try_output_like_input(output_mem, output, input_tensor);                   \
+    try_typecode(typecode, input_tensor);                                      \
+    if (is_contiguous(input_tensor) && is_contiguous(output_tensor) &&         \
+        optimized::activation(optimized::activation_op_t::_name, typecode,     \
+                              input_mem, output_mem,                           \
+                              compute_size(input_tensor->shape()), _alpha_mem, \
+                              _gamma_mem, context)                             \
+            .is_ok())                                                          \
+        return ok(output);                                                     \
+    try_(reference::_name(typecode, input_mem, output_mem, ##__VA_ARGS__,      \
+                          input_tensor->shape(), input_tensor->strides(),      \
+                          output_tensor->shape(), output_tensor->strides(),    \
+                          context));                                           \
+    KERNEL_FINISH;
+
+#define ACTIVATION_OP(_name)                                                   \
+    result<value_t> nncase::kernels::stackvm::_name(                           \
+        value_t input, value_t output, kernel_context &context) {              \
+        try_input(input_mem, input);                                           \
+        ACTIVATION_DISPATCH(_name, nullptr, nullptr)                           \
+    }
+
+#define ACTIVATION_OP_WITH_ALPHA(_name)                                        \
+    result<value_t> nncase::kernels::stackvm::_name(                           \
+        value_t input, value_t alpha, value_t output,                          \
+        kernel_context &context) {                                             \
+        try_input(input_mem, input);                                           \
+        try_input(alpha_mem, alpha);                                           \
+        ACTIVATION_DISPATCH(_name, alpha_mem, nullptr, alpha_mem)              \
+    }
+
+#define ACTIVATION_OP_WITH_ALPHA_GAMMA(_name)                                  \
+    result<value_t> nncase::kernels::stackvm::_name(                           \
+        value_t input, value_t alpha, value_t gamma, value_t output,           \
+        kernel_context &context) {                                             \
+        try_input(input_mem, input);                                           \
+        try_input(alpha_mem, alpha);                                           \
+        try_input(gamma_mem, gamma);                                           \
+        ACTIVATION_DISPATCH(_name, alpha_mem, gamma_mem, alpha_mem, gamma_mem) \
+    }
+
+ACTIVATION_OP(relu)
+ACTIVATION_OP(softsign)
+ACTIVATION_OP(softplus)
+ACTIVATION_OP(sigmoid)
+ACTIVATION_OP(swish)
+ACTIVATION_OP(hard_swish)
+ACTIVATION_OP(erf)
+ACTIVATION_OP_WITH_ALPHA(elu)
+ACTIVATION_OP_WITH_ALPHA(celu)
+ACTIVATION_OP_WITH_ALPHA(leaky_relu)
+ACTIVATION_OP_WITH_ALPHA(gelu)
+ACTIVATION_OP_WITH_ALPHA_GAMMA(selu)
+ACTIVATION_OP_WITH_ALPHA_GAMMA(hard_sigmoid)
+
+#undef ACTIVATION_OP_WITH_ALPHA_GAMMA
+#undef ACTIVATION_OP_WITH_ALPHA
+#undef ACTIVATION_OP
+#undef ACTIVATION_DISPATCH
+
 result<value_t> kernels::stackvm::prelu(value_t input, value_t slope,
                                         value_t output,
                                         kernel_context &context) {
@@ -664,6 +896,11 @@ result<value_t> kernels::stackvm::prelu(value_t input, value_t slope,
     try_in_mem(slope);
     try_output_like_input(out_mem, output, input_tensor);
     try_typecode(type, input_tensor);
+    if (is_contiguous(input_tensor) && is_contiguous(slope_tensor) &&
+        optimized::prelu(type, input_mem, slope_mem, out_mem,
+                         input_tensor->shape(), slope_tensor->shape(), context)
+            .is_ok())
+        return ok(output);
     try_(reference::prelu(
         type, input_mem, slope_mem, out_mem, input_tensor->shape(),
         input_tensor->strides(), slope_tensor->shape(), slope_tensor->strides(),
@@ -671,11 +908,20 @@ result<value_t> kernels::stackvm::prelu(value_t input, value_t slope,
     return ok(output);
 }
 
-result<value_t>
-nncase::kernels::stackvm::prod([[maybe_unused]] value_t input,
-                               [[maybe_unused]] value_t output,
-                               [[maybe_unused]] kernel_context &context) {
-    return err(std::errc::not_supported);
+result<value_t> nncase::kernels::stackvm::prod(value_t input, value_t output,
+                                               kernel_context &context) {
+    try_input(in_mem, input);
+    try_typecode(typecode, input_tensor);
+    try_output(out_mem, output, input_tensor->dtype(), dims_t{});
+
+    // prod reduces every axis; reduce_op_t::prod ignores the init value
+    dims_t axes(input_tensor->shape().size());
+    std::iota(axes.begin(), axes.end(), 0);
+    CONTIGUOUS_KERNEL(reduce, input_tensor, typecode, reduce_op_t::prod,
+                      nullptr, in_mem, out_mem, input_tensor->shape(), axes,
+                      input_tensor->strides(), output_tensor->strides(), false,
+                      context);
+    return ok(output);
 }
 
 result<value_t> nncase::kernels::stackvm::quantize(typecode_t target_type,
@@ -694,6 +940,126 @@ result<value_t> nncase::kernels::stackvm::quantize(typecode_t target_type,
     return ok(output);
 }
 
+inline value_range<int32_t> quantized_clamp_range(const float *fused_clamp) {
+    // the integers inside the fused clamp, saturated to int32
+    auto to_int32 = [](double v) {
+        return (int32_t)std::clamp(
+            v, (double)std::numeric_limits<int32_t>::lowest(),
+            (double)std::numeric_limits<int32_t>::max());
+    };
+    return {to_int32(std::ceil((double)fused_clamp[0])),
+            to_int32(std::floor((double)fused_clamp[1]))};
+}
+
+result<value_t> nncase::kernels::stackvm::quantized_conv2d(
+    typecode_t target_type, value_t input, value_t weights, value_t bias,
+    value_t stride, value_t padding, value_t dilation, value_t groups,
+    value_t fused_clamp, value_t input_zero_point, value_t output_scales,
+    value_t output_zero_point, value_t output, kernel_context &context) {
+    try_input(input_mem, input);
+    try_input(weights_mem, weights);
+    try_input(bias_mem, bias);
+    try_strides(strides, stride);
+    try_paddings(pads, padding);
+    try_strides(dilations, dilation);
+    try_to_integer(groups_value, groups);
+    try_f32_input(fused_clamp_value, fused_clamp);
+    try_to_integer(input_zero_point_value, input_zero_point);
+    try_f32_input(output_scales_value, output_scales);
+    try_to_integer(output_zero_point_value, output_zero_point);
+    if (!cmp_type<uint8_t>(input_tensor->dtype()) ||
+        !cmp_type<int8_t>(weights_tensor->dtype()) ||
+        !cmp_type<int32_t>(bias_tensor->dtype()) ||
+        !is_contiguous(input_tensor) || !is_contiguous(weights_tensor) ||
+        !is_contiguous(bias_tensor))
+        return err(std::errc::not_supported);
+
+    const auto out_channels = weights_tensor->shape()[0];
+    const auto scales_size = compute_size(output_scales_tensor->shape());
+    if (compute_size(bias_tensor->shape()) != out_channels ||
+        (scales_size != 1 && scales_size != out_channels))
+        return err(std::errc::invalid_argument);
+    auto out_shape =
+        conv2d_infer_shape(input_tensor->shape(), weights_tensor->shape(),
+                           strides, dilations, pads);
+    try_output(out_mem, output, target_type, out_shape);
+    try_(optimized::quantized_conv2d(
+        target_type, IN_CAST(uint8_t, input_mem), IN_CAST(int8_t, weights_mem),
+        IN_CAST(int32_t, bias_mem), out_mem, input_tensor->shape(),
+        weights_tensor->shape(), pads[0], pads[1], (int32_t)groups_value,
+        (int32_t)strides[0], (int32_t)strides[1], (int32_t)dilations[0],
+        (int32_t)dilations[1], (int32_t)input_zero_point_value,
+        {output_scales_value, scales_size}, (int32_t)output_zero_point_value,
+        quantized_clamp_range(fused_clamp_value), context));
+    return ok(output);
+}
+
+result<value_t> nncase::kernels::stackvm::quantized_mat_mul(
+    typecode_t target_type, value_t lhs, value_t rhs, value_t lhs_zero_point,
+    value_t output_scales, value_t output_zero_point, value_t output,
+    kernel_context &context) {
+    try_input(lhs_mem, lhs);
+    try_input(rhs_mem, rhs);
+    try_to_integer(lhs_zero_point_value, lhs_zero_point);
+    try_f32_input(output_scales_value, output_scales);
+    try_to_integer(output_zero_point_value, output_zero_point);
+    auto lhs_shape = lhs_tensor->shape();
+    auto rhs_shape = rhs_tensor->shape();
+    if (!cmp_type<uint8_t>(lhs_tensor->dtype()) ||
+        !cmp_type<int8_t>(rhs_tensor->dtype()) || lhs_shape.empty() ||
+        rhs_shape.empty() || lhs_shape.size() > 4 || rhs_shape.size() > 4 ||
+        !is_contiguous(lhs_tensor) || !is_contiguous(rhs_tensor))
+        return err(std::errc::not_supported);
+
+    // 1-D operands and batch broadcasting follow reference::matmul
+    dims_t a_shape = lhs_shape, b_shape = rhs_shape;
+    if (a_shape.size() == 1)
+        a_shape.insert(a_shape.begin(), 1);
+    if (b_shape.size() == 1)
+        b_shape.insert(b_shape.end(), 1);
+    const auto a = runtime::to_4d(a_shape), b = runtime::to_4d(b_shape);
+    const auto m = a[2], k = a[3], n = b[3];
+    const auto scales_size = compute_size(output_scales_tensor->shape());
+    auto broadcastable = [](size_t x, size_t y) {
+        return x == y || x == 1 || y == 1;
+    };
+    if (b[2] != k || !broadcastable(a[0], b[0]) ||
+        !broadcastable(a[1], b[1]) || (scales_size != 1 && scales_size != n))
+        return err(std::errc::invalid_argument);
+    try_var(out_shape, matmul_infer_shape(lhs_shape, rhs_shape));
+    try_output(out_mem, output, target_type, out_shape);
+
+    auto run = [&](const uint8_t *lhs, const int8_t *rhs, gsl::byte *out,
+                   size_t rows) {
+        return optimized::quantized_matmul(
+            target_type, lhs, rhs, nullptr, out, rows, n, k,
+            (int32_t)lhs_zero_point_value, {output_scales_value, scales_size},
+            (int32_t)output_zero_point_value, value_range<int32_t>::full(),
+            context);
+    };
+    const auto out_bytes = runtime::get_bytes(target_type);
+    // an rhs without batch dims is shared by every lhs matrix, so the lhs
+    // batch folds into m
+    if (b[0] == 1 && b[1] == 1) {
+        try_(run(IN_CAST(uint8_t, lhs_mem), IN_CAST(int8_t, rhs_mem), out_mem,
+                 a[0] * a[1] * m));
+        return ok(output);
+    }
+
+    const auto batches = std::max(a[0], b[0]);
+    const auto channels = std::max(a[1], b[1]);
+    for (size_t i = 0; i < batches; i++) {
+        for (size_t c = 0; c < channels; c++) {
+            const auto ai = (a[0] == 1 ? 0 : i) * a[1] + (a[1] == 1 ? 0 : c);
+            const auto bi = (b[0] == 1 ? 0 : i) * b[1] + (b[1] == 1 ? 0 : c);
+            try_(run(IN_CAST(uint8_t, lhs_mem) + ai * m * k,
+                     IN_CAST(int8_t, rhs_mem) + bi * k * n,
+                     out_mem + (i * channels + c) * m * n * out_bytes, m));
+        }
+    }
+    return ok(output);
+}
+
 result<value_t> nncase::kernels::stackvm::quant_param_of(
     [[maybe_unused]] quant_mode_t quant_mode, [[maybe_unused]] value_t range,
     [[maybe_unused]] value_t bits, [[maybe_unused]] value_t output,
@@ -756,6 +1122,61 @@ result<value_t> nncase::kernels::stackvm::reduce(
     return ok(output);
 }
 
+result<value_t> nncase::kernels::stackvm::reduce_arg(
+    reduce_arg_op_t reduce_arg_op, typecode_t dest_type, value_t input,
+    value_t axis, value_t keep_dims, value_t select_last_index, value_t output,
+    kernel_context &context) {
+    try_input(in_mem, input);
+    try_typecode(input_typecode, input_tensor);
+    try_positive_axis(axis_value, axis, input_tensor);
+    try_to_scalar(keep_dims_value, keep_dims, bool);
+    try_to_scalar(select_last_index_value, select_last_index, bool);
+    auto axes = dims_t{(size_t)axis_value};
+    auto out_shape = kernels::detail::get_reduced_shape(
+        input_tensor->shape(), axes, keep_dims_value);
+    try_output(out_mem, output, dest_type, out_shape);
+
+    CONTIGUOUS_KERNEL(reduce_arg, input_tensor, input_typecode, dest_type,
+                      reduce_arg_op, in_mem, out_mem, input_tensor->shape(),
+                      input_tensor->strides(), output_tensor->strides(), axes,
+                      keep_dims_value, select_last_index_value, context);
+    return ok(output);
+}
+
+result<value_t> nncase::kernels::stackvm::reduce_window2d(
+    reduce_op_t reduce_op, value_t input, value_t init_value, value_t filter,
+    value_t stride, value_t padding, value_t dilation,
+    [[maybe_unused]] value_t ceil_mode, value_t count_include_pad,
+    value_t output, kernel_context &context) {
+    try_f32_input(input_mem, input);
+    try_to_scalar(init_v, init_value, float);
+    try_dims(filter_value, filter);
+    try_dims(strides_value, stride);
+    try_dims(dilations_value, dilation);
+    try_paddings(pads, padding);
+    try_to_scalar(count_include_pad_value, count_include_pad, bool);
+    auto out_shape = reduce_window2d_infer_shape(
+        input_tensor->shape(), filter_value, strides_value, dilations_value,
+        pads);
+    try_f32_output(out_mem, output, out_shape);
+    if (is_contiguous(input_tensor)) {
+        try_(optimized::reduce_window2d(
+            reduce_op, input_mem, init_v, out_mem, input_tensor->shape(),
+            pads[0], pads[1], filter_value[0], filter_value[1],
+            strides_value[0], strides_value[1], dilations_value[0],
+            dilations_value[1], value_range<float>::full(),
+            count_include_pad_value, context));
+    } else {
+        try_(reference::reduce_window2d(
+            reduce_op, input_mem, init_v, out_mem, input_tensor->shape(),
+            input_tensor->strides(), output_tensor->strides(), pads[0],
+            pads[1], filter_value[0], filter_value[1], strides_value[0],
+            strides_value[1], dilations_value[0], dilations_value[1],
+            value_range<float>::full(), count_include_pad_value, context));
+    }
+    return ok(output);
+}
+
 result<value_t>
 nncase::kernels::stackvm::relu6([[maybe_unused]] value_t input,
                                 [[maybe_unused]] value_t output,
@@ -936,13 +1357,20 @@ result<value_t> nncase::kernels::stackvm::resize_image(
 
 result<value_t> nncase::kernels::stackvm::reverse_sequence(
     value_t input, value_t seq_lens, value_t batch_axis, value_t time_axis,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     try_in_mem(input);
     try_integer_v(batch_axis);
     try_integer_v(time_axis);
     try_dims(seq_lens_value, seq_lens);
     auto out_shape = input_tensor->shape();
     try_out_mem(output, input_tensor->dtype(), out_shape);
+    if (optimized::reverse_sequence(
+            input_tensor->dtype(), input_mem, output_mem,
+            input_tensor->shape(), seq_lens_value, batch_axis_value,
+            time_axis_value, input_tensor->strides(),
+            output_tensor->strides(), context)
+            .is_ok())
+        KERNEL_FINISH;
     try_(reference::reverse_sequence(
         input_tensor->dtype(), input_mem, output_mem, input_tensor->shape(),
         seq_lens_value, batch_axis_value, time_axis_value,
@@ -951,10 +1379,16 @@ result<value_t> nncase::kernels::stackvm::reverse_sequence(
 }
 
 result<value_t> nncase::kernels::stackvm::select(
-    [[maybe_unused]] value_t predicate, [[maybe_unused]] value_t true_value,
-    [[maybe_unused]] value_t false_value, [[maybe_unused]] value_t output,
+    value_t predicate, value_t true_value, value_t false_value, value_t output,
     [[maybe_unused]] kernel_context &context) {
-    return err(std::errc::not_supported);
+    // the predicate is a scalar, so one branch is copied through whole
+    try_to_scalar(predicate_value, predicate, bool);
+    try_var(selected_tensor,
+            (predicate_value ? true_value : false_value).as<tensor>());
+    try_alloc_output(output, selected_tensor->dtype(),
+                     selected_tensor->shape(), false);
+    try_(selected_tensor->copy_to(output));
+    KERNEL_FINISH;
 }
 
 result<value_t>
@@ -1053,15 +1487,17 @@ result<value_t> nncase::kernels::stackvm::slice(value_t input, value_t begins,
 
 result<value_t>
 nncase::kernels::stackvm::softmax(value_t input, value_t axis, value_t output,
-                                  [[maybe_unused]] kernel_context &context) {
+                                  kernel_context &context) {
     try_input(in_mem, input);
     try_output_like_input(out_mem, output, input_tensor);
     try_positive_axis(axis_value, axis, input_tensor);
     try_typecode(type, input_tensor);
-    if (type == dt_float32 || type == dt_float16) {
-        CONTIGUOUS_KERNEL(softmax, input_tensor, type, in_mem, out_mem,
-                          input_tensor->shape(), input_tensor->strides(),
-                          output_tensor->strides(), axis_value, 1.f);
+    if ((type == dt_float32 || type == dt_float16 || type == dt_bfloat16) &&
+        is_contiguous(input_tensor)) {
+        try_(optimized::softmax(type, in_mem, out_mem, input_tensor->shape(),
+                                input_tensor->strides(),
+                                output_tensor->strides(), axis_value, 1.f,
+                                context));
     } else {
         try_(reference::softmax(type, in_mem, out_mem, input_tensor->shape(),
                                 input_tensor->strides(),
@@ -1071,9 +1507,8 @@ nncase::kernels::stackvm::softmax(value_t input, value_t axis, value_t output,
 }
 
 result<value_t> nncase::kernels::stackvm::space_to_batch(
-    [[maybe_unused]] value_t input, [[maybe_unused]] value_t block_shape,
-    [[maybe_unused]] value_t paddings, [[maybe_unused]] value_t output,
-    [[maybe_unused]] kernel_context &context) {
+    value_t input, value_t block_shape, value_t paddings, value_t output,
+    kernel_context &context) {
     try_in_mem(input);
     try_paddings(paddings_value, paddings);
     try_dims_v(block_shape);
@@ -1081,6 +1516,13 @@ result<value_t> nncase::kernels::stackvm::space_to_batch(
         input_tensor->shape(), block_shape_value, paddings_value);
     try_out_mem(output, input_tensor->dtype(), out_shape);
 
+    if (optimized::space_to_batch(input_tensor->dtype(), input_mem, output_mem,
+                                  input_tensor->shape(), block_shape_value,
+                                  paddings_value, input_tensor->strides(),
+                                  out_shape, output_tensor->strides(), context)
+            .is_ok())
+        KERNEL_FINISH;
+
     try_(reference::space_to_batch(input_tensor->dtype(), input_mem, output_mem,
                                    input_tensor->shape(), block_shape_value,
                                    paddings_value, input_tensor->strides(),
@@ -1183,7 +1625,7 @@ result<value_t> nncase::kernels::stackvm::stack(value_t inputs, value_t axis,
 
 result<value_t>
 nncase::kernels::stackvm::tile(value_t input, value_t repeats, value_t output,
-                               [[maybe_unused]] kernel_context &context) {
+                               kernel_context &context) {
     try_input(in_mem, input);
     try_dims(repeats_value, repeats);
     auto ty = input_tensor->dtype();
@@ -1191,14 +1633,14 @@ nncase::kernels::stackvm::tile(value_t input, value_t repeats, value_t output,
     try_output(out_mem, output, ty, out_shape);
     try_(optimized::tile(ty, in_mem, out_mem, input_tensor->shape(), out_shape,
                          input_tensor->strides(), output_tensor->strides(),
-                         repeats_value));
+                         repeats_value, context));
     KERNEL_FINISH;
 }
 
 result<value_t>
 nncase::kernels::stackvm::top_k(value_t x, value_t k, value_t axis,
                                 value_t largest, value_t sorted, value_t output,
-                                [[maybe_unused]] kernel_context &context) {
+                                kernel_context &context) {
     try_in_mem(x);
     try_integer_v(k);
     try_positive_axis(axis_value, axis, x_tensor);
@@ -1218,28 +1660,23 @@ nncase::kernels::stackvm::top_k(value_t x, value_t k, value_t axis,
         tycode, x_mem, outputs[0], OUT_CAST(int64_t, outputs[1]),
         x_tensor->shape(), x_tensor->strides(), out_values->shape(),
         out_values->strides(), out_indices->shape(), out_indices->strides(),
-        k_value, axis_value, largest_value, sorted_value));
+        k_value, axis_value, largest_value, sorted_value, context));
     KERNEL_FINISH;
 }
 
 result<value_t>
 nncase::kernels::stackvm::transpose(value_t input, value_t perm, value_t output,
-                                    [[maybe_unused]] kernel_context &context) {
+                                    kernel_context &context) {
     try_input(input_mem, input);
     auto dt = input_tensor->dtype();
     try_dims(perm_value, perm);
     auto out_shape = transpose_infer_shape(input_tensor->shape(), perm_value);
     try_output(out_mem, output, dt, out_shape);
 
-    if (out_shape.size() == 4) {
-        try_(optimized::transpose(dt, input_mem, out_mem, input_tensor->shape(),
-                                  perm_value, input_tensor->strides(),
-                                  output_tensor->strides(), context));
-    } else {
-        try_(reference::transpose(dt, input_mem, out_mem, input_tensor->shape(),
-                                  perm_value, input_tensor->strides(),
-                                  output_tensor->strides()));
-    }
+    CONTIGUOUS_KERNEL(transpose, input_tensor, dt, input_mem, out_mem,
+                      input_tensor->shape(), perm_value,
+                      input_tensor->strides(), output_tensor->strides(),
+                      context);
     return ok(output);
 }
 
@@ -1259,28 +1696,28 @@ result<value_t> nncase::kernels::stackvm::trilu(value_t input, value_t k,
 result<value_t>
 nncase::kernels::stackvm::uniform(typecode_t type, value_t high, value_t low,
                                   value_t seed, value_t shape, value_t output,
-                                  [[maybe_unused]] kernel_context &context) {
+                                  kernel_context &context) {
     try_float_scalar(high_value, high);
     try_float_scalar(low_value, low);
     try_float_scalar(seed_value, seed);
     try_dims(out_shape, shape);
     try_output(out_mem, output, dt_float32, out_shape);
-    try_(reference::random_uniform(type, out_mem, out_shape, low_value,
-                                   high_value, seed_value));
+    try_(optimized::random_uniform(type, out_mem, out_shape, low_value,
+                                   high_value, seed_value, context));
     KERNEL_FINISH;
 }
 
 result<value_t> nncase::kernels::stackvm::uniform_like(
     typecode_t type, value_t input, value_t high, value_t low, value_t seed,
-    value_t output, [[maybe_unused]] kernel_context &context) {
+    value_t output, kernel_context &context) {
     to_tensor(in_tensor, input);
     try_float_scalar(high_value, high);
     try_float_scalar(low_value, low);
     try_float_scalar(seed_value, seed);
     auto out_shape = in_tensor->shape();
     try_output(out_mem, output, dt_float32, out_shape);
-    try_(reference::random_uniform(type, out_mem, out_shape, low_value,
-                                   high_value, seed_value));
+    try_(optimized::random_uniform(type, out_mem, out_shape, low_value,
+                                   high_value, seed_value, context));
     KERNEL_FINISH;
 }
 
@@ -1327,11 +1764,11 @@ result<value_t> nncase::kernels::stackvm::where(
     auto out_shape = where_infer_shape(cond_tensor->shape(), x_tensor->shape(),
                                        y_tensor->shape());
     try_output(out_mem, output, dt, out_shape);
-    CONTIGUOUS_KERNEL(where, cond_tensor, dt, cond_mem, x_mem, y_mem, out_mem,
-                      cond_tensor->shape(), x_tensor->shape(),
-                      y_tensor->shape(), out_shape, cond_tensor->strides(),
-                      x_tensor->strides(), y_tensor->strides(),
-                      output_tensor->strides());
+    try_(optimized::where(dt, cond_mem, x_mem, y_mem, out_mem,
+                          cond_tensor->shape(), x_tensor->shape(),
+                          y_tensor->shape(), out_shape, cond_tensor->strides(),
+                          x_tensor->strides(), y_tensor->strides(),
+                          output_tensor->strides(), context));
     KERNEL_FINISH;
 }
 
@@ -1343,7 +1780,8 @@ result<value_t> kernels::stackvm::unary(unary_op_t unary_op, value_t input,
     auto dtype = input_tensor->dtype();
     try_output(out_mem, output, dtype, input_tensor->shape());
 
-    if (typoecode != dt_float32) {
+    if (typoecode != dt_float32 && typoecode != dt_float16 &&
+        typoecode != dt_bfloat16) {
         try_(reference::unary(typoecode, unary_op, input_mem, out_mem,
                               input_tensor->shape(), input_tensor->strides(),
                               output_tensor->shape(), output_tensor->strides(),
@@ -1394,7 +1832,7 @@ result<value_t> nncase::kernels::stackvm::grid_sample(
     out_shape[2] = grid_tensor->shape()[1];
     out_shape[3] = grid_tensor->shape()[2];
     try_output(out_mem, output, input_tensor->dtype(), out_shape);
-    try_(reference::grid_sample(
+    try_(optimized::grid_sample(
         typoecode, in_mem, grid_mem, out_mem, input_tensor->shape(),
         input_tensor->strides(), grid_tensor->shape(), grid_tensor->strides(),
         output_tensor->strides(), align_corners, mode, padding_mode, context));
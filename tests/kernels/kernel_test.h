@@ -1166,6 +1166,26 @@ class KernelTest {
         return cArray;
     }
 
+    std::vector<float> GetFloatArray(const char *key) {
+        if (!_document[key].is_array()) {
+            throw std::runtime_error("type error! it should be array.");
+        }
+
+        const auto &array = _document[key];
+        size_t arraySize = array.size();
+        std::vector<float> cArray(arraySize);
+        for (size_t i = 0; i < arraySize; i++) {
+            if (array[i].is_number_float()) {
+                cArray[i] = array[i].get<float>();
+            } else {
+                std::cout << "Invalid JSON format. Expected float values in "
+                             "the array."
+                          << std::endl;
+            }
+        }
+        return cArray;
+    }
+
     axes_t GetAxesArray(const char *key) {
         if (!_document[key].is_array()) {
             throw std::runtime_error("type error! it should be array.");
@@ -0,0 +1,99 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "kernel_test.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <nncase/kernels/cpu_features.h>
+#include <string>
+#include <vector>
+
+namespace nncase {
+template <class T>
+runtime::runtime_tensor quantized_test_tensor(std::vector<T> values,
+                                              const dims_t &shape) {
+    return runtime::hrt::create(
+               std::is_same_v<T, uint8_t>   ? dt_uint8
+               : std::is_same_v<T, int8_t>  ? dt_int8
+               : std::is_same_v<T, int32_t> ? dt_int32
+               : std::is_same_v<T, int64_t> ? dt_int64
+                                            : dt_float32,
+               shape,
+               {reinterpret_cast<gsl::byte *>(values.data()),
+                values.size() * sizeof(T)},
+               true, runtime::host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+// The quantized kernels' epilogue: int32 outputs keep the accumulator, u8 and
+// i8 outputs scale it in float, round half to even and add the zero point.
+// Either is then clamped to the output type and [low, high].
+inline int32_t quantized_test_requantize(typecode_t type, int64_t acc,
+                                         float scale, int32_t zero_point,
+                                         double low, double high) {
+    double q = (double)acc;
+    if (type == dt_uint8) {
+        low = std::max(low, 0.);
+        high = std::min(high, 255.);
+    } else if (type == dt_int8) {
+        low = std::max(low, -128.);
+        high = std::min(high, 127.);
+    } else {
+        low = std::max(low, (double)std::numeric_limits<int32_t>::lowest());
+        high = std::min(high, (double)std::numeric_limits<int32_t>::max());
+    }
+    if (type != dt_int32)
+        q = std::nearbyint((float)acc * scale) + zero_point;
+    return (int32_t)std::clamp(q, std::ceil(low), std::floor(high));
+}
+
+// Reads the u8, i8 or int32 output of a quantized kernel as int32.
+inline std::vector<int32_t> quantized_test_output(value_t output) {
+    runtime::runtime_tensor actual(
+        output.as<tensor>().expect("as tensor failed"));
+    auto mapped =
+        std::move(runtime::hrt::map(actual, runtime::map_read).unwrap());
+    if (actual.datatype() == dt_uint8) {
+        auto data = mapped.buffer().as_span<uint8_t>();
+        return {data.begin(), data.end()};
+    } else if (actual.datatype() == dt_int8) {
+        auto data = mapped.buffer().as_span<int8_t>();
+        return {data.begin(), data.end()};
+    }
+    auto data = mapped.buffer().as_span<int32_t>();
+    return {data.begin(), data.end()};
+}
+
+// Expects run to give the expected output on every kernel ISA level the host
+// supports.
+inline void expect_quantized_output_on_every_isa(
+    const std::vector<int32_t> &expected,
+    const std::function<std::vector<int32_t>()> &run,
+    const std::string &message) {
+    auto isa = kernels::kernel_isa();
+    for (auto level : {kernels::cpu_isa_t::generic, kernels::cpu_isa_t::sse4_2,
+                       kernels::cpu_isa_t::avx2, kernels::cpu_isa_t::avx512,
+                       kernels::cpu_isa_t::avx512_vnni,
+                       kernels::cpu_isa_t::avx512_bf16}) {
+        if (kernels::set_kernel_isa(level).is_ok()) {
+            EXPECT_EQ(expected, run())
+                << message << " on " << kernels::to_string(level);
+        }
+    }
+    kernels::set_kernel_isa(isa).expect("restore kernel isa failed");
+}
+} // namespace nncase
@@ -0,0 +1,93 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "kernel_test.h"
+#include <cstring>
+#include <functional>
+#include <nncase/kernels/cpu_features.h>
+#include <vector>
+
+namespace nncase {
+// Shape drawn by the random generator tests: large enough to be split across
+// threads, with a partial last group.
+inline runtime::runtime_tensor random_test_shape() {
+    int64_t shape[] = {3, 7, 61, 67};
+    return runtime::hrt::create(
+               dt_int64, {4},
+               {reinterpret_cast<gsl::byte *>(shape), sizeof(shape)}, true,
+               runtime::host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+inline runtime::runtime_tensor random_test_scalar(float value) {
+    return runtime::hrt::create(
+               dt_float32, {1},
+               {reinterpret_cast<gsl::byte *>(&value), sizeof(value)}, true,
+               runtime::host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+// Expects generate to give the same samples for any thread count and on
+// every kernel ISA level the host supports, and returns them.
+inline std::vector<float> expect_deterministic_samples(
+    const std::function<result<value_t>(kernels::kernel_context &)>
+        &generate) {
+    auto samples = [&](uint32_t num_threads) {
+        auto context = kernels::default_kernel_context();
+        context.num_threads = num_threads;
+        auto output = generate(context).expect("generate failed");
+        runtime::runtime_tensor actual(
+            output.as<tensor>().expect("as tensor failed"));
+        auto mapped =
+            std::move(runtime::hrt::map(actual, runtime::map_read).unwrap());
+        auto data = mapped.buffer().as_span<float>();
+        return std::vector<float>(data.begin(), data.end());
+    };
+    // compare bit patterns, so that signed zeros and NaNs must match as well
+    auto bits = [](const std::vector<float> &values) {
+        std::vector<uint32_t> result(values.size());
+        std::memcpy(result.data(), values.data(),
+                    values.size() * sizeof(float));
+        return result;
+    };
+
+    auto expected = samples(1);
+    EXPECT_EQ(bits(expected), bits(samples(4)));
+    auto isa = kernels::kernel_isa();
+    for (auto level : {kernels::cpu_isa_t::generic, kernels::cpu_isa_t::sse4_2,
+                       kernels::cpu_isa_t::avx2, kernels::cpu_isa_t::avx512,
+                       kernels::cpu_isa_t::avx512_vnni,
+                       kernels::cpu_isa_t::avx512_bf16}) {
+        if (kernels::set_kernel_isa(level).is_ok()) {
+            EXPECT_EQ(bits(expected), bits(samples(4)))
+                << kernels::to_string(level);
+        }
+    }
+    kernels::set_kernel_isa(isa).expect("restore kernel isa failed");
+    return expected;
+}
+
+// Sample mean and (population) variance.
+inline std::pair<double, double>
+sample_moments(const std::vector<float> &values) {
+    double mean = 0, var = 0;
+    for (auto v : values)
+        mean += v;
+    mean /= values.size();
+    for (auto v : values)
+        var += (v - mean) * (v - mean);
+    return {mean, var / values.size()};
+}
+} // namespace nncase
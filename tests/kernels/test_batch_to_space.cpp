@@ -107,6 +107,81 @@ TEST_P(BatchToSpaceTest, BatchToSpace) {
     EXPECT_TRUE(result);
 }
 
+TEST(BatchToSpaceBlockTest, non_uniform) {
+    // blocks of 2 x 3 with crops on both spatial dims, so each output dim
+    // scales by its own block size
+    constexpr size_t batch = 2, channels = 2, in_h = 3, in_w = 2;
+    constexpr size_t block_h = 2, block_w = 3;
+    constexpr size_t crop_top = 1, crop_left = 0, crop_right = 2;
+    constexpr size_t out_h = in_h * block_h - crop_top;
+    constexpr size_t out_w = in_w * block_w - crop_left - crop_right;
+    constexpr size_t in_n = batch * block_h * block_w;
+
+    std::vector<float> dense(in_n * channels * in_h * in_w);
+    std::vector<float> sparse(dense.size() * 2);
+    for (size_t i = 0; i < dense.size(); i++) {
+        dense[i] = (float)i;
+        sparse[i * 2] = dense[i];
+    }
+    std::vector<float> expected(batch * channels * out_h * out_w, -1.f);
+    for (size_t n = 0; n < in_n; n++) {
+        const auto b = n % batch, bh = n / batch / block_w,
+                   bw = n / batch % block_w;
+        for (size_t c = 0; c < channels; c++)
+            for (size_t h = 0; h < in_h; h++)
+                for (size_t w = 0; w < in_w; w++) {
+                    const auto oh = h * block_h + bh, ow = w * block_w + bw;
+                    if (oh < crop_top || oh - crop_top >= out_h ||
+                        ow < crop_left || ow - crop_left >= out_w)
+                        continue;
+                    expected[((b * channels + c) * out_h + oh - crop_top) *
+                                 out_w +
+                             ow - crop_left] =
+                        dense[((n * channels + c) * in_h + h) * in_w + w];
+                }
+    }
+
+    int64_t block[] = {block_h, block_w};
+    int64_t crops[] = {crop_top, 0, crop_left, crop_right};
+    auto block_tensor =
+        hrt::create(dt_int64, {2},
+                    {reinterpret_cast<gsl::byte *>(block), sizeof(block)}, true,
+                    host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    auto crops_tensor =
+        hrt::create(dt_int64, {2, 2},
+                    {reinterpret_cast<gsl::byte *>(crops), sizeof(crops)}, true,
+                    host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    // contiguous inputs take the optimized kernel and strided ones the
+    // reference kernel
+    auto contiguous = hrt::create(dt_float32, {in_n, channels, in_h, in_w},
+                                  {reinterpret_cast<gsl::byte *>(dense.data()),
+                                   dense.size() * sizeof(float)},
+                                  true, host_runtime_tensor::pool_cpu_only)
+                          .expect("create tensor failed");
+    auto strided =
+        hrt::create(dt_float32, {in_n, channels, in_h, in_w},
+                    {channels * in_h * in_w * 2, in_h * in_w * 2, in_w * 2, 2},
+                    {reinterpret_cast<gsl::byte *>(sparse.data()),
+                     sparse.size() * sizeof(float)},
+                    true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+
+    for (auto &input : {contiguous, strided}) {
+        auto output =
+            kernels::stackvm::batch_to_space(input.impl(), block_tensor.impl(),
+                                             crops_tensor.impl())
+                .expect("batch_to_space failed");
+        runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+        EXPECT_EQ((dims_t{batch, channels, out_h, out_w}),
+                  dims_t(actual.shape().begin(), actual.shape().end()));
+        auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+        auto data = mapped.buffer().as_span<float>();
+        EXPECT_EQ(expected, std::vector<float>(data.begin(), data.end()));
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
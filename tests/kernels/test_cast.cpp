@@ -139,6 +139,65 @@ TEST_P(CastTest, cast) {
     EXPECT_TRUE(result1);
 }
 
+// Expects a float to T cast of every input to saturate and map NaN to 0.
+template <class T>
+void expect_saturated_cast(typecode_t type, const std::vector<float> &values,
+                           std::initializer_list<runtime_tensor> inputs) {
+    for (auto &input : inputs) {
+        auto output =
+            kernels::stackvm::cast(
+                type, runtime::stackvm::cast_mode_t::kdefault, input.impl())
+                .expect("cast failed");
+        runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+        auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+        auto data = mapped.buffer().as_span<T>();
+        for (size_t i = 0; i < values.size(); i++) {
+            const auto v = values[i];
+            const auto expected =
+                std::isnan(v) ? (T)0
+                : v <= (float)std::numeric_limits<T>::lowest()
+                    ? std::numeric_limits<T>::lowest()
+                : v >= (float)std::numeric_limits<T>::max()
+                    ? std::numeric_limits<T>::max()
+                    : (T)v;
+            EXPECT_EQ(expected, data[i]) << "element " << i;
+        }
+    }
+}
+
+TEST(CastSaturateTest, strided) {
+    // contiguous inputs take the optimized kernel and strided ones the
+    // reference kernel, which must convert out-of-range values the same way
+    const float special[] = {std::numeric_limits<float>::quiet_NaN(),
+                             std::numeric_limits<float>::infinity(),
+                             -std::numeric_limits<float>::infinity(),
+                             1e10f,
+                             -1e10f,
+                             300.f,
+                             -300.f,
+                             -1.5f};
+    constexpr size_t rows = 4, cols = 8;
+    std::vector<float> dense(rows * cols), sparse(rows * cols * 2);
+    for (size_t i = 0; i < dense.size(); i++) {
+        dense[i] = special[i % cols] * (float)(i / cols + 1);
+        sparse[i * 2] = dense[i];
+    }
+    auto contiguous = hrt::create(dt_float32, {rows, cols},
+                                  {reinterpret_cast<gsl::byte *>(dense.data()),
+                                   dense.size() * sizeof(float)},
+                                  true, host_runtime_tensor::pool_cpu_only)
+                          .expect("create tensor failed");
+    auto strided = hrt::create(dt_float32, {rows, cols}, {cols * 2, 2},
+                               {reinterpret_cast<gsl::byte *>(sparse.data()),
+                                sparse.size() * sizeof(float)},
+                               true, host_runtime_tensor::pool_cpu_only)
+                       .expect("create tensor failed");
+
+    expect_saturated_cast<int8_t>(dt_int8, dense, {contiguous, strided});
+    expect_saturated_cast<uint8_t>(dt_uint8, dense, {contiguous, strided});
+    expect_saturated_cast<int32_t>(dt_int32, dense, {contiguous, strided});
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
@@ -37,13 +37,24 @@ class Conv2DTransposeTest : public KernelTest,
         auto typecode = GetDataType("lhs_type");
         auto input_shape = GetShapeArray("lhs_shape");
         auto weight_shape = GetShapeArray("weight_shape");
-        auto bias_shape = GetShapeArray("bias_shape");
         dilations_value = GetShapeArray("dilations_value");
         pad_value = GetShapeArray("pad_value");
         strides_value = GetShapeArray("strides_value");
         group_value = GetNumber("group_value");
         output_padding_value = GetShapeArray("output_padding_value");
-        output_shape_value = GetShapeArray("output_shape_value");
+        fused_clamp_value = GetFloatArray("fused_clamp_value");
+
+        // the output padding must be smaller than the stride or the dilation
+        for (size_t i = 0; i < output_padding_value.size(); i++) {
+            if (output_padding_value[i] >= strides_value[i] &&
+                output_padding_value[i] >= dilations_value[i])
+                GTEST_SKIP();
+        }
+
+        // onnx weights are [in_channels, out_channels / groups, kh, kw]
+        const auto groups = (size_t)group_value;
+        const auto g_ic = weight_shape[0] / groups, g_oc = weight_shape[1];
+        dims_t bias_shape{g_oc * groups};
 
         input = hrt::create(typecode, input_shape,
                             host_runtime_tensor::pool_cpu_only)
@@ -55,6 +66,23 @@ class Conv2DTransposeTest : public KernelTest,
                      .expect("create tensor failed");
         init_tensor(weight);
 
+        // the kernel takes [out_channels, in_channels / groups, kh, kw]
+        kernel_weight =
+            hrt::create(typecode,
+                        {g_oc * groups, g_ic, weight_shape[2], weight_shape[3]},
+                        host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        NNCASE_UNUSED auto res = kernels::stackvm::apply(
+            kernel_weight.shape(),
+            [&](gsl::span<const size_t> index) -> result<void> {
+                const auto g = index[0] / g_oc;
+                dims_t onnx_index{g * g_ic + index[1], index[0] % g_oc,
+                                  index[2], index[3]};
+                get<float>(kernel_weight, index) =
+                    get<float>(weight, onnx_index);
+                return ok();
+            });
+
         bais = hrt::create(typecode, bias_shape,
                            host_runtime_tensor::pool_cpu_only)
                    .expect("create tensor failed");
@@ -66,12 +94,13 @@ class Conv2DTransposeTest : public KernelTest,
   protected:
     runtime_tensor input;
     runtime_tensor weight;
+    runtime_tensor kernel_weight;
     runtime_tensor bais;
     dims_t dilations_value;
     dims_t pad_value;
     dims_t strides_value;
     dims_t output_padding_value;
-    dims_t output_shape_value;
+    std::vector<float> fused_clamp_value;
     int64_t group_value;
 };
 
@@ -106,16 +135,30 @@ TEST_P(Conv2DTransposeTest, conv2d_transpose) {
     std::copy(output_padding_value.begin(), output_padding_value.end(),
               output_padding);
 
-    size_t output_shape_size = output_shape_value.size();
-    int64_t *output_shape =
-        (int64_t *)malloc(output_shape_size * sizeof(int64_t));
-    std::copy(output_shape_value.begin(), output_shape_value.end(),
-              output_shape);
-
-    auto output_ort = ortki_ConvTranspose(
+    // no explicit output shape: onnx derives it from the pads, the strides,
+    // the dilations and the output padding
+    auto conv_ort = ortki_ConvTranspose(
         input_ort, weight_ort, bais_ort, auto_pad, dilations, dilations_size,
         group_value, kernel_shape, 2, output_padding, output_padding_size,
-        output_shape, output_shape_size, pad, pad_size, strides, strides_size);
+        nullptr, 0, pad, pad_size, strides, strides_size);
+
+    float clamp_min[] = {fused_clamp_value[0]};
+    auto clamp_min_tensor =
+        hrt::create(
+            nncase::dt_float32, {1},
+            {reinterpret_cast<gsl::byte *>(clamp_min), sizeof(clamp_min)},
+            true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    float clamp_max[] = {fused_clamp_value[1]};
+    auto clamp_max_tensor =
+        hrt::create(
+            nncase::dt_float32, {1},
+            {reinterpret_cast<gsl::byte *>(clamp_max), sizeof(clamp_max)},
+            true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    auto output_ort =
+        ortki_Clip(conv_ort, runtime_tensor_2_ort_tensor(clamp_min_tensor),
+                   runtime_tensor_2_ort_tensor(clamp_max_tensor));
     size_t size = 0;
     void *ptr_ort = tensor_buffer(output_ort, &size);
     dims_t shape(tensor_rank(output_ort));
@@ -127,7 +170,9 @@ TEST_P(Conv2DTransposeTest, conv2d_transpose) {
 
     // actual
     int64_t group[] = {group_value};
-    float fused_clamp[] = {-FLT_MAX, FLT_MAX};
+    float fused_clamp[] = {fused_clamp_value[0], fused_clamp_value[1]};
+    int64_t output_shape[] = {(int64_t)shape[0], (int64_t)shape[1],
+                              (int64_t)shape[2], (int64_t)shape[3]};
     auto dilations_ptr = hrt::create(nncase::dt_int64, {2},
                                      {reinterpret_cast<gsl::byte *>(dilations),
                                       dilations_size * sizeof(int64_t)},
@@ -176,16 +221,16 @@ TEST_P(Conv2DTransposeTest, conv2d_transpose) {
     auto output_shape_ptr =
         hrt::create(nncase::dt_int64, {4},
                     {reinterpret_cast<gsl::byte *>(output_shape),
-                     output_shape_size * sizeof(int64_t)},
+                     sizeof(output_shape)},
                     true, host_runtime_tensor::pool_cpu_only)
             .expect("create tensor failed");
 
     auto output =
         kernels::stackvm::conv2d_transpose(
-            runtime::stackvm::pad_mode_t::constant, input.impl(), weight.impl(),
-            bais.impl(), output_shape_ptr.impl(), strides_ptr.impl(),
-            pad_ptr.impl(), output_padding_ptr.impl(), dilations_ptr.impl(),
-            group_ptr.impl(), fused_clamp_ptr.impl())
+            runtime::stackvm::pad_mode_t::constant, input.impl(),
+            kernel_weight.impl(), bais.impl(), output_shape_ptr.impl(),
+            strides_ptr.impl(), pad_ptr.impl(), output_padding_ptr.impl(),
+            dilations_ptr.impl(), group_ptr.impl(), fused_clamp_ptr.impl())
             .expect("conv2d_transpose failed");
     runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
 
@@ -208,23 +253,21 @@ int main(int argc, char *argv[]) {
     FOR_LOOP(lhs_type, i)
     FOR_LOOP(lhs_shape, j)
     FOR_LOOP(weight_shape, k)
-    FOR_LOOP(bias_shape, l)
     FOR_LOOP(dilations_value, m)
     FOR_LOOP(pad_value, n)
     FOR_LOOP(strides_value, o)
     FOR_LOOP(group_value, p)
     FOR_LOOP(output_padding_value, r)
-    FOR_LOOP(output_shape_value, s)
+    FOR_LOOP(fused_clamp_value, s)
     SPLIT_ELEMENT(lhs_type, i)
     SPLIT_ELEMENT(lhs_shape, j)
     SPLIT_ELEMENT(weight_shape, k)
-    SPLIT_ELEMENT(bias_shape, l)
     SPLIT_ELEMENT(dilations_value, m)
     SPLIT_ELEMENT(pad_value, n)
     SPLIT_ELEMENT(strides_value, o)
     SPLIT_ELEMENT(group_value, p)
     SPLIT_ELEMENT(output_padding_value, r)
-    SPLIT_ELEMENT(output_shape_value, s)
+    SPLIT_ELEMENT(fused_clamp_value, s)
     WRITE_SUB_CASE()
     FOR_LOOP_END()
     FOR_LOOP_END()
@@ -235,7 +278,6 @@ int main(int argc, char *argv[]) {
     FOR_LOOP_END()
     FOR_LOOP_END()
     FOR_LOOP_END()
-    FOR_LOOP_END()
 
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -105,6 +105,81 @@ TEST_P(CumSumTest, cum_sum) {
     EXPECT_TRUE(result);
 }
 
+TEST(CumSumScanTest, exclusive_reverse) {
+    // a long innermost scan takes the blocked path and a scan over a middle
+    // axis the lane-parallel one; both split their work by thread count
+    struct scan_case {
+        dims_t shape;
+        int64_t axis;
+    };
+    auto context = kernels::default_kernel_context();
+    context.num_threads = 4;
+    std::vector<scan_case> cases{
+        {{1, 70001}, 1}, {{3, 100, 130}, 1}, {{5, 333}, 1}};
+    for (size_t i = 0; i < cases.size(); i++) {
+        auto &c = cases[i];
+        // small integers keep every partial sum exact
+        std::vector<int32_t> data(compute_size(c.shape));
+        for (size_t j = 0; j < data.size(); j++)
+            data[j] = (int32_t)(j % 7) - 3;
+        auto input0 = hrt::create(dt_int32, c.shape,
+                                  {reinterpret_cast<gsl::byte *>(data.data()),
+                                   data.size() * sizeof(int32_t)},
+                                  true, host_runtime_tensor::pool_cpu_only)
+                          .expect("create tensor failed");
+        auto axis_ptr =
+            hrt::create(nncase::dt_int64, {1},
+                        {reinterpret_cast<gsl::byte *>(&c.axis), 8}, true,
+                        host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        for (int64_t exclusive_value : {0, 1}) {
+            for (int64_t reverse_value : {0, 1}) {
+                // expected
+                auto output_ort = ortki_CumSum(
+                    KernelTest::runtime_tensor_2_ort_tensor(input0),
+                    KernelTest::runtime_tensor_2_ort_tensor(axis_ptr),
+                    exclusive_value, reverse_value);
+                size_t size = 0;
+                auto ptr_ort = reinterpret_cast<int32_t *>(
+                    tensor_buffer(output_ort, &size));
+                std::vector<int32_t> expected(ptr_ort,
+                                              ptr_ort + size / sizeof(int32_t));
+
+                // actual
+                float exclusive[] = {(float)exclusive_value};
+                auto exclusive_ptr =
+                    hrt::create(nncase::dt_float32, {1},
+                                {reinterpret_cast<gsl::byte *>(exclusive),
+                                 sizeof(exclusive)},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
+                float reverse[] = {(float)reverse_value};
+                auto reverse_ptr =
+                    hrt::create(nncase::dt_float32, {1},
+                                {reinterpret_cast<gsl::byte *>(reverse),
+                                 sizeof(reverse)},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
+                auto output =
+                    kernels::stackvm::cum_sum(
+                        input0.impl(), axis_ptr.impl(), exclusive_ptr.impl(),
+                        reverse_ptr.impl(), nullptr, context)
+                        .expect("cum_sum failed");
+                runtime_tensor actual(
+                    output.as<tensor>().expect("as tensor failed"));
+                auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+                auto actual_data = mapped.buffer().as_span<int32_t>();
+
+                // compare
+                EXPECT_EQ(expected, std::vector<int32_t>(actual_data.begin(),
+                                                         actual_data.end()))
+                    << "case " << i << ", exclusive " << exclusive_value
+                    << ", reverse " << reverse_value;
+            }
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
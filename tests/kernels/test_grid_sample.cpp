@@ -0,0 +1,119 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_test.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/simple_types.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <ortki/operators.h>
+#include <random>
+
+using namespace nncase;
+using namespace nncase::runtime;
+using namespace nncase::runtime::stackvm;
+using namespace ortki;
+
+namespace {
+const char *to_string(grid_sample_mode_t mode) {
+    return mode == grid_sample_mode_t::nearest_neighbor ? "nearest"
+                                                        : "bilinear";
+}
+
+const char *to_string(grid_sample_padding_mode_t padding_mode) {
+    switch (padding_mode) {
+    case grid_sample_padding_mode_t::border:
+        return "border";
+    case grid_sample_padding_mode_t::reflection:
+        return "reflection";
+    default:
+        return "zeros";
+    }
+}
+
+// Samples a random image with a grid reaching well past [-1, 1] on every
+// side, so that each padding mode decides a good share of the outputs.
+void check_grid_sample(grid_sample_mode_t mode,
+                       grid_sample_padding_mode_t padding_mode) {
+    dims_t in_shape{2, 3, 5, 7};
+    dims_t grid_shape{2, 4, 9, 2};
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> dis(-1.f, 1.f);
+    std::vector<float> in_data(compute_size(in_shape));
+    for (auto &v : in_data)
+        v = dis(gen);
+    std::vector<float> grid_data(compute_size(grid_shape));
+    for (auto &v : grid_data)
+        v = 2.5f * dis(gen);
+
+    auto input = hrt::create(dt_float32, in_shape,
+                             {reinterpret_cast<gsl::byte *>(in_data.data()),
+                              in_data.size() * sizeof(float)},
+                             true, host_runtime_tensor::pool_cpu_only)
+                     .expect("create tensor failed");
+    auto grid = hrt::create(dt_float32, grid_shape,
+                            {reinterpret_cast<gsl::byte *>(grid_data.data()),
+                             grid_data.size() * sizeof(float)},
+                            true, host_runtime_tensor::pool_cpu_only)
+                    .expect("create tensor failed");
+
+    for (auto align_corners : {grid_sample_align_corners_t::none,
+                               grid_sample_align_corners_t::align_corners}) {
+        // expected
+        auto output_ort = ortki_GridSample(
+            KernelTest::runtime_tensor_2_ort_tensor(input),
+            KernelTest::runtime_tensor_2_ort_tensor(grid),
+            (long)align_corners, to_string(mode), to_string(padding_mode));
+        size_t size = 0;
+        auto ptr_ort =
+            reinterpret_cast<float *>(tensor_buffer(output_ort, &size));
+
+        // actual
+        auto output = kernels::stackvm::grid_sample(align_corners, mode,
+                                                    padding_mode, input.impl(),
+                                                    grid.impl())
+                          .expect("grid_sample failed");
+        runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+        auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+        auto data = mapped.buffer().as_span<float>();
+
+        // compare
+        ASSERT_EQ(size / sizeof(float), data.size());
+        for (size_t i = 0; i < data.size(); i++)
+            EXPECT_NEAR(ptr_ort[i], data[i], 1e-5f)
+                << to_string(mode) << " " << to_string(padding_mode)
+                << " align_corners " << (int)align_corners << " index " << i;
+    }
+}
+} // namespace
+
+TEST(GridSampleTest, nearest) {
+    for (auto padding_mode : {grid_sample_padding_mode_t::zeros,
+                              grid_sample_padding_mode_t::border,
+                              grid_sample_padding_mode_t::reflection})
+        check_grid_sample(grid_sample_mode_t::nearest_neighbor, padding_mode);
+}
+
+TEST(GridSampleTest, reflection) {
+    check_grid_sample(grid_sample_mode_t::bilinear,
+                      grid_sample_padding_mode_t::reflection);
+}
+
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -21,6 +21,7 @@
 #include <nncase/runtime/simple_types.h>
 #include <nncase/runtime/stackvm/opcode.h>
 #include <ortki/operators.h>
+#include <random>
 
 #define TEST_CASE_NAME "test_layer_norm"
 
@@ -106,7 +107,7 @@ TEST_P(LayerNormTest, layer_norm) {
 
     // actual
     auto output =
-        kernels::stackvm::layer_norm((int32_t)axis_value, eps, false, false,
+        kernels::stackvm::layer_norm((int32_t)axis_value, eps, true, false,
                                      input.impl(), scale.impl(), b.impl())
             .expect("layer_norm failed");
     runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
@@ -125,6 +126,105 @@ TEST_P(LayerNormTest, layer_norm) {
     EXPECT_TRUE(result);
 }
 
+namespace {
+runtime_tensor make_tensor(const dims_t &shape, std::vector<float> &data) {
+    return hrt::create(dt_float32, shape,
+                       {reinterpret_cast<gsl::byte *>(data.data()),
+                        data.size() * sizeof(float)},
+                       true, host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+std::vector<float> random_vector(size_t size, std::mt19937 &gen) {
+    std::uniform_real_distribution<float> dis(-2.f, 2.f);
+    std::vector<float> data(size);
+    for (auto &v : data)
+        v = dis(gen);
+    return data;
+}
+
+// Normalizes the dims from axis on as one group, or only the axis dim when
+// channel_first, with scale and bias indexed by the position in the group
+// (the channel when channel_first). Without use_mean this is RMS norm.
+void check_layer_norm(const dims_t &shape, int32_t axis, bool use_mean,
+                      bool channel_first) {
+    const float eps = 1e-5f;
+    const auto positive_axis = axis < 0 ? axis + (int32_t)shape.size() : axis;
+    size_t outer = 1, inner = 1;
+    for (int32_t i = 0; i < positive_axis; i++)
+        outer *= shape[i];
+    for (size_t i = positive_axis + 1; i < shape.size(); i++)
+        inner *= shape[i];
+    const auto channels = shape[positive_axis];
+    // the group and the stride between its elements
+    const auto group = channel_first ? channels : channels * inner;
+    const auto step = channel_first ? inner : 1;
+    const auto groups_per_outer = channel_first ? inner : 1;
+
+    std::mt19937 gen(7);
+    auto in_data = random_vector(compute_size(shape), gen);
+    auto scale_data = random_vector(group, gen);
+    auto bias_data = random_vector(group, gen);
+    auto input = make_tensor(shape, in_data);
+    auto scale = make_tensor({group}, scale_data);
+    auto bias = make_tensor({group}, bias_data);
+
+    std::vector<float> expected(in_data.size());
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t g = 0; g < groups_per_outer; g++) {
+            const auto base = o * channels * inner + g;
+            double mean = 0, var = 0;
+            if (use_mean) {
+                for (size_t c = 0; c < group; c++)
+                    mean += in_data[base + c * step];
+                mean /= group;
+            }
+            for (size_t c = 0; c < group; c++) {
+                const auto d = in_data[base + c * step] - mean;
+                var += d * d;
+            }
+            const auto rstd = 1.0 / std::sqrt(var / group + eps);
+            for (size_t c = 0; c < group; c++)
+                expected[base + c * step] =
+                    (float)((in_data[base + c * step] - mean) * rstd *
+                                scale_data[c] +
+                            bias_data[c]);
+        }
+    }
+
+    auto output =
+        kernels::stackvm::layer_norm(axis, eps, use_mean, channel_first,
+                                     input.impl(), scale.impl(), bias.impl())
+            .expect("layer_norm failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+    auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+    auto data = mapped.buffer().as_span<float>();
+    ASSERT_EQ(expected.size(), data.size());
+    for (size_t i = 0; i < data.size(); i++)
+        ASSERT_NEAR(expected[i], data[i], 1e-4f)
+            << "axis " << axis << " use_mean " << use_mean
+            << " channel_first " << channel_first << " index " << i;
+}
+} // namespace
+
+TEST(LayerNormVariantTest, rms_norm) {
+    check_layer_norm({4, 67}, -1, false, false);
+    check_layer_norm({2, 3, 8, 16}, 1, false, false);
+    // large enough to run threaded
+    check_layer_norm({64, 1024}, 1, false, false);
+}
+
+TEST(LayerNormVariantTest, channel_first) {
+    for (auto use_mean : {true, false}) {
+        // the inner size leaves a scalar tail after the 8-lane blocks
+        check_layer_norm({2, 6, 5, 7}, 1, use_mean, true);
+        check_layer_norm({3, 4, 16}, -2, use_mean, true);
+        check_layer_norm({1, 16, 64, 64}, 1, use_mean, true);
+        // on the last axis channel_first is the plain layer norm
+        check_layer_norm({5, 24}, 1, use_mean, true);
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
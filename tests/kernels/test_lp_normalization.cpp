@@ -0,0 +1,111 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "kernel_test.h"
+#include <gtest/gtest.h>
+#include <iostream>
+#include <nncase/kernels/stackvm/tensor_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/simple_types.h>
+#include <nncase/runtime/stackvm/opcode.h>
+#include <random>
+
+using namespace nncase;
+using namespace nncase::runtime;
+
+namespace {
+template <class T>
+runtime_tensor make_tensor(typecode_t type, const dims_t &shape,
+                           std::vector<T> &data) {
+    return hrt::create(type, shape,
+                       {reinterpret_cast<gsl::byte *>(data.data()),
+                        data.size() * sizeof(T)},
+                       true, host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+// Divides every element by the p-norm of its line along axis. The first line
+// is all zeros and must come out as zeros.
+void check_lp_normalization(const dims_t &shape, int64_t axis, int64_t p) {
+    size_t outer = 1, inner = 1;
+    for (int64_t i = 0; i < axis; i++)
+        outer *= shape[i];
+    for (size_t i = axis + 1; i < shape.size(); i++)
+        inner *= shape[i];
+    const auto axis_size = shape[axis];
+
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<float> dis(-2.f, 2.f);
+    std::vector<float> in_data(compute_size(shape));
+    for (auto &v : in_data)
+        v = dis(gen);
+    for (size_t k = 0; k < axis_size; k++)
+        in_data[k * inner] = 0.f;
+
+    std::vector<float> expected(in_data.size());
+    for (size_t o = 0; o < outer; o++) {
+        for (size_t j = 0; j < inner; j++) {
+            const auto base = o * axis_size * inner + j;
+            double norm = 0;
+            for (size_t k = 0; k < axis_size; k++) {
+                const auto v = in_data[base + k * inner];
+                norm += p == 1 ? std::fabs(v) : v * v;
+            }
+            norm = p == 1 ? norm : std::sqrt(norm);
+            for (size_t k = 0; k < axis_size; k++)
+                expected[base + k * inner] =
+                    norm == 0 ? 0.f
+                              : (float)(in_data[base + k * inner] / norm);
+        }
+    }
+
+    std::vector<int64_t> axis_data{axis}, p_data{p};
+    auto input = make_tensor(dt_float32, shape, in_data);
+    auto axis_tensor = make_tensor(dt_int64, {1}, axis_data);
+    auto p_tensor = make_tensor(dt_int64, {1}, p_data);
+    auto output = kernels::stackvm::lp_normalization(
+                      input.impl(), axis_tensor.impl(), p_tensor.impl())
+                      .expect("lp_normalization failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+    auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+    auto data = mapped.buffer().as_span<float>();
+    ASSERT_EQ(expected.size(), data.size());
+    for (size_t i = 0; i < data.size(); i++)
+        ASSERT_NEAR(expected[i], data[i], 1e-5f)
+            << "axis " << axis << " p " << p << " index " << i;
+}
+} // namespace
+
+TEST(LpNormalizationTest, last_axis) {
+    for (int64_t p : {1, 2}) {
+        check_lp_normalization({4, 37}, 1, p);
+        // large enough to run threaded
+        check_lp_normalization({256, 160}, 1, p);
+    }
+}
+
+TEST(LpNormalizationTest, inner_axis) {
+    for (int64_t p : {1, 2}) {
+        // the inner size is not a multiple of the block
+        check_lp_normalization({2, 5, 300}, 1, p);
+        check_lp_normalization({3, 8, 4, 5}, 1, p);
+        check_lp_normalization({6, 7, 2}, 0, p);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
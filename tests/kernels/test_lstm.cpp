@@ -21,6 +21,7 @@
 #include <nncase/runtime/simple_types.h>
 #include <nncase/runtime/stackvm/opcode.h>
 #include <ortki/operators.h>
+#include <random>
 
 using namespace nncase;
 using namespace nncase::runtime;
@@ -205,6 +206,129 @@ TEST_P(LstmTest, lstm) {
     [[maybe_unused]] auto result = check_tuple_output(expected, dtypes, output);
 }
 
+TEST(LstmBidirectionalTest, batched) {
+    // batch 3 and both directions, so that the per-direction bias offset and
+    // the per-batch h/c rows are used. The second case gives x a stride on
+    // its unit input dimension: the data is unchanged but x is no longer
+    // contiguous, which routes the op to the reference kernel.
+    const size_t seq_len = 4, batch = 3, hidden = 5, directions = 2;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> dis(-1.f, 1.f);
+    auto random = [&](size_t n) {
+        std::vector<float> v(n);
+        for (auto &e : v)
+            e = dis(gen);
+        return v;
+    };
+    auto create = [](std::vector<float> &v, const dims_t &shape,
+                     const strides_t &strides) {
+        return hrt::create(dt_float32, shape, strides,
+                           {reinterpret_cast<gsl::byte *>(v.data()),
+                            v.size() * sizeof(float)},
+                           true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    };
+    auto make_ort = [](std::vector<float> &v, dims_t shape) {
+        return make_tensor(v.data(), DataType_FLOAT,
+                           reinterpret_cast<int64_t *>(shape.data()),
+                           shape.size());
+    };
+
+    for (bool strided : {false, true}) {
+        const size_t input_size = strided ? 1 : 3;
+        dims_t x_shape{seq_len, batch, input_size};
+        dims_t w_shape{directions, 4 * hidden, input_size};
+        dims_t r_shape{directions, 4 * hidden, hidden};
+        dims_t b_shape{directions, 8 * hidden};
+        dims_t state_shape{directions, batch, hidden};
+        auto x_data = random(compute_size(x_shape));
+        auto w_data = random(compute_size(w_shape));
+        auto r_data = random(compute_size(r_shape));
+        auto b_data = random(compute_size(b_shape));
+        auto h_data = random(compute_size(state_shape));
+        auto c_data = random(compute_size(state_shape));
+
+        // expected
+        std::vector<int32_t> seq_lens(batch, (int32_t)seq_len);
+        dims_t seq_lens_shape{batch};
+        auto seq_lens_ort =
+            make_tensor(seq_lens.data(), DataType_INT32,
+                        reinterpret_cast<int64_t *>(seq_lens_shape.data()), 1);
+        std::vector<float> p_data(directions * 3 * hidden, 0.f);
+        float alpha[] = {0.0f};
+        float beta[] = {0.0f};
+        const char *activations_ptr[] = {"Sigmoid", "Tanh", "Tanh",
+                                         "Sigmoid", "Tanh", "Tanh"};
+        float clip = std::numeric_limits<float>::quiet_NaN();
+        auto output_ort = ortki_LSTM(
+            make_ort(x_data, x_shape), make_ort(w_data, w_shape),
+            make_ort(r_data, r_shape), make_ort(b_data, b_shape),
+            seq_lens_ort, make_ort(h_data, state_shape),
+            make_ort(c_data, state_shape),
+            make_ort(p_data, dims_t{directions, 3 * hidden}), alpha, 1, beta,
+            1, activations_ptr, 6, clip, "bidirectional", hidden, 0, 0, false,
+            3);
+
+        // actual
+        auto x_strides = strided ? strides_t{batch, 1, 3}
+                                 : get_default_strides(x_shape);
+        auto x = create(x_data, x_shape, x_strides);
+        EXPECT_EQ(!strided, is_contiguous(x.shape(), x.strides()));
+        auto w = create(w_data, w_shape, get_default_strides(w_shape));
+        auto r = create(r_data, r_shape, get_default_strides(r_shape));
+        auto b = create(b_data, b_shape, get_default_strides(b_shape));
+        auto init_h =
+            create(h_data, state_shape, get_default_strides(state_shape));
+        auto init_c =
+            create(c_data, state_shape, get_default_strides(state_shape));
+        std::vector<float> clip_data{clip};
+        auto clip_tensor = create(clip_data, {1}, {1});
+        std::vector<int64_t> int_args{(int64_t)seq_len, (int64_t)hidden, 0, 3};
+        auto int_arg = [&](size_t i) {
+            return hrt::create(dt_int64, {1},
+                               {reinterpret_cast<gsl::byte *>(&int_args[i]),
+                                sizeof(int64_t)},
+                               true, host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        };
+        auto seq_lens_tensor = int_arg(0);
+        auto p_tensor =
+            create(p_data, {directions, 3 * hidden},
+                   get_default_strides(dims_t{directions, 3 * hidden}));
+        std::vector<float> alpha_data{alpha[0]}, beta_data{beta[0]};
+        auto alpha_tensor = create(alpha_data, {1}, {1});
+        auto beta_tensor = create(beta_data, {1}, {1});
+        auto output =
+            kernels::stackvm::lstm(
+                runtime::stackvm::lstmdirection_t::bidirectional,
+                runtime::stackvm::lstmlayout_t::zero,
+                {"Sigmoid", "Tanh", "Tanh", "Sigmoid", "Tanh", "Tanh"},
+                x.impl(), w.impl(), r.impl(), b.impl(), seq_lens_tensor.impl(),
+                init_h.impl(), init_c.impl(), p_tensor.impl(),
+                alpha_tensor.impl(), beta_tensor.impl(), clip_tensor.impl(),
+                int_arg(1).impl(), int_arg(2).impl(), int_arg(3).impl())
+                .expect("lstm failed");
+        auto fields = output.as<tuple>().expect("as tuple failed")->fields();
+
+        // compare Y, Y_h and Y_c
+        ASSERT_EQ(3u, fields.size());
+        for (size_t i = 0; i < fields.size(); i++) {
+            size_t size = 0;
+            auto ptr_ort = reinterpret_cast<float *>(
+                tensor_buffer(tensor_seq_get_value(output_ort, i), &size));
+            runtime_tensor actual(
+                fields[i].as<tensor>().expect("as tensor failed"));
+            auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+            auto data = mapped.buffer().as_span<float>();
+            ASSERT_EQ(size / sizeof(float), data.size());
+            for (size_t j = 0; j < data.size(); j++)
+                EXPECT_NEAR(ptr_ort[j], data[j], 1e-5f)
+                    << "output " << i << " index " << j << " strided "
+                    << strided;
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
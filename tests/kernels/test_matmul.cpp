@@ -15,6 +15,7 @@
 #include "kernel_test.h"
 #include <gtest/gtest.h>
 #include <iostream>
+#include <nncase/kernels/cpu_features.h>
 #include <nncase/kernels/stackvm/tensor_ops.h>
 #include <nncase/runtime/datatypes.h>
 #include <nncase/runtime/runtime_tensor.h>
@@ -91,6 +92,61 @@ TEST_P(MatMulTest, mat_mul) {
     EXPECT_TRUE(result);
 }
 
+// bfloat16 takes the vdpbf16ps gemm on avx512_bf16 and widens to f32 below
+// it. k is odd and n is not a multiple of the 16-column panel, so both
+// paddings are exercised; the lhs batch is broadcast over the rhs one.
+TEST(MatMulBf16Test, every_isa) {
+    const size_t m = 5, k = 37, n = 35;
+    std::vector<bfloat16> a(2 * m * k), b(3 * k * n);
+    for (size_t i = 0; i < a.size(); i++)
+        a[i] = bfloat16((float)((int)(i * 7 % 5) - 2) / 2);
+    for (size_t i = 0; i < b.size(); i++)
+        b[i] = bfloat16((float)((int)(i * 3 % 5) - 2) / 2);
+    auto lhs = hrt::create(dt_bfloat16, {2, 1, m, k},
+                           {reinterpret_cast<gsl::byte *>(a.data()),
+                            a.size() * sizeof(bfloat16)},
+                           true, host_runtime_tensor::pool_cpu_only)
+                   .expect("create tensor failed");
+    auto rhs = hrt::create(dt_bfloat16, {1, 3, k, n},
+                           {reinterpret_cast<gsl::byte *>(b.data()),
+                            b.size() * sizeof(bfloat16)},
+                           true, host_runtime_tensor::pool_cpu_only)
+                   .expect("create tensor failed");
+
+    // halves keep every product and partial sum exact in bfloat16, so all
+    // levels must match exactly whatever they accumulate in
+    std::vector<float> expected(2 * 3 * m * n);
+    for (size_t bn = 0; bn < 2; bn++)
+        for (size_t c = 0; c < 3; c++)
+            for (size_t i = 0; i < m; i++)
+                for (size_t j = 0; j < n; j++) {
+                    double sum = 0;
+                    for (size_t kk = 0; kk < k; kk++)
+                        sum += (double)(float)a[(bn * m + i) * k + kk] *
+                               (float)b[(c * k + kk) * n + j];
+                    expected[((bn * 3 + c) * m + i) * n + j] = (float)sum;
+                }
+
+    auto isa = kernels::kernel_isa();
+    for (auto level : {kernels::cpu_isa_t::generic, kernels::cpu_isa_t::sse4_2,
+                       kernels::cpu_isa_t::avx2, kernels::cpu_isa_t::avx512,
+                       kernels::cpu_isa_t::avx512_vnni,
+                       kernels::cpu_isa_t::avx512_bf16}) {
+        if (kernels::set_kernel_isa(level).is_err())
+            continue;
+        auto output = kernels::stackvm::mat_mul(lhs.impl(), rhs.impl())
+                          .expect("matmul failed");
+        runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+        EXPECT_EQ(dims_t({2, 3, m, n}),
+                  dims_t(actual.shape().begin(), actual.shape().end()));
+        auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+        auto data = mapped.buffer().as_span<bfloat16>();
+        std::vector<float> values(data.begin(), data.end());
+        EXPECT_EQ(expected, values) << kernels::to_string(level);
+    }
+    kernels::set_kernel_isa(isa).expect("restore kernel isa failed");
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_type, i)
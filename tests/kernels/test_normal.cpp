@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "kernel_test.h"
+#include "random_test.h"
 #include <gtest/gtest.h>
 #include <iostream>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -125,6 +126,26 @@ TEST_P(NormalTest, normal) {
     EXPECT_TRUE(result);
 }
 
+TEST(NormalDeterminismTest, across_threads_and_isas) {
+    auto mean = random_test_scalar(0.5f), scale = random_test_scalar(2.0f),
+         seed = random_test_scalar(7.0f);
+    auto shape = random_test_shape();
+    auto samples =
+        expect_deterministic_samples([&](kernels::kernel_context &context) {
+            return kernels::stackvm::normal(dt_float32, mean.impl(),
+                                            scale.impl(), seed.impl(),
+                                            shape.impl(), nullptr, context);
+        });
+
+    // N(0.5, 2^2): with ~86k samples the standard error is about 0.007 for
+    // the mean and 0.02 for the variance
+    for (auto v : samples)
+        ASSERT_TRUE(std::isfinite(v));
+    auto [sample_mean, sample_var] = sample_moments(samples);
+    EXPECT_NEAR(0.5, sample_mean, 0.05);
+    EXPECT_NEAR(4.0, sample_var, 0.15);
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
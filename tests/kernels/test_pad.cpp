@@ -147,6 +147,76 @@ TEST_P(PadTest, Pad) {
     EXPECT_TRUE(result);
 }
 
+TEST_P(PadTest, fast_paths) {
+    auto check = [&](std::vector<int64_t> pads) {
+        // expected
+        size_t size = 0;
+        auto pad = hrt::create(dt_int64, {pads.size()},
+                               {reinterpret_cast<gsl::byte *>(pads.data()),
+                                sizeof(pads[0]) * pads.size()},
+                               true, host_runtime_tensor::pool_cpu_only)
+                       .expect("create tensor failed");
+        std::vector<int64_t> axis_v(pads.size() / 2);
+        std::iota(axis_v.begin(), axis_v.end(), 0);
+        auto axis = hrt::create(dt_int64, {axis_v.size()},
+                                {reinterpret_cast<gsl::byte *>(axis_v.data()),
+                                 sizeof(axis_v[0]) * axis_v.size()},
+                                true, host_runtime_tensor::pool_cpu_only)
+                        .expect("create tensor failed");
+        auto l_ort = runtime_tensor_2_ort_tensor(input);
+        auto pad_ort = runtime_tensor_2_ort_tensor(pad);
+        auto value_ort = runtime_tensor_2_ort_tensor(value);
+        auto axis_ort = runtime_tensor_2_ort_tensor(axis);
+        auto output_ort =
+            ortki_Pad(l_ort, pad_ort, value_ort, axis_ort, mode_str.c_str());
+        void *ptr_ort = tensor_buffer(output_ort, &size);
+        dims_t shape(tensor_rank(output_ort));
+        tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
+        auto expected =
+            hrt::create(input.datatype(), shape,
+                        {reinterpret_cast<gsl::byte *>(ptr_ort), size}, true,
+                        host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+
+        // actual
+        auto pads_nncase = ToNncaseFormat(pads);
+        pad = hrt::create(dt_int64, {pads_nncase.size()},
+                          {reinterpret_cast<gsl::byte *>(pads_nncase.data()),
+                           sizeof(pads_nncase[0]) * pads_nncase.size()},
+                          true, host_runtime_tensor::pool_cpu_only)
+                  .expect("create tensor failed");
+        auto output =
+            kernels::stackvm::pad(mode, input.impl(), pad.impl(), value.impl())
+                .expect("pad failed");
+        runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+
+        bool result = is_same_tensor(expected, actual) ||
+                      cosine_similarity_tensor(expected, actual);
+
+        if (!result) {
+            std::cout << "actual ";
+            print_runtime_tensor(actual);
+            std::cout << "expected ";
+            print_runtime_tensor(expected);
+        }
+
+        // compare
+        EXPECT_TRUE(result);
+    };
+
+    // only outer axes padded: the unpadded trailing axes fold into blocks
+    check({1, 2, 0, 0, 1, 1, 0, 0});
+    // borders wider than one vector on the innermost axis
+    check({0, 0, 0, 9, 0, 0, 0, 11});
+    // every axis padded, so each output row has borders on both sides
+    check({1, 1, 2, 3, 1, 2, 3, 1});
+    // crops, alone and next to padding on the same row
+    if (mode == runtime::stackvm::pad_mode_t::constant) {
+        check({0, 0, -1, -2, 0, 0, 0, -3});
+        check({0, -1, 2, -3, -1, 0, -2, 4});
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
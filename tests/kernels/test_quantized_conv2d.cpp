@@ -0,0 +1,154 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "quantized_test.h"
+#include <gtest/gtest.h>
+#include <nncase/kernels/stackvm/quantized_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+
+namespace {
+struct conv_case {
+    dims_t in_shape;
+    dims_t w_shape;
+    int64_t pad, stride, dilation, groups;
+    float low, high;
+    typecode_t target_type;
+    int32_t in_zero_point;
+    std::vector<float> scales;
+    int32_t out_zero_point;
+};
+
+void check_quantized_conv2d(const conv_case &c) {
+    std::vector<uint8_t> x(compute_size(c.in_shape));
+    std::vector<int8_t> w(compute_size(c.w_shape));
+    std::vector<int32_t> b(c.w_shape[0]);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = (uint8_t)(i * 37 % 256);
+    for (size_t i = 0; i < w.size(); i++)
+        w[i] = (int8_t)((int)(i * 53 % 256) - 128);
+    for (size_t i = 0; i < b.size(); i++)
+        b[i] = (int32_t)(i * 1000) - 4000;
+
+    // expected: padding holds the input zero point, so it adds nothing
+    const auto batch = (int64_t)c.in_shape[0], in_c = (int64_t)c.in_shape[1],
+               in_h = (int64_t)c.in_shape[2], in_w = (int64_t)c.in_shape[3];
+    const auto out_c = (int64_t)c.w_shape[0], g_ic = (int64_t)c.w_shape[1],
+               k_h = (int64_t)c.w_shape[2], k_w = (int64_t)c.w_shape[3];
+    const auto g_oc = out_c / c.groups;
+    const auto out_h =
+        (in_h + 2 * c.pad - c.dilation * (k_h - 1) - 1) / c.stride + 1;
+    const auto out_w =
+        (in_w + 2 * c.pad - c.dilation * (k_w - 1) - 1) / c.stride + 1;
+    auto input_at = [&](int64_t n, int64_t channel, int64_t y, int64_t x_) {
+        return (int64_t)x[((n * in_c + channel) * in_h + y) * in_w + x_] -
+               c.in_zero_point;
+    };
+    auto weight_at = [&](int64_t oc, int64_t ic, int64_t y, int64_t x_) {
+        return (int64_t)w[((oc * g_ic + ic) * k_h + y) * k_w + x_];
+    };
+    std::vector<int32_t> expected;
+    for (int64_t n = 0; n < batch; n++) {
+        for (int64_t oc = 0; oc < out_c; oc++) {
+            for (int64_t oy = 0; oy < out_h; oy++) {
+                for (int64_t ox = 0; ox < out_w; ox++) {
+                    int64_t acc = b[oc];
+                    for (int64_t ic = 0; ic < g_ic; ic++) {
+                        const auto channel = oc / g_oc * g_ic + ic;
+                        for (int64_t ky = 0; ky < k_h; ky++) {
+                            const auto iy =
+                                oy * c.stride - c.pad + ky * c.dilation;
+                            for (int64_t kx = 0; kx < k_w; kx++) {
+                                const auto ix =
+                                    ox * c.stride - c.pad + kx * c.dilation;
+                                if (iy < 0 || iy >= in_h || ix < 0 ||
+                                    ix >= in_w)
+                                    continue;
+                                acc += input_at(n, channel, iy, ix) *
+                                       weight_at(oc, ic, ky, kx);
+                            }
+                        }
+                    }
+                    expected.push_back(quantized_test_requantize(
+                        c.target_type, acc,
+                        c.scales[c.scales.size() == 1 ? 0 : oc],
+                        c.out_zero_point, c.low, c.high));
+                }
+            }
+        }
+    }
+
+    auto input = quantized_test_tensor(x, c.in_shape);
+    auto weights = quantized_test_tensor(w, c.w_shape);
+    auto bias = quantized_test_tensor(b, {b.size()});
+    auto stride = quantized_test_tensor<int64_t>({c.stride, c.stride}, {2});
+    auto padding =
+        quantized_test_tensor<int64_t>({c.pad, c.pad, c.pad, c.pad}, {2, 2});
+    auto dilation =
+        quantized_test_tensor<int64_t>({c.dilation, c.dilation}, {2});
+    auto groups = quantized_test_tensor<int64_t>({c.groups}, {});
+    auto fused_clamp = quantized_test_tensor<float>({c.low, c.high}, {2});
+    auto in_zero_point = quantized_test_tensor<int32_t>({c.in_zero_point}, {});
+    auto scales = quantized_test_tensor(c.scales, {c.scales.size()});
+    auto out_zero_point =
+        quantized_test_tensor<int32_t>({c.out_zero_point}, {});
+    expect_quantized_output_on_every_isa(
+        expected,
+        [&] {
+            return quantized_test_output(
+                kernels::stackvm::quantized_conv2d(
+                    c.target_type, input.impl(), weights.impl(), bias.impl(),
+                    stride.impl(), padding.impl(), dilation.impl(),
+                    groups.impl(), fused_clamp.impl(), in_zero_point.impl(),
+                    scales.impl(), out_zero_point.impl())
+                    .expect("quantized_conv2d failed"));
+        },
+        "groups " + std::to_string(c.groups));
+}
+} // namespace
+
+TEST(QuantizedConv2DTest, int32) {
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+    check_quantized_conv2d({{2, 3, 9, 11}, {21, 3, 3, 3}, 1, 1, 1, 1, -inf,
+                            inf, dt_int32, 0, {1.f}, 0});
+    check_quantized_conv2d({{1, 4, 13, 10}, {6, 2, 3, 2}, 2, 2, 2, 2, -inf,
+                            inf, dt_int32, 131, {1.f}, 0});
+    // the fused clamp bounds the accumulators
+    check_quantized_conv2d({{1, 5, 6, 7}, {9, 5, 1, 1}, 0, 1, 1, 1, -3000.5f,
+                            4000.5f, dt_int32, 7, {1.f}, 0});
+}
+
+TEST(QuantizedConv2DTest, uint8) {
+    std::vector<float> scales(21);
+    for (size_t j = 0; j < scales.size(); j++)
+        scales[j] = 2e-3f * (j % 4 + 1);
+    check_quantized_conv2d({{2, 3, 9, 11}, {21, 3, 3, 3}, 1, 1, 1, 1, -1e9f,
+                            1e9f, dt_uint8, 128, scales, 100});
+    // the fused clamp bounds the requantized values, as a fused relu6 does
+    check_quantized_conv2d({{1, 4, 13, 10}, {6, 2, 3, 2}, 2, 2, 2, 2, 128.f,
+                            200.f, dt_uint8, 3, {5e-3f}, 128});
+}
+
+TEST(QuantizedConv2DTest, int8) {
+    check_quantized_conv2d({{1, 4, 13, 10}, {6, 2, 3, 2}, 2, 2, 2, 2, -1e9f,
+                            1e9f, dt_int8, 131, {4e-3f}, -5});
+}
+
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+/* Copyright 2019-2021 Canaan Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "quantized_test.h"
+#include <gtest/gtest.h>
+#include <nncase/kernels/stackvm/quantized_ops.h>
+#include <nncase/runtime/datatypes.h>
+#include <nncase/runtime/runtime_tensor.h>
+#include <nncase/runtime/util.h>
+
+using namespace nncase;
+using namespace nncase::runtime;
+
+namespace {
+struct matmul_case {
+    dims_t lhs_shape;
+    dims_t rhs_shape;
+    typecode_t target_type;
+    int32_t lhs_zero_point;
+    std::vector<float> scales;
+    int32_t out_zero_point;
+};
+
+void check_quantized_matmul(const matmul_case &c) {
+    std::vector<uint8_t> l(compute_size(c.lhs_shape));
+    std::vector<int8_t> r(compute_size(c.rhs_shape));
+    for (size_t i = 0; i < l.size(); i++)
+        l[i] = (uint8_t)(i * 37 % 256);
+    // weights past +-64, so that the split maddubs path is taken
+    for (size_t i = 0; i < r.size(); i++)
+        r[i] = (int8_t)((int)(i * 53 % 256) - 128);
+
+    // expected: 1-D operands become a row and a column, and the batch dims
+    // broadcast as in onnx MatMul
+    dims_t a_shape = c.lhs_shape, b_shape = c.rhs_shape;
+    if (a_shape.size() == 1)
+        a_shape.insert(a_shape.begin(), 1);
+    if (b_shape.size() == 1)
+        b_shape.insert(b_shape.end(), 1);
+    const auto a = to_4d(a_shape), b = to_4d(b_shape);
+    const auto m = a[2], k = a[3], n = b[3];
+    const auto batches = std::max(a[0], b[0]);
+    const auto channels = std::max(a[1], b[1]);
+    std::vector<int32_t> expected;
+    for (size_t i = 0; i < batches; i++) {
+        for (size_t ch = 0; ch < channels; ch++) {
+            auto lhs = l.data() + ((a[0] == 1 ? 0 : i) * a[1] +
+                                   (a[1] == 1 ? 0 : ch)) *
+                                      m * k;
+            auto rhs = r.data() + ((b[0] == 1 ? 0 : i) * b[1] +
+                                   (b[1] == 1 ? 0 : ch)) *
+                                      k * n;
+            for (size_t y = 0; y < m; y++) {
+                for (size_t x = 0; x < n; x++) {
+                    int64_t acc = 0;
+                    for (size_t p = 0; p < k; p++)
+                        acc += (int64_t)(lhs[y * k + p] - c.lhs_zero_point) *
+                               rhs[p * n + x];
+                    expected.push_back(quantized_test_requantize(
+                        c.target_type, acc,
+                        c.scales[c.scales.size() == 1 ? 0 : x],
+                        c.out_zero_point, -INFINITY, INFINITY));
+                }
+            }
+        }
+    }
+
+    auto lhs = quantized_test_tensor(l, c.lhs_shape);
+    auto rhs = quantized_test_tensor(r, c.rhs_shape);
+    auto lhs_zero_point =
+        quantized_test_tensor<int32_t>({c.lhs_zero_point}, {});
+    auto scales = quantized_test_tensor(c.scales, {c.scales.size()});
+    auto out_zero_point =
+        quantized_test_tensor<int32_t>({c.out_zero_point}, {});
+    expect_quantized_output_on_every_isa(
+        expected,
+        [&] {
+            return quantized_test_output(
+                kernels::stackvm::quantized_mat_mul(
+                    c.target_type, lhs.impl(), rhs.impl(),
+                    lhs_zero_point.impl(), scales.impl(),
+                    out_zero_point.impl())
+                    .expect("quantized_mat_mul failed"));
+        },
+        "lhs rank " + std::to_string(c.lhs_shape.size()) + " rhs rank " +
+            std::to_string(c.rhs_shape.size()));
+}
+} // namespace
+
+TEST(QuantizedMatMulTest, int32) {
+    // k and n off the 4 x 16 block; a 3-D lhs with a 2-D rhs folds into m
+    check_quantized_matmul({{3, 5, 37}, {37, 21}, dt_int32, 0, {1.f}, 0});
+    check_quantized_matmul({{2, 7, 70}, {2, 70, 33}, dt_int32, 131, {1.f}, 0});
+    check_quantized_matmul({{1, 3}, {3, 1}, dt_int32, 255, {1.f}, 0});
+}
+
+TEST(QuantizedMatMulTest, broadcast) {
+    // batch dims of 1 on either side broadcast against the other side
+    check_quantized_matmul({{2, 1, 5, 37}, {3, 37, 21}, dt_int32, 7, {1.f}, 0});
+    check_quantized_matmul({{5, 37}, {2, 37, 21}, dt_int32, 0, {1.f}, 0});
+    check_quantized_matmul(
+        {{1, 3, 4, 19}, {2, 1, 19, 17}, dt_uint8, 128, {2e-3f}, 100});
+}
+
+TEST(QuantizedMatMulTest, vector) {
+    // a 1-D lhs is a single row and a 1-D rhs a single column
+    check_quantized_matmul({{37}, {37, 21}, dt_int32, 3, {1.f}, 0});
+    check_quantized_matmul({{2, 5, 37}, {37}, dt_int32, 3, {1.f}, 0});
+    check_quantized_matmul({{37}, {2, 37, 21}, dt_int8, 9, {1e-3f}, 0});
+    check_quantized_matmul({{37}, {37}, dt_int32, 200, {1.f}, 0});
+}
+
+TEST(QuantizedMatMulTest, uint8) {
+    std::vector<float> scales(21);
+    for (size_t j = 0; j < scales.size(); j++)
+        scales[j] = 1e-4f * (j % 5 + 1);
+    check_quantized_matmul({{3, 5, 37}, {37, 21}, dt_uint8, 128, scales, 100});
+    check_quantized_matmul(
+        {{2, 7, 70}, {2, 70, 33}, dt_uint8, 3, {2.5e-4f}, 128});
+}
+
+TEST(QuantizedMatMulTest, int8) {
+    check_quantized_matmul(
+        {{2, 7, 70}, {2, 70, 33}, dt_int8, 131, {2e-4f}, -5});
+    check_quantized_matmul({{4, 19}, {19, 40}, dt_int8, 0, {1e-3f}, 0});
+}
+
+TEST(QuantizedMatMulTest, invalid_scales) {
+    auto lhs = quantized_test_tensor(std::vector<uint8_t>(6), {2, 3});
+    auto rhs = quantized_test_tensor(std::vector<int8_t>(12), {3, 4});
+    auto zero_point = quantized_test_tensor<int32_t>({0}, {});
+    auto scales = quantized_test_tensor<float>({1.f, 1.f}, {2});
+    EXPECT_TRUE(kernels::stackvm::quantized_mat_mul(
+                    dt_uint8, lhs.impl(), rhs.impl(), zero_point.impl(),
+                    scales.impl(), zero_point.impl())
+                    .is_err());
+}
+
+TEST(QuantizedMatMulTest, invalid_batch) {
+    auto lhs = quantized_test_tensor(std::vector<uint8_t>(24), {2, 3, 4});
+    auto rhs = quantized_test_tensor(std::vector<int8_t>(60), {3, 4, 5});
+    auto zero_point = quantized_test_tensor<int32_t>({0}, {});
+    auto scales = quantized_test_tensor<float>({1.f}, {1});
+    EXPECT_TRUE(kernels::stackvm::quantized_mat_mul(
+                    dt_int32, lhs.impl(), rhs.impl(), zero_point.impl(),
+                    scales.impl(), zero_point.impl())
+                    .is_err());
+}
+
+int main(int argc, char *argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
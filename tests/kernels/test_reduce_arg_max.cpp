@@ -125,6 +125,77 @@ TEST_P(ReduceArgMaxTest, ReduceArgMax) {
     EXPECT_TRUE(result);
 }
 
+namespace {
+runtime_tensor make_scalar(int64_t value) {
+    return hrt::create(dt_int64, {1},
+                       {reinterpret_cast<gsl::byte *>(&value), sizeof(value)},
+                       true, host_runtime_tensor::pool_cpu_only)
+        .expect("create tensor failed");
+}
+
+// Reduces the rows of a [rows, cols] tensor and checks the selected indices.
+void expect_reduce_arg(runtime::stackvm::reduce_arg_op_t op,
+                       runtime_tensor &input, bool select_last,
+                       const std::vector<int64_t> &expected) {
+    auto axis = make_scalar(1);
+    auto keep_dims = make_scalar(0);
+    auto select_last_idx = make_scalar(select_last);
+    auto output = kernels::stackvm::reduce_arg(op, dt_int64, input.impl(),
+                                               axis.impl(), keep_dims.impl(),
+                                               select_last_idx.impl())
+                      .expect("reduce_arg failed");
+    runtime_tensor actual(output.as<tensor>().expect("as tensor failed"));
+    auto mapped = std::move(hrt::map(actual, map_read).unwrap());
+    auto data = mapped.buffer().as_span<int64_t>();
+    ASSERT_EQ(expected.size(), data.size());
+    for (size_t i = 0; i < data.size(); i++)
+        EXPECT_EQ(expected[i], data[i])
+            << "select_last " << select_last << " row " << i;
+}
+} // namespace
+
+TEST(ReduceArgTieTest, near_ties) {
+    // Only exactly equal values tie. A value one ulp away from the extremum
+    // is never selected, even with select_last_index. Contiguous inputs take
+    // the optimized kernel and strided ones the reference kernel.
+    constexpr size_t rows = 3, cols = 19;
+    const auto near = std::nextafter(1.f, 0.f);
+    std::vector<float> dense(rows * cols), sparse(rows * cols * 2);
+    for (size_t i = 0; i < dense.size(); i++)
+        dense[i] = (float)(i % 7) / 16.f - 0.25f;
+    auto row = [&](size_t r) { return dense.data() + r * cols; };
+    row(0)[3] = 1.f, row(0)[17] = near;
+    row(1)[0] = near, row(1)[2] = 1.f, row(1)[12] = 1.f, row(1)[15] = near;
+    row(2)[9] = near, row(2)[16] = 1.f;
+    const std::vector<int64_t> first{3, 2, 16}, last{3, 12, 16};
+
+    for (auto op : {runtime::stackvm::reduce_arg_op_t::arg_max,
+                    runtime::stackvm::reduce_arg_op_t::arg_min}) {
+        const float sign =
+            op == runtime::stackvm::reduce_arg_op_t::arg_max ? 1.f : -1.f;
+        std::vector<float> values(dense.size());
+        for (size_t i = 0; i < dense.size(); i++)
+            sparse[i * 2] = values[i] = sign * dense[i];
+
+        auto contiguous =
+            hrt::create(dt_float32, {rows, cols},
+                        {reinterpret_cast<gsl::byte *>(values.data()),
+                         values.size() * sizeof(float)},
+                        true, host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        auto strided =
+            hrt::create(dt_float32, {rows, cols}, {cols * 2, 2},
+                        {reinterpret_cast<gsl::byte *>(sparse.data()),
+                         sparse.size() * sizeof(float)},
+                        true, host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        for (auto input : {contiguous, strided}) {
+            expect_reduce_arg(op, input, false, first);
+            expect_reduce_arg(op, input, true, last);
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_type, i)
@@ -13,6 +13,7 @@
  * permissions and limitations under the License.
  */
 #include "kernel_test.h"
+#include <array>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -272,6 +273,69 @@ TEST_P(TileTest, Tile) {
     EXPECT_TRUE(result5);
 }
 
+TEST_P(TileTest, zero_and_unit_repeats) {
+    auto input_ort = runtime_tensor_2_ort_tensor(input);
+    auto tile = [&](std::array<int64_t, 4> repeats_array) {
+        auto repeats =
+            hrt::create(dt_int64, {4},
+                        {reinterpret_cast<gsl::byte *>(repeats_array.data()),
+                         sizeof(repeats_array)},
+                        true, host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+        auto output = kernels::stackvm::tile(input.impl(), repeats.impl())
+                          .expect("tile failed");
+        return std::make_pair(
+            repeats,
+            runtime_tensor(output.as<tensor>().expect("as tensor failed")));
+    };
+
+    // a zero repeat gives an empty output of the tiled shape
+    for (auto repeats_array : {std::array<int64_t, 4>{1, 0, 1, 1},
+                               std::array<int64_t, 4>{2, 1, 1, 0}}) {
+        auto [repeats, actual] = tile(repeats_array);
+        dims_t expected_shape(input.shape().begin(), input.shape().end());
+        for (size_t i = 0; i < expected_shape.size(); i++)
+            expected_shape[i] *= repeats_array[i];
+        EXPECT_TRUE(std::equal(expected_shape.begin(), expected_shape.end(),
+                               actual.shape().begin(), actual.shape().end()));
+    }
+
+    // unit repeats next to real ones are coalesced with them
+    for (auto repeats_array : {std::array<int64_t, 4>{1, 1, 1, 3},
+                               std::array<int64_t, 4>{3, 1, 1, 1},
+                               std::array<int64_t, 4>{1, 2, 1, 1},
+                               std::array<int64_t, 4>{2, 1, 3, 1}}) {
+        // actual
+        auto [repeats, actual] = tile(repeats_array);
+
+        // expected
+        size_t size = 0;
+        auto output_ort =
+            ortki_Tile(input_ort, runtime_tensor_2_ort_tensor(repeats));
+        void *ptr_ort = tensor_buffer(output_ort, &size);
+        dims_t shape(tensor_rank(output_ort));
+        tensor_shape(output_ort, reinterpret_cast<int64_t *>(shape.data()));
+        auto expected =
+            hrt::create(input.datatype(), shape,
+                        {reinterpret_cast<gsl::byte *>(ptr_ort), size}, true,
+                        host_runtime_tensor::pool_cpu_only)
+                .expect("create tensor failed");
+
+        bool result = is_same_tensor(expected, actual) ||
+                      cosine_similarity_tensor(expected, actual);
+
+        if (!result) {
+            std::cout << "actual ";
+            print_runtime_tensor(actual);
+            std::cout << "expected ";
+            print_runtime_tensor(expected);
+        }
+
+        // compare
+        EXPECT_TRUE(result);
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 #include "kernel_test.h"
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <nncase/kernels/stackvm/tensor_ops.h>
@@ -141,6 +142,89 @@ TEST_P(TopKTest, TopK) {
     [[maybe_unused]] auto result = check_tuple_output(expected, dtypes, output);
 }
 
+TEST(TopKTieBreakTest, sorted) {
+    // only 5 distinct values, so most kept elements tie with the k-th one
+    constexpr size_t rows = 3, length = 67;
+    std::vector<float> x(rows * length);
+    for (size_t i = 0; i < x.size(); i++)
+        x[i] = (float)(i * 7 % 5);
+    auto input0 = hrt::create(dt_float32, {rows, length},
+                              {reinterpret_cast<gsl::byte *>(x.data()),
+                               x.size() * sizeof(float)},
+                              true, host_runtime_tensor::pool_cpu_only)
+                      .expect("create tensor failed");
+    auto scalar = [](int64_t value) {
+        return hrt::create(dt_int64, {1},
+                           {reinterpret_cast<gsl::byte *>(&value),
+                            sizeof(value)},
+                           true, host_runtime_tensor::pool_cpu_only)
+            .expect("create tensor failed");
+    };
+
+    // k below and above the bounded heap limit of the optimized kernel
+    for (int64_t k_count : {5, 40}) {
+        for (int64_t largest_flag : {0, 1}) {
+            // expected: a replay of the bounded heap of the reference kernel,
+            // which decides the tied indices kept and orders ties by index
+            std::vector<float> expected_values;
+            std::vector<int64_t> expected_indices;
+            auto worse = [&](const std::pair<float, size_t> &a,
+                             const std::pair<float, size_t> &b) {
+                return largest_flag ? a > b : a < b;
+            };
+            for (size_t r = 0; r < rows; r++) {
+                std::vector<std::pair<float, size_t>> heap;
+                for (size_t i = 0; i < length; i++) {
+                    auto v = x[r * length + i];
+                    if (heap.size() < (size_t)k_count) {
+                        heap.emplace_back(v, i);
+                        std::push_heap(heap.begin(), heap.end(), worse);
+                    } else if (largest_flag ? v > heap.front().first
+                                            : v < heap.front().first) {
+                        std::pop_heap(heap.begin(), heap.end(), worse);
+                        heap.back() = {v, i};
+                        std::push_heap(heap.begin(), heap.end(), worse);
+                    }
+                }
+                std::sort_heap(heap.begin(), heap.end(), worse);
+                for (auto &p : heap) {
+                    expected_values.push_back(p.first);
+                    expected_indices.push_back((int64_t)p.second);
+                }
+            }
+
+            // actual
+            auto output =
+                kernels::stackvm::top_k(input0.impl(), scalar(k_count).impl(),
+                                        scalar(1).impl(),
+                                        scalar(largest_flag).impl(),
+                                        scalar(1).impl())
+                    .expect("topk failed");
+            auto fields =
+                output.as<tuple>().expect("as tuple failed")->fields();
+            runtime_tensor values(
+                fields[0].as<tensor>().expect("as tensor failed"));
+            runtime_tensor indices(
+                fields[1].as<tensor>().expect("as tensor failed"));
+
+            auto values_mapped = std::move(hrt::map(values, map_read).unwrap());
+            auto values_data = values_mapped.buffer().as_span<float>();
+            auto indices_mapped =
+                std::move(hrt::map(indices, map_read).unwrap());
+            auto indices_data = indices_mapped.buffer().as_span<int64_t>();
+
+            // compare
+            EXPECT_EQ(expected_values, std::vector<float>(values_data.begin(),
+                                                          values_data.end()))
+                << "k " << k_count << " largest " << largest_flag;
+            EXPECT_EQ(expected_indices,
+                      std::vector<int64_t>(indices_data.begin(),
+                                           indices_data.end()))
+                << "k " << k_count << " largest " << largest_flag;
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     READY_TEST_CASE_GENERATE()
     FOR_LOOP(lhs_shape, i)
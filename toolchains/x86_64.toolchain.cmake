@@ -1,5 +1,9 @@
-if (MSVC)
-    add_compile_options(/arch:AVX)
-else()
-    add_compile_options(-mavx)
+# With ENABLE_X86_KERNEL_DISPATCH (the default) only the per-ISA kernel
+# builds use AVX, so the rest of the runtime stays at the x86_64 baseline.
+if(DEFINED ENABLE_X86_KERNEL_DISPATCH AND NOT ENABLE_X86_KERNEL_DISPATCH)
+    if (MSVC)
+        add_compile_options(/arch:AVX)
+    else()
+        add_compile_options(-mavx)
+    endif()
 endif()